@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace libbitcoin {
+namespace database {
+namespace bench {
+
+using namespace bc::system;
+using namespace boost::filesystem;
+
+bool selected(const parameters& parameters, const std::string& name)
+{
+    return name.find(parameters.filter) != std::string::npos;
+}
+
+path file(const parameters& parameters, const std::string& name)
+{
+    create_directories(parameters.directory);
+    const auto filename = parameters.directory / name;
+
+    // A file_storage opens an existing file, this replaces any of the name.
+    ofstream stream(filename.string(), std::ios::trunc);
+    stream.put('z');
+    return filename;
+}
+
+hash_digest key(size_t index)
+{
+    data_chunk data(sizeof(uint64_t));
+    make_unsafe_serializer(data.begin()).write_8_bytes_little_endian(index);
+    return sha256_hash(data);
+}
+
+void measure(const std::string& name, size_t count, size_t threads,
+    const operation& operation)
+{
+    const auto workers = std::max(std::min(threads, count), size_t(1));
+    const auto span = (count + workers - 1u) / workers;
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+
+    const auto start = asio::steady_clock::now();
+
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        const auto begin = worker * span;
+        const auto end = std::min(begin + span, count);
+
+        pool.emplace_back([&operation, begin, end]()
+        {
+            for (auto index = begin; index < end; ++index)
+                operation(index);
+        });
+    }
+
+    for (auto& thread: pool)
+        thread.join();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        asio::steady_clock::now() - start).count();
+    const auto per = count == 0 ? 0.0 : double(elapsed) / count;
+    const auto rate = elapsed == 0 ? 0.0 : count * 1e9 / elapsed;
+
+    std::cout
+        << std::left << std::setw(40) << name << std::right
+        << std::setw(12) << count << " ops "
+        << std::setw(3) << workers << " threads "
+        << std::fixed << std::setprecision(1)
+        << std::setw(12) << per << " ns/op "
+        << std::setw(14) << rate << " ops/s" << std::endl;
+}
+
+} // namespace bench
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_BENCH_HPP
+#define LIBBITCOIN_DATABASE_BENCH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace libbitcoin {
+namespace database {
+namespace bench {
+
+/// The scale of each benchmark, from the command line.
+struct parameters
+{
+    /// Operations per benchmark, partitioned across threads.
+    size_t count;
+
+    /// Threads of concurrent benchmarks (one for the others).
+    size_t threads;
+
+    /// Buckets of the hash tables.
+    size_t buckets;
+
+    /// Directory of the benchmark files, removed once all have run.
+    boost::filesystem::path directory;
+
+    /// Substring of the names of the benchmarks to run (all if empty).
+    std::string filter;
+};
+
+typedef std::function<void(size_t index)> operation;
+
+/// True if the benchmark of the name is selected by the filter.
+bool selected(const parameters& parameters, const std::string& name);
+
+/// A new file of the name in the benchmark directory, replacing any other.
+boost::filesystem::path file(const parameters& parameters,
+    const std::string& name);
+
+/// A well distributed key of the index.
+system::hash_digest key(size_t index);
+
+/// Invoke the operation for each index of the count, partitioned across the
+/// threads, and write the elapsed time and rate of the operations.
+void measure(const std::string& name, size_t count, size_t threads,
+    const operation& operation);
+
+// Benchmarks by module.
+void primitives(const parameters& parameters);
+void memory(const parameters& parameters);
+void unspent(const parameters& parameters);
+
+} // namespace bench
+} // namespace database
+} // namespace libbitcoin
+
+#endif
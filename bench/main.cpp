@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "bench.hpp"
+
+#define BS_BENCH_USAGE \
+    "Usage: libbitcoin-database-bench [count [threads [buckets [filter " \
+    "[directory]]]]]\n"
+
+using namespace bc;
+using namespace bc::database;
+
+// Run the selected benchmarks of the storage primitives.
+int main(int argc, char** argv)
+{
+    bench::parameters parameters;
+    parameters.count = 1000000;
+    parameters.threads = 4;
+    parameters.buckets = 1000003;
+    parameters.directory = "bench";
+
+    try
+    {
+        if (argc > 1)
+            parameters.count = std::stoul(argv[1]);
+
+        if (argc > 2)
+            parameters.threads = std::stoul(argv[2]);
+
+        if (argc > 3)
+            parameters.buckets = std::stoul(argv[3]);
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << BS_BENCH_USAGE;
+        return -1;
+    }
+
+    if (argc > 4)
+        parameters.filter = argv[4];
+
+    if (argc > 5)
+        parameters.directory = argv[5];
+
+    if (parameters.buckets == 0 || argc > 6)
+    {
+        std::cerr << BS_BENCH_USAGE;
+        return -1;
+    }
+
+    bench::primitives(parameters);
+    bench::memory(parameters);
+    bench::unspent(parameters);
+
+    boost::filesystem::remove_all(parameters.directory);
+    return 0;
+}
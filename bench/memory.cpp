@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <cstddef>
+#include <string>
+#include <bitcoin/database.hpp>
+
+namespace libbitcoin {
+namespace database {
+namespace bench {
+
+// The bytes of each reservation, as of a small tx.
+static constexpr size_t value_size = 256;
+
+// Each reservation grows the file by the value size. Without a reservation
+// of address space and without expansion each one remaps the file.
+static void reserve(const parameters& parameters, const std::string& name,
+    size_t expansion, size_t reservation)
+{
+    if (!selected(parameters, name))
+        return;
+
+    file_storage storage(file(parameters, "file_storage"),
+        file_storage::default_capacity, expansion, 0, reservation);
+
+    if (!storage.open())
+        return;
+
+    measure(name, parameters.count, 1, [&](size_t index)
+    {
+        storage.reserve((index + 1u) * value_size);
+    });
+
+    storage.close();
+}
+
+void memory(const parameters& parameters)
+{
+    const auto size = parameters.count * value_size;
+    const auto expansion = file_storage::default_expansion;
+
+    reserve(parameters, "file_storage reserve (expanded)", expansion, 0);
+    reserve(parameters, "file_storage reserve (reserved)", 0,
+        file_storage::default_capacity + size);
+    reserve(parameters, "file_storage reserve (remap)", 0, 0);
+}
+
+} // namespace bench
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+namespace libbitcoin {
+namespace database {
+namespace bench {
+
+using namespace bc::system;
+
+typedef hash_digest key_type;
+typedef array_index index_type;
+typedef file_offset slab_link;
+typedef array_index record_link;
+typedef slab_manager<slab_link> slab_store;
+typedef record_manager<record_link> record_store;
+typedef hash_table<slab_store, index_type, slab_link, key_type> slab_map;
+typedef hash_table<record_store, index_type, record_link, key_type>
+    record_map;
+typedef hash_table_multimap<index_type, record_link, key_type>
+    record_multimap;
+
+// The value of each element, about the size of a small tx.
+static constexpr size_t value_size = 256;
+
+// The rows of each key of the multimap.
+static constexpr size_t rows = 16;
+
+static void write_value(byte_serializer& serial)
+{
+    serial.skip(value_size);
+}
+
+// The slab table is linked, then found and unlinked by all of its keys.
+static void slab_table(const parameters& parameters)
+{
+    const auto index_buckets = static_cast<index_type>(parameters.buckets);
+
+    if (!selected(parameters, "hash_table"))
+        return;
+
+    file_storage storage(file(parameters, "hash_table"));
+    if (!storage.open())
+        return;
+
+    slab_map table(storage, index_buckets);
+    if (!table.create())
+        return;
+
+    measure("hash_table link (slab)", parameters.count, parameters.threads,
+        [&](size_t index)
+        {
+            auto element = table.allocator();
+            element.create(key(index), write_value, value_size);
+            table.link(element);
+        });
+
+    table.commit();
+    std::atomic<size_t> found(0);
+
+    measure("hash_table find (slab)", parameters.count, parameters.threads,
+        [&](size_t index)
+        {
+            if (table.find(key(index)))
+                ++found;
+        });
+
+    measure("hash_table unlink (slab)", parameters.count, parameters.threads,
+        [&](size_t index)
+        {
+            table.unlink(key(index));
+        });
+
+    table.commit();
+    storage.close();
+}
+
+static void managers(const parameters& parameters)
+{
+    if (selected(parameters, "record_manager allocate"))
+    {
+        file_storage storage(file(parameters, "record_manager"));
+        record_store manager(storage, 0, value_size);
+
+        if (storage.open() && manager.create())
+        {
+            measure("record_manager allocate", parameters.count,
+                parameters.threads, [&](size_t)
+                {
+                    manager.allocate(1);
+                });
+
+            manager.commit();
+            storage.close();
+        }
+    }
+
+    if (selected(parameters, "slab_manager allocate"))
+    {
+        file_storage storage(file(parameters, "slab_manager"));
+        slab_store manager(storage, 0);
+
+        if (storage.open() && manager.create())
+        {
+            measure("slab_manager allocate", parameters.count,
+                parameters.threads, [&](size_t)
+                {
+                    manager.allocate(value_size);
+                });
+
+            manager.commit();
+            storage.close();
+        }
+    }
+}
+
+// The multimap is linked with the rows of each key, and the rows of each key
+// are then traversed (by the list elements of the key).
+static void multimap(const parameters& parameters)
+{
+    const auto index_buckets = static_cast<index_type>(parameters.buckets);
+    const auto keys = std::max(parameters.count / rows, size_t(1));
+
+    if (!selected(parameters, "hash_table_multimap link") &&
+        !selected(parameters, "list_element traversal"))
+        return;
+
+    file_storage table_file(file(parameters, "multimap_table"));
+    file_storage rows_file(file(parameters, "multimap_rows"));
+
+    if (!table_file.open() || !rows_file.open())
+        return;
+
+    record_map table(table_file, index_buckets, sizeof(record_link));
+    record_store index(rows_file, 0, record_multimap::size(value_size));
+    record_multimap multimap(table, index);
+
+    if (!table.create() || !index.create())
+        return;
+
+    measure("hash_table_multimap link", parameters.count, parameters.threads,
+        [&](size_t row)
+        {
+            auto element = multimap.allocator();
+            element.create(write_value);
+            multimap.link(key(row % keys), element);
+        });
+
+    table.commit();
+    index.commit();
+    std::atomic<size_t> visited(0);
+
+    measure("list_element traversal", keys, parameters.threads,
+        [&](size_t key_index)
+        {
+            size_t count = 0;
+            for (auto row = multimap.find(key(key_index)); row;
+                row.jump_next())
+                ++count;
+
+            visited += count;
+        });
+
+    table_file.close();
+    rows_file.close();
+}
+
+void primitives(const parameters& parameters)
+{
+    slab_table(parameters);
+    managers(parameters);
+    multimap(parameters);
+}
+
+} // namespace bench
+} // namespace database
+} // namespace libbitcoin
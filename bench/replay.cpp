@@ -0,0 +1,300 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_REPLAY_USAGE \
+    "Usage: libbitcoin-database-replay blocks directory [count " \
+    "[push|organize] [--catalog] [--flush]]\n"
+#define BS_REPLAY_DIR_EXISTS \
+    "Failed because the directory %1% already exists.\n"
+#define BS_REPLAY_FILE_MISSING \
+    "Failed to open the blocks file %1%.\n"
+#define BS_REPLAY_READ_FAIL \
+    "Failed to read the block at height %1%.\n"
+#define BS_REPLAY_CREATE_FAIL \
+    "Failed to create the database from the first block.\n"
+#define BS_REPLAY_WRITE_FAIL \
+    "Failed to %1% the block at height %2%, '%3%'.\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace boost::filesystem;
+using boost::format;
+
+// The blocks file is framed as by the linearized block files of the satoshi
+// client (and its blk*.dat files), with the blocks in height order from the
+// genesis block: network magic (4), block size (4), block (wire, witness).
+static bool read_block(std::ifstream& file, block& out)
+{
+    data_chunk frame(2 * sizeof(uint32_t));
+
+    if (!file.read(reinterpret_cast<char*>(frame.data()), frame.size()))
+        return false;
+
+    const auto size = from_little_endian_unsafe<uint32_t>(frame.data() +
+        sizeof(uint32_t));
+    data_chunk data(size);
+
+    if (!file.read(reinterpret_cast<char*>(data.data()), data.size()))
+        return false;
+
+    return out.from_data(data, true);
+}
+
+// The median of the timestamps of the preceding (up to) eleven blocks.
+static uint32_t median_time_past(const std::deque<uint32_t>& timestamps)
+{
+    if (timestamps.empty())
+        return 0;
+
+    std::vector<uint32_t> sorted(timestamps.begin(), timestamps.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2u];
+}
+
+static void report(const std::string& name,
+    const latency_histogram::values& values)
+{
+    if (values.count == 0)
+        return;
+
+    const auto mean = std::chrono::duration_cast<asio::microseconds>(
+        values.total).count() / values.count;
+    const auto maximum = std::chrono::duration_cast<asio::microseconds>(
+        values.maximum).count();
+
+    std::cout
+        << std::left << std::setw(12) << name << std::right
+        << std::setw(10) << values.count << " calls "
+        << std::setw(10) << mean << " us mean "
+        << std::setw(10) << values.quantile(0.5).count() << " us p50 "
+        << std::setw(10) << values.quantile(0.99).count() << " us p99 "
+        << std::setw(10) << maximum << " us max" << std::endl;
+}
+
+// Populate the prevouts of the block from the store, as does validation.
+static void populate(const data_base& database, const block& block,
+    size_t fork_height)
+{
+    for (const auto& tx: block.transactions())
+    {
+        if (tx.is_coinbase())
+            continue;
+
+        for (const auto& input: tx.inputs())
+            database.transactions().get_output(input.previous_output(),
+                fork_height);
+    }
+}
+
+// Drive the blocks of the file through the writers of a new database, and
+// report rates, the latencies of each writer and the bytes written.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << BS_REPLAY_USAGE;
+        return -1;
+    }
+
+    const path blocks_file(argv[1]);
+    const path directory(argv[2]);
+    auto count = max_size_t;
+    auto organize = false;
+    auto catalog = false;
+    auto flush = false;
+
+    try
+    {
+        if (argc > 3)
+            count = std::stoul(argv[3]);
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << BS_REPLAY_USAGE;
+        return -1;
+    }
+
+    for (auto arg = 4; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (option == "organize")
+            organize = true;
+        else if (option == "--catalog")
+            catalog = true;
+        else if (option == "--flush")
+            flush = true;
+        else if (option != "push")
+        {
+            std::cerr << BS_REPLAY_USAGE;
+            return -1;
+        }
+    }
+
+    if (exists(directory))
+    {
+        std::cerr << format(BS_REPLAY_DIR_EXISTS) % directory;
+        return -1;
+    }
+
+    std::ifstream file(blocks_file.string(), std::ios::binary);
+
+    if (!file.good())
+    {
+        std::cerr << format(BS_REPLAY_FILE_MISSING) % blocks_file;
+        return -1;
+    }
+
+    block genesis;
+
+    if (!read_block(file, genesis))
+    {
+        std::cerr << format(BS_REPLAY_READ_FAIL) % 0;
+        return -1;
+    }
+
+    create_directories(directory);
+    database::settings configuration;
+    configuration.directory = directory;
+    configuration.flush_writes = flush;
+    data_base database(configuration, catalog);
+
+    if (!database.create(genesis))
+    {
+        std::cerr << BS_REPLAY_CREATE_FAIL;
+        return -1;
+    }
+
+    const auto initial = database.counters().total().logical;
+    std::deque<uint32_t> timestamps{ genesis.header().timestamp() };
+    latency_histogram populate_latency;
+    size_t blocks = 0;
+    size_t transactions = 0;
+    auto previous = genesis.hash();
+
+    const auto start = asio::steady_clock::now();
+
+    for (size_t height = 1; blocks < count; ++height)
+    {
+        block next;
+
+        if (!read_block(file, next))
+        {
+            if (file.eof())
+                break;
+
+            std::cerr << format(BS_REPLAY_READ_FAIL) % height;
+            return -1;
+        }
+
+        const auto time = median_time_past(timestamps);
+        code ec;
+        std::string stage;
+
+        if (!organize)
+        {
+            stage = "push";
+            ec = database.push(next, height, time);
+        }
+        else
+        {
+            const auto incoming = std::make_shared<header_const_ptr_list>();
+            const auto outgoing = std::make_shared<header_const_ptr_list>();
+            const auto header = std::make_shared<message::header>(
+                next.header());
+            header->metadata.median_time_past = time;
+            incoming->push_back(header);
+
+            if ((ec = database.reorganize({ previous, height - 1u },
+                incoming, outgoing)))
+                stage = "reorganize";
+            else if ((ec = database.update(next, height)))
+                stage = "update";
+            else
+            {
+                {
+                    const latency_histogram::timer timer(populate_latency);
+                    populate(database, next, height - 1u);
+                }
+
+                if ((ec = database.candidate(next)))
+                    stage = "candidate";
+                else if (catalog && (ec = database.catalog(next)))
+                    stage = "catalog";
+                else if ((ec = database.confirm(next.hash(), height)))
+                    stage = "confirm";
+            }
+        }
+
+        if (ec)
+        {
+            std::cerr << format(BS_REPLAY_WRITE_FAIL) % stage % height %
+                ec.message();
+            return -1;
+        }
+
+        timestamps.push_back(next.header().timestamp());
+        if (timestamps.size() > 11u)
+            timestamps.pop_front();
+
+        previous = next.hash();
+        transactions += next.transactions().size();
+        ++blocks;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<asio::microseconds>(
+        asio::steady_clock::now() - start).count();
+    const auto seconds = std::max(elapsed, decltype(elapsed)(1)) / 1e6;
+    const auto written = database.counters().total().logical - initial;
+    const auto latencies = database.latencies();
+
+    std::cout
+        << std::fixed << std::setprecision(1)
+        << blocks << " blocks, " << transactions << " txs in " << seconds
+        << " s: " << blocks / seconds << " blocks/s, "
+        << transactions / seconds << " txs/s, " << written
+        << " bytes written." << std::endl;
+
+    report("push", latencies.push);
+    report("reorganize", latencies.reorganize);
+    report("update", latencies.update);
+    report("populate", populate_latency.read());
+    report("get_output", latencies.get_output);
+    report("candidate", latencies.candidate);
+    report("catalog", latencies.catalog);
+    report("confirm", latencies.confirm);
+
+    return database.close() ? 0 : -1;
+}
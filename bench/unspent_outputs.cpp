@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/database.hpp>
+
+namespace libbitcoin {
+namespace database {
+namespace bench {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// The outputs of each tx, its hash is cached before it is measured.
+static constexpr uint32_t outputs = 2;
+
+static transaction::list transactions(size_t count)
+{
+    transaction::list out;
+    out.reserve(count);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        out.push_back({ 1, static_cast<uint32_t>(index), {},
+            output::list(outputs, { index, {} }) });
+        out.back().hash();
+    }
+
+    return out;
+}
+
+// The cache holds all of the txs, so that each populate is a hit.
+void unspent(const parameters& parameters)
+{
+    if (!selected(parameters, "unspent_outputs"))
+        return;
+
+    const auto txs = transactions(parameters.count);
+    database::unspent_outputs cache(parameters.count);
+
+    measure("unspent_outputs add", parameters.count, parameters.threads,
+        [&](size_t index)
+        {
+            cache.add(txs[index], index, 0, true);
+        });
+
+    std::atomic<size_t> hits(0);
+
+    measure("unspent_outputs populate", parameters.count, parameters.threads,
+        [&](size_t index)
+        {
+            const output_point point{ txs[index].hash(),
+                static_cast<uint32_t>(index % outputs) };
+
+            if (cache.populate(point))
+                ++hits;
+        });
+}
+
+} // namespace bench
+} // namespace database
+} // namespace libbitcoin
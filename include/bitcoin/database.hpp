@@ -16,34 +16,63 @@
 
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
+#include <bitcoin/database/cache_policy.hpp>
+#include <bitcoin/database/change_feed.hpp>
+#include <bitcoin/database/compact_filter.hpp>
+#include <bitcoin/database/compressed_script.hpp>
+#include <bitcoin/database/concurrent.hpp>
 #include <bitcoin/database/data_base.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/existence_filter.hpp>
+#include <bitcoin/database/latency_histogram.hpp>
+#include <bitcoin/database/negative_cache.hpp>
+#include <bitcoin/database/script_hash_cache.hpp>
 #include <bitcoin/database/settings.hpp>
+#include <bitcoin/database/sip_hash.hpp>
 #include <bitcoin/database/store.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 #include <bitcoin/database/unspent_outputs.hpp>
 #include <bitcoin/database/unspent_transaction.hpp>
 #include <bitcoin/database/verify.hpp>
 #include <bitcoin/database/version.hpp>
 #include <bitcoin/database/databases/address_database.hpp>
+#include <bitcoin/database/databases/balance_database.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
+#include <bitcoin/database/databases/filter_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/databases/utxo_database.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
+#include <bitcoin/database/memory/processor_affinity.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/striped_mutex.hpp>
+#include <bitcoin/database/memory/striped_sequence.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/hash_table_header.hpp>
 #include <bitcoin/database/primitives/hash_table_multimap.hpp>
 #include <bitcoin/database/primitives/list.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/primitives/list_iterator.hpp>
+#include <bitcoin/database/primitives/open_table.hpp>
+#include <bitcoin/database/primitives/record_field.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
 #include <bitcoin/database/result/address_iterator.hpp>
 #include <bitcoin/database/result/address_result.hpp>
 #include <bitcoin/database/result/block_result.hpp>
 #include <bitcoin/database/result/inpoint_iterator.hpp>
+#include <bitcoin/database/result/output_view.hpp>
 #include <bitcoin/database/result/transaction_iterator.hpp>
+#include <bitcoin/database/result/transaction_links.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
+#include <bitcoin/database/result/transaction_view.hpp>
 
 #endif
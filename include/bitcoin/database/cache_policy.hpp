@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_CACHE_POLICY_HPP
+#define LIBBITCOIN_DATABASE_CACHE_POLICY_HPP
+
+#include <cstdint>
+
+namespace libbitcoin {
+namespace database {
+
+/// The eviction policy of the unspent output cache.
+enum class cache_policy : uint8_t
+{
+    /// Evict the oldest entry by insertion.
+    fifo,
+
+    /// Evict the oldest entry not hit since it was last passed over, so hot
+    /// entries are promoted and a one-shot scan does not flush them (clock).
+    clock
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
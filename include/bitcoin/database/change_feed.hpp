@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_CHANGE_FEED_HPP
+#define LIBBITCOIN_DATABASE_CHANGE_FEED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// An ordered feed of the changes committed by the writers of a store, for
+/// replay into a replica by data_base::apply. Only the most recent changes
+/// are retained, in memory, so a follower that falls behind them (or that
+/// outlives the store) must be rebuilt.
+class BCD_API change_feed
+  : system::noncopyable
+{
+public:
+    /// The data_base writer of the change.
+    enum class operation : uint8_t
+    {
+        push,
+        reorganize_headers,
+        reorganize_blocks,
+        update,
+        invalidate,
+        candidate,
+        confirm,
+        store,
+        catalog_block,
+        catalog_transaction
+    };
+
+    /// A committed change, sequenced from one.
+    struct BCD_API change
+    {
+        /// The change of the wire serialization, false if invalid.
+        static bool from_data(change& out, const system::data_chunk& data);
+
+        /// The wire serialization of the change.
+        system::data_chunk to_data() const;
+
+        uint64_t sequence;
+        operation type;
+        system::data_chunk data;
+    };
+
+    typedef std::vector<change> list;
+
+    /// Construct a feed retaining up to the capacity of changes.
+    change_feed(size_t capacity);
+
+    /// Sequence and retain the change, dropping the oldest if full.
+    void publish(operation type, system::data_chunk&& data);
+
+    /// Append up to the limit of changes after the sequence, false if any of
+    /// them is no longer retained or the sequence has not been published.
+    bool read(list& out, uint64_t after, size_t limit) const;
+
+    /// The sequence of the last change published, zero if none.
+    uint64_t sequence() const;
+
+private:
+    const size_t capacity_;
+
+    // Protected by mutex.
+    uint64_t sequence_;
+    std::deque<change> changes_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_COMPACT_FILTER_HPP
+#define LIBBITCOIN_DATABASE_COMPACT_FILTER_HPP
+
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// BIP158 basic block filters, a Golomb-coded set of the output scripts of
+/// a block and the scripts of the prevouts that it spends, keyed by the
+/// block hash. Filter headers chain the filters of successive blocks.
+class BCD_API compact_filter
+{
+public:
+    /// The Golomb-Rice parameter and false positive rate (1/m) of the basic
+    /// filter.
+    static const uint8_t basic_p;
+    static const uint64_t basic_m;
+
+    /// The distinct elements of the basic filter of the block, excluding
+    /// empty and null data scripts (prevout metadata must be populated).
+    static system::data_stack elements(const system::chain::block& block);
+
+    /// Encode the elements as a filter keyed by the block hash, prefixed by
+    /// the element count.
+    static system::data_chunk encode(const system::hash_digest& block_hash,
+        const system::data_stack& elements);
+
+    /// False if the element is certainly not in the filter of the block.
+    static bool match(const system::data_chunk& filter,
+        const system::hash_digest& block_hash,
+        const system::data_chunk& element);
+
+    /// The header of the filter, chained to the previous filter header (null
+    /// hash for the genesis block).
+    static system::hash_digest header(const system::data_chunk& filter,
+        const system::hash_digest& previous_header);
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
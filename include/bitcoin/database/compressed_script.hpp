@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_COMPRESSED_SCRIPT_HPP
+#define LIBBITCOIN_DATABASE_COMPRESSED_SCRIPT_HPP
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// Template compression of output scripts for storage.
+/// Standard pay-to-key-hash, pay-to-script-hash and witness v0 key and script
+/// hash scripts are stored as a one byte template and the hash. All other
+/// scripts are stored as their size (offset past the templates) and bytes.
+class BCD_API compressed_script
+{
+public:
+    /// The stored size of the script (given as bytes without size prefix).
+    static size_t size(const system::data_chunk& script);
+
+    /// Write the script (given as bytes without size prefix).
+    static void write(byte_serializer& serial,
+        const system::data_chunk& script);
+
+    /// Read a stored script, returning its bytes without size prefix.
+    static system::data_chunk read(byte_deserializer& deserial);
+
+    /// Read past a stored script.
+    static void skip(byte_deserializer& deserial);
+
+    /// The size of a stored script, read without advancing the deserializer.
+    static size_t stored_size(byte_deserializer deserial);
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_CONCURRENT_HPP
+#define LIBBITCOIN_DATABASE_CONCURRENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// Invoke the handler over [0, count) in batches on the threadpool and wait
+/// for all to complete. Runs on the calling thread if the pool is not started.
+/// Each batch runs pinned to the processors of a nonzero mask of NUMA nodes.
+BCD_API void concurrent(system::threadpool& pool, size_t count, size_t batch,
+    const std::function<void(size_t first, size_t last)>& handler,
+    uint64_t nodes=0);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -20,15 +20,33 @@
 #define LIBBITCOIN_DATABASE_DATA_BASE_HPP
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/change_feed.hpp>
 #include <bitcoin/database/databases/address_database.hpp>
 #include <bitcoin/database/databases/block_database.hpp>
+#include <bitcoin/database/databases/balance_database.hpp>
+#include <bitcoin/database/databases/filter_database.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/databases/utxo_database.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/latency_histogram.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/striped_sequence.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
 
@@ -41,6 +59,60 @@ class BCD_API data_base
 {
 public:
     typedef std::function<void(const system::code&)> result_handler;
+    typedef std::function<void(size_t top)> snapshot_reader;
+
+    /// The performance counters of each table, address counters are zero if
+    /// not indexed.
+    struct table_counters
+    {
+        storage_counters block_table;
+        storage_counters candidate_index;
+        storage_counters confirmed_index;
+        storage_counters transaction_index;
+        storage_counters transaction_table;
+        storage_counters address_table;
+        storage_counters address_index;
+        storage_counters utxo_table;
+        storage_counters filter_table;
+        storage_counters balance_table;
+
+        /// The sum over all tables.
+        storage_counters total() const;
+    };
+
+    /// The memory footprint of each table, address footprints are zero if
+    /// not indexed, with the approximate bytes of the output cache.
+    struct table_residency
+    {
+        storage_residency block_table;
+        storage_residency candidate_index;
+        storage_residency confirmed_index;
+        storage_residency transaction_index;
+        storage_residency transaction_table;
+        storage_residency address_table;
+        storage_residency address_index;
+        storage_residency utxo_table;
+        storage_residency filter_table;
+        storage_residency balance_table;
+        uint64_t output_cache;
+
+        /// The sum over all tables.
+        storage_residency total() const;
+    };
+
+    /// The latencies of the writers (including waits on the write locks),
+    /// and of prevout lookups by the transaction table.
+    struct operation_latencies
+    {
+        latency_histogram::values push;
+        latency_histogram::values reorganize;
+        latency_histogram::values confirm;
+        latency_histogram::values update;
+        latency_histogram::values candidate;
+        latency_histogram::values catalog;
+        latency_histogram::values store;
+        latency_histogram::values get_output;
+    };
 
     data_base(const settings& settings, bool catalog);
 
@@ -62,6 +134,29 @@ public:
     /// Call close on destruct.
     ~data_base();
 
+    /// Initiate write back of all tables, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
+    /// Apply the access advice of each table, valid once opened or created.
+    bool advise(const settings& settings);
+
+    /// Apply the NUMA placement of each table, valid once opened or created.
+    bool place(const settings& settings);
+
+    /// Fault in (and optionally pin) the configured hot regions in parallel.
+    bool prefault(const settings& settings);
+
+    /// The performance counters of each table, valid once opened or created.
+    table_counters counters() const;
+
+    /// The memory footprint of each table, valid once opened or created.
+    /// The resident pages of each file are read from the kernel, at a cost
+    /// proportional to its size, so this is for diagnostics.
+    table_residency residency() const;
+
+    /// The latency histograms of each operation, valid once opened or created.
+    operation_latencies latencies() const;
+
     /// Reader interfaces.
     // ------------------------------------------------------------------------
     // These are const to preclude write operations by public callers.
@@ -70,9 +165,46 @@ public:
 
     const transaction_database& transactions() const;
 
-    /// Invalid if indexes not initialized.
+    /// Invalid if indexes not initialized, waits for a lazy open of the
+    /// table to complete (invalid if the open failed).
     const address_database& addresses() const;
 
+    /// False while the address table is opened in the background (lazy).
+    bool addresses_ready() const;
+
+    /// Invalid if filters not initialized.
+    const filter_database& filters() const;
+
+    /// The height through which confirmed blocks are address indexed, the
+    /// confirmed top unless indexing is deferred, false if none (or not
+    /// indexed). Rows of unconfirmed txs are not indexed when deferred.
+    bool cataloged(size_t& out_height) const;
+
+    /// Invalid if balances not initialized.
+    const balance_database& balances() const;
+
+    /// Invalid if the change feed not enabled (change_feed_size). The first
+    /// change is the genesis push of create, with which followers are created.
+    const change_feed& changes() const;
+
+    /// Write the wire serialization of the block to out (resized), copying
+    /// from the stored header and tx records without building txs. False if
+    /// the block is not found or populated, or has pruned output scripts.
+    bool block_data(system::data_chunk& out, const block_result& block,
+        bool witness=true) const;
+
+    /// Invoke the reader with the confirmed top height, repeating it until
+    /// its reads overlap no confirmation or reorganization. The reads of
+    /// blocks, their txs and spend states are then consistent with the top.
+    /// Writers are not blocked. False if there is no confirmed top.
+    bool snapshot(const snapshot_reader& reader) const;
+
+    /// Follow the files and committed tops of the writer of a read-only
+    /// store, such as before each query (no-op if not read only). Records
+    /// referenced across tables are read without a remap if the files are
+    /// mapped within a reservation (file_reservation_size).
+    bool refresh();
+
     // Node writers.
     // ------------------------------------------------------------------------
 
@@ -81,6 +213,13 @@ public:
     system::code push(const system::chain::block& block, size_t height=0,
         uint32_t median_time_past=0);
 
+    // INITCHAIN (bootstrap)
+    /// Push the consecutive blocks from height through candidacy and
+    /// confirmation (presumed valid, as below a checkpoint), in one write.
+    /// Header metadata median_time_past must be set on all blocks.
+    system::code push(const system::block_const_ptr_list& blocks,
+        size_t height);
+
     // HEADER ORGANIZER (reorganize)
     /// Reorganize the header index to the specified fork point.
     system::code reorganize(const system::config::checkpoint& fork_point,
@@ -91,6 +230,11 @@ public:
     /// Update the stored block with txs.
     system::code update(const system::chain::block& block, size_t height);
 
+    // BLOCK ORGANIZER (prefetch)
+    /// Warm the output cache for the prevouts of the updated block on the
+    /// prefetch threads, overlapping lookups with the preceding validation.
+    void prefetch(system::block_const_ptr block);
+
     // BLOCK ORGANIZER (update, invalidate)
     /// Set header validation state and metadata.
     system::code invalidate(const system::chain::header& header,
@@ -114,6 +258,15 @@ public:
     /// Confirm candidate block with confirmed parent.
     system::code confirm(const system::hash_digest& block_hash,
         size_t height);
+
+    // BLOCK ORGANIZER (pipeline)
+    /// Update, candidate and optionally confirm the consecutive blocks from
+    /// height, of stored candidate headers (presumed valid, as below a
+    /// checkpoint). The update of each block on the pipeline thread overlaps
+    /// the candidate (and confirm) of its predecessor, which starts only once
+    /// the block is updated. Flushed writes overlap only with a flush latency.
+    system::code ingest(const system::block_const_ptr_list& blocks,
+        size_t height, bool confirm);
     
     // TRANSACTION ORGANIZER (store)
     /// Store unconfirmed tx/payments that was verified with the given forks.
@@ -123,10 +276,68 @@ public:
     /// Add payments of the transaction to the payment index.
     system::code catalog(const system::chain::transaction& tx);
 
+    // COMPACTOR (background)
+    /// Rewrite the history of each address as a contiguous run, newest first
+    /// by confirmed height, concurrently with catalog writers. An address
+    /// that is paged, or to which a row is added meanwhile, is skipped.
+    system::code compact(const system::hash_list& hashes);
+
+    // Rebuild.
+    // ------------------------------------------------------------------------
+
+    /// Create and build the address index of an existing store (constructed
+    /// with catalog) from its confirmed blocks, partitioning the heights of
+    /// each window across the write threads. The store is left open. A
+    /// pruned store cannot be indexed, as its spent scripts are discarded.
+    bool build_addresses();
+
+    /// Rewrite the transaction table of an existing (closed) store with the
+    /// txs of confirmed blocks in height and position order, followed by
+    /// those of other populated blocks, dropping pooled txs of no block.
+    /// The address index holds tx links, so its files are removed (rebuild
+    /// with build_addresses). Undo records are discarded. The store is left
+    /// closed.
+    bool defragment();
+
+    // Snapshots.
+    // ------------------------------------------------------------------------
+
+    /// Export the unspent output table at the confirmed top to a snapshot,
+    /// setting its digest, fails if the table is not enabled.
+    system::code export_utxos(const path& filename,
+        system::hash_digest& out_digest) const;
+
+    /// Import a snapshot into the empty unspent output table of a new store,
+    /// setting the height and hash of the block at which it was taken. The
+    /// caller must match the digest with the one published for the snapshot.
+    system::code import_utxos(const path& filename, size_t& out_height,
+        system::hash_digest& out_block_hash,
+        system::hash_digest& out_digest);
+
+    // Backup.
+    // ------------------------------------------------------------------------
+
+    /// Copy the flushed files of the open store to an existing directory,
+    /// holding new writes once those in progress complete. Files are cloned
+    /// where the file system supports it, otherwise copied, in which case
+    /// writes are held for the duration of the copy. The copy is opened as a
+    /// store with the settings of this store.
+    system::code backup(const path& directory);
+
+    // Replication.
+    // ------------------------------------------------------------------------
+
+    /// Apply a change read from the feed of a leader store, through the
+    /// writer of the change. Changes must be applied in sequence, each once,
+    /// to a follower created with the same genesis block and tables.
+    system::code apply(const change_feed::change& change);
+
 protected:
     void start();
     void commit();
     bool flush() const override;
+    bool begin_write() const override;
+    bool end_write() const override;
 
     // Header reorganization.
     // ------------------------------------------------------------------------
@@ -156,17 +367,102 @@ protected:
     std::shared_ptr<block_database> blocks_;
     std::shared_ptr<transaction_database> transactions_;
     std::shared_ptr<address_database> addresses_;
+    std::shared_ptr<utxo_database> utxos_;
+    std::shared_ptr<filter_database> filters_;
+    std::shared_ptr<balance_database> balances_;
+
+    // Logs the small writes of the block and transaction tables if set.
+    std::shared_ptr<write_log> log_;
 
 private:
     system::chain::transaction::list to_transactions(
         const block_result& result) const;
 
+    // Push the block within the write of the caller, without committing.
+    system::code push_confirmed(const system::chain::block& block,
+        size_t height, uint32_t median_time_past);
+
+    // Catalog the block without publishing the change.
+    system::code catalog_block(const system::chain::block& block);
+
+    // Read the stored block with tx links and median time past metadata.
+    bool get_block(system::chain::block& out,
+        const system::hash_digest& hash) const;
+
+    // Prune the scripts spent by the confirmed block at the prune depth.
+    bool prune(size_t height);
+
+    // Wait for a lazy open of the address table, false if it failed.
+    bool addresses_opened() const;
+
+    // Write-ahead logging of flushed writes.
+    bool logged() const;
+    bool replay() const;
+    bool checkpoint() const;
+
+    // The open, flush or close of each table, run concurrently across tables.
+    typedef std::pair<std::string, std::function<bool()>> table_task;
+    typedef std::vector<table_task> table_tasks;
+    bool run_tables(const std::string& phase, const table_tasks& tasks) const;
+
+    // Catalog the window of confirmed blocks from the first height.
+    bool build_addresses(size_t first, size_t count);
+
+    // Deferred address indexing of confirmed blocks below the lag.
+    void catch_up();
+    bool catalog_confirmed(size_t height);
+    void load_progress(bool created);
+    bool save_progress() const;
+
     std::atomic<bool> closed_;
     const bool catalog_;
+    const bool deferred_;
     const settings& settings_;
 
+    // Sizes and serializes block transactions when started (write_threads).
+    system::threadpool pool_;
+
+    // Warms the output cache for upcoming blocks (prefetch_threads).
+    system::threadpool prefetch_pool_;
+
+    // Catalogs confirmed blocks trailing the top if deferred (one thread).
+    system::threadpool catalog_pool_;
+    std::atomic<bool> cataloging_;
+
+    // Updates blocks ahead of their candidate and confirm (one thread).
+    system::threadpool ingest_pool_;
+
+    // The result of opening the address table in the background if lazy.
+    std::shared_future<bool> address_opening_;
+
+    // The next confirmed height to catalog if deferred.
+    std::atomic<size_t> progress_;
+
     // Used to prevent unsafe concurrent writes.
     mutable system::shared_mutex write_mutex_;
+
+    // Counts writes in progress, which a backup waits to drain, and those of
+    // each thread, so that a write nested within another is not held.
+    mutable std::mutex quiesce_mutex_;
+    mutable std::condition_variable quiesced_;
+    mutable std::unordered_map<std::thread::id, size_t> nesting_;
+    mutable size_t writing_;
+    mutable bool quiescing_;
+
+    // Latencies of the writers.
+    latency_histogram push_latency_;
+    latency_histogram reorganize_latency_;
+    latency_histogram confirm_latency_;
+    latency_histogram update_latency_;
+    latency_histogram candidate_latency_;
+    latency_histogram catalog_latency_;
+    latency_histogram store_latency_;
+
+    // Odd while confirmations are written, validates snapshot reads.
+    const striped_sequence confirmations_;
+
+    // The committed changes, retained for followers if enabled.
+    std::shared_ptr<change_feed> feed_;
 };
 
 } // namespace database
@@ -19,14 +19,27 @@
 #ifndef LIBBITCOIN_DATABASE_ADDRESS_DATABASE_HPP
 #define LIBBITCOIN_DATABASE_ADDRESS_DATABASE_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/striped_mutex.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/hash_table_multimap.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
 #include <bitcoin/database/result/address_result.hpp>
+#include <bitcoin/database/script_hash_cache.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -37,11 +50,25 @@ class BCD_API address_database
 {
 public:
     typedef boost::filesystem::path path;
-
-    /// Construct the database.
+    typedef std::vector<system::hash_digest> key_list;
+    typedef std::vector<system::chain::payment_record> payment_list;
+    typedef std::function<size_t(const system::chain::payment_record&)>
+        rank_function;
+
+    /// Construct the database, huge pages apply to the bucket array only.
+    /// The reservation is the address space mapped for each file at open.
+    /// Populate is the batch size of pages prepared ahead of writers.
+    /// A nonzero extent preallocates file growth in multiples of extent.
+    /// Paged rows are stored in pages of doubling size chained per address
+    /// (the row file format, set at creation), instead of a row list.
+    /// Script hashes of the given number of recent outputs are cached, so
+    /// that inputs spending them are cataloged without hashing. Iterators of
+    /// results prefetch rows read_ahead rows ahead.
     address_database(const path& lookup_filename, const path& rows_filename,
         size_t table_minimum, size_t index_minimum, size_t buckets,
-        size_t expansion);
+        size_t expansion, bool huge_pages=false, size_t reservation=0,
+        size_t populate=0, size_t extent=0, bool paged=false,
+        size_t script_hashes=0, size_t read_ahead=0);
 
     /// Close the database (all threads must first be stopped).
     ~address_database();
@@ -55,27 +82,88 @@ public:
     /// Call before using the database.
     bool open();
 
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    bool refresh();
+
     /// Commit latest inserts.
     void commit();
 
     /// Flush the memory maps to disk.
     bool flush() const;
 
+    /// Initiate write back of the memory maps, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
     /// Call to unload the memory map.
     bool close();
 
+    /// Advise the expected access pattern of each file.
+    bool advise(access_advice table, access_advice rows);
+
+    /// Place each file on the NUMA nodes (zero for all), and pin the batch
+    /// workers to bound nodes.
+    bool place(memory_placement placement, uint64_t nodes);
+
+    /// The performance counters of each file.
+    void counters(storage_counters& out_table,
+        storage_counters& out_rows) const;
+
+    /// The memory footprint of each file, the bucket array as the table head.
+    void residency(storage_residency& out_table,
+        storage_residency& out_rows) const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    /// Rebuild the hash table into the (open) file with a new bucket count.
+    /// The file replaces the table file once closed, rows are unchanged.
+    bool rehash(storage& file, size_t buckets) const;
+
     // Queries.
     //-------------------------------------------------------------------------
 
     /// Get the output and input points associated with the address hash.
     address_result get(const system::hash_digest& hash) const;
 
+    /// Get the results of many address hashes, in the order of the hashes.
+    /// Hashes are sorted by bucket and found in prefetched batches (on the
+    /// threadpool if started), prefetching the newest rows of each.
+    std::vector<address_result> get(const system::hash_list& hashes,
+        system::threadpool& pool) const;
+
     // Store.
     //-------------------------------------------------------------------------
 
     /// Add a row for each payment recorded in the transaction.
     void catalog(const system::chain::transaction& tx);
 
+    /// Add a row for each payment recorded in the txs of the block that did
+    /// not previously exist, hashing scripts on the threadpool (if started).
+    void catalog(const system::chain::block& block,
+        system::threadpool& pool);
+
+    /// Add the gathered rows in one bulk insert, stably sorted by key so that
+    /// the rows of each key are contiguous and remain in their given order.
+    void catalog(const key_list& keys, const payment_list& rows);
+
+    /// Append the keys and rows of the payments of the txs of the block that
+    /// did not previously exist (with populated prevouts), hashing scripts on
+    /// the calling thread, for a bulk insert.
+    void payments(key_list& out_keys, payment_list& out_rows,
+        const system::chain::block& block);
+
+    // Compaction.
+    //-------------------------------------------------------------------------
+
+    /// Rewrite the rows of the address as one contiguous run in descending
+    /// order of rank (stable), swapped in for the list, concurrent with
+    /// writers. False if a row is added meanwhile or if rows are paged (pages
+    /// are runs). The replaced rows are not reclaimed.
+    bool compact(const system::hash_digest& hash, const rank_function& rank);
+
 protected:
     /// Store the input|output point as a value for the hash of output
     /// script as the key
@@ -89,6 +177,26 @@ private:
     typedef record_manager<link_type> manager_type;
     typedef hash_table<manager_type, index_type, link_type, key_type>
         record_map;
+    typedef slab_manager<file_offset> page_manager;
+
+    // Find the results of the keys as one prefetched batch.
+    void find(std::vector<address_result>& out, const key_list& keys) const;
+
+    // Write the rows in one allocation, or by key to pages if paged.
+    void insert(const std::vector<key_type>& keys,
+        const payment_list& records);
+
+    // Reuse cached keys of inputs, and cache the keys of outputs.
+    void reuse(key_list& keys,
+        std::vector<const system::chain::script*>& scripts,
+        const std::vector<system::chain::point>& points,
+        const payment_list& rows) const;
+    void retain(const key_list& keys,
+        const std::vector<system::chain::point>& points,
+        const payment_list& rows);
+
+    // Append the rows to the head page of the key, chaining new pages.
+    void append(const key_type& key, const payment_list& rows);
 
     // The record multimap as distinct file as opposed to linkage within the map
     // allows avoidance of hash storage with each entry. This is similar to
@@ -105,6 +213,20 @@ private:
     file_storage address_index_file_;
     manager_type address_index_;
     record_multimap address_multimap_;
+
+    /// History pages, over the row file if paged (as opposed to rows).
+    const bool paged_;
+    page_manager pages_;
+    mutable striped_mutex page_mutex_;
+
+    /// Script hashes of recently cataloged outputs.
+    mutable script_hash_cache script_hashes_;
+
+    /// The prefetch distance of result iterators.
+    const size_t read_ahead_;
+
+    /// The NUMA nodes of batch workers, zero if not pinned.
+    std::atomic<uint64_t> worker_nodes_;
 };
 
 } // namespace database
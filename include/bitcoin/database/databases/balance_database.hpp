@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_BALANCE_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_BALANCE_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+class address_database;
+class transaction_database;
+
+/// This is a record hash table where the key is the hash of an output script
+/// (as the address table), and the value is the confirmed summary of its
+/// payments. The table is maintained with the confirmed chain, so a balance
+/// is read with one lookup instead of resolving each row of the history.
+class BCD_API balance_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// The confirmed payments to and from a script.
+    struct summary
+    {
+        /// The sum of the values of confirmed outputs to the script.
+        uint64_t received;
+
+        /// The sum of the values of those outputs spent by confirmed inputs.
+        uint64_t spent;
+
+        /// The number of confirmed transactions paying to or from the script.
+        uint32_t transactions;
+
+        /// The height of the last confirmed block paying to or from it.
+        uint32_t height;
+    };
+
+    /// Construct the database, huge pages apply to the bucket array only.
+    /// The reservation is the address space mapped for the file at open.
+    /// Populate is the batch size of pages prepared ahead of writers.
+    /// A nonzero extent preallocates file growth in multiples of extent.
+    balance_database(const path& map_filename, size_t table_minimum,
+        size_t buckets, size_t expansion, bool huge_pages=false,
+        size_t reservation=0, size_t populate=0, size_t extent=0);
+
+    /// Close the database (all threads must first be stopped).
+    ~balance_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new balance database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    bool refresh();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory map to disk.
+    bool flush() const;
+
+    /// Initiate write back of the memory map, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
+    /// Call to unload the memory map.
+    bool close();
+
+    /// Advise the expected access pattern of the file.
+    bool advise(access_advice table);
+
+    /// The performance counters of the file.
+    storage_counters counters() const;
+
+    /// The memory footprint of the file, the bucket array as its head.
+    storage_residency residency() const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Fetch the confirmed summary of the script hash, false if the script
+    /// has no confirmed payments.
+    bool get(summary& out, const system::hash_digest& hash) const;
+
+    // Store.
+    //-------------------------------------------------------------------------
+
+    /// Add the payments of the block confirmed at the height. Prevouts are
+    /// read from their metadata if populated, otherwise from the tx table.
+    /// False if the table cannot be extended.
+    bool confirm(const system::chain::block& block, size_t height,
+        const transaction_database& transactions);
+
+    /// Remove the payments of the block unconfirmed from the height, after
+    /// its txs are unconfirmed. The last height of a script active at the
+    /// height is resolved from its history if addresses are indexed, and is
+    /// otherwise bounded by the preceding height.
+    /// False if the table cannot be extended.
+    bool unconfirm(const system::chain::block& block, size_t height,
+        const transaction_database& transactions,
+        const address_database* addresses=nullptr);
+
+private:
+    typedef system::hash_digest key_type;
+    typedef array_index index_type;
+    typedef array_index link_type;
+    typedef record_manager<link_type> manager_type;
+    typedef hash_table<manager_type, index_type, link_type, key_type>
+        record_map;
+
+    // The change to a summary, transactions counted once per tx.
+    struct change
+    {
+        uint64_t received;
+        uint64_t spent;
+        uint32_t transactions;
+    };
+
+    typedef std::map<key_type, change> change_map;
+
+    static key_type to_key(const system::chain::script& script);
+    static void gather(change_map& out, const system::chain::block& block,
+        const transaction_database& transactions);
+
+    bool write(const key_type& key, const summary& value);
+    uint32_t last_height(const key_type& key, size_t height,
+        const transaction_database& transactions,
+        const address_database* addresses) const;
+
+    // Hash table used for looking up summaries by script hash.
+    file_storage hash_table_file_;
+    record_map hash_table_;
+
+    // Summaries are updated in place, concurrent with readers.
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
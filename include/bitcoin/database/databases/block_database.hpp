@@ -21,32 +21,55 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
 #include <bitcoin/database/result/block_result.hpp>
 
 namespace libbitcoin {
 namespace database {
 
+class transaction_database;
+
 /// Stores block_headers each with a list of transaction indexes.
 /// Lookup possible by hash or height.
 class BCD_API block_database
 {
 public:
     typedef boost::filesystem::path path;
+    typedef system::message::compact_block::short_id_list short_id_list;
 
-    /// Construct the database.
+    /// Construct the database, huge pages apply to the full block table.
+    /// The reservation is the address space mapped for each file at open.
+    /// Populate is the batch size of pages prepared ahead of writers.
+    /// A nonzero extent preallocates file growth in multiples of extent.
+    /// Resident headers hold the header, hash, median time past and link of
+    /// each candidate and confirmed height in memory for height queries.
+    /// A times file holds the timestamp (as a running maximum) and median
+    /// time past of each confirmed height, for searches by time.
+    /// Candidate states hold the validation and population state of each
+    /// candidate height in memory, for scans by state.
     block_database(const path& map_filename,
         const path& candidate_index_filename,
         const path& confirmed_index_filename, const path& tx_index_filename,
         size_t table_minimum, size_t candidate_index_minimum,
         size_t confirmed_index_minimum, size_t tx_index_minimum,
-        size_t buckets, size_t expansion);
+        size_t buckets, size_t expansion, bool huge_pages=false,
+        size_t reservation=0, size_t populate=0, size_t extent=0,
+        bool resident_headers=false, const path& times_filename=path(),
+        bool candidate_states=false);
 
     /// Close the database (all threads must first be stopped).
     ~block_database();
@@ -66,9 +89,60 @@ public:
     /// Flush the memory maps to disk.
     bool flush() const;
 
+    /// Flush the memory maps to disk, including logged writes.
+    bool checkpoint() const;
+
+    /// Log the small writes of each file, call before open.
+    void attach(write_log& log);
+
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    /// Values held in memory are loaded at open and are not refreshed.
+    bool refresh();
+
+    /// Initiate write back of the memory maps, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
     /// Call to unload the memory map.
     bool close();
 
+    /// Advise the expected access pattern of each file.
+    bool advise(access_advice table, access_advice candidate_index,
+        access_advice confirmed_index, access_advice tx_index);
+
+    /// Place each file on the NUMA nodes (zero for all), and pin the batch
+    /// workers to bound nodes.
+    bool place(memory_placement placement, uint64_t nodes);
+
+    /// Fault in (and optionally pin) the table and/or the height indexes.
+    bool prefault(bool table, bool indexes, bool pin);
+
+    /// The performance counters of each file.
+    void counters(storage_counters& out_table,
+        storage_counters& out_candidate_index,
+        storage_counters& out_confirmed_index,
+        storage_counters& out_tx_index) const;
+
+    /// The memory footprint of each file, the bucket array as the table head.
+    void residency(storage_residency& out_table,
+        storage_residency& out_candidate_index,
+        storage_residency& out_confirmed_index,
+        storage_residency& out_tx_index) const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    /// Rebuild the hash table into the (open) file with a new bucket count.
+    /// The file replaces the table file once closed, links are unchanged.
+    bool rehash(storage& file, size_t buckets) const;
+
+    /// Replace each link of the transaction index by the relinker, of the
+    /// confirmed blocks first in height order, then of all others in index
+    /// order. False if the relinker fails, leaving the index partly relinked.
+    bool relink(const transaction_database::relinker& relinker);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -81,28 +155,82 @@ public:
     /// Fetch block by hash.
     block_result get(const system::hash_digest& hash) const;
 
+    /// Fetch the header (without metadata) and median time past by
+    /// candidate|confirmed height, resident if enabled (otherwise read).
+    bool get_header(system::chain::header& out_header,
+        uint32_t& out_median_time_past, size_t height, bool candidate) const;
+
+    /// Fetch the block hash by candidate|confirmed height (as above).
+    bool get_hash(system::hash_digest& out_hash, size_t height,
+        bool candidate) const;
+
+    /// Find the first confirmed height of a block with a timestamp at or
+    /// after the time (or of a median time past at or after the time if
+    /// median), false if there is none or if times are not indexed.
+    bool find_height(size_t& out_height, uint32_t time, bool median) const;
+
+    /// Compute the BIP152 (version 1) short ids of the txs of the populated
+    /// block, keyed by its header and nonce (the salt stored at update).
+    /// The coinbase is excluded, as it is prefilled. False if the block is
+    /// not found, not populated or has no salt (such as if invalid).
+    bool get_short_ids(short_id_list& out_ids, uint64_t& out_nonce,
+        const system::hash_digest& hash,
+        const transaction_database& transactions) const;
+
+    /// Find the first candidate height at or above the height of a block
+    /// that is not valid (unvalidated or failed), false if there is none or
+    /// if candidate states are not held.
+    bool find_unvalidated(size_t& out_height, size_t from_height) const;
+
+    /// Get the candidate heights in [from_height, from_height + count) of
+    /// blocks that are not populated (empty), false if states are not held.
+    bool get_empty(std::vector<size_t>& out_heights, size_t from_height,
+        size_t count) const;
+
     /// Populate header metadata for the given header.
     void get_header_metadata(const system::chain::header& header) const;
 
+    /// Populate header metadata for the given headers, hashed on the
+    /// threadpool (if started) and found as one prefetched batch. A list that
+    /// extends the candidate top linearly is resolved by a single lookup.
+    void get_header_metadata(const system::chain::header::list& headers,
+        system::threadpool& pool) const;
+
     // Writers.
     // ------------------------------------------------------------------------
+    // Writers by link skip the hash table probe of the equivalent by hash.
 
     /// Store header, validated at height, candidate, pending (but unindexed).
-    void store(const system::chain::header& header, size_t height,
+    /// Returns the link of the block, for writers that follow the store.
+    array_index store(const system::chain::header& header, size_t height,
         uint32_t median_time_past);
 
     /// Populate pooled block transaction references, state is unchanged.
+    /// A random short id salt is stored with the references, if unset.
     bool update(const system::chain::block& block);
+    bool update(array_index link, const system::chain::block& block);
 
     /// Promote pooled block to valid|invalid and set code.
     bool validate(const system::hash_digest& hash, const system::code& error);
+    bool validate(array_index link, const system::code& error);
 
     /// Promote pooled|candidate block to candidate|confirmed respectively.
     bool promote(const system::hash_digest& hash, size_t height, bool candidate);
+    bool promote(array_index link, size_t height, bool candidate);
 
     /// Demote candidate|confirmed header to pooled|pooled (not candidate).
     bool demote(const system::hash_digest& hash, size_t height,
         bool candidate);
+    bool demote(array_index link, size_t height, bool candidate);
+
+    /// Promote the pooled|candidate blocks to candidate|confirmed at the
+    /// contiguous heights from first height, with one index resize.
+    bool promote(const system::hash_list& hashes, size_t first_height,
+        bool candidate);
+
+    /// Demote all candidate|confirmed headers above the fork height to
+    /// pooled|pooled, in one index resize.
+    bool demote(size_t fork_height, bool candidate);
 
 private:
     typedef system::hash_digest key_type;
@@ -111,11 +239,20 @@ private:
     typedef list_element<const manager_type, link_type, key_type> const_element;
     typedef hash_table<manager_type, array_index, link_type, key_type> record_map;
 
-    typedef system::message::compact_block::short_id_list short_id_list;
+    // The indexed record of a height, which is immutable while indexed.
+    struct resident_header
+    {
+        system::hash_digest hash;
+        system::byte_array<80> header;
+        uint32_t median_time_past;
+        link_type link;
+    };
+
+    typedef std::vector<resident_header> resident_chain;
 
     link_type associate(const system::chain::transaction::list& transactions);
     void promote(const_element& element, bool positive, bool candidate);
-    void store(const system::chain::header& header, size_t height,
+    link_type store(const system::chain::header& header, size_t height,
         uint32_t median_time_past, uint32_t checksum, link_type tx_start,
         size_t tx_count, uint8_t status);
 
@@ -124,6 +261,24 @@ private:
     link_type read_link(size_t height, const manager_type& manager) const;
     void pop_link(link_type link, size_t height, manager_type& manager);
     void push_link(link_type link, size_t height, manager_type& manager);
+    void pop_links(size_t height, manager_type& manager);
+    void push_links(const std::vector<link_type>& links, size_t first_height,
+        manager_type& manager);
+
+    // Resident Utilities.
+    resident_chain& resident(const manager_type& manager);
+    const resident_chain& resident(const manager_type& manager) const;
+    resident_header read_resident(link_type link) const;
+    void load_resident(const manager_type& manager);
+
+    // State Utilities.
+    uint8_t read_state(link_type link) const;
+    void set_candidate_state(link_type link, size_t height, uint8_t state);
+    void load_states();
+
+    // Time Utilities.
+    void push_times(const std::vector<link_type>& links, size_t first_height);
+    bool load_times();
 
     static const size_t prefix_size_;
 
@@ -147,6 +302,25 @@ private:
 
     // This provides atomicity for checksum, tx_start, tx_count, state.
     mutable system::shared_mutex metadata_mutex_;
+
+    // The resident headers of each index, by height, if enabled.
+    const bool resident_;
+    resident_chain candidate_headers_;
+    resident_chain confirmed_headers_;
+    mutable system::shared_mutex resident_mutex_;
+
+    // The validation and population state by candidate height, if enabled.
+    const bool stateful_;
+    std::vector<uint8_t> candidate_states_;
+    mutable system::shared_mutex states_mutex_;
+
+    // Times by confirmed height, used if a times file is configured.
+    const bool timed_;
+    file_storage times_file_;
+    manager_type times_;
+
+    // The NUMA nodes of batch workers, zero if not pinned.
+    std::atomic<uint64_t> worker_nodes_;
 };
 
 } // namespace database
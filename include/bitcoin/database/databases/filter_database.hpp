@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_FILTER_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_FILTER_DATABASE_HPP
+
+#include <cstddef>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This is a slab hash table where the key is the hash of each cataloged
+/// block, and the value is its BIP158 basic filter and filter header. The
+/// header chains to that of the previous block, so a block is cataloged
+/// after its parent. A filter is independent of confirmation, so a block
+/// confirmed at a height reads its filter with one lookup by its hash.
+class BCD_API filter_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Construct the database, huge pages apply to the bucket array only.
+    /// The reservation is the address space mapped for the file at open.
+    /// Populate is the batch size of pages prepared ahead of writers.
+    /// A nonzero extent preallocates file growth in multiples of extent.
+    filter_database(const path& map_filename, size_t table_minimum,
+        size_t buckets, size_t expansion, bool huge_pages=false,
+        size_t reservation=0, size_t populate=0, size_t extent=0);
+
+    /// Close the database (all threads must first be stopped).
+    ~filter_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new filter database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    bool refresh();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory map to disk.
+    bool flush() const;
+
+    /// Initiate write back of the memory map, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
+    /// Call to unload the memory map.
+    bool close();
+
+    /// Advise the expected access pattern of the file.
+    bool advise(access_advice table);
+
+    /// The performance counters of the file.
+    storage_counters counters() const;
+
+    /// The memory footprint of the file, the bucket array as its head.
+    storage_residency residency() const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Fetch the filter header and filter of the block, false if not found.
+    bool get(system::hash_digest& out_header, system::data_chunk& out_filter,
+        const system::hash_digest& block_hash) const;
+
+    /// Fetch the filter header of the block, false if not found.
+    bool get_header(system::hash_digest& out_header,
+        const system::hash_digest& block_hash) const;
+
+    // Store.
+    //-------------------------------------------------------------------------
+
+    /// Build and store the basic filter of the block (with populated prevout
+    /// metadata), false if its parent has no filter header. A block that is
+    /// already stored is unchanged.
+    bool store(const system::chain::block& block);
+
+private:
+    typedef system::hash_digest key_type;
+    typedef array_index index_type;
+    typedef file_offset link_type;
+    typedef slab_manager<link_type> manager_type;
+    typedef hash_table<manager_type, index_type, link_type, key_type> slab_map;
+
+    // Hash table used for looking up filters by block hash.
+    file_storage hash_table_file_;
+    slab_map hash_table_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
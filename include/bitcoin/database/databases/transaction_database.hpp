@@ -19,13 +19,34 @@
 #ifndef LIBBITCOIN_DATABASE_TRANSACTION_DATABASE_HPP
 #define LIBBITCOIN_DATABASE_TRANSACTION_DATABASE_HPP
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/cache_policy.hpp>
+#include <bitcoin/database/databases/utxo_database.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/existence_filter.hpp>
+#include <bitcoin/database/latency_histogram.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
 #include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/striped_sequence.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
+#include <bitcoin/database/negative_cache.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
+#include <bitcoin/database/result/transaction_links.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
 #include <bitcoin/database/unspent_outputs.hpp>
 
@@ -42,9 +63,89 @@ class BCD_API transaction_database
 public:
     typedef boost::filesystem::path path;
 
+    /// Replace the link of a tx with that of its copy, false on failure.
+    typedef std::function<bool(file_offset& link)> relinker;
+
+    /// Relink the txs to retain, false on failure.
+    typedef std::function<bool(const relinker&)> relink_walker;
+
+    /// The optional features of the table, each disabled by default.
+    struct BCD_API options
+    {
+        options();
+
+        /// Huge pages apply to the bucket array only.
+        bool huge_pages;
+
+        /// The address space mapped for each file at open.
+        size_t reservation;
+
+        /// The batch size of pages prepared ahead of writers.
+        size_t populate;
+
+        /// A nonzero extent preallocates file growth in multiples of extent.
+        size_t extent;
+
+        /// Store a fingerprint of each bucket's first key in the bucket.
+        bool fingerprints;
+
+        /// A nonzero filter size holds an existence filter of all tx hashes
+        /// in memory, saved to the filter file at close, restored at open.
+        size_t filter_size;
+        path filter_filename;
+
+        /// A nonzero offsets minimum stores an output offset table with each
+        /// tx of at least that many outputs, for direct access to any output.
+        size_t offsets_minimum;
+
+        /// A spends file holds the mutable spend state of outputs in a dense
+        /// column, leaving stored txs unwritten after store (implies offsets).
+        path spends_filename;
+
+        /// Store standard output scripts by template and hash, readable
+        /// independent of this option (implies offsets).
+        bool compress_scripts;
+
+        /// A witnesses file holds the witnesses of segregated txs apart from
+        /// the tx, so reads without witness do not touch them (implies
+        /// offsets).
+        path witnesses_filename;
+
+        /// Allow spent output scripts to be discarded by prune, for txs
+        /// stored with it (implies offsets).
+        bool prune_scripts;
+
+        /// The approximate memory budget of the output cache, in addition to
+        /// its transaction count limit (zero is unbudgeted).
+        size_t cache_bytes;
+
+        /// Hold outputs individually, the cache limit then counts outputs.
+        bool cache_granular;
+
+        /// The replacement policy of the output cache.
+        cache_policy cache_eviction;
+
+        /// A cache file persists the output cache across restarts.
+        path cache_filename;
+
+        /// A utxo database is consulted by output lookups after the cache.
+        const utxo_database* utxos;
+
+        /// A nonzero misses count records that many recently missed prevout
+        /// tx hashes of the pool path, until the tx is stored.
+        size_t misses;
+
+        /// An undo file records the prevout spends of each confirmed block by
+        /// position, indexed by height, so the block unconfirms without
+        /// lookups.
+        path undo_filename;
+        path undo_index_filename;
+    };
+
     /// Construct the database.
     transaction_database(const path& map_filename, size_t table_minimum,
-        size_t buckets, size_t expansion, size_t cache_capacity);
+        size_t buckets, size_t expansion, size_t cache_capacity,
+        const options& features=options());
 
     /// Close the database (all threads must first be stopped).
     ~transaction_database();
@@ -64,9 +165,70 @@ public:
     /// Flush the memory map to disk.
     bool flush() const;
 
+    /// Flush the memory maps to disk, including logged writes.
+    bool checkpoint() const;
+
+    /// Log the small writes of each file, call before open.
+    void attach(write_log& log);
+
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    /// Values held in memory are loaded at open and are not refreshed.
+    bool refresh();
+
+    /// Initiate write back of the memory map, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
     /// Call to unload the memory map.
     bool close();
 
+    /// Load the saved output cache in the background if saved for the table
+    /// state and confirmed top height, writes wait on it (file is consumed).
+    void load_cache(size_t top_height);
+
+    /// Save the output cache for the confirmed top height, call before close.
+    bool save_cache(size_t top_height);
+
+    /// Advise the expected access pattern of the file.
+    bool advise(access_advice table);
+
+    /// Place the table and its columns on the NUMA nodes (zero for all), and
+    /// pin the batch workers to bound nodes.
+    bool place(memory_placement table, uint64_t nodes);
+
+    /// Fault in (and optionally pin) the hash table bucket array.
+    bool prefault(bool pin);
+
+    /// The performance counters of the file.
+    storage_counters counters() const;
+
+    /// The memory footprint of the file, the bucket array as its head.
+    storage_residency residency() const;
+
+    /// The approximate bytes of the outputs held by the output cache.
+    size_t cache_bytes() const;
+
+    /// The latencies of get_output (of a single point).
+    latency_histogram::values output_latencies() const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    /// Rebuild the hash table into the (open) file with a new bucket count,
+    /// optionally with fingerprints. The file replaces the table file once
+    /// closed, links are unchanged.
+    bool rehash(storage& file, size_t buckets, bool fingerprints=false) const;
+
+    /// Rebuild the table into the (open) file holding only the txs relinked
+    /// by the walker, contiguous in the order relinked, each copied once (by
+    /// hash). The file replaces the table file once closed. Undo records are
+    /// discarded, as they hold positions within the table file. Commit
+    /// before this call, and do not write to the table concurrently.
+    bool defragment(storage& file, size_t buckets, bool fingerprints,
+        const relink_walker& walker);
+
     // Queries.
     //-------------------------------------------------------------------------
 
@@ -76,6 +238,10 @@ public:
     /// Fetch transaction by its hash.
     transaction_result get(const system::hash_digest& hash) const;
 
+    /// Fetch transactions by their hashes (in order), as a prefetched batch.
+    std::vector<transaction_result> get(const system::hash_list& hashes,
+        bool advise=false) const;
+
     /// Populate tx metadata for the given block context.
     void get_block_metadata(const system::chain::transaction& tx,
         uint32_t forks, size_t fork_height) const;
@@ -88,6 +254,19 @@ public:
     bool get_output(const system::chain::output_point& point,
         size_t fork_height) const;
 
+    /// Populate output metadata for all prevouts of the block, using the
+    /// threadpool for lookups of the points that are not cached.
+    void get_outputs(const system::chain::block& block, size_t fork_height,
+        system::threadpool& pool) const;
+
+    /// Warm the output cache with the stored prevouts of the block that it
+    /// does not hold, faulting in their tx records ahead of validation.
+    void prefetch(const system::chain::block& block);
+
+    /// Prefetch the leading cache line of the tx record of each link (such
+    /// as the links of a block), ahead of a walk of the records.
+    void prefetch(const transaction_links& links) const;
+
     // Writers.
     // ------------------------------------------------------------------------
 
@@ -97,6 +276,11 @@ public:
     /// Store a set of transactions (potentially from an unconfirmed block).
     bool store(const system::chain::transaction::list& transactions);
 
+    /// Store a set of transactions as above, in one contiguous allocation,
+    /// using the threadpool (if started) to size and serialize them.
+    bool store(const system::chain::transaction::list& transactions,
+        system::threadpool& pool);
+
     /// Mark outputs spent by the candidate tx.
     bool candidate(file_offset link);
 
@@ -111,21 +295,67 @@ public:
     bool confirm(const system::chain::block& block, size_t height,
         uint32_t median_time_past);
 
+    /// Promote the txs of a block (by link, in block order) to confirmed.
+    /// All prevout spends are applied in one pass, sorted by file position.
+    bool confirm(const link_list& links, size_t height,
+        uint32_t median_time_past);
+
     /// Demote the set of transactions associated with a block to pooled.
     bool unconfirm(const system::chain::block& block);
 
+    /// Demote the txs of the confirmed block at the (top) height to pooled,
+    /// replaying its undo record to unspend its prevouts if one is held.
+    bool unconfirm(const system::chain::block& block, size_t height);
+
+    /// Discard the scripts of the prevouts of the txs of a confirmed block
+    /// (by link, in block order), retaining their values and spend state.
+    /// Pruned scripts read as empty, and whole pages of them are released
+    /// to the file system. This cannot be undone, so the block must be
+    /// below any depth of reorganization. Untabled prevouts are skipped.
+    bool prune(const link_list& links);
+
 private:
     typedef system::hash_digest key_type;
     typedef array_index index_type;
     typedef file_offset link_type;
     typedef slab_manager<link_type> manager_type;
     typedef hash_table<manager_type, index_type, link_type, key_type> slab_map;
+    typedef transaction_result::spend_manager spend_manager;
+    typedef record_manager<array_index> height_manager;
+    typedef std::vector<std::pair<file_offset, link_type>> position_list;
+
+    // Populate output metadata from the result of the point's tx lookup.
+    bool get_output(const system::chain::output_point& point,
+        const transaction_result& result, size_t fork_height) const;
+
+    // Cache the unspent outputs at the indexes of the tx result.
+    void prefetch(const transaction_result& result,
+        const std::vector<uint32_t>& indexes);
 
     // Store a transaction.
     //-------------------------------------------------------------------------
     bool storize(const system::chain::transaction& tx, size_t height,
         uint32_t median_time_past, size_t position);
 
+    // Serialization of the tx record, with offset table when tabled.
+    bool tabled(const system::chain::transaction& tx) const;
+    size_t record_size(const system::chain::transaction& tx) const;
+    bool segregate(const system::chain::transaction& tx) const;
+    void write_record(byte_serializer& serial,
+        const system::chain::transaction& tx, size_t height,
+        uint32_t median_time_past, size_t position, link_type spends,
+        link_type witnesses) const;
+
+    // Store the spend column records of the tx, or return not_allocated.
+    link_type store_spends(const system::chain::transaction& tx);
+
+    // Store the witnesses slab of the tx, or return not_allocated.
+    link_type store_witnesses(const system::chain::transaction& tx);
+
+    // Update the spend state of an output within the spend column.
+    void write_candidate_spent(link_type spend, bool positive);
+    void write_spender_height(link_type spend, size_t spender_height);
+
     // Update the candidate state of the tx.
     //-------------------------------------------------------------------------
     bool candidate(file_offset link, bool positive);
@@ -142,19 +372,78 @@ private:
     bool confirmed_spend(const system::chain::output_point& point,
         size_t spender_height);
 
+    // Locate the spend of the output within the tx of the found element,
+    // and its spend column record (or not_allocated if within the tx).
+    bool get_spend(const slab_map::const_value_type& element,
+        const system::chain::output_point& point, size_t spender_height,
+        size_t& offset, link_type& spend) const;
+    bool get_spend(const slab_map::const_value_type& element,
+        const system::chain::output_point& point, size_t& offset,
+        link_type& spend, size_t& height, uint16_t& position) const;
+
+    // Update the spender height of all prevouts of the txs (but coinbase).
+    bool confirmed_spends(const link_list& links, size_t spender_height);
+
+    // Write the spender height to the spends, each list sorted by position.
+    void write_spender_heights(const std::vector<link_type>& spends,
+        const position_list& positions, size_t spender_height);
+
+    // Store or read the undo record of the prevout spends of a block.
+    bool store_undo(size_t height, const std::vector<link_type>& spends,
+        const position_list& positions);
+    bool read_undo(size_t height, std::vector<link_type>& spends,
+        position_list& positions) const;
+
     // Promote metadata of the existing tx to confirmed.
     bool confirmize(link_type link, size_t height, uint32_t median_time_past,
         size_t position);
 
+    // The size of the hash table header (bucket array).
+    const size_t buckets_size_;
+
     // Hash table used for looking up txs by hash.
     file_storage hash_table_file_;
     slab_map hash_table_;
 
-    // This is thread safe.
-    unspent_outputs cache_;
+    // Column of output spend state, used if a spends file is configured.
+    const bool columnar_;
+    file_storage spends_file_;
+    spend_manager spends_;
 
-    // This provides atomicity for height and position.
-    mutable system::shared_mutex metadata_mutex_;
+    // Slabs of segregated witnesses, used if a witnesses file is configured.
+    const bool segregated_;
+    file_storage witnesses_file_;
+    manager_type witnesses_;
+
+    // Undo records of confirmed blocks, used if an undo file is configured.
+    const bool undoable_;
+    file_storage undo_file_;
+    manager_type undo_;
+    file_storage undo_index_file_;
+    height_manager undo_index_;
+
+    // Complete a background cache load before the cache is first written.
+    void wait_cache();
+
+    // These are thread safe.
+    unspent_outputs cache_;
+    const path cache_filename_;
+    std::atomic<bool> cache_loading_;
+    std::thread cache_loader_;
+    std::mutex cache_mutex_;
+    const utxo_database* utxos_;
+    negative_cache misses_;
+    mutable latency_histogram output_latency_;
+    const path filter_filename_;
+    existence_filter filter_;
+    const size_t offsets_minimum_;
+    const bool compress_scripts_;
+    const bool prune_scripts_;
+    std::atomic<uint64_t> worker_nodes_;
+
+    // This provides atomicity for height and position, by record, without
+    // blocking readers.
+    mutable striped_sequence metadata_sequence_;
 };
 
 } // namespace database
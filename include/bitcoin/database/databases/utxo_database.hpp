@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_UTXO_DATABASE_HPP
+#define LIBBITCOIN_DATABASE_UTXO_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/primitives/hash_table.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+class transaction_database;
+
+/// This is a slab hash table where the key is the output point of each
+/// confirmed unspent output, and the value is the output with its height,
+/// median time past and coinbase flag. The table is maintained with the
+/// confirmed chain, so its working set is that of the unspent outputs.
+class BCD_API utxo_database
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Construct the database, huge pages apply to the bucket array only.
+    /// The reservation is the address space mapped for the file at open.
+    /// Populate is the batch size of pages prepared ahead of writers.
+    /// A nonzero extent preallocates file growth in multiples of extent.
+    utxo_database(const path& map_filename, size_t table_minimum,
+        size_t buckets, size_t expansion, bool huge_pages=false,
+        size_t reservation=0, size_t populate=0, size_t extent=0);
+
+    /// Close the database (all threads must first be stopped).
+    ~utxo_database();
+
+    // Startup and shutdown.
+    // ------------------------------------------------------------------------
+
+    /// Initialize a new utxo database.
+    bool create();
+
+    /// Call before using the database.
+    bool open();
+
+    /// Map the files for reads only, shared with a writer, call before open.
+    void set_read_only();
+
+    /// Follow the files and committed counts of the writer (if read only).
+    bool refresh();
+
+    /// Commit latest inserts.
+    void commit();
+
+    /// Flush the memory map to disk.
+    bool flush() const;
+
+    /// Initiate write back of the memory map, optionally waiting on the disk.
+    bool writeback(bool wait=false) const;
+
+    /// Call to unload the memory map.
+    bool close();
+
+    /// Advise the expected access pattern of the file.
+    bool advise(access_advice table);
+
+    /// The performance counters of the file.
+    storage_counters counters() const;
+
+    /// The memory footprint of the file, the bucket array as its head.
+    storage_residency residency() const;
+
+    /// Chain length statistics of the hash table, optionally sampled.
+    table_statistics statistics(size_t samples=0) const;
+
+    // Queries.
+    //-------------------------------------------------------------------------
+
+    /// Populate the prevout metadata if the output is unspent and confirmed
+    /// at or below the fork height (otherwise look up the tx).
+    bool populate(const system::chain::output_point& point,
+        size_t fork_height=max_size_t) const;
+
+    // Store.
+    //-------------------------------------------------------------------------
+
+    /// Add an unspent output, false if the table cannot be extended.
+    bool store(const system::chain::output_point& point,
+        const system::chain::output& output, size_t height,
+        uint32_t median_time_past, bool coinbase);
+
+    /// True if no output has been stored (removed slabs are not reclaimed).
+    bool empty() const;
+
+    /// Remove an output (spent or unconfirmed), false if not found.
+    bool remove(const system::chain::output_point& point);
+
+    /// Remove the prevouts spent by the block and add its outputs, false if
+    /// the table cannot be extended.
+    bool confirm(const system::chain::block& block, size_t height,
+        uint32_t median_time_past);
+
+    /// Remove the outputs of the (unconfirmed) block and restore the prevouts
+    /// that it spent from the transaction table, false if the table cannot
+    /// be extended.
+    bool unconfirm(const system::chain::block& block,
+        const transaction_database& transactions);
+
+    // Snapshot.
+    //-------------------------------------------------------------------------
+
+    /// Write all unspent outputs to a snapshot of the given confirmed block.
+    /// The digest commits to the file content, so an importer can compare it
+    /// with the digest published for the same snapshot.
+    bool export_snapshot(const path& filename, size_t height,
+        const system::hash_digest& block_hash,
+        system::hash_digest& out_digest) const;
+
+    /// Verify the snapshot digest and then store its outputs, setting the
+    /// identity of the block at which it was taken. The table is unchanged
+    /// if the snapshot is invalid or the table is not empty on entry.
+    bool import_snapshot(const path& filename, size_t& out_height,
+        system::hash_digest& out_block_hash,
+        system::hash_digest& out_digest);
+
+private:
+    typedef system::byte_array<system::hash_size + sizeof(uint32_t)> key_type;
+    typedef array_index index_type;
+    typedef file_offset link_type;
+    typedef slab_manager<link_type> manager_type;
+    typedef hash_table<manager_type, index_type, link_type, key_type> slab_map;
+
+    static key_type to_key(const system::chain::output_point& point);
+    bool read_snapshot(const path& filename, size_t& out_height,
+        system::hash_digest& out_block_hash, system::hash_digest& out_digest,
+        bool store);
+
+    // Hash table used for looking up unspent outputs by point.
+    file_storage hash_table_file_;
+    slab_map hash_table_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
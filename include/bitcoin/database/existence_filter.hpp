@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_EXISTENCE_FILTER_HPP
+#define LIBBITCOIN_DATABASE_EXISTENCE_FILTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A blocked Bloom filter of digests, held in memory. Each digest sets eight
+/// bits within one cache line (block), so a query touches a single line. There
+/// are no false negatives, so a miss proves that a digest was never inserted.
+class BCD_API existence_filter
+  : system::noncopyable
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Construct a filter of the byte size, rounded down to the block size.
+    existence_filter(size_t size);
+
+    /// The filter size is zero, so it reports all digests as contained.
+    bool disabled() const;
+
+    /// The byte size of the filter.
+    size_t size() const;
+
+    /// Remove all digests.
+    void clear();
+
+    /// Add the digest to the filter.
+    void insert(const system::hash_digest& hash);
+
+    /// False if the digest has certainly not been inserted.
+    bool contains(const system::hash_digest& hash) const;
+
+    /// Write the filter to the file, with a tag identifying the source state.
+    bool save(const path& filename, uint64_t tag) const;
+
+    /// Read the filter from the file, false (and cleared) if the file is
+    /// missing, incomplete or of another filter size or tag.
+    bool load(const path& filename, uint64_t tag);
+
+private:
+    typedef std::atomic<uint64_t> word;
+
+    size_t block(const system::hash_digest& hash) const;
+
+    // These are thread safe.
+    const size_t blocks_;
+    std::vector<word> words_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -19,12 +19,18 @@
 #ifndef LIBBITCOIN_DATABASE_HASH_TABLE_IPP
 #define LIBBITCOIN_DATABASE_HASH_TABLE_IPP
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/hash_table_header.hpp>
 #include <bitcoin/database/primitives/list.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -35,18 +41,21 @@ const Link hash_table<Manager, Index, Link, Key>::not_found =
 
 template <typename Manager, typename Index, typename Link, typename Key>
 hash_table<Manager, Index, Link, Key>::hash_table(storage& file,
-    Index buckets)
-  : header_(file, buckets),
-    manager_(file, hash_table_header<Index, Link>::size(buckets))
+    Index buckets, bucket_tags tags)
+  : file_(file),
+    header_(file, buckets, tags == bucket_tags::fingerprint),
+    manager_(file, hash_table_header<Index, Link>::size(buckets,
+        tags == bucket_tags::fingerprint))
 {
 }
 
 template <typename Manager, typename Index, typename Link, typename Key>
 hash_table<Manager, Index, Link, Key>::hash_table(storage& file,
-    Index buckets, size_t value_size)
-  : header_(file, buckets),
-    manager_(file, hash_table_header<Index, Link>::size(buckets),
-        value_type::size(value_size))
+    Index buckets, size_t value_size, bucket_tags tags)
+  : file_(file),
+    header_(file, buckets, tags == bucket_tags::fingerprint),
+    manager_(file, hash_table_header<Index, Link>::size(buckets,
+        tags == bucket_tags::fingerprint), value_type::size(value_size))
 {
 }
 
@@ -62,6 +71,13 @@ bool hash_table<Manager, Index, Link, Key>::start()
     return header_.start() && manager_.start();
 }
 
+// The bucket array is fixed at creation, so only the manager is refreshed.
+template <typename Manager, typename Index, typename Link, typename Key>
+bool hash_table<Manager, Index, Link, Key>::refresh()
+{
+    return manager_.refresh();
+}
+
 template <typename Manager, typename Index, typename Link, typename Key>
 void hash_table<Manager, Index, Link, Key>::commit()
 {
@@ -72,23 +88,133 @@ template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::value_type
 hash_table<Manager, Index, Link, Key>::allocator()
 {
-    return { manager_, list_mutex_ };
+    // The element is unreachable until linked, at which time it is rebound to
+    // the list mutex of its bucket.
+    return { manager_, list_mutex_[0] };
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+typename hash_table<Manager, Index, Link, Key>::value_type
+hash_table<Manager, Index, Link, Key>::allocator(Link link)
+{
+    // The element is unreachable until linked, at which time it is rebound to
+    // the list mutex of its bucket.
+    return { manager_, link, list_mutex_[0] };
+}
+
+// The elements are allocated in a single manager reservation.
+template <typename Manager, typename Index, typename Link, typename Key>
+Link hash_table<Manager, Index, Link, Key>::allocate(size_t size)
+{
+    return manager_.allocate(size);
 }
 
 template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::const_value_type
 hash_table<Manager, Index, Link, Key>::find(const Key& key) const
 {
-    list<const Manager, Link, Key> list(manager_, bucket_value(key),
-        list_mutex_);
+    const auto index = bucket_index(key);
+
+    // A fingerprint miss avoids reading the chain (and the slab) entirely.
+    if (!header_.contains(index, key))
+    {
+        BCD_TRACE2(hash_table_find, index, not_found);
+        return { manager_, not_found, list_mutex_[index] };
+    }
+
+    list<const Manager, Link, Key> list(manager_, bucket_value(index),
+        list_mutex_[index]);
 
     for (const auto item: list)
+    {
         if (item.match(key))
+        {
+            BCD_TRACE2(hash_table_find, index, item.link());
             return item;
+        }
+    }
 
+    BCD_TRACE2(hash_table_find, index, not_found);
     return *list.end();
 }
 
+template <typename Manager, typename Index, typename Link, typename Key>
+std::vector<typename hash_table<Manager, Index, Link, Key>::const_value_type>
+hash_table<Manager, Index, Link, Key>::find(const std::vector<Key>& keys,
+    bool advise) const
+{
+    const auto count = keys.size();
+    std::vector<Index> indexes(count);
+    std::vector<Link> links(count, not_found);
+    std::vector<bool> found(count, false);
+
+    // Compute all buckets, prefetching those not excluded by fingerprint.
+    for (size_t key = 0; key < count; ++key)
+    {
+        indexes[key] = bucket_index(keys[key]);
+
+        if (header_.contains(indexes[key], keys[key]))
+            header_.prefetch(indexes[key], advise);
+        else
+            found[key] = true;
+    }
+
+    // Read all chain roots, prefetching each first element.
+    for (size_t key = 0; key < count; ++key)
+    {
+        if (found[key])
+            continue;
+
+        links[key] = bucket_value(indexes[key]);
+
+        if (links[key] == not_found)
+            found[key] = true;
+        else
+            prefetch(links[key], advise);
+    }
+
+    // Advance each chain one element per pass, prefetching the next.
+    for (auto pending = true; pending;)
+    {
+        pending = false;
+
+        for (size_t key = 0; key < count; ++key)
+        {
+            if (found[key])
+                continue;
+
+            const const_value_type element{ manager_, links[key],
+                list_mutex_[indexes[key]] };
+
+            if (element.match(keys[key]))
+            {
+                found[key] = true;
+                continue;
+            }
+
+            links[key] = element.next();
+
+            if (links[key] == not_found)
+            {
+                found[key] = true;
+                continue;
+            }
+
+            prefetch(links[key], advise);
+            pending = true;
+        }
+    }
+
+    std::vector<const_value_type> out;
+    out.reserve(count);
+
+    // A not_found link value produces a terminator element.
+    for (size_t key = 0; key < count; ++key)
+        out.push_back({ manager_, links[key], list_mutex_[indexes[key]] });
+
+    return out;
+}
+
 template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::const_value_type
 hash_table<Manager, Index, Link, Key>::get(Link link) const
@@ -99,29 +225,39 @@ hash_table<Manager, Index, Link, Key>::get(Link link) const
         "Non-terminating link is past end of file.");
 
     // A not_found link value produces a terminator element.
-    return { manager_, link, list_mutex_ };
+    if (link == not_found)
+        return terminator();
+
+    // The key is immutable once linked, and selects the list mutex stripe.
+    const const_value_type element{ manager_, link, list_mutex_[0] };
+    return { manager_, link, list_mutex_[bucket_index(element.key())] };
 }
 
 template <typename Manager, typename Index, typename Link, typename Key>
 typename hash_table<Manager, Index, Link, Key>::const_value_type
 hash_table<Manager, Index, Link, Key>::terminator() const
 {
-    return { manager_, not_found, list_mutex_ };
+    return { manager_, not_found, list_mutex_[0] };
 }
 
 template <typename Manager, typename Index, typename Link, typename Key>
 void hash_table<Manager, Index, Link, Key>::link(value_type& element)
 {
     const auto index = bucket_index(element.key());
+    auto& root_mutex = root_mutex_[index];
+    const value_type linked{ manager_, element.link(), list_mutex_[index] };
+
+    // The tag precedes the link so that a linked key is never filtered out.
+    header_.tag(index, element.key());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    root_mutex_.lock_upgrade();
-    element.set_next(bucket_value(index));
-    root_mutex_.unlock_upgrade_and_lock();
+    root_mutex.lock_upgrade();
+    linked.set_next(bucket_value(index));
+    root_mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     header_.write(index, element.link());
-    root_mutex_.unlock();
+    root_mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -131,16 +267,18 @@ template <typename Manager, typename Index, typename Link, typename Key>
 bool hash_table<Manager, Index, Link, Key>::unlink(const Key& key)
 {
     const auto index = bucket_index(key);
+    auto& root_mutex = root_mutex_[index];
 
     // Critical Section.
     ///////////////////////////////////////////////////////////////////////////
-    root_mutex_.lock_upgrade();
+    root_mutex.lock_upgrade();
 
-    list<Manager, Link, Key> list(manager_, bucket_value(index), list_mutex_);
+    list<Manager, Link, Key> list(manager_, bucket_value(index),
+        list_mutex_[index]);
 
     if (list.empty())
     {
-        root_mutex_.unlock_upgrade();
+        root_mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return false;
     }
@@ -152,18 +290,19 @@ bool hash_table<Manager, Index, Link, Key>::unlink(const Key& key)
     // TODO: implement -> overload.
     if ((*previous).match(key))
     {
-        root_mutex_.unlock_upgrade_and_lock();
+        root_mutex.unlock_upgrade_and_lock();
         //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         header_.write(index, (*previous).next());
-        root_mutex_.unlock();
+        root_mutex.unlock();
         //---------------------------------------------------------------------
         return true;
     }
 
-    root_mutex_.unlock_upgrade();
+    root_mutex.unlock_upgrade();
     ///////////////////////////////////////////////////////////////////////////
 
-    // The linked list internally manages link update safety using list_mutex_.
+    // The linked list internally manages link update safety using the list
+    // mutex of the bucket.
     for (auto item = ++previous; item != list.end(); item++)
     {
         // TODO: implement -> overloads.
@@ -177,6 +316,159 @@ bool hash_table<Manager, Index, Link, Key>::unlink(const Key& key)
     return false;
 }
 
+template <typename Manager, typename Index, typename Link, typename Key>
+bool hash_table<Manager, Index, Link, Key>::rehash(hash_table& target) const
+{
+    const auto source_size = header_.size();
+    const auto target_size = target.header_.size();
+    const auto logical = file_.logical();
+
+    if (logical < source_size || !target.header_.create())
+        return false;
+
+    const auto payload = logical - source_size;
+
+    // The accessors must remain in scope until the end of the block.
+    {
+        const auto to = target.file_.resize(target_size + payload);
+        const auto from = file_.access();
+        const auto start = to->buffer() + target_size;
+        std::memcpy(start, from->buffer() + source_size, payload);
+        target.file_.dirty(start, payload);
+    }
+
+    // This reads the committed count (or size) of the copied payload.
+    if (!target.manager_.start())
+        return false;
+
+    std::vector<Link> links;
+
+    for (Index index = 0; index < header_.buckets(); ++index)
+    {
+        links.clear();
+
+        list<const Manager, Link, Key> list(manager_,
+            bucket_value(index), list_mutex_[index]);
+
+        for (const auto item: list)
+            links.push_back(item.link());
+
+        // Relink the oldest first, so the newest of equal keys remains first.
+        for (auto link = links.rbegin(); link != links.rend(); ++link)
+        {
+            value_type element{ target.manager_, *link,
+                target.list_mutex_[0] };
+            target.link(element);
+        }
+    }
+
+    return true;
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+std::vector<Link> hash_table<Manager, Index, Link, Key>::links() const
+{
+    std::vector<Link> out;
+
+    for (Index index = 0; index < header_.buckets(); ++index)
+    {
+        list<const Manager, Link, Key> list(manager_, bucket_value(index),
+            list_mutex_[index]);
+
+        for (const auto item: list)
+            out.push_back(item.link());
+    }
+
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+size_t hash_table<Manager, Index, Link, Key>::payload_size() const
+{
+    return manager_.payload_size();
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+size_t hash_table<Manager, Index, Link, Key>::header_size() const
+{
+    return header_.size();
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+Link hash_table<Manager, Index, Link, Key>::copy(Link link, size_t size,
+    hash_table& target) const
+{
+    const auto copied = target.manager_.allocate(size);
+
+    if (copied == Manager::not_allocated)
+        return not_found;
+
+    // The accessors must remain in scope until the end of the block.
+    {
+        const auto from = manager_.access(link);
+        const auto to = target.manager_.access(copied);
+        std::memcpy(to.buffer(), from.buffer(), size);
+        target.manager_.dirty(to, size);
+    }
+
+    // The key is copied, the next link is rewritten by the link.
+    value_type element{ target.manager_, copied, target.list_mutex_[0] };
+    target.link(element);
+    return copied;
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+table_statistics hash_table<Manager, Index, Link, Key>::statistics(
+    size_t samples) const
+{
+    table_statistics out;
+    out.buckets = header_.buckets();
+
+    const size_t buckets = header_.buckets();
+    const auto stride = samples == 0 || samples >= buckets ? 1 :
+        buckets / samples;
+
+    for (size_t index = 0; index < buckets; index += stride)
+    {
+        size_t length = 0;
+        list<const Manager, Link, Key> list(manager_,
+            bucket_value(static_cast<Index>(index)), list_mutex_[index]);
+
+        for (auto item = list.begin(); item != list.end(); ++item)
+            ++length;
+
+        out.add(length);
+    }
+
+    return out;
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+void hash_table<Manager, Index, Link, Key>::for_each(
+    std::function<void(const Key&)> handler) const
+{
+    for (Index index = 0; index < header_.buckets(); ++index)
+    {
+        list<const Manager, Link, Key> list(manager_, bucket_value(index),
+            list_mutex_[index]);
+
+        for (const auto item: list)
+            handler(item.key());
+    }
+}
+
+template <typename Manager, typename Index, typename Link, typename Key>
+void hash_table<Manager, Index, Link, Key>::prefetch(Link link,
+    bool advise) const
+{
+    static BC_CONSTEXPR auto size = std::tuple_size<Key>::value + sizeof(Link);
+
+    // The guard must remain in scope until the end of the block.
+    const auto memory = manager_.access(link);
+    file_.prefetch(memory.buffer(), size, advise);
+}
+
 // private
 template <typename Manager, typename Index, typename Link, typename Key>
 Link hash_table<Manager, Index, Link, Key>::bucket_value(Index index) const
@@ -195,7 +487,7 @@ Link hash_table<Manager, Index, Link, Key>::bucket_value(const Key& key) const
 template <typename Manager, typename Index, typename Link, typename Key>
 Index hash_table<Manager, Index, Link, Key>::bucket_index(const Key& key) const
 {
-    return hash_table_header<Index, Link>::remainder(key, header_.buckets());
+    return header_.bucket(key);
 }
 
 } // namespace database
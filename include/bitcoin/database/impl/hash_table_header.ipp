@@ -19,7 +19,9 @@
 #ifndef LIBBITCOIN_DATABASE_HASH_TABLE_HEADER_IPP
 #define LIBBITCOIN_DATABASE_HASH_TABLE_HEADER_IPP
 
+#include <tuple>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
 
@@ -35,14 +37,120 @@ inline Index hash_table_header<Index, Link>::remainder(const Key& key,
     return divisor == 0 ? 0 : std::hash<Key>()(key) % divisor;
 }
 
+template <typename Index, typename Link>
+template <typename Key>
+inline Index hash_table_header<Index, Link>::mask(const Key& key,
+    Index buckets)
+{
+    static BC_CONSTEXPR auto bytes = std::tuple_size<Key>::value <
+        sizeof(Index) ? std::tuple_size<Key>::value : sizeof(Index);
+
+    // The key is a digest, so its leading bytes are uniformly distributed.
+    // This is independent of the standard library and of the host byte order.
+    BITCOIN_ASSERT(power_of_two(buckets));
+    Index value = 0;
+
+    // This reduces to a single (little-endian) load for common key sizes.
+    for (size_t byte = 0; byte < bytes; ++byte)
+        value |= static_cast<Index>(key[byte]) << (byte * 8);
+
+    return value & (buckets - 1);
+}
+
+template <typename Index, typename Link>
+template <typename Key>
+inline Index hash_table_header<Index, Link>::bucket(const Key& key) const
+{
+    return masked_ ? mask(key, buckets_) : remainder(key, buckets_);
+}
+
+template <typename Index, typename Link>
+template <typename Key>
+inline bool hash_table_header<Index, Link>::contains(Index index,
+    const Key& key) const
+{
+    if (!fingerprints_)
+        return true;
+
+    BITCOIN_ASSERT(index < buckets_);
+    const auto bits = fingerprint(key);
+
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(tag_link(buckets_, index));
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    system::shared_lock lock(mutex_[index]);
+    return (deserial.template read_little_endian<uint32_t>() & bits) == bits;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Index, typename Link>
+template <typename Key>
+void hash_table_header<Index, Link>::tag(Index index, const Key& key)
+{
+    if (!fingerprints_)
+        return;
+
+    BITCOIN_ASSERT(index < buckets_);
+    const auto bits = fingerprint(key);
+
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(tag_link(buckets_, index));
+    const auto buffer = memory.buffer();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    system::unique_lock lock(mutex_[index]);
+    auto deserial = system::make_unsafe_deserializer(buffer);
+    const auto value = deserial.template read_little_endian<uint32_t>() | bits;
+    auto serial = system::make_unsafe_serializer(buffer);
+    serial.template write_little_endian<uint32_t>(value);
+    ///////////////////////////////////////////////////////////////////////////
+
+    file_.dirty(buffer, sizeof(uint32_t));
+}
+
+// static
+template <typename Index, typename Link>
+template <typename Key>
+inline uint32_t hash_table_header<Index, Link>::fingerprint(const Key& key)
+{
+    static BC_CONSTEXPR auto size = std::tuple_size<Key>::value;
+    static_assert(size >= 2, "Fingerprint requires a key of two bytes.");
+
+    // Use the bytes that follow those of a masked bucket index (where they
+    // exist), as these do not otherwise distinguish the keys of a bucket.
+    static BC_CONSTEXPR auto offset = size - 2 < sizeof(Index) ? size - 2 :
+        sizeof(Index);
+
+    return (uint32_t(1) << (key[offset] % 32)) |
+        (uint32_t(1) << (key[offset + 1] % 32));
+}
+
 // Link must be unsigned (see static assertions below).
 // HACK: This is a VC++ workaround, otherwise std::numeric_limits<Link>::max().
 template <typename Index, typename Link>
 const Link hash_table_header<Index, Link>::empty = (Link)bc::max_uint64;
 
+// The high bit of the stored size, which is otherwise never set.
 template <typename Index, typename Link>
-hash_table_header<Index, Link>::hash_table_header(storage& file, Index buckets)
-  : file_(file), buckets_(buckets)
+const Index hash_table_header<Index, Link>::masked =
+    Index(1) << (sizeof(Index) * 8 - 1);
+
+// The next bit of the stored size, which is also never otherwise set.
+template <typename Index, typename Link>
+const Index hash_table_header<Index, Link>::fingerprinted =
+    Index(1) << (sizeof(Index) * 8 - 2);
+
+template <typename Index, typename Link>
+hash_table_header<Index, Link>::hash_table_header(storage& file, Index buckets,
+    bool fingerprints)
+  : file_(file), buckets_(buckets), masked_(power_of_two(buckets)),
+    fingerprints_(fingerprints)
 {
     static_assert(std::is_unsigned<Link>::value,
         "Hash table header requires unsigned value type.");
@@ -54,17 +162,21 @@ hash_table_header<Index, Link>::hash_table_header(storage& file, Index buckets)
 template <typename Index, typename Link>
 bool hash_table_header<Index, Link>::create()
 {
-    const auto file_size = size(buckets_);
+    const auto rows_size = size(buckets_);
+    const auto file_size = size(buckets_, fingerprints_);
 
     // The accessor must remain in scope until the end of the block.
     const auto memory = file_.resize(file_size);
 
-    // Speed-optimized fill implementation.
-    memset(memory->buffer(), (uint8_t)empty, file_size);
+    // Speed-optimized fill implementation (tags are cleared).
+    memset(memory->buffer(), (uint8_t)empty, rows_size);
+    memset(memory->buffer() + rows_size, 0, file_size - rows_size);
 
-    // Overwrite the start of the buffer with the bucket count.
+    // Overwrite the start of the buffer with the bucket count and flags.
     auto serial = system::make_unsafe_serializer(memory->buffer());
-    serial.template write_little_endian<Index>(buckets_);
+    serial.template write_little_endian<Index>(buckets_ |
+        (masked_ ? masked : 0) | (fingerprints_ ? fingerprinted : 0));
+    file_.dirty(memory->buffer(), file_size);
     return true;
 }
 
@@ -72,15 +184,24 @@ template <typename Index, typename Link>
 bool hash_table_header<Index, Link>::start()
 {
     // File is too small for the number of buckets in the header.
-    if (file_.capacity() < link(buckets_))
+    if (file_.capacity() < size(buckets_, fingerprints_))
         return false;
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
 
     // Does not require atomicity (no concurrency during start).
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
-    return deserial.template read_little_endian<Index>() == buckets_;
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
+    const auto stored = deserial.template read_little_endian<Index>();
+
+    // A table created before the masked format (or with an unmasked count)
+    // retains its format, so that existing stores remain readable.
+    // The fingerprint array is part of the layout, so it must be configured
+    // consistently with the creation of the table.
+    masked_ = (stored & masked) != 0;
+    const auto fingerprints = (stored & fingerprinted) != 0;
+    return (stored & ~(masked | fingerprinted)) == buckets_ &&
+        fingerprints == fingerprints_ && (!masked_ || power_of_two(buckets_));
 }
 
 template <typename Index, typename Link>
@@ -88,14 +209,14 @@ Link hash_table_header<Index, Link>::read(Index index) const
 {
     BITCOIN_ASSERT(index < buckets_);
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(link(index));
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(link(index));
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    system::shared_lock lock(mutex_);
+    system::shared_lock lock(mutex_[index]);
     return deserial.template read_little_endian<Link>();
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -105,16 +226,33 @@ void hash_table_header<Index, Link>::write(Index index, Link value)
 {
     BITCOIN_ASSERT(index < buckets_);
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(link(index));
-    auto serial = system::make_unsafe_serializer(memory->buffer());
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(link(index));
+    auto serial = system::make_unsafe_serializer(memory.buffer());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    system::unique_lock lock(mutex_);
+    system::unique_lock lock(mutex_[index]);
     serial.template write_little_endian<Link>(value);
     ///////////////////////////////////////////////////////////////////////////
+
+    file_.dirty(memory.buffer(), sizeof(Link));
+}
+
+template <typename Index, typename Link>
+void hash_table_header<Index, Link>::prefetch(Index index, bool advise) const
+{
+    BITCOIN_ASSERT(index < buckets_);
+
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    const auto start = memory.buffer();
+    file_.prefetch(start + link(index), sizeof(Link), advise);
+
+    if (fingerprints_)
+        file_.prefetch(start + tag_link(buckets_, index), sizeof(uint32_t),
+            advise);
 }
 
 template <typename Index, typename Link>
@@ -124,14 +262,14 @@ Index hash_table_header<Index, Link>::buckets() const
 }
 
 template <typename Index, typename Link>
-size_t hash_table_header<Index, Link>::size()
+size_t hash_table_header<Index, Link>::size() const
 {
-    return size(buckets_);
+    return size(buckets_, fingerprints_);
 }
 
 // static
 template <typename Index, typename Link>
-size_t hash_table_header<Index, Link>::size(Index buckets)
+size_t hash_table_header<Index, Link>::size(Index buckets, bool fingerprints)
 {
     // Header byte size is file link of last bucket + 1:
     //
@@ -140,7 +278,16 @@ size_t hash_table_header<Index, Link>::size(Index buckets)
     //  [ [      ...         ] ]
     //  [ [ row[buckets - 1] ] ] <=
     //
-    return link(buckets);
+    // Or, with fingerprints, the link of the last tag + 1.
+    //
+    return fingerprints ? tag_link(buckets, buckets) : link(buckets);
+}
+
+// static
+template <typename Index, typename Link>
+bool hash_table_header<Index, Link>::power_of_two(Index buckets)
+{
+    return buckets != 0 && (buckets & (buckets - 1)) == 0;
 }
 
 // static
@@ -157,6 +304,14 @@ file_offset hash_table_header<Index, Link>::link(Index index)
     return sizeof(Index) + index * sizeof(Link);
 }
 
+// static
+template <typename Index, typename Link>
+file_offset hash_table_header<Index, Link>::tag_link(Index buckets,
+    Index index)
+{
+    return link(buckets) + index * sizeof(uint32_t);
+}
+
 } // namespace database
 } // namespace libbitcoin
 
@@ -19,6 +19,9 @@
 #ifndef LIBBITCOIN_DATABASE_HASH_TABLE_MULTIMAP_IPP
 #define LIBBITCOIN_DATABASE_HASH_TABLE_MULTIMAP_IPP
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/list.hpp>
@@ -46,31 +49,85 @@ template <typename Index, typename Link, typename Key>
 typename hash_table_multimap<Index, Link, Key>::value_type
 hash_table_multimap<Index, Link, Key>::allocator()
 {
-    // Empty-keyed (for payload elements).
-    return { manager_, list_mutex_ };
+    // Empty-keyed (for payload elements), rebound to its stripe when linked.
+    return { manager_, list_mutex_[0] };
+}
+
+template <typename Index, typename Link, typename Key>
+typename hash_table_multimap<Index, Link, Key>::value_type
+hash_table_multimap<Index, Link, Key>::allocator(Link link)
+{
+    // Empty-keyed (for payload elements), rebound to its stripe when linked.
+    return { manager_, link, list_mutex_[0] };
+}
+
+// The elements are allocated in a single manager reservation.
+template <typename Index, typename Link, typename Key>
+Link hash_table_multimap<Index, Link, Key>::allocate(size_t count)
+{
+    return manager_.allocate(count);
 }
 
 template <typename Index, typename Link, typename Key>
 typename hash_table_multimap<Index, Link, Key>::const_value_type
 hash_table_multimap<Index, Link, Key>::find(const Key& key) const
 {
+    const auto index = map_.bucket_index(key);
     const auto element = map_.find(key);
 
     if (!element)
-        return { manager_, element.not_found, list_mutex_ };
+        return { manager_, element.not_found, list_mutex_[0] };
 
     Link first;
     const auto reader = [&](byte_deserializer& deserial)
     {
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
-        system::shared_lock lock(root_mutex_);
+        system::shared_lock lock(root_mutex_[index]);
         first = deserial.template read_little_endian<Link>();
         ///////////////////////////////////////////////////////////////////////
     };
 
     element.read(reader);
-    return { manager_, first, list_mutex_ };
+    return { manager_, first, list_mutex_[index] };
+}
+
+template <typename Index, typename Link, typename Key>
+std::vector<typename hash_table_multimap<Index, Link, Key>::const_value_type>
+hash_table_multimap<Index, Link, Key>::find(const std::vector<Key>& keys,
+    bool advise) const
+{
+    const auto elements = map_.find(keys, advise);
+    std::vector<const_value_type> out;
+    out.reserve(keys.size());
+
+    for (size_t key = 0; key < keys.size(); ++key)
+    {
+        const auto& element = elements[key];
+
+        if (!element)
+        {
+            out.push_back({ manager_, element.not_found, list_mutex_[0] });
+            continue;
+        }
+
+        const auto index = map_.bucket_index(keys[key]);
+
+        Link first;
+        const auto reader = [&](byte_deserializer& deserial)
+        {
+            // Critical Section.
+            ///////////////////////////////////////////////////////////////////
+            system::shared_lock lock(root_mutex_[index]);
+            first = deserial.template read_little_endian<Link>();
+            ///////////////////////////////////////////////////////////////////
+        };
+
+        element.read(reader);
+        out.push_back({ manager_, first, list_mutex_[index] });
+    }
+
+    return out;
 }
 
 template <typename Index, typename Link, typename Key>
@@ -80,48 +137,106 @@ hash_table_multimap<Index, Link, Key>::get(Link link) const
     const auto element = map_.get(link);
 
     if (!element)
-        return { manager_, element.not_found, list_mutex_ };
+        return { manager_, element.not_found, list_mutex_[0] };
+
+    const auto index = map_.bucket_index(element.key());
 
     Link first;
     const auto reader = [&](byte_deserializer& deserial)
     {
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
-        system::shared_lock lock(root_mutex_);
+        system::shared_lock lock(root_mutex_[index]);
         first = deserial.template read_little_endian<Link>();
         ///////////////////////////////////////////////////////////////////////
     };
 
     element.read(reader);
-    return { manager_, first, list_mutex_ };
+    return { manager_, first, list_mutex_[index] };
+}
+
+template <typename Index, typename Link, typename Key>
+typename hash_table_multimap<Index, Link, Key>::const_value_type
+hash_table_multimap<Index, Link, Key>::terminator() const
+{
+    return { manager_, const_value_type::not_found, list_mutex_[0] };
 }
 
 template <typename Index, typename Link, typename Key>
 void hash_table_multimap<Index, Link, Key>::link(const Key& key,
     value_type& element)
+{
+    link(key, element.link(), element.link());
+}
+
+template <typename Index, typename Link, typename Key>
+void hash_table_multimap<Index, Link, Key>::link(const std::vector<Key>& keys,
+    Link first)
+{
+    std::vector<size_t> order(keys.size());
+
+    for (size_t position = 0; position < order.size(); ++position)
+        order[position] = position;
+
+    // Group elements by key, preserving allocation order within each key.
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t left, size_t right)
+        {
+            return keys[left] < keys[right];
+        });
+
+    for (auto it = order.begin(); it != order.end();)
+    {
+        const auto& key = keys[*it];
+        const auto index = map_.bucket_index(key);
+        const Link tail = first + *it;
+        auto head = tail;
+
+        // Chain newer elements to older, the newest becomes the list head.
+        // The elements are not yet reachable, so chaining requires no lock.
+        for (++it; it != order.end() && keys[*it] == key; ++it)
+        {
+            const Link link = first + *it;
+            const value_type element{ manager_, link, list_mutex_[index] };
+            element.set_next(head);
+            head = link;
+        }
+
+        link(key, head, tail);
+    }
+}
+
+// private
+template <typename Index, typename Link, typename Key>
+void hash_table_multimap<Index, Link, Key>::link(const Key& key, Link head,
+    Link tail)
 {
     const auto writer = [&](byte_serializer& serial)
     {
-        serial.template write_little_endian<Link>(element.link());
+        serial.template write_little_endian<Link>(head);
     };
 
+    const auto index = map_.bucket_index(key);
+    auto& root_mutex = root_mutex_[index];
+    const value_type linked{ manager_, tail, list_mutex_[index] };
+
     // Critical Section.
     ///////////////////////////////////////////////////////////////////////////
-    root_mutex_.lock_upgrade();
+    root_mutex.lock_upgrade();
 
     // Find the root element for this key in hash table.
     // The hash table supports multiple values per key, but this uses only one.
     auto root = map_.find(key);
 
-    root_mutex_.unlock_upgrade_and_lock();
+    root_mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
     if (!root)
     {
         // Commit the termination of the new list.
-        element.set_next(element.not_found);
+        linked.set_next(linked.not_found);
 
-        // Create and map new root and "link" from it to the new element.
+        // Create and map new root and "link" from it to the new head.
         auto new_root = map_.allocator();
         new_root.create(key, writer);
         map_.link(new_root);
@@ -138,23 +253,26 @@ void hash_table_multimap<Index, Link, Key>::link(const Key& key,
         // Read the address of the existing first list element.
         root.read(reader);
 
-        // Commit linkage to the existing first list element.
-        element.set_next(first);
+        // Commit linkage of the tail to the existing first list element.
+        linked.set_next(first);
 
-        // "link" existing root to the new first element.
-        root.write(writer);
+        // "link" existing root to the new head element.
+        root.write(writer, sizeof(Link));
     }
 
-    root_mutex_.unlock();
+    root_mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
 template <typename Index, typename Link, typename Key>
 bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
 {
+    const auto index = map_.bucket_index(key);
+    auto& root_mutex = root_mutex_[index];
+
     // Critical Section.
     ///////////////////////////////////////////////////////////////////////////
-    root_mutex_.lock_upgrade();
+    root_mutex.lock_upgrade();
 
     // Find the root element for this key in hash table.
     // The hash table supports multiple values per key, but this uses only one.
@@ -163,7 +281,7 @@ bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
     // There is no root element, nothing to unlink.
     if (!root)
     {
-        root_mutex_.unlock_upgrade();
+        root_mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return false;
     }
@@ -178,12 +296,12 @@ bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
     // Read the address of the existing first list element.
     root.read(reader);
 
-    value_type first{ manager_, link, list_mutex_ };
+    value_type first{ manager_, link, list_mutex_[index] };
 
     // The root element is empty (points to terminator), nothing to unlink.
     if (!first)
     {
-        root_mutex_.unlock_upgrade();
+        root_mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return false;
     }
@@ -196,16 +314,65 @@ bool hash_table_multimap<Index, Link, Key>::unlink(const Key& key)
         serial.template write_little_endian<Link>(first.next());
     };
 
-    root_mutex_.unlock_upgrade_and_lock();
+    root_mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    root.write(writer);
+    root.write(writer, sizeof(Link));
 
-    root_mutex_.unlock();
+    root_mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 
     return true;
 }
 
+// Readers of the replaced list are unaffected, as its elements are retained.
+template <typename Index, typename Link, typename Key>
+bool hash_table_multimap<Index, Link, Key>::relink(const Key& key,
+    Link expected, Link head)
+{
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.template write_little_endian<Link>(head);
+    };
+
+    Link first;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        first = deserial.template read_little_endian<Link>();
+    };
+
+    auto& root_mutex = root_mutex_[map_.bucket_index(key)];
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    root_mutex.lock_upgrade();
+
+    const auto root = map_.find(key);
+
+    if (!root)
+    {
+        root_mutex.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    // An element linked since the list was read is not in the chain.
+    root.read(reader);
+
+    if (first != expected)
+    {
+        root_mutex.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    root_mutex.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    root.write(writer, sizeof(Link));
+    root_mutex.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+    return true;
+}
+
 } // namespace database
 } // namespace libbitcoin
 
@@ -24,6 +24,7 @@
 #include <tuple>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 
 namespace libbitcoin {
@@ -62,17 +63,19 @@ list_element<Manager, Link, Key>::list_element(Manager& manager, Link link,
 
 // private
 // Populate a new (unlinked) element with key and value data.
+// The size of the element is recorded for flush once it is written.
 template <typename Manager, typename Link, typename Key>
 void list_element<Manager, Link, Key>::initialize(const Key& key,
-    write_function write)
+    write_function write, size_t size)
 {
     const auto memory = data(0);
-    auto serial = system::make_unsafe_serializer(memory->buffer());
+    auto serial = system::make_unsafe_serializer(memory.buffer());
 
     // Limited to tuple|iterator Key types.
     serial.write_forward(key);
     serial.skip(sizeof(Link));
     serial.write_delegated(write);
+    manager_.dirty(memory, size);
 }
 
 // This call assumes the manager is a record_manager.
@@ -81,7 +84,7 @@ Link list_element<Manager, Link, Key>::create(write_function write)
 {
     BC_CONSTEXPR empty_key unkeyed{};
     link_ = manager_.allocate(1);
-    initialize(unkeyed, write);
+    initialize(unkeyed, write, manager_.record_size());
     return link_;
 }
 
@@ -91,7 +94,7 @@ Link list_element<Manager, Link, Key>::create(const Key& key,
     write_function write)
 {
     link_ = manager_.allocate(1);
-    initialize(key, write);
+    initialize(key, write, manager_.record_size());
     return link_;
 }
 
@@ -101,16 +104,45 @@ Link list_element<Manager, Link, Key>::create(const Key& key,
     write_function write, size_t value_size)
 {
     link_ = manager_.allocate(size(value_size));
-    initialize(key, write);
+    initialize(key, write, size(value_size));
     return link_;
 }
 
+// The element must have been allocated by the caller (unlinked).
+// This call assumes the manager is a record_manager.
+template <typename Manager, typename Link, typename Key>
+void list_element<Manager, Link, Key>::populate(write_function write)
+{
+    BC_CONSTEXPR empty_key unkeyed{};
+    initialize(unkeyed, write, manager_.record_size());
+}
+
+// The element must have been allocated by the caller (unlinked).
+// This call assumes the manager is a record_manager.
+template <typename Manager, typename Link, typename Key>
+void list_element<Manager, Link, Key>::populate(const Key& key,
+    write_function write)
+{
+    initialize(key, write, manager_.record_size());
+}
+
+// The element must have been allocated by the caller (unlinked).
+// This call assumes the manager is a slab_manager.
 template <typename Manager, typename Link, typename Key>
-void list_element<Manager, Link, Key>::write(write_function writer) const
+void list_element<Manager, Link, Key>::populate(const Key& key,
+    write_function write, size_t value_size)
+{
+    initialize(key, write, size(value_size));
+}
+
+template <typename Manager, typename Link, typename Key>
+void list_element<Manager, Link, Key>::write(write_function writer,
+    size_t size) const
 {
     const auto memory = data(std::tuple_size<Key>::value + sizeof(Link));
-    auto serial = system::make_unsafe_serializer(memory->buffer());
+    auto serial = system::make_unsafe_serializer(memory.buffer());
     writer(serial);
+    manager_.dirty(memory, size);
 }
 
 // Jump to the next element in the list.
@@ -136,35 +168,43 @@ template <typename Manager, typename Link, typename Key>
 void list_element<Manager, Link, Key>::set_next(Link next) const
 {
     const auto memory = data(std::tuple_size<Key>::value);
-    auto serial = system::make_unsafe_serializer(memory->buffer());
+    auto serial = system::make_unsafe_serializer(memory.buffer());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
     serial.template write_little_endian<Link>(next);
     ///////////////////////////////////////////////////////////////////////////
+
+    manager_.dirty(memory, sizeof(Link));
 }
 
 template <typename Manager, typename Link, typename Key>
 void list_element<Manager, Link, Key>::read(read_function reader) const
 {
     const auto memory = data(std::tuple_size<Key>::value + sizeof(Link));
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
     reader(deserial);
 }
 
+template <typename Manager, typename Link, typename Key>
+access_guard list_element<Manager, Link, Key>::access() const
+{
+    return data(std::tuple_size<Key>::value + sizeof(Link));
+}
+
 template <typename Manager, typename Link, typename Key>
 bool list_element<Manager, Link, Key>::match(const Key& key) const
 {
     const auto memory = data(0);
-    return std::equal(key.begin(), key.end(), memory->buffer());
+    return std::equal(key.begin(), key.end(), memory.buffer());
 }
 
 template <typename Manager, typename Link, typename Key>
 Key list_element<Manager, Link, Key>::key() const
 {
     const auto memory = data(0);
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
 
     // Limited to tuple Key types (see deserializer to generalize).
     return deserial.template read_forward<Key>();
@@ -180,7 +220,7 @@ template <typename Manager, typename Link, typename Key>
 Link list_element<Manager, Link, Key>::next() const
 {
     const auto memory = data(std::tuple_size<Key>::value);
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
@@ -196,6 +236,26 @@ list_element<Manager, Link, Key>::terminator() const
     return { manager_, mutex_ };
 }
 
+template <typename Manager, typename Link, typename Key>
+list_element<Manager, Link, Key>
+list_element<Manager, Link, Key>::at(Link link) const
+{
+    return { manager_, link, mutex_ };
+}
+
+// This call assumes the manager is a record_manager.
+template <typename Manager, typename Link, typename Key>
+void list_element<Manager, Link, Key>::prefetch(Link link, size_t value_size,
+    bool advise) const
+{
+    if (link == not_found || manager_.past_eof(link))
+        return;
+
+    // The guard must remain in scope until the end of the block.
+    const auto memory = manager_.access(link);
+    manager_.prefetch(memory, size(value_size), advise);
+}
+
 template <typename Manager, typename Link, typename Key>
 bool list_element<Manager, Link, Key>::terminal() const
 {
@@ -222,11 +282,11 @@ bool list_element<Manager, Link, Key>::operator!=(list_element other) const
 
 // private
 template <typename Manager, typename Link, typename Key>
-memory_ptr list_element<Manager, Link, Key>::data(size_t bytes) const
+access_guard list_element<Manager, Link, Key>::data(size_t bytes) const
 {
     BITCOIN_ASSERT(link_ != not_found);
-    auto memory = manager_.get(link_);
-    memory->increment(bytes);
+    auto memory = manager_.access(link_);
+    memory.increment(bytes);
     return memory;
 }
 
@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_OPEN_TABLE_IPP
+#define LIBBITCOIN_DATABASE_OPEN_TABLE_IPP
+
+#include <cstring>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
+#include <bitcoin/database/primitives/hash_table_header.hpp>
+#include <bitcoin/database/primitives/list_element.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+template <typename Link, typename Key>
+const Link open_table<Link, Key>::not_found = (Link)bc::max_uint64;
+
+template <typename Link, typename Key>
+const Link open_table<Link, Key>::occupied = 0;
+
+template <typename Link, typename Key>
+open_table<Link, Key>::open_table(storage& file, Link slots,
+    size_t value_size)
+  : slots_(slots),
+    record_size_(value_type::size(value_size)),
+    manager_(file, 0, record_size_)
+{
+}
+
+template <typename Link, typename Key>
+bool open_table<Link, Key>::create()
+{
+    if (slots_ == 0 || !manager_.create())
+        return false;
+
+    // All slots are allocated at creation, the count never changes.
+    const auto first = manager_.allocate(slots_);
+    const auto size = slots_ * record_size_;
+
+    // The guard must remain in scope until the end of the block.
+    const auto memory = manager_.access(first);
+
+    // Speed-optimized fill implementation, (Link)0xff.. is vacant.
+    memset(memory.buffer(), (uint8_t)not_found, size);
+    manager_.dirty(memory, size);
+    manager_.commit();
+    return true;
+}
+
+template <typename Link, typename Key>
+bool open_table<Link, Key>::start()
+{
+    return manager_.start() && manager_.count() == slots_;
+}
+
+template <typename Link, typename Key>
+void open_table<Link, Key>::commit()
+{
+    manager_.commit();
+}
+
+template <typename Link, typename Key>
+Link open_table<Link, Key>::store(const Key& key, write_function write)
+{
+    auto link = slot(key);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    system::unique_lock lock(store_mutex_);
+
+    for (Link probe = 0; probe < slots_; ++probe, link = (link + 1) % slots_)
+    {
+        const value_type element{ manager_, link, mutex_ };
+
+        if (element.next() != not_found)
+            continue;
+
+        // The guard must remain in scope until the end of the block.
+        // A vacant slot is unreachable, so the key and value are written
+        // before the slot is marked occupied (under the element mutex).
+        {
+            const auto memory = manager_.access(link);
+            auto serial = system::make_unsafe_serializer(memory.buffer());
+            serial.write_forward(key);
+            serial.skip(sizeof(Link));
+            write(serial);
+            manager_.dirty(memory, record_size_);
+        }
+
+        element.set_next(occupied);
+        return link;
+    }
+
+    return not_found;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Link, typename Key>
+typename open_table<Link, Key>::const_value_type
+open_table<Link, Key>::find(const Key& key) const
+{
+    auto link = slot(key);
+
+    // A vacant slot terminates the probe sequence, as slots are never freed.
+    for (Link probe = 0; probe < slots_; ++probe, link = (link + 1) % slots_)
+    {
+        const const_value_type element{ manager_, link, mutex_ };
+
+        if (element.next() == not_found)
+            break;
+
+        if (element.match(key))
+            return element;
+    }
+
+    return terminator();
+}
+
+template <typename Link, typename Key>
+typename open_table<Link, Key>::const_value_type
+open_table<Link, Key>::get(Link link) const
+{
+    // A not_found link value produces a terminator element.
+    if (link == not_found)
+        return terminator();
+
+    BITCOIN_ASSERT_MSG(link < slots_, "Link is past the last slot.");
+    return { manager_, link, mutex_ };
+}
+
+template <typename Link, typename Key>
+typename open_table<Link, Key>::const_value_type
+open_table<Link, Key>::terminator() const
+{
+    return { manager_, not_found, mutex_ };
+}
+
+template <typename Link, typename Key>
+Link open_table<Link, Key>::slot(const Key& key) const
+{
+    typedef hash_table_header<Link, Link> header;
+    return (slots_ & (slots_ - 1)) == 0 ? header::mask(key, slots_) :
+        header::remainder(key, slots_);
+}
+
+template <typename Link, typename Key>
+Link open_table<Link, Key>::slots() const
+{
+    return slots_;
+}
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_RECORD_FIELD_IPP
+#define LIBBITCOIN_DATABASE_RECORD_FIELD_IPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+template <size_t Offset, typename Integer>
+constexpr size_t record_field<Offset, Integer>::offset;
+
+template <size_t Offset, typename Integer>
+constexpr size_t record_field<Offset, Integer>::size;
+
+template <size_t Offset, typename Integer>
+constexpr size_t record_field<Offset, Integer>::end;
+
+// The loop is over a constant size, so it compiles to a single load.
+template <size_t Offset, typename Integer>
+Integer record_field<Offset, Integer>::read(const uint8_t* record)
+{
+    uint64_t value = 0;
+
+    for (size_t byte = 0; byte < size; ++byte)
+        value |= static_cast<uint64_t>(record[Offset + byte]) << (8u * byte);
+
+    return static_cast<Integer>(value);
+}
+
+template <size_t Offset, typename Integer>
+void record_field<Offset, Integer>::write(uint8_t* record, Integer value)
+{
+    const auto bits = static_cast<uint64_t>(value);
+
+    for (size_t byte = 0; byte < size; ++byte)
+        record[Offset + byte] = static_cast<uint8_t>(bits >> (8u * byte));
+}
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_DATABASE_RECORD_MANAGER_IPP
 #define LIBBITCOIN_DATABASE_RECORD_MANAGER_IPP
 
+#include <algorithm>
 #include <cstddef>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/memory.hpp>
@@ -36,11 +37,13 @@ namespace database {
 
 template <typename Link>
 record_manager<Link>::record_manager(storage& file, size_t header_size,
-    size_t record_size)
+    size_t record_size, size_t arena_size)
   : file_(file),
     header_size_(header_size),
     record_size_(record_size),
-    record_count_(0)
+    arena_records_(std::max(arena_size / record_size, size_t(1))),
+    record_count_(0),
+    arena_count_(0)
 {
 }
 
@@ -57,6 +60,7 @@ bool record_manager<Link>::create()
 
     // This currently throws if there is insufficient space.
     file_.resize(header_size_ + link_to_position(record_count_));
+    arena_count_ = record_count_.load();
     write_count();
     return true;
     ///////////////////////////////////////////////////////////////////////////
@@ -69,7 +73,8 @@ bool record_manager<Link>::start()
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
 
-    read_count();
+    record_count_ = read_count();
+    arena_count_ = record_count_.load();
     const auto minimum = header_size_ + link_to_position(record_count_);
 
     // Records size does not exceed file size.
@@ -77,26 +82,44 @@ bool record_manager<Link>::start()
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// The count is committed after the records are written, and the file is
+// extended before them, so once refreshed after the read of the count the
+// file covers it. The count is then published to readers.
 template <typename Link>
-void record_manager<Link>::commit()
+bool record_manager<Link>::refresh()
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
-    write_count();
+
+    const auto count = read_count();
+
+    if (!file_.refresh() ||
+        header_size_ + link_to_position(count) > file_.capacity())
+        return false;
+
+    record_count_ = count;
+    arena_count_ = count;
+    return true;
     ///////////////////////////////////////////////////////////////////////////
 }
 
 template <typename Link>
-Link record_manager<Link>::count() const
+void record_manager<Link>::commit()
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    system::shared_lock lock(mutex_);
-    return record_count_;
+    system::unique_lock lock(mutex_);
+    write_count();
     ///////////////////////////////////////////////////////////////////////////
 }
 
+template <typename Link>
+Link record_manager<Link>::count() const
+{
+    return record_count_.load();
+}
+
 template <typename Link>
 void record_manager<Link>::set_count(Link value)
 {
@@ -109,26 +132,33 @@ void record_manager<Link>::set_count(Link value)
 }
 
 // Return the next index, regardless of the number created.
-// The file is thread safe, the critical section is to protect record_count_.
+// Records are carved from the arena lock-free, the critical section protects
+// only the growth of the arena, which is shared by all writers.
 template <typename Link>
 Link record_manager<Link>::allocate(size_t count)
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    system::unique_lock lock(mutex_);
+    auto next = record_count_.load();
 
-    // Always write after the last index.
-    const auto next_record_index = record_count_;
-    const size_t position = link_to_position(record_count_ + count);
-    const size_t required_size = header_size_ + position;
+    while (true)
+    {
+        if (next + count > arena_count_.load())
+        {
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            system::unique_lock lock(mutex_);
 
-    // Currently throws runtime_error if insufficient space.
-    if (!file_.reserve(required_size))
-        return 0;
+            // Another writer may have grown the arena while we waited.
+            next = record_count_.load();
 
-    record_count_ += count;
-    return next_record_index;
-    ///////////////////////////////////////////////////////////////////////////
+            if (next + count > arena_count_.load() && !reserve(next, count))
+                return not_allocated;
+            ///////////////////////////////////////////////////////////////////
+        }
+
+        // On failure next is updated to the current count and we retry.
+        if (record_count_.compare_exchange_weak(next, next + count))
+            return next;
+    }
 }
 
 template <typename Link>
@@ -143,6 +173,44 @@ memory_ptr record_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+void record_manager<Link>::dirty(memory_ptr memory, size_t size) const
+{
+    file_.dirty(memory->buffer(), size);
+}
+
+template <typename Link>
+access_guard record_manager<Link>::access(Link link) const
+{
+    // Ensure requested position is within the file.
+    // We avoid a runtime error here to optimize out the count lock.
+    BITCOIN_ASSERT_MSG(!past_eof(link), "Read past end of file.");
+
+    access_guard memory(file_);
+    memory.increment(header_size_ + link_to_position(link));
+    return memory;
+}
+
+template <typename Link>
+void record_manager<Link>::dirty(const access_guard& memory,
+    size_t size) const
+{
+    file_.dirty(memory.buffer(), size);
+}
+
+template <typename Link>
+void record_manager<Link>::prefetch(const access_guard& memory, size_t size,
+    bool advise) const
+{
+    file_.prefetch(memory.buffer(), size, advise);
+}
+
+template <typename Link>
+size_t record_manager<Link>::record_size() const
+{
+    return record_size_;
+}
+
 template <typename Link>
 bool record_manager<Link>::past_eof(Link link) const
 {
@@ -151,17 +219,35 @@ bool record_manager<Link>::past_eof(Link link) const
 
 // privates
 
+// Grow the arena to cover count records past next, called under mutex.
+// Records are recorded for flush by their writers, as they are written.
+template <typename Link>
+bool record_manager<Link>::reserve(Link next, size_t count)
+{
+    const Link last = next + std::max(count, arena_records_);
+    const auto required_size = header_size_ + link_to_position(last);
+
+    // Currently throws runtime_error if insufficient space.
+    const auto memory = file_.reserve(required_size);
+
+    if (!memory)
+        return false;
+
+    arena_count_ = last;
+    return true;
+}
+
 // Read the count value from the first 32 bits of the file after the header.
 template <typename Link>
-void record_manager<Link>::read_count()
+Link record_manager<Link>::read_count() const
 {
     BITCOIN_ASSERT(header_size_ + sizeof(Link) <= file_.capacity());
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(header_size_);
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
-    record_count_ = deserial.template read_little_endian<Link>();
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(header_size_);
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
+    return deserial.template read_little_endian<Link>();
 }
 
 // Write the count value to the first 32 bits of the file after the header.
@@ -170,11 +256,12 @@ void record_manager<Link>::write_count()
 {
     BITCOIN_ASSERT(header_size_ + sizeof(Link) <= file_.capacity());
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(header_size_);
-    auto serial = system::make_unsafe_serializer(memory->buffer());
-    serial.template write_little_endian<Link>(record_count_);
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(header_size_);
+    auto serial = system::make_unsafe_serializer(memory.buffer());
+    serial.template write_little_endian<Link>(record_count_.load());
+    file_.dirty(memory.buffer(), sizeof(Link));
 }
 
 template <typename Link>
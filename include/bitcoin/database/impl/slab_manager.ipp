@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_DATABASE_SLAB_MANAGER_IPP
 #define LIBBITCOIN_DATABASE_SLAB_MANAGER_IPP
 
+#include <algorithm>
 #include <cstddef>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/memory.hpp>
@@ -35,10 +36,13 @@ namespace database {
 // TODO: guard against overflows.
 
 template <typename Link>
-slab_manager<Link>::slab_manager(storage& file, size_t header_size)
+slab_manager<Link>::slab_manager(storage& file, size_t header_size,
+    size_t arena_size)
   : file_(file),
     header_size_(header_size),
-    payload_size_(sizeof(Link))
+    arena_size_(arena_size),
+    payload_size_(sizeof(Link)),
+    arena_end_(sizeof(Link))
 {
 }
 
@@ -55,6 +59,7 @@ bool slab_manager<Link>::create()
 
     // This currently throws if there is insufficient space.
     file_.resize(header_size_ + payload_size_);
+    arena_end_ = payload_size_.load();
     write_size();
     return true;
     ///////////////////////////////////////////////////////////////////////////
@@ -67,7 +72,8 @@ bool slab_manager<Link>::start()
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
 
-    read_size();
+    payload_size_ = read_size();
+    arena_end_ = payload_size_.load();
     const auto minimum = header_size_ + payload_size_;
 
     // Slabs size does not exceed file size.
@@ -75,46 +81,71 @@ bool slab_manager<Link>::start()
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// The size is committed after the slabs are written, and the file is
+// extended before them, so once refreshed after the read of the size the
+// file covers it. The size is then published to readers.
 template <typename Link>
-void slab_manager<Link>::commit()
+bool slab_manager<Link>::refresh()
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     system::unique_lock lock(mutex_);
-    write_size();
+
+    const auto size = read_size();
+
+    if (!file_.refresh() || header_size_ + size > file_.capacity())
+        return false;
+
+    payload_size_ = size;
+    arena_end_ = size;
+    return true;
     ///////////////////////////////////////////////////////////////////////////
 }
 
 template <typename Link>
-size_t slab_manager<Link>::payload_size() const
+void slab_manager<Link>::commit()
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    system::shared_lock lock(mutex_);
-    return payload_size_;
+    system::unique_lock lock(mutex_);
+    write_size();
     ///////////////////////////////////////////////////////////////////////////
 }
 
+template <typename Link>
+size_t slab_manager<Link>::payload_size() const
+{
+    return payload_size_.load();
+}
+
 // Return is offset by header but not size storage (embedded in data files).
-// The file is thread safe, the critical section is to protect payload_size_.
+// Slabs are carved from the arena lock-free, the critical section protects
+// only the growth of the arena, which is shared by all writers.
 template <typename Link>
 Link slab_manager<Link>::allocate(size_t size)
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    system::unique_lock lock(mutex_);
-
-    // Always write after the last slab.
-    const auto next_slab_position = payload_size_;
-    const size_t required_size = header_size_ + payload_size_ + size;
-
-    // Currently throws runtime_error if insufficient space.
-    if (!file_.reserve(required_size))
-        return not_allocated;
-
-    payload_size_ += size;
-    return next_slab_position;
-    ///////////////////////////////////////////////////////////////////////////
+    auto next = payload_size_.load();
+
+    while (true)
+    {
+        if (next + size > arena_end_.load())
+        {
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            system::unique_lock lock(mutex_);
+
+            // Another writer may have grown the arena while we waited.
+            next = payload_size_.load();
+
+            if (next + size > arena_end_.load() && !reserve(next, size))
+                return not_allocated;
+            ///////////////////////////////////////////////////////////////////
+        }
+
+        // On failure next is updated to the current size and we retry.
+        if (payload_size_.compare_exchange_weak(next, next + size))
+            return next;
+    }
 }
 
 // Position is offset by header but not size storage (embedded in data files).
@@ -130,6 +161,37 @@ memory_ptr slab_manager<Link>::get(Link link) const
     return memory;
 }
 
+template <typename Link>
+void slab_manager<Link>::dirty(memory_ptr memory, size_t size) const
+{
+    file_.dirty(memory->buffer(), size);
+}
+
+template <typename Link>
+access_guard slab_manager<Link>::access(Link link) const
+{
+    // Ensure requested position is within the file.
+    // We avoid a runtime error here to optimize out the payload_size lock.
+    BITCOIN_ASSERT_MSG(link < payload_size(), "Read past end of file.");
+
+    access_guard memory(file_);
+    memory.increment(header_size_ + link);
+    return memory;
+}
+
+template <typename Link>
+void slab_manager<Link>::dirty(const access_guard& memory, size_t size) const
+{
+    file_.dirty(memory.buffer(), size);
+}
+
+template <typename Link>
+void slab_manager<Link>::prefetch(const access_guard& memory, size_t size,
+    bool advise) const
+{
+    file_.prefetch(memory.buffer(), size, advise);
+}
+
 template <typename Link>
 bool slab_manager<Link>::past_eof(Link link) const
 {
@@ -138,17 +200,34 @@ bool slab_manager<Link>::past_eof(Link link) const
 
 // privates
 
+// Grow the arena to cover size bytes past next, called under mutex.
+// Slabs are recorded for flush by their writers, as they are written.
+template <typename Link>
+bool slab_manager<Link>::reserve(size_t next, size_t size)
+{
+    const auto last = next + std::max(size, arena_size_);
+
+    // Currently throws runtime_error if insufficient space.
+    const auto memory = file_.reserve(header_size_ + last);
+
+    if (!memory)
+        return false;
+
+    arena_end_ = last;
+    return true;
+}
+
 // Read the size value from the first 64 bits of the file after the header.
 template <typename Link>
-void slab_manager<Link>::read_size()
+size_t slab_manager<Link>::read_size() const
 {
     BITCOIN_ASSERT(header_size_ + sizeof(Link) <= file_.capacity());
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(header_size_);
-    auto deserial = system::make_unsafe_deserializer(memory->buffer());
-    payload_size_ = deserial.template read_little_endian<Link>();
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(header_size_);
+    auto deserial = system::make_unsafe_deserializer(memory.buffer());
+    return deserial.template read_little_endian<Link>();
 }
 
 // Write the size value to the first 64 bits of the file after the header.
@@ -157,11 +236,12 @@ void slab_manager<Link>::write_size() const
 {
     BITCOIN_ASSERT(header_size_ + sizeof(Link) <= file_.capacity());
 
-    // The accessor must remain in scope until the end of the block.
-    const auto memory = file_.access();
-    memory->increment(header_size_);
-    auto serial = system::make_unsafe_serializer(memory->buffer());
-    serial.template write_little_endian<Link>(payload_size_);
+    // The guard must remain in scope until the end of the block.
+    access_guard memory(file_);
+    memory.increment(header_size_);
+    auto serial = system::make_unsafe_serializer(memory.buffer());
+    serial.template write_little_endian<Link>(payload_size_.load());
+    file_.dirty(memory.buffer(), sizeof(Link));
 }
 
 } // namespace database
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_LATENCY_HISTOGRAM_HPP
+#define LIBBITCOIN_DATABASE_LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A histogram of operation latencies in buckets of powers of two
+/// microseconds, with a count, total and maximum. Each record is a few
+/// relaxed atomic updates, so it may be taken on hot paths.
+class BCD_API latency_histogram
+  : system::noncopyable
+{
+public:
+    /// Bucket zero counts latencies under one microsecond, bucket n those
+    /// under 2^n microseconds (and not under 2^(n-1)), the last all others.
+    static const size_t buckets;
+
+    /// A copy of the histogram, its values are not read as one snapshot.
+    struct BCD_API values
+    {
+        values();
+
+        /// The upper bound of the bucket that contains the fraction (0..1)
+        /// of the recorded latencies, zero if none recorded.
+        system::asio::microseconds quantile(double fraction) const;
+
+        uint64_t count;
+        system::asio::duration total;
+        system::asio::duration maximum;
+        std::vector<uint64_t> buckets;
+    };
+
+    /// Records the latency of its scope on destruct.
+    class BCD_API timer
+      : system::noncopyable
+    {
+    public:
+        timer(latency_histogram& histogram);
+        ~timer();
+
+    private:
+        latency_histogram& histogram_;
+        const system::asio::steady_clock::time_point start_;
+    };
+
+    latency_histogram();
+
+    /// Record the latency of one operation.
+    void record(const system::asio::duration& latency);
+
+    /// Copy the recorded values.
+    values read() const;
+
+    /// Remove all recorded values.
+    void reset();
+
+private:
+    static size_t bucket(const system::asio::duration& latency);
+
+    std::atomic<uint64_t> count_;
+    std::atomic<int64_t> total_;
+    std::atomic<int64_t> maximum_;
+    std::vector<std::atomic<uint64_t>> buckets_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_ACCESS_ADVICE_HPP
+#define LIBBITCOIN_DATABASE_ACCESS_ADVICE_HPP
+
+#include <cstdint>
+
+namespace libbitcoin {
+namespace database {
+
+/// The expected access pattern of a memory map, passed on to the kernel.
+enum class access_advice : uint8_t
+{
+    /// Default kernel readahead.
+    normal,
+
+    /// No readahead, for hash table buckets and randomly-accessed rows.
+    random,
+
+    /// Aggressive readahead, for appended or height-ordered files.
+    sequential,
+
+    /// Read the mapped file into the page cache now.
+    willneed
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
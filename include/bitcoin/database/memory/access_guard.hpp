@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_ACCESS_GUARD_HPP
+#define LIBBITCOIN_DATABASE_ACCESS_GUARD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/storage.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class provides stack-scoped shared access to a storage buffer, without
+/// heap allocation or reference counting (see accessor for memory_ptr).
+/// The call caller must know the buffer size as it is unprotected/unmanaged.
+class BCD_API access_guard
+  : system::noncopyable
+{
+public:
+    /// Lock the storage for shared access and read its buffer pointer.
+    access_guard(storage& file);
+
+    /// Transfer the lock, allowing return of the guard by value.
+    access_guard(access_guard&& other);
+
+    /// Free the buffer pointer lock.
+    ~access_guard();
+
+    /// Get the buffer pointer.
+    uint8_t* buffer() const;
+
+    /// Advance the buffer pointer a specified number of bytes.
+    void increment(size_t value);
+
+private:
+    storage* file_;
+    uint8_t* data_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -37,6 +37,9 @@ public:
     /// Assign a null upgradeable buffer pointer.
     accessor(system::upgrade_mutex& mutex);
 
+    /// Lock for shared access and then read the referenced buffer pointer.
+    accessor(system::upgrade_mutex& mutex, uint8_t* const& data);
+
     /// Free the buffer pointer lock.
     ~accessor();
 
@@ -25,13 +25,19 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/memory/storage_counters.hpp>
+#include <bitcoin/database/memory/storage_residency.hpp>
+#include <bitcoin/database/memory/write_log.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -47,8 +53,18 @@ public:
     static const uint64_t default_capacity;
 
     /// Construct a database (start is currently called, may throw).
+    /// Huge page advice is mostly a no-op for a writable shared map of a
+    /// regular file, which the kernel rarely backs with huge pages.
+    /// The leading huge_pages bytes of the map are advised for (transparent)
+    /// huge page backing, zero disables and max_size_t covers the full map.
+    /// A nonzero reservation maps that much address space at open so that
+    /// growth within it extends the file without remapping or blocking reads.
+    /// A nonzero populate is the batch of pages to populate ahead of writers.
+    /// A nonzero extent preallocates growth in multiples of extent bytes.
     file_storage(const path& filename);
-    file_storage(const path& filename, size_t minimum, size_t expansion);
+    file_storage(const path& filename, size_t minimum, size_t expansion,
+        size_t huge_pages=0, size_t reservation=0, size_t populate=0,
+        size_t extent=0);
 
     /// Close the database.
     ~file_storage();
@@ -56,9 +72,34 @@ public:
     /// Open and map database files, must be closed.
     bool open();
 
-    /// Flush the memory map to disk, idempotent.
+    /// Flush bytes written since the last flush to disk, idempotent.
+    /// Logged bytes are not flushed (see attach).
     bool flush() const;
 
+    /// Flush all bytes written since the last checkpoint, including logged
+    /// bytes, after which the committed records of the log are redundant.
+    bool checkpoint() const;
+
+    /// Record writes of up to write_log::max_write bytes in the log, instead
+    /// of for the next flush, until the next checkpoint (or close).
+    void attach(write_log& log);
+
+    /// Map the file for reads only, without locking, resizing, syncing or
+    /// truncating it, so that it may be shared with a writer of another
+    /// process (set before open). The file is reopened for reads only, so
+    /// it need not be writable by the process. Resize and reserve then throw.
+    void set_read_only();
+
+    /// Follow the size of a file mapped for reads only, as extended (or
+    /// truncated) by its writer, remapping when beyond the reservation.
+    /// No-op if not read only, false if closed or the remap fails.
+    bool refresh();
+
+    /// Initiate write back of bytes written since the last write back or
+    /// flush, optionally waiting on the disk (but not for the file metadata).
+    /// These remain to be completed by the next flush.
+    bool writeback(bool wait=false) const;
+
     /// Unmap and release files, restartable, idempotent.
     bool close();
 
@@ -71,9 +112,23 @@ public:
     /// The current logical size of mapped data.
     size_t logical() const;
 
+    /// The cumulative performance counters and current sizes of the map.
+    storage_counters counters() const;
+
+    /// The memory footprint of the map, its resident pages read from the
+    /// kernel (where supported), with the leading head bytes reported apart.
+    storage_residency residency(size_t head=0) const;
+
     /// Get protected shared access to memory, starting at first byte.
     memory_ptr access();
 
+    /// Lock for shared access to memory and get the first byte, must be
+    /// paired with unlock_shared (use access_guard to provide scope).
+    uint8_t* lock_shared();
+
+    /// Release the shared access obtained by lock_shared.
+    void unlock_shared();
+
     /// Throws runtime_error if insufficient space.
     /// Resize the logical map to the specified size, return access.
     /// Increase or shrink the physical size to match the logical size.
@@ -84,39 +139,114 @@ public:
     /// Increase the physical size to at least the logical size.
     memory_ptr reserve(size_t required);
 
+    /// Record bytes written through an accessor for the next flush.
+    void dirty(const uint8_t* position, size_t size);
+
+    /// Prefetch the cache line of the position (where supported), and
+    /// optionally advise asynchronous readahead of the pages of the range.
+    void prefetch(const uint8_t* position, size_t size, bool advise);
+
+    /// Zero the range, punching a hole in the file for its whole pages (where
+    /// supported), and record the remaining bytes for the next flush.
+    void punch(uint8_t* position, size_t size);
+
+    /// Advise the expected access pattern, retained across resizes.
+    bool advise(access_advice advice);
+
+    /// Apply the NUMA policy over the node mask (zero for all nodes) to the
+    /// map, retained across resizes, and migrate its resident pages (Linux).
+    bool place(memory_placement placement, uint64_t nodes);
+
+    /// Fault in the leading size bytes of the logical map (max_size_t for all)
+    /// and optionally lock them in memory (across resizes) until close.
+    bool prefault(size_t size, bool pin);
+
+    /// Copy the file to a new file, by a reflink (sharing its extents until
+    /// written) where the file system supports it, otherwise by streaming.
+    static bool copy(const path& from, const path& to);
+
 private:
+    // Page-aligned [begin, end) file ranges, ordered and coalesced.
+    typedef std::map<size_t, size_t> ranges;
+
     static size_t file_size(int file_handle);
-    static int open_file(const boost::filesystem::path& filename);
+    static int open_file(const boost::filesystem::path& filename,
+        bool read_only);
     static bool handle_error(const std::string& context,
         const boost::filesystem::path& filename);
 
     size_t page() const;
+    size_t resident(size_t begin, size_t end) const;
     bool unmap();
     bool map(size_t size);
     bool remap(size_t size);
+    bool repin();
     bool truncate(size_t size);
     bool truncate_mapped(size_t size);
-    bool validate(size_t size);
+    bool validate(size_t size, size_t length);
+    size_t reservation(size_t size) const;
+    bool advise_huge_pages();
+    bool advise_access();
+    bool place_memory(bool migrate);
+    bool sync(const ranges& dirty, bool exact) const;
+    static size_t insert(ranges& dirty, size_t begin, size_t end);
+    bool populate(size_t required);
     memory_ptr reserve(size_t required, size_t minimum, size_t expansion);
 
     void log_mapping() const;
+    void log_huge_pages() const;
+    void log_advice() const;
+    void log_placement() const;
+    void log_populate() const;
+    void log_prefaulted(size_t size,
+        const system::asio::duration& elapsed) const;
     void log_resizing(size_t size) const;
+    void log_allocated(size_t size,
+        const system::asio::duration& elapsed) const;
     void log_flushed() const;
     void log_unmapping() const;
     void log_unmapped() const;
 
-    // File system.
-    const int file_handle_;
+    // File system (the handle is replaced when set read only).
+    int file_handle_;
     const size_t minimum_;
     const size_t expansion_;
+    const size_t huge_pages_;
+    const size_t reservation_;
+    const size_t populate_;
+    const size_t extent_;
     const boost::filesystem::path filename_;
+    const size_t page_size_;
 
     // Protected by mutex.
     bool closed_;
     uint8_t* data_;
     size_t capacity_;
+    size_t allocated_;
+    size_t reserved_;
+    size_t populated_;
+    size_t pinned_;
     size_t logical_size_;
+    access_advice advice_;
+    memory_placement placement_;
+    uint64_t nodes_;
     mutable system::upgrade_mutex mutex_;
+
+    // Protected by dirty mutex.
+    mutable ranges dirty_;
+    mutable ranges logged_;
+    mutable ranges unwritten_;
+    mutable size_t unwritten_bytes_;
+    mutable system::shared_mutex dirty_mutex_;
+
+    // Set before open.
+    write_log* log_;
+    uint8_t log_file_;
+    bool read_only_;
+
+    // Protected by counters mutex.
+    mutable storage_counters counters_;
+    mutable system::shared_mutex counters_mutex_;
 };
 
 } // namespace database
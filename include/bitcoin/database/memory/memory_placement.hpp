@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_MEMORY_PLACEMENT_HPP
+#define LIBBITCOIN_DATABASE_MEMORY_PLACEMENT_HPP
+
+#include <cstdint>
+
+namespace libbitcoin {
+namespace database {
+
+/// The NUMA memory policy of a memory map, over a mask of nodes.
+enum class memory_placement : uint8_t
+{
+    /// Default kernel policy, pages are placed by the faulting thread.
+    local,
+
+    /// Pages are placed only on the nodes, workers are pinned to them.
+    bind,
+
+    /// Pages are spread round robin over the nodes.
+    interleave
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_PROCESSOR_AFFINITY_HPP
+#define LIBBITCOIN_DATABASE_PROCESSOR_AFFINITY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+typedef std::vector<size_t> processors;
+
+/// The mask of online NUMA nodes (Linux), zero where unknown.
+BCD_API uint64_t numa_nodes();
+
+/// The processors of the NUMA nodes of the mask (Linux), empty where unknown.
+BCD_API processors numa_processors(uint64_t nodes);
+
+/// This class pins the calling thread to a set of processors for its scope,
+/// and restores the prior affinity of the thread on destruct. An empty set,
+/// or a platform without thread affinity (non-Linux), leaves it unchanged.
+class BCD_API processor_affinity
+  : system::noncopyable
+{
+public:
+    /// Pin the calling thread to the processors.
+    processor_affinity(const processors& pinned);
+
+    /// Restore the prior affinity of the thread.
+    ~processor_affinity();
+
+    /// The thread is pinned to the processors.
+    bool pinned() const;
+
+private:
+    processors prior_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
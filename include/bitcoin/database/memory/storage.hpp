@@ -40,6 +40,10 @@ public:
     /// Unmap and release files, restartable, idempotent.
     virtual bool close() = 0;
 
+    /// Follow the size of the file as changed by another process (if read
+    /// only), false if closed.
+    virtual bool refresh() = 0;
+
     /// Determine if the database is closed.
     virtual bool closed() const = 0;
 
@@ -52,6 +56,13 @@ public:
     /// Get protected shared access to memory, starting at first byte.
     virtual memory_ptr access() = 0;
 
+    /// Lock for shared access to memory and get the first byte, must be
+    /// paired with unlock_shared (use access_guard to provide scope).
+    virtual uint8_t* lock_shared() = 0;
+
+    /// Release the shared access obtained by lock_shared.
+    virtual void unlock_shared() = 0;
+
     /// Resize the logical map to the specified size, return access.
     /// Increase or shrink the physical size to match the logical size.
     virtual memory_ptr resize(size_t required) = 0;
@@ -59,6 +70,21 @@ public:
     /// Resize the logical map to the specified size, return access.
     /// Increase the physical size to at least the logical size.
     virtual memory_ptr reserve(size_t required) = 0;
+
+    /// Record bytes written through an accessor for the next flush.
+    /// The position must be within the buffer of a memory object in scope.
+    virtual void dirty(const uint8_t* position, size_t size) = 0;
+
+    /// Hint that bytes are about to be read, optionally advising readahead
+    /// of their pages so that page faults are overlapped with other work.
+    /// The position must be within the buffer of a memory object in scope.
+    virtual void prefetch(const uint8_t* position, size_t size,
+        bool advise) = 0;
+
+    /// Zero bytes through an accessor, releasing the disk space of whole
+    /// pages within the range where supported, and record them as written.
+    /// The position must be within the buffer of a memory object in scope.
+    virtual void punch(uint8_t* position, size_t size) = 0;
 };
 
 } // namespace database
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_STORAGE_COUNTERS_HPP
+#define LIBBITCOIN_DATABASE_STORAGE_COUNTERS_HPP
+
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// Cumulative performance counters of a memory map, with current sizes.
+struct BCD_API storage_counters
+{
+    storage_counters();
+
+    /// Accumulate the counters (and sizes) of another storage.
+    storage_counters& operator+=(const storage_counters& other);
+
+    /// Physical growth of the file, a remap when beyond the reservation.
+    uint64_t resizes;
+    uint64_t remaps;
+    system::asio::duration resize_duration;
+    system::asio::duration resize_maximum;
+
+    /// Flush synchronizations of dirty ranges to disk.
+    uint64_t flushes;
+    system::asio::duration flush_duration;
+
+    /// Writer acquisitions of the upgrade lock and time spent waiting on it.
+    uint64_t upgrades;
+    system::asio::duration upgrade_wait;
+
+    /// Bytes of dirty pages not yet written back, at the time of the read.
+    uint64_t unwritten;
+
+    /// Bytes of address space, file and data at the time of the read.
+    uint64_t reserved;
+    uint64_t capacity;
+    uint64_t logical;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
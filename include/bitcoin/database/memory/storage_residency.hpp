@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_STORAGE_RESIDENCY_HPP
+#define LIBBITCOIN_DATABASE_STORAGE_RESIDENCY_HPP
+
+#include <cstdint>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// The memory footprint of a memory map at the time of the read, with its
+/// head (the bucket array of a hash table) reported apart from its body
+/// (slabs or records).
+struct BCD_API storage_residency
+{
+    storage_residency();
+
+    /// Accumulate the footprint of another storage.
+    storage_residency& operator+=(const storage_residency& other);
+
+    /// Bytes of file mapped, of data and of the head of the data.
+    uint64_t mapped;
+    uint64_t logical;
+    uint64_t head;
+
+    /// Bytes of the resident pages of the head and of the body of the data.
+    uint64_t head_resident;
+    uint64_t body_resident;
+
+    /// Bytes of dirty pages not yet written back.
+    uint64_t dirty;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_STRIPED_MUTEX_HPP
+#define LIBBITCOIN_DATABASE_STRIPED_MUTEX_HPP
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A fixed set of shared mutexes selected by index (such as a hash table
+/// bucket), so that operations on different indexes rarely contend.
+class BCD_API striped_mutex
+  : system::noncopyable
+{
+public:
+    static const size_t default_stripes;
+
+    /// Construct the set of mutexes, stripes must be nonzero.
+    striped_mutex(size_t stripes=default_stripes);
+
+    /// The mutex of the stripe containing the index.
+    system::shared_mutex& operator[](size_t index) const;
+
+    /// The number of mutexes.
+    size_t stripes() const;
+
+private:
+    const size_t stripes_;
+    const std::unique_ptr<system::shared_mutex[]> mutexes_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
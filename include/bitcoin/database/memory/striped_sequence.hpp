@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_STRIPED_SEQUENCE_HPP
+#define LIBBITCOIN_DATABASE_STRIPED_SEQUENCE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A fixed set of sequence locks selected by index (such as a record link),
+/// for small values updated in place. Readers take no lock and repeat a read
+/// that overlapped a write of its stripe. Writers of a stripe are exclusive.
+class BCD_API striped_sequence
+  : system::noncopyable
+{
+public:
+    static const size_t default_stripes;
+
+    /// Construct the set of sequences, stripes must be nonzero.
+    striped_sequence(size_t stripes=default_stripes);
+
+    /// Begin a read of the values of the index, returning the sequence to
+    /// validate it with. This waits only for a write in progress.
+    uint32_t begin_read(size_t index) const;
+
+    /// True if no write of the stripe overlapped the read, otherwise the
+    /// values read since begin_read must be discarded and read again.
+    bool end_read(size_t index, uint32_t sequence) const;
+
+    /// Begin a write of the values of the index, excluding other writers.
+    void begin_write(size_t index) const;
+
+    /// End the write, invalidating reads of the stripe that overlapped it.
+    void end_write(size_t index) const;
+
+    /// The number of sequences.
+    size_t stripes() const;
+
+private:
+    // Each sequence is padded to a cache line, so stripes do not false share.
+    struct sequence
+    {
+        std::atomic<uint32_t> value;
+        uint8_t padding[64 - sizeof(std::atomic<uint32_t>)];
+    };
+
+    std::atomic<uint32_t>& at(size_t index) const;
+
+    const size_t stripes_;
+    const std::unique_ptr<sequence[]> sequences_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_WRITE_LOG_HPP
+#define LIBBITCOIN_DATABASE_WRITE_LOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// An append-only redo log of the small writes to the memory maps of enrolled
+/// files, so that the pages of those writes need not be flushed with each
+/// commit. Records are durable once followed by a commit marker (synced), and
+/// are replayed into their files at open. The log is reset at a checkpoint,
+/// once the enrolled files are flushed in full.
+class BCD_API write_log
+  : system::noncopyable
+{
+public:
+    typedef boost::filesystem::path path;
+
+    /// Writes of up to this many bytes are logged.
+    static const size_t max_write;
+
+    /// Apply the committed records of the log to the files (in the directory
+    /// of the log) and sync them, then empty the log. True if no log exists.
+    static bool replay(const path& filename);
+
+    /// Construct a log over the file (created at open).
+    write_log(const path& filename);
+
+    /// Close the log.
+    ~write_log();
+
+    /// Create or empty the log file, rewriting the enrollments.
+    bool open();
+
+    /// Commit pending records and close the log file, retaining it.
+    bool close();
+
+    /// Assign an identifier to the file (by its name, in the log directory).
+    uint8_t enroll(const path& filename);
+
+    /// Record bytes written at the offset of the enrolled file.
+    void record(uint8_t file, size_t offset, const uint8_t* data,
+        size_t size);
+
+    /// Append the pending records and a commit marker, and sync the log.
+    bool commit();
+
+    /// Discard the committed records, after a flush of all enrolled files.
+    /// Records pending commit are retained.
+    bool reset();
+
+    /// The bytes committed to the log since the last reset.
+    size_t size() const;
+
+private:
+    bool write(const system::data_chunk& data);
+    system::data_chunk enrollments() const;
+
+    const path filename_;
+    int file_handle_;
+
+    // Protected by mutex.
+    std::vector<std::string> names_;
+    system::data_chunk pending_;
+    mutable std::mutex mutex_;
+
+    // Protected by commit mutex.
+    std::atomic<size_t> size_;
+    mutable std::mutex commit_mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
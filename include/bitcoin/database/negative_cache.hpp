@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_NEGATIVE_CACHE_HPP
+#define LIBBITCOIN_DATABASE_NEGATIVE_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A direct mapped cache of recently missed digests, held in memory. A newer
+/// miss replaces any digest in its slot, so the cache is bounded and a hit
+/// proves that the digest was absent when it was recorded.
+class BCD_API negative_cache
+  : system::noncopyable
+{
+public:
+    /// Construct a cache of the number of slots (zero disables the cache).
+    negative_cache(size_t capacity);
+
+    /// The capacity is zero, so no digest is recorded.
+    bool disabled() const;
+
+    /// The number of slots.
+    size_t capacity() const;
+
+    /// The number of queries that found a recorded miss.
+    size_t hits() const;
+
+    /// Obtain the erase sequence before the lookup to be recorded.
+    uint64_t sequence() const;
+
+    /// Record the missed digest, unless erased since obtaining the sequence.
+    void insert(const system::hash_digest& hash, uint64_t sequence);
+
+    /// True if the digest is recorded as missed.
+    bool contains(const system::hash_digest& hash) const;
+
+    /// Invalidate any recorded miss of the digest, as it has been stored.
+    void erase(const system::hash_digest& hash);
+
+    /// Remove all digests.
+    void clear();
+
+private:
+    size_t slot(const system::hash_digest& hash) const;
+
+    // These are thread safe.
+    mutable std::atomic<size_t> hits_;
+    std::atomic<uint64_t> sequence_;
+
+    // These are protected by mutex.
+    const size_t capacity_;
+    std::vector<system::hash_digest> slots_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -21,13 +21,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/hash_table_header.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/primitives/table_statistics.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/memory/striped_mutex.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -44,6 +48,9 @@ namespace database {
  *  [ [    ...    ] ]
  *  [ [ item:Link ] ]
  *
+ * The bucket list is optionally followed by a fingerprint per bucket (see
+ * hash_table_header), which rejects most absent keys before the chain read.
+ *
  * The slab_manager is used to create a payload of linked chains. A header
  * containing the hash of the item, and the next value is stored with each
  * slab.
@@ -65,10 +72,12 @@ public:
     static const Link not_found;
 
     /// Construct a hash table for variable size entries.
-    hash_table(storage& file, Index buckets);
+    hash_table(storage& file, Index buckets,
+        bucket_tags tags=bucket_tags::none);
 
     /// Construct a hash table for fixed size entries.
-    hash_table(storage& file, Index buckets, size_t value_size);
+    hash_table(storage& file, Index buckets, size_t value_size,
+        bucket_tags tags=bucket_tags::none);
 
     /// Create hash table in the file (left in started state).
     bool create();
@@ -76,15 +85,31 @@ public:
     /// Verify the size of the hash table in the file.
     bool start();
 
+    /// Follow the size of the table committed by a writer (read only).
+    bool refresh();
+
     /// Commit table size to the file.
     void commit();
 
     /// Use to allocate an element in the hash table.
     value_type allocator();
 
+    /// Use to populate an element of a bulk allocation.
+    value_type allocator(Link link);
+
+    /// Allocate contiguous elements (bytes of slabs or count of records),
+    /// returning the first link. Each element is populated and linked.
+    Link allocate(size_t size);
+
     /// Find an element with the given key in the hash table.
     const_value_type find(const Key& key) const;
 
+    /// Find the elements of many keys, in the order of the keys. Buckets and
+    /// chain elements are prefetched a step ahead and the chains are walked
+    /// interleaved, overlapping memory (and optionally page fault) latency.
+    std::vector<const_value_type> find(const std::vector<Key>& keys,
+        bool advise=false) const;
+
     /// Get the element with the given link from the hash table.
     const_value_type get(Link link) const;
 
@@ -97,15 +122,57 @@ public:
     /// Remove an element with the given key from the hash table.
     bool unlink(const Key& key);
 
+    /// The bucket of the key, which also selects its lock stripe.
+    Index bucket_index(const Key& key) const;
+
+    /// Rebuild this table into a target table of any bucket count, over a
+    /// new file. The payload is copied verbatim, so element links (which may
+    /// be referenced externally) remain valid, and all elements are relinked
+    /// into the buckets (and fingerprints) of the target. Commit before this
+    /// call, and do not write to either table concurrently.
+    bool rehash(hash_table& target) const;
+
+    /// The links of all linked elements, in link (allocation) order. The
+    /// distance to the next (or to the payload size) is the allocation of an
+    /// element, as elements are allocated contiguously. Not concurrent with
+    /// writes.
+    std::vector<Link> links() const;
+
+    /// The size of all allocated slabs, the end of the last (slab tables).
+    size_t payload_size() const;
+
+    /// The byte size of the header (bucket array), which leads the file.
+    size_t header_size() const;
+
+    /// Copy the element of the link, of the given allocation, into the
+    /// target table (created) and link it there, returning the link of the
+    /// copy or not_found if not allocated. The target is written in the order
+    /// of copies, so a sequence of copies is contiguous. Do not write to
+    /// either table concurrently.
+    Link copy(Link link, size_t size, hash_table& target) const;
+
+    /// Walk the chains of all buckets, or of the given number of buckets at
+    /// a regular stride (for very large tables), to obtain statistics.
+    table_statistics statistics(size_t samples=0) const;
+
+    /// Visit the key of each linked element, not concurrently with writes.
+    void for_each(std::function<void(const Key&)> handler) const;
+
+    /// Prefetch the key and next link of the element, optionally advising
+    /// readahead of its pages.
+    void prefetch(Link link, bool advise) const;
+
 private:
     Link bucket_value(Index index) const;
     Link bucket_value(const Key& key) const;
-    Index bucket_index(const Key& key) const;
 
+    storage& file_;
     hash_table_header<Index, Link> header_;
     Manager manager_;
-    mutable system::shared_mutex root_mutex_;
-    mutable system::shared_mutex list_mutex_;
+
+    // Striped by bucket, so that operations on distinct buckets scale.
+    mutable striped_mutex root_mutex_;
+    mutable striped_mutex list_mutex_;
 };
 
 } // namespace database
@@ -21,11 +21,20 @@
 
 #include <functional>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/memory/striped_mutex.hpp>
 
 namespace libbitcoin {
 namespace database {
 
+/// Selects the optional bucket fingerprint array of a hash table.
+enum class bucket_tags
+{
+    none,
+    fingerprint
+};
+
 /// Size-prefixed array.
 /// Empty elements are represented by the value hash_table_header.empty.
 ///
@@ -34,6 +43,20 @@ namespace database {
 ///  [ [      ...     ] ]
 ///  [ [ row:Link ] ]
 ///
+/// A power-of-two bucket count creates a masked table, in which the bucket is
+/// the leading key bytes (a digest) masked to the count, and the stored size
+/// carries the masked flag. Other tables reduce std::hash by the count.
+///
+/// A fingerprinted table follows the rows with one tag per bucket:
+///
+///  [ [ tag:uint32 ] ]
+///  [ [    ...     ] ]
+///  [ [ tag:uint32 ] ]
+///
+/// Each tag accumulates two bits of every key linked into its bucket, so most
+/// lookups of absent keys are rejected without reading the bucket's chain.
+/// Tags are not cleared by unlink, which only increases false positives.
+///
 template <typename Index, typename Link>
 class hash_table_header
   : system::noncopyable
@@ -43,14 +66,28 @@ public:
     template <typename Key>
     static Index remainder(const Key& key, Index divisor);
 
+    /// The leading bytes of the key masked to a power-of-two bucket count.
+    template <typename Key>
+    static Index mask(const Key& key, Index buckets);
+
+    /// Flag of the stored size, set for a masked table.
+    static const Index masked;
+
+    /// Flag of the stored size, set for a fingerprinted table.
+    static const Index fingerprinted;
+
+    /// The tag bits of the key, two bits of a 32 bit tag.
+    template <typename Key>
+    static uint32_t fingerprint(const Key& key);
+
     // Empty cell (null pointer) sentinel.
     static const Link empty;
 
     /// The hash table header byte size for a given bucket count.
-    static size_t size(Index buckets);
+    static size_t size(Index buckets, bool fingerprints=false);
 
-    /// Construct a hash table header.
-    hash_table_header(storage& file, Index buckets);
+    /// Construct a hash table header, optionally with bucket fingerprints.
+    hash_table_header(storage& file, Index buckets, bool fingerprints=false);
 
     /// Allocate the hash table and populate with empty values.
     bool create();
@@ -64,19 +101,44 @@ public:
     /// Write value to item.
     void write(Index index, Link value);
 
+    /// Prefetch the item (and its tag), optionally advising readahead.
+    void prefetch(Index index, bool advise) const;
+
+    /// The bucket of the key in the format of the table.
+    template <typename Key>
+    Index bucket(const Key& key) const;
+
+    /// False if the key is certainly not linked into the bucket.
+    template <typename Key>
+    bool contains(Index index, const Key& key) const;
+
+    /// Add the key to the fingerprint of the bucket (before linking it).
+    template <typename Key>
+    void tag(Index index, const Key& key);
+
     /// The hash table header bucket count.
     Index buckets() const;
 
     /// The hash table header byte size.
-    size_t size();
+    size_t size() const;
 
 private:
     // Position in the memory map relative the header end.
     static file_offset link(Index index);
 
+    // Position of the indexed fingerprint, following the last bucket.
+    static file_offset tag_link(Index buckets, Index index);
+
+    // True if the bucket count is a nonzero power of two.
+    static bool power_of_two(Index buckets);
+
     storage& file_;
     Index buckets_;
-    mutable system::shared_mutex mutex_;
+    bool masked_;
+    const bool fingerprints_;
+
+    // Bucket values and tags are protected by the mutex of the bucket stripe.
+    mutable striped_mutex mutex_;
 };
 
 } // namespace database
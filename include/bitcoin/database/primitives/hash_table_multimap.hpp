@@ -19,11 +19,14 @@
 #ifndef LIBBITCOIN_DATABASE_HASH_TABLE_MULTIMAP_HPP
 #define LIBBITCOIN_DATABASE_HASH_TABLE_MULTIMAP_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/memory/striped_mutex.hpp>
 #include <bitcoin/database/primitives/hash_table.hpp>
 #include <bitcoin/database/primitives/list.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
@@ -58,24 +61,51 @@ public:
     /// Use to allocate an element in a multimap.
     value_type allocator();
 
+    /// Use to populate an element of a bulk allocation.
+    value_type allocator(Link link);
+
+    /// Allocate count contiguous elements and return the first link.
+    Link allocate(size_t count);
+
     /// Find an iterator for the given multimap key.
     const_value_type find(const Key& key) const;
 
+    /// Find iterators for many keys, in the order of the keys, in one
+    /// prefetched batch of the table (see hash_table::find).
+    std::vector<const_value_type> find(const std::vector<Key>& keys,
+        bool advise=false) const;
+
     /// Get the iterator for the given link from a multimap.
     const_value_type get(Link link) const;
 
+    /// A not found iterator for this multimap.
+    const_value_type terminator() const;
+
     /// Add the given element to a multimap.
     /// Multimap elements have empty internal key values.
     void link(const Key& key, value_type& element);
 
+    /// Add the contiguous elements from first to a multimap, one per key.
+    /// Elements of a common key are chained and linked in one critical section.
+    void link(const std::vector<Key>& keys, Link first);
+
     /// Remove a multimap element with the given key.
     bool unlink(const Key& key);
 
+    /// Replace the list of the key with the chain from head (connected and
+    /// terminated), only if the list head remains expected.
+    bool relink(const Key& key, Link expected, Link head);
+
 private:
+    // Link the chain from head to tail (preconnected) to the key root.
+    void link(const Key& key, Link head, Link tail);
+
     table& map_;
     manager& manager_;
-    mutable system::shared_mutex root_mutex_;
-    mutable system::shared_mutex list_mutex_;
+
+    // Striped by the map bucket of the key, so distinct keys rarely contend.
+    mutable striped_mutex root_mutex_;
+    mutable striped_mutex list_mutex_;
 };
 
 } // namespace database
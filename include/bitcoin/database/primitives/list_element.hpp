@@ -24,6 +24,7 @@
 #include <utility>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 
 namespace libbitcoin {
@@ -57,6 +58,15 @@ public:
     /// Allocate and populate a new keyed slab element.
     Link create(const Key& key, write_function write, size_t value_size);
 
+    /// Populate an unkeyed record element that was allocated in bulk.
+    void populate(write_function write);
+
+    /// Populate a keyed record element that was allocated in bulk.
+    void populate(const Key& key, write_function write);
+
+    /// Populate a keyed slab element that was allocated in bulk.
+    void populate(const Key& key, write_function write, size_t value_size);
+
     /// Update this element to the next element (read next from file).
     bool jump_next();
 
@@ -67,11 +77,16 @@ public:
     void set_next(Link next) const;
 
     /// Write to the state of the element (write to file).
-    void write(write_function writer) const;
+    /// The size bounds the value bytes the writer may change, from the start.
+    void write(write_function writer, size_t size) const;
 
     /// Read from the state of the element.
     void read(read_function reader) const;
 
+    /// Shared access to the value of the element, for reading in place.
+    /// The file cannot be remapped (grown) until the guard is destroyed.
+    access_guard access() const;
+
     /// True if the element key (read from file) matches the parameter.
     bool match(const Key& key) const;
 
@@ -87,6 +102,13 @@ public:
     /// A list terminator for this instance.
     list_element terminator() const;
 
+    /// The element of this list at the link (terminal if not_found).
+    list_element at(Link link) const;
+
+    /// Prefetch the element of this list at the link, optionally advising
+    /// readahead. A link past the end is ignored, so it may be speculative.
+    void prefetch(Link link, size_t value_size, bool advise) const;
+
     /// The element is terminal (not found, cannot be read).
     bool terminal() const;
 
@@ -98,8 +120,8 @@ public:
     bool operator!=(list_element other) const;
 
 private:
-    memory_ptr data(size_t bytes) const;
-    void initialize(const Key& key, write_function write);
+    access_guard data(size_t bytes) const;
+    void initialize(const Key& key, write_function write, size_t size);
 
     Link link_;
     Manager& manager_;
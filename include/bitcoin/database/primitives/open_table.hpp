@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_OPEN_TABLE_HPP
+#define LIBBITCOIN_DATABASE_OPEN_TABLE_HPP
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/storage.hpp>
+#include <bitcoin/database/primitives/hash_table_header.hpp>
+#include <bitcoin/database/primitives/list_element.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/**
+ * A hash table of fixed size records stored inline in a fixed number of
+ * slots, resolving collisions by linear probing (open addressing).
+ *
+ *  [ count:Link  ]
+ *  [ [ key:Key   ] ]
+ *  [ [ next:Link ] ]
+ *  [ [ value     ] ]
+ *  [ [    ...    ] ]
+ *
+ * A lookup is one contiguous probe sequence rather than a bucket and chain of
+ * record reads. The count is the slot count, and the link of an element is
+ * its slot, so elements are returned in the hash_table (list_element) form.
+ * The next field marks a slot as vacant (not_found) or occupied (zero).
+ *
+ * Elements are never relocated (i.e. no Robin Hood displacement), so links
+ * remain valid for external indexes. The table cannot grow, so the slot
+ * count must be configured for the lifetime of the table, and store fails
+ * (not_found) once the table is full.
+ */
+template <typename Link, typename Key>
+class open_table
+  : system::noncopyable
+{
+public:
+    typedef record_manager<Link> manager;
+    typedef list_element<manager, Link, Key> value_type;
+    typedef list_element<const manager, Link, Key> const_value_type;
+    typedef typename value_type::write_function write_function;
+
+    static const Link not_found;
+
+    /// The next value of an occupied slot.
+    static const Link occupied;
+
+    /// Construct an open table for fixed size entries.
+    open_table(storage& file, Link slots, size_t value_size);
+
+    /// Create the table in the file with all slots vacant.
+    bool create();
+
+    /// Verify the slot count of the table in the file.
+    bool start();
+
+    /// Commit the table to the file.
+    void commit();
+
+    /// Store the key and value in the first vacant slot of its probe
+    /// sequence, returns the slot or not_found if the table is full.
+    /// Keys are presumed unique (as with hash_table link).
+    Link store(const Key& key, write_function write);
+
+    /// Find the element of the key, or a terminator.
+    const_value_type find(const Key& key) const;
+
+    /// Get the element of the link (slot), or a terminator.
+    const_value_type get(Link link) const;
+
+    /// Get a terminator element.
+    const_value_type terminator() const;
+
+    /// The first slot of the probe sequence of the key.
+    Link slot(const Key& key) const;
+
+    /// The number of slots.
+    Link slots() const;
+
+private:
+    const Link slots_;
+    const size_t record_size_;
+    manager manager_;
+
+    // Slot occupancy (next) is protected by the mutex, stores are serialized.
+    mutable system::shared_mutex mutex_;
+    mutable system::shared_mutex store_mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#include <bitcoin/database/impl/open_table.ipp>
+
+#endif
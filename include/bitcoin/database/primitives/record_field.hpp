@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_RECORD_FIELD_HPP
+#define LIBBITCOIN_DATABASE_RECORD_FIELD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A little-endian integer of a fixed record layout, at a compile-time offset
+/// from the start of the record, read and written in place without a
+/// serializer. Layouts are sequences of fields, each following the last.
+template <size_t Offset, typename Integer>
+struct record_field
+{
+    typedef Integer type;
+
+    static constexpr size_t offset = Offset;
+    static constexpr size_t size = sizeof(Integer);
+    static constexpr size_t end = Offset + sizeof(Integer);
+
+    /// Read the field from the record.
+    static Integer read(const uint8_t* record);
+
+    /// Write the field to the record.
+    static void write(uint8_t* record, Integer value);
+};
+
+/// The field of the integer type that follows the field in its layout.
+template <typename Field, typename Integer>
+using next_field = record_field<Field::end, Integer>;
+
+} // namespace database
+} // namespace libbitcoin
+
+#include <bitcoin/database/impl/record_field.ipp>
+
+#endif
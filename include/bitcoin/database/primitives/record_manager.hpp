@@ -19,9 +19,11 @@
 #ifndef LIBBITCOIN_DATABASE_RECORD_MANAGER_HPP
 #define LIBBITCOIN_DATABASE_RECORD_MANAGER_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
 
@@ -32,6 +34,8 @@ namespace database {
 /// data referenced by an index. The file will be resized accordingly
 /// and the total number of records updated so new chunks can be allocated.
 /// It also provides logical record mapping to the record memory address.
+/// Records are carved from a reserved arena without locking, so that
+/// concurrent writers contend for the file only when the arena is exhausted.
 template <typename Link>
 class record_manager
   : system::noncopyable
@@ -41,7 +45,8 @@ public:
     //static constexpr Link empty = std::numeric_limits<Link>::max();
     static const Link not_allocated = (Link)bc::max_uint64;
 
-    record_manager(storage& file, size_t header_size, size_t record_size);
+    record_manager(storage& file, size_t header_size, size_t record_size,
+        size_t arena_size=65536);
 
     /// Create record manager.
     bool create();
@@ -49,24 +54,45 @@ public:
     /// Prepare manager for usage.
     bool start();
 
-    /// Commit record count to the file.
+    /// Commit record count to the file, excluding the unused arena.
     void commit();
 
+    /// Follow the record count committed by a writer of a read only file.
+    bool refresh();
+
     /// The number of records in this container.
     Link count() const;
 
     /// Change the number of records of this container (truncation).
     void set_count(Link value);
 
+    /// The size of each record.
+    size_t record_size() const;
+
     /// Check if link is past eof
     bool past_eof(Link link) const;
 
-    /// Allocate records and return first logical index, commit after writing.
+    /// Allocate records and return first logical index (or not_allocated),
+    /// commit after writing.
+    /// The writer records the bytes that it writes with dirty.
     Link allocate(size_t count);
 
     /// Return memory object for the record at the specified index.
     memory_ptr get(Link link) const;
 
+    /// Record bytes written through the memory object for the next flush.
+    void dirty(memory_ptr memory, size_t size) const;
+
+    /// Return a stack-scoped guard for the record at the specified index.
+    access_guard access(Link link) const;
+
+    /// Record bytes written through the guard for the next flush.
+    void dirty(const access_guard& memory, size_t size) const;
+
+    /// Hint that bytes are about to be read through the guard, optionally
+    /// advising readahead of their pages.
+    void prefetch(const access_guard& memory, size_t size, bool advise) const;
+
 private:
     // The record index of a disk position.
     Link position_to_link(file_offset position) const;
@@ -75,18 +101,23 @@ private:
     file_offset link_to_position(Link link) const;
 
     // Read the count of the records from the file.
-    void read_count();
+    Link read_count() const;
 
     // Write the count of the records from the file.
     void write_count();
 
+    // Reserve file space for at least the specified records past next.
+    bool reserve(Link next, size_t count);
+
     // This class is thread and remap safe.
     storage& file_;
     const size_t header_size_;
     const size_t record_size_;
+    const size_t arena_records_;
 
-    // Record count is protected by mutex.
-    Link record_count_;
+    // Record count is atomic, arena growth is protected by mutex.
+    std::atomic<Link> record_count_;
+    std::atomic<Link> arena_count_;
     mutable system::shared_mutex mutex_;
 };
 
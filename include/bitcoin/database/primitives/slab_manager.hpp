@@ -19,9 +19,11 @@
 #ifndef LIBBITCOIN_DATABASE_SLAB_MANAGER_HPP
 #define LIBBITCOIN_DATABASE_SLAB_MANAGER_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/memory/storage.hpp>
 
@@ -31,6 +33,8 @@ namespace database {
 /// The slab manager represents a growing collection of various sized
 /// slabs of data on disk. It will resize the file accordingly and keep
 /// track of the current end pointer so new slabs can be allocated.
+/// Slabs are carved from a reserved arena without locking, so that
+/// concurrent writers contend for the file only when the arena is exhausted.
 template <typename Link>
 class slab_manager
   : system::noncopyable
@@ -40,7 +44,7 @@ public:
     //static constexpr Link empty = std::numeric_limits<Link>::max();
     static const Link not_allocated = (Link)bc::max_uint64;
 
-    slab_manager(storage& file, size_t header_size);
+    slab_manager(storage& file, size_t header_size, size_t arena_size=65536);
 
     /// Create slab manager.
     bool create();
@@ -48,13 +52,17 @@ public:
     /// Prepare manager for use.
     bool start();
 
-    /// Commit total slabs size to the file.
+    /// Commit total slabs size to the file, excluding the unused arena.
     void commit();
 
+    /// Follow the slabs size committed by a writer of a read only file.
+    bool refresh();
+
     /// Get the size of all slabs and size prefix (excludes header).
     size_t payload_size() const;
 
     /// Allocate a slab and return its position, commit after writing.
+    /// The writer records the bytes that it writes with dirty.
     Link allocate(size_t size);
 
     /// Check if link is past eof
@@ -63,19 +71,37 @@ public:
     /// Return memory object for the slab at the specified position.
     memory_ptr get(Link position) const;
 
+    /// Record bytes written through the memory object for the next flush.
+    void dirty(memory_ptr memory, size_t size) const;
+
+    /// Return a stack-scoped guard for the slab at the specified position.
+    access_guard access(Link position) const;
+
+    /// Record bytes written through the guard for the next flush.
+    void dirty(const access_guard& memory, size_t size) const;
+
+    /// Hint that bytes are about to be read through the guard, optionally
+    /// advising readahead of their pages.
+    void prefetch(const access_guard& memory, size_t size, bool advise) const;
+
 private:
     // Read the size of the data from the file.
-    void read_size();
+    size_t read_size() const;
 
     // Write the size of the data from the file.
     void write_size() const;
 
+    // Reserve file space for at least the specified bytes past next.
+    bool reserve(size_t next, size_t size);
+
     // This class is thread and remap safe.
     storage& file_;
     const size_t header_size_;
+    const size_t arena_size_;
 
-    // Payload size is protected by mutex.
-    size_t payload_size_;
+    // Payload size is atomic, arena growth is protected by mutex.
+    std::atomic<size_t> payload_size_;
+    std::atomic<size_t> arena_end_;
     mutable system::shared_mutex mutex_;
 };
 
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_TABLE_STATISTICS_HPP
+#define LIBBITCOIN_DATABASE_TABLE_STATISTICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// Chain length statistics of a hash table, over all or a sample of buckets.
+struct BCD_API table_statistics
+{
+    /// Chains of this length or longer share the last histogram entry.
+    static const size_t histogram_size;
+
+    table_statistics();
+
+    /// Count a sampled bucket with the given chain length.
+    void add(size_t length);
+
+    /// Elements per sampled bucket.
+    double load_factor() const;
+
+    /// The element count, extrapolated from the sample to all buckets.
+    uint64_t estimated_elements() const;
+
+    /// The bucket count that achieves the given load for estimated elements.
+    uint64_t recommended_buckets(double load=1.0) const;
+
+    /// Buckets in the table and buckets sampled.
+    uint64_t buckets;
+    uint64_t sampled;
+
+    /// Of the sampled buckets.
+    uint64_t elements;
+    uint64_t empty;
+    uint64_t maximum;
+
+    /// Sampled bucket count by chain length.
+    std::vector<uint64_t> histogram;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
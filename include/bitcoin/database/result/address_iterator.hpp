@@ -20,10 +20,13 @@
 #define LIBBITCOIN_DATABASE_ADDRESS_ITERATOR_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -35,6 +38,10 @@ public:
     //-------------------------------------------------------------------------
     typedef list_element<const record_manager<array_index>, array_index,
         empty_key> const_element;
+    typedef slab_manager<file_offset> page_manager;
+
+    /// The token of the end iterator.
+    static const uint64_t end_token;
 
     // std::iterator_traits
     //-------------------------------------------------------------------------
@@ -50,7 +57,21 @@ public:
     // Constructors.
     //-------------------------------------------------------------------------
 
-    address_iterator(const const_element& element);
+    /// List rows are prefetched read_ahead rows ahead along the stride of
+    /// the last step (rows of a bulk insert or compaction are contiguous),
+    /// paged rows by prefetching the next page as each page is read.
+    address_iterator(const const_element& element, size_t read_ahead=0);
+
+    /// Iterate the rows of the chained pages from head, of which count are
+    /// populated in the head page (other pages are full). The element is a
+    /// terminator, distinguishing the end of the rows.
+    address_iterator(const const_element& terminator,
+        const page_manager& pages, file_offset head, size_t count,
+        size_t read_ahead);
+
+    /// Resume iteration of chained pages at the position of the token.
+    address_iterator(const const_element& terminator,
+        const page_manager& pages, uint64_t token, size_t read_ahead);
 
     // Operators.
     //-------------------------------------------------------------------------
@@ -62,11 +83,36 @@ public:
     bool operator==(const address_iterator& other) const;
     bool operator!=(const address_iterator& other) const;
 
+    // Positioning.
+    //-------------------------------------------------------------------------
+
+    /// A resumable position of this iterator, which remains valid as rows
+    /// are added to the address (stored rows do not move).
+    uint64_t token() const;
+
+    /// Advance over count rows. Full pages are skipped by their headers,
+    /// without reading their rows (list rows are skipped by their links).
+    void skip(size_t count);
+
 private:
     void populate();
+    void prefetch(array_index previous);
+    void read_page(file_offset page, size_t count);
+    void increment();
 
     const_element element_;
     value_type payment_;
+
+    // List rows prefetched ahead, along the stride of the last step.
+    size_t read_ahead_;
+    int64_t stride_;
+
+    // Paged rows, read a page at a time and iterated newest first.
+    const page_manager* pages_;
+    file_offset page_;
+    file_offset next_;
+    size_t position_;
+    std::vector<value_type> rows_;
 };
 
 } // namespace database
@@ -24,6 +24,7 @@
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/address_iterator.hpp>
 
 namespace libbitcoin {
@@ -37,9 +38,16 @@ public:
     typedef array_index link_type;
     typedef record_manager<link_type> manager;
     typedef list_element<const manager, link_type, key_type> const_value_type;
+    typedef slab_manager<file_offset> page_manager;
 
+    /// Iterators prefetch rows read_ahead rows ahead (zero for none).
     address_result(const const_value_type& element,
-        const system::hash_digest& hash);
+        const system::hash_digest& hash, size_t read_ahead=0);
+
+    /// Construct over paged rows, count is the number in the head page.
+    address_result(const const_value_type& terminator,
+        const page_manager& pages, file_offset head, size_t count,
+        const system::hash_digest& hash, size_t read_ahead=0);
 
     /// True if the requested block exists.
     operator bool() const;
@@ -51,11 +59,24 @@ public:
     address_iterator begin() const;
     address_iterator end() const;
 
+    /// Resume iteration at the token of an iterator of this address.
+    address_iterator begin(uint64_t token) const;
+
+    /// Iterate from the offset (rows from newest), skipping full pages
+    /// without reading their rows, for pagination by offset.
+    address_iterator seek(size_t offset) const;
+
 private:
     system::hash_digest hash_;
 
     // This class is thread safe.
     const_value_type element_;
+
+    // Paged rows (if pages is set).
+    const page_manager* pages_;
+    file_offset head_;
+    size_t count_;
+    size_t read_ahead_;
 };
 
 } // namespace database
@@ -24,8 +24,10 @@
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
+#include <bitcoin/database/primitives/record_field.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/result/transaction_iterator.hpp>
+#include <bitcoin/database/result/transaction_links.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -42,6 +44,26 @@ public:
     typedef list_element<const manager, link_type, key_type>
         const_element_type;
 
+    /// The layout of the stored block, the header followed by metadata.
+    struct layout
+    {
+        // The previous block hash and merkle root follow the version.
+        typedef record_field<0, uint32_t> version;
+        typedef record_field<version::end + 2u * system::hash_size, uint32_t>
+            timestamp;
+        typedef next_field<timestamp, uint32_t> bits;
+        typedef next_field<bits, uint32_t> nonce;
+        typedef next_field<nonce, uint32_t> median_time_past;
+        typedef next_field<median_time_past, uint32_t> height;
+        typedef next_field<height, uint8_t> state;
+        typedef next_field<state, uint32_t> checksum;
+        typedef next_field<checksum, uint32_t> tx_start;
+        typedef next_field<tx_start, uint16_t> tx_count;
+
+        static constexpr size_t header_size = median_time_past::offset;
+        static constexpr size_t size = tx_count::end;
+    };
+
     block_result(const const_element_type& element,
         system::shared_mutex& metadata_mutex, const manager& index_manager);
 
@@ -78,21 +100,30 @@ public:
     /// The state of the block (flags).
     uint8_t state() const;
 
-    /// The full block p2p message checksum (presumed invalid if zero).
+    /// The short id salt of the populated block (zero if unset), the error
+    /// code if the block is invalid.
     uint32_t checksum() const;
 
     /// The number of transactions in this block (may be zero).
     size_t transaction_count() const;
 
+    /// The position of the first transaction link in the transaction index.
+    array_index transaction_start() const;
+
     /// Iterate over the transaction link set.
     transaction_iterator begin() const;
     transaction_iterator end() const;
 
+    /// The transaction link span, read in place under one access.
+    transaction_links links() const;
+
     /// Set metadata onto the given header.
     void set_metadata(const system::chain::header& header) const;
 
 private:
-    system::chain::header header_;
+    uint32_t version_;
+    uint32_t timestamp_;
+    uint32_t bits_;
     uint32_t median_time_past_;
     uint32_t height_;
     uint8_t state_;
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_OUTPUT_VIEW_HPP
+#define LIBBITCOIN_DATABASE_OUTPUT_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A read-only view of a stored output, read in place from the memory map.
+/// Valid only while the transaction view that provided it is in scope.
+/// Spend state is not exposed, as it may be held in the spend column.
+class BCD_API output_view
+{
+public:
+    /// Construct an invalid (not found) view.
+    output_view();
+
+    /// Construct over the stored output at data, of the given index in the
+    /// output offset table (nullptr if not tabled, so never pruned).
+    output_view(uint8_t* data, bool compressed, uint8_t* table,
+        uint32_t index);
+
+    /// True if the view is valid (found).
+    operator bool() const;
+
+    /// The script of the output is stored by template (if standard).
+    bool compressed() const;
+
+    /// The script of the output has been pruned. Bytes read in place may be
+    /// zeroed by a concurrent prune, so check this after reading them.
+    bool pruned() const;
+
+    /// The value of the output.
+    uint64_t value() const;
+
+    /// The stored size of the output.
+    size_t size() const;
+
+    /// The stored output bytes, including spend state.
+    system::data_slice data() const;
+
+    /// The script bytes, without size prefix (as stored if compressed).
+    system::data_slice stored_script() const;
+
+    /// The script, expanded if compressed (empty if pruned).
+    system::chain::script script() const;
+
+    /// The sha256 hash of the script bytes, without size prefix (or
+    /// null_hash if pruned).
+    system::hash_digest script_hash() const;
+
+private:
+    uint8_t* data_;
+    bool compressed_;
+    uint8_t* table_;
+    uint32_t index_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_TRANSACTION_LINKS_HPP
+#define LIBBITCOIN_DATABASE_TRANSACTION_LINKS_HPP
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A read-only view of the contiguous transaction links of a block, read in
+/// place from the memory map of the tx index under one access. The view
+/// holds shared access to the index, which cannot be remapped (grown) until
+/// the view is destroyed, so it must not be held across a block update.
+class BCD_API transaction_links
+  : system::noncopyable
+{
+public:
+    // Definition for constructor type.
+    //-------------------------------------------------------------------------
+    typedef record_manager<array_index> manager;
+
+    /// Construct over the count of links from start.
+    transaction_links(const manager& records, array_index start,
+        size_t count);
+
+    /// Transfer the access, allowing return of the view by value.
+    transaction_links(transaction_links&& other);
+
+    /// The number of links (may be zero).
+    size_t size() const;
+
+    /// The link at the position, which must be less than size.
+    file_offset operator[](size_t position) const;
+
+    /// Copy the links to a list.
+    link_list to_list() const;
+
+private:
+    access_guard memory_;
+    size_t count_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
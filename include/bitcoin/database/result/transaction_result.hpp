@@ -23,9 +23,13 @@
 #include <cstdint>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/striped_sequence.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
+#include <bitcoin/database/primitives/record_field.hpp>
+#include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/primitives/slab_manager.hpp>
 #include <bitcoin/database/result/inpoint_iterator.hpp>
+#include <bitcoin/database/result/transaction_view.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -39,6 +43,21 @@ public:
     typedef slab_manager<link_type> manager;
     typedef list_element<const manager, link_type, key_type>
         const_element_type;
+    typedef record_manager<link_type> spend_manager;
+
+    /// The layout of the metadata prefix of the stored transaction.
+    struct layout
+    {
+        typedef record_field<0, uint32_t> height;
+        typedef next_field<height, uint16_t> position;
+        typedef next_field<position, uint8_t> candidate;
+        typedef next_field<candidate, uint32_t> median_time_past;
+
+        static constexpr size_t size = median_time_past::end;
+    };
+
+    /// The stored size of the spend state of an output in the spend column.
+    static const size_t spend_record_size;
 
     /// This is the store value for candidate true.
     static const uint8_t candidate_true;
@@ -52,8 +71,69 @@ public:
     /// This is unconfirmed tx position sentinel.
     static const uint16_t unconfirmed;
 
+    /// The stored size of the tx, with output scripts optionally compressed
+    /// and witnesses optionally segregated (stored as empty).
+    static size_t stored_size(const system::chain::transaction& tx,
+        bool compressed, bool segregated);
+
+    /// Write the stored tx, with output scripts optionally compressed and
+    /// witnesses optionally segregated (stored as empty).
+    static void write_transaction(byte_serializer& serial,
+        const system::chain::transaction& tx, bool compressed,
+        bool segregated);
+
+    /// The stored size of an output offset table for the number of outputs.
+    static size_t offsets_size(size_t outputs);
+
+    /// Write the output offset table of the tx, which may precede the stored
+    /// tx (following metadata), for direct access to its outputs.
+    /// The spends link is the first spend column record of the outputs.
+    /// Compressed output scripts require the table (as it records them).
+    /// The witnesses link is the slab of segregated witnesses of the inputs.
+    static void write_offsets(byte_serializer& serial,
+        const system::chain::transaction& tx,
+        link_type spends=spend_manager::not_allocated,
+        bool compressed=false, link_type witnesses=manager::not_allocated);
+
+    /// Read past the output offset table, if present, returning its size
+    /// (or zero). Sets offset to the position of the indexed output within
+    /// the stored tx, or of the input count if the index is beyond the
+    /// outputs, or zero if there is no table.
+    static size_t read_offsets(byte_deserializer& deserial, uint32_t index,
+        size_t& offset);
+
+    /// As above, also setting the first spend column record of the outputs,
+    /// or spend_manager::not_allocated if spends are held in the tx, the
+    /// segregated witnesses slab, or manager::not_allocated if witnesses are
+    /// held in the tx, the end of the stored tx (or zero), and if output
+    /// scripts are compressed.
+    static size_t read_offsets(byte_deserializer& deserial, uint32_t index,
+        size_t& offset, link_type& spends, link_type& witnesses, size_t& end,
+        bool& compressed);
+
+    /// Read the output offset table, if present, for pruning the script of
+    /// the indexed output. Sets entry to the position of its table offset,
+    /// and begin and end to the range of its script following the size
+    /// prefix, all relative to the table. False if there is no table, the
+    /// index is beyond the outputs, or the script is already pruned.
+    static bool read_prunable(byte_deserializer& deserial, uint32_t index,
+        size_t& entry, size_t& begin, size_t& end);
+
+    /// True if the script of the indexed output is pruned, given the
+    /// deserializer at an output offset table that is present.
+    static bool read_pruned(byte_deserializer table, uint32_t index);
+
+    /// As read_pruned, ordered after preceding reads of the script. A prune
+    /// marks the offset before zeroing the script, so a script read and then
+    /// found unmarked was not zeroed.
+    static bool reread_pruned(byte_deserializer table, uint32_t index);
+
+    /// Mark the table offset of a pruned output (table entry position).
+    static void write_pruned(uint8_t* entry);
+
     transaction_result(const const_element_type& element,
-        system::shared_mutex& metadata_mutex);
+        const striped_sequence& metadata_sequence, const spend_manager& spends,
+        const manager& witnesses);
 
     /// True if this transaction result is valid (found).
     operator bool() const;
@@ -83,16 +163,38 @@ public:
     ////bool is_confirmed_spent(size_t fork_height) const;
 
     /// The output at the specified index within this transaction.
+    /// The script of a pruned output is empty.
     system::chain::output output(uint32_t index) const;
 
     /// The transaction, optionally including witness.
+    /// The scripts of pruned outputs are empty.
     system::chain::transaction transaction(bool witness=true) const;
 
+    /// A view of the stored transaction, read in place without allocation.
+    /// The view holds shared access to the file until it is destroyed.
+    transaction_view view() const;
+
+    /// The size of the wire serialization of the tx, optionally including
+    /// witness, or zero if an output script has been pruned.
+    size_t serialized_size(bool witness=true) const;
+
+    /// Write the wire serialization of the tx to the buffer, which must be
+    /// of serialized_size, copying from the stored record (without chain
+    /// objects). False if an output script has been pruned.
+    bool to_data(uint8_t* buffer, bool witness=true) const;
+
     /// Iterate over the input set.
     inpoint_iterator begin() const;
     inpoint_iterator end() const;
 
 private:
+    // Write (or size if buffer is null) the wire serialization.
+    size_t write(uint8_t* buffer, bool witness) const;
+
+    // Overlay the output with its spend state from the spend column.
+    void read_spend(link_type spends, uint32_t index,
+        system::chain::output& output) const;
+
     bool candidate_;
     uint32_t height_;
     uint16_t position_;
@@ -101,8 +203,12 @@ private:
     // This class is thread safe.
     const const_element_type element_;
 
-    // Metadata values are kept consistent by mutex.
-    system::shared_mutex& metadata_mutex_;
+    // Metadata values are kept consistent by sequence (of the link).
+    const striped_sequence& metadata_sequence_;
+
+    // These are thread safe.
+    const spend_manager& spends_;
+    const manager& witnesses_;
 };
 
 } // namespace database
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_TRANSACTION_VIEW_HPP
+#define LIBBITCOIN_DATABASE_TRANSACTION_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_guard.hpp>
+#include <bitcoin/database/primitives/list_element.hpp>
+#include <bitcoin/database/primitives/slab_manager.hpp>
+#include <bitcoin/database/result/output_view.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// A read-only view of a stored transaction, read in place from the memory
+/// map without materializing chain objects. The view holds shared access to
+/// the file, which cannot be remapped (grown) until the view is destroyed,
+/// so it must not be held across a write by the same thread.
+/// Metadata and spend state are read by the transaction result.
+class BCD_API transaction_view
+  : system::noncopyable
+{
+public:
+    // Definition for constructor type (avoids circular reference).
+    //-------------------------------------------------------------------------
+    typedef slab_manager<file_offset> manager;
+    typedef list_element<const manager, file_offset, system::hash_digest>
+        const_element;
+
+    /// Construct over the stored transaction of the (found) element.
+    transaction_view(const const_element& element);
+
+    /// Transfer the access, allowing return of the view by value.
+    transaction_view(transaction_view&& other);
+
+    /// The number of outputs.
+    size_t outputs() const;
+
+    /// The output at the index, or an invalid view if out of range.
+    /// Access is direct when the tx is stored with an offset table.
+    output_view output(uint32_t index) const;
+
+    /// The stored transaction bytes (store serialization, without metadata
+    /// or any offset table, and witnesses excluded if segregated).
+    system::data_slice data() const;
+
+private:
+    uint8_t* output_position(uint32_t index) const;
+
+    access_guard memory_;
+    uint8_t* table_;
+    uint8_t* transaction_;
+    size_t outputs_;
+    size_t end_;
+    bool compressed_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
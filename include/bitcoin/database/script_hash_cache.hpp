@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_SCRIPT_HASH_CACHE_HPP
+#define LIBBITCOIN_DATABASE_SCRIPT_HASH_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// This class is thread safe.
+/// A direct mapped cache of the script hashes of recently cataloged outputs,
+/// held in memory, so that an input spending one of them is cataloged without
+/// hashing its prevout script. A newer output replaces any in its slot.
+class BCD_API script_hash_cache
+  : system::noncopyable
+{
+public:
+    /// Construct a cache of the number of slots (zero disables the cache).
+    script_hash_cache(size_t capacity);
+
+    /// The capacity is zero, so no script hash is recorded.
+    bool disabled() const;
+
+    /// The number of slots.
+    size_t capacity() const;
+
+    /// The number of queries that found a recorded script hash.
+    size_t hits() const;
+
+    /// Record the script hash of the output at the point.
+    void insert(const system::chain::point& point,
+        const system::hash_digest& script_hash);
+
+    /// Obtain the recorded script hash of the output at the point.
+    bool find(system::hash_digest& out_script_hash,
+        const system::chain::point& point) const;
+
+    /// Remove all script hashes.
+    void clear();
+
+private:
+    struct entry
+    {
+        system::hash_digest hash;
+        uint32_t index;
+        system::hash_digest script_hash;
+    };
+
+    size_t slot(const system::chain::point& point) const;
+
+    // This is thread safe.
+    mutable std::atomic<size_t> hits_;
+
+    // These are protected by mutex.
+    const size_t capacity_;
+    std::vector<entry> slots_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -21,7 +21,10 @@
 
 #include <cstdint>
 #include <boost/filesystem.hpp>
+#include <bitcoin/database/cache_policy.hpp>
 #include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/access_advice.hpp>
+#include <bitcoin/database/memory/memory_placement.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -33,14 +36,64 @@ public:
     settings();
     settings(system::config::settings context);
 
+    /// Derive bucket counts, minimum file sizes and the growth rate from the
+    /// expected chain size, and the output cache budget from memory (zero
+    /// for no limit). Minimum sizes are scaled down to half of the disk.
+    /// Context defaults are not auto sized, as the bucket counts of an
+    /// existing store must match, so this applies only to a new store.
+    void auto_size(uint64_t blocks, uint64_t transactions, uint64_t memory=0,
+        uint64_t disk=0);
+
     /// Properties.
     boost::filesystem::path directory;
     bool flush_writes;
+    uint32_t flush_latency;
+    bool flush_log;
+    uint64_t flush_log_size;
+    uint64_t dirty_bytes_budget;
+    bool read_only;
+    uint32_t change_feed_size;
     uint32_t cache_capacity;
+    uint32_t write_threads;
+    uint32_t prefetch_threads;
     uint16_t file_growth_rate;
+    uint64_t file_reservation_size;
+    uint64_t file_populate_size;
+    uint64_t file_allocation_extent;
     uint32_t block_table_buckets;
     uint32_t transaction_table_buckets;
     uint32_t address_table_buckets;
+    bool block_table_huge_pages;
+    bool transaction_table_huge_pages;
+    bool address_table_huge_pages;
+    bool block_resident_headers;
+    bool block_time_index;
+    bool block_candidate_states;
+    bool transaction_table_fingerprints;
+    bool address_table_paged;
+    bool address_table_deferred;
+    uint32_t address_table_lag;
+    uint32_t address_script_hashes;
+    uint32_t address_read_ahead;
+    bool address_table_lazy;
+    uint64_t transaction_filter_size;
+    uint32_t transaction_output_offsets;
+    bool transaction_spend_column;
+    bool transaction_script_compression;
+    bool transaction_segregated_witnesses;
+    bool transaction_undo;
+    uint32_t transaction_prune_depth;
+    uint64_t cache_bytes;
+    bool cache_granular;
+    cache_policy cache_eviction;
+    bool cache_persist;
+    uint32_t cache_misses;
+    uint32_t utxo_table_buckets;
+    uint64_t utxo_table_size;
+    uint32_t filter_table_buckets;
+    uint64_t filter_table_size;
+    uint32_t balance_table_buckets;
+    uint64_t balance_table_size;
     uint64_t block_table_size;
     uint64_t candidate_index_size;
     uint64_t confirmed_index_size;
@@ -48,6 +101,23 @@ public:
     uint64_t transaction_table_size;
     uint64_t address_index_size;
     uint64_t address_table_size;
+    access_advice block_table_advice;
+    access_advice candidate_index_advice;
+    access_advice confirmed_index_advice;
+    access_advice transaction_index_advice;
+    access_advice transaction_table_advice;
+    access_advice address_index_advice;
+    access_advice address_table_advice;
+    bool block_table_prefault;
+    bool block_index_prefault;
+    bool transaction_buckets_prefault;
+    bool prefault_pin;
+    memory_placement block_table_placement;
+    memory_placement transaction_table_placement;
+    memory_placement address_table_placement;
+    uint64_t block_table_nodes;
+    uint64_t transaction_table_nodes;
+    uint64_t address_table_nodes;
 };
 
 } // namespace database
@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_SIP_HASH_HPP
+#define LIBBITCOIN_DATABASE_SIP_HASH_HPP
+
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+/// SipHash-2-4 of the data with the 128 bit key (k0, k1), as keyed by the
+/// BIP152 short ids of txs and the BIP158 hashes of filter elements.
+BCD_API uint64_t sip_hash(uint64_t k0, uint64_t k1,
+    const system::data_slice& data);
+
+/// Read the (k0, k1) key from the leading 16 bytes of the hash.
+BCD_API void sip_hash_key(uint64_t& out_k0, uint64_t& out_k1,
+    const system::hash_digest& hash);
+
+} // namespace database
+} // namespace libbitcoin
+
+#endif
@@ -19,7 +19,12 @@
 #ifndef LIBBITCOIN_DATABASE_STORE_HPP
 #define LIBBITCOIN_DATABASE_STORE_HPP
 
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
@@ -39,15 +44,59 @@ public:
     static const std::string BLOCK_TABLE;
     static const std::string CANDIDATE_INDEX;
     static const std::string CONFIRMED_INDEX;
+    static const std::string BLOCK_TIMES;
     static const std::string TRANSACTION_INDEX;
     static const std::string TRANSACTION_TABLE;
     static const std::string ADDRESS_TABLE;
     static const std::string ADDRESS_ROWS;
+    static const std::string TRANSACTION_FILTER;
+    static const std::string TRANSACTION_CACHE;
+    static const std::string ADDRESS_PROGRESS;
+    static const std::string WRITE_AHEAD_LOG;
+    static const std::string TRANSACTION_SPENDS;
+    static const std::string TRANSACTION_WITNESSES;
+    static const std::string UTXO_TABLE;
+    static const std::string FILTER_TABLE;
+    static const std::string BALANCE_TABLE;
+    static const std::string TRANSACTION_UNDO;
+    static const std::string TRANSACTION_UNDO_INDEX;
+
+    /// The optional files and behaviors of the store, each disabled by
+    /// default.
+    struct BCD_API options
+    {
+        options();
+
+        /// The spend column and witnesses files of the transaction table.
+        bool spends;
+        bool witnesses;
+
+        /// The unspent output, filter and balance index files.
+        bool utxos;
+        bool filters;
+        bool balances;
+
+        /// The undo record files of confirmed blocks.
+        bool undo;
+
+        /// The times file of the confirmed index.
+        bool times;
+
+        /// Writers flushed each write that end within the flush latency (in
+        /// milliseconds) of a pending commit share its flush (zero for none).
+        uint32_t flush_latency;
+
+        /// A read only store takes neither the exclusive nor the flush lock,
+        /// so it may be opened by any number of processes alongside its
+        /// writer.
+        bool read_only;
+    };
 
     // Construct.
     // ------------------------------------------------------------------------
 
-    store(const path& prefix, bool with_indexes, bool flush_each_write=false);
+    store(const path& prefix, bool with_indexes, bool flush_each_write=false,
+        const options& features=options());
 
     // Open and close.
     // ------------------------------------------------------------------------
@@ -55,6 +104,9 @@ public:
     /// Create database files.
     virtual bool create();
 
+    /// Create the index files (of an existing store without them).
+    virtual bool create_indexes();
+
     /// Acquire exclusive access.
     virtual bool open();
 
@@ -68,11 +120,16 @@ public:
     virtual bool begin_write() const;
 
     /// End sequence write with optional flush unlock.
+    /// With a flush latency this joins the pending commit (or leads a new
+    /// one) and returns once a flush that follows the write is complete.
     virtual bool end_write() const;
 
     /// True if write flushing is enabled.
     virtual bool flush_each_write() const;
 
+    /// True if opened for reads only (writes fail to begin).
+    virtual bool read_only() const;
+
     // File names.
     // ------------------------------------------------------------------------
 
@@ -83,21 +140,62 @@ public:
     const path transaction_index;
     const path transaction_table;
 
+    /// Optional content (spend column and witnesses of transaction table).
+    const path transaction_spends;
+    const path transaction_witnesses;
+
     /// Optional indexes.
     const path address_table;
     const path address_rows;
+    const path utxo_table;
+    const path filter_table;
+    const path balance_table;
+
+    /// Optional undo records (prevout spends of confirmed blocks).
+    const path transaction_undo;
+    const path transaction_undo_index;
+
+    /// Optional times of the confirmed index.
+    const path block_times;
+
+    /// Optional sidecars (not created with the store).
+    const path transaction_filter;
+    const path transaction_cache;
+    const path address_progress;
+    const path write_ahead_log;
 
 protected:
     // The implementation must flush all data to disk here.
     virtual bool flush() const = 0;
 
-
 private:
+    bool begin_group_write() const;
+    bool end_group_write() const;
     const path prefix_;
     const bool with_indexes_;
     const bool flush_each_write_;
+    const bool with_spends_;
+    const bool with_witnesses_;
+    const bool with_utxos_;
+    const bool with_undo_;
+    const bool with_filters_;
+    const bool with_times_;
+    const bool with_balances_;
+    const bool read_only_;
     mutable system::flush_lock flush_lock_;
     mutable system::interprocess_lock exclusive_lock_;
+
+    // Group commit, these are protected by commit_mutex_.
+    const std::chrono::milliseconds flush_latency_;
+    mutable bool locked_;
+    mutable bool committing_;
+    mutable bool failed_;
+    mutable size_t writers_;
+    mutable size_t joined_;
+    mutable uint64_t ticket_;
+    mutable uint64_t committed_;
+    mutable std::mutex commit_mutex_;
+    mutable std::condition_variable commit_condition_;
 };
 
 } // namespace database
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_DATABASE_TRACEPOINTS_HPP
+#define LIBBITCOIN_DATABASE_TRACEPOINTS_HPP
+
+// Static (USDT) tracepoints of the libbitcoin_database provider, compiled in
+// when WITH_TRACEPOINTS is defined (--enable-tracepoints), and otherwise not
+// compiled. An unattached probe is a nop instruction with its arguments left
+// in registers, so probes may be placed on hot paths. Arguments are integers
+// or pointers (such as a file name, read by bpftrace with str).
+#ifdef WITH_TRACEPOINTS
+    #include <sys/sdt.h>
+
+    #define BCD_TRACE(name) \
+        DTRACE_PROBE(libbitcoin_database, name)
+    #define BCD_TRACE1(name, a) \
+        DTRACE_PROBE1(libbitcoin_database, name, a)
+    #define BCD_TRACE2(name, a, b) \
+        DTRACE_PROBE2(libbitcoin_database, name, a, b)
+    #define BCD_TRACE3(name, a, b, c) \
+        DTRACE_PROBE3(libbitcoin_database, name, a, b, c)
+
+    // Fire name__entry, and name__return on any exit of the enclosing scope.
+    #define BCD_TRACE_SCOPE(name) \
+        BCD_TRACE(name##__entry); \
+        const auto name##_trace_return_ = []() \
+        { \
+            BCD_TRACE(name##__return); \
+        }; \
+        const libbitcoin::database::trace_scope< \
+            decltype(name##_trace_return_)> name##_trace_scope_( \
+                name##_trace_return_)
+
+namespace libbitcoin {
+namespace database {
+
+/// Invokes the handler on destruct, to fire the return probe of a scope.
+template <typename Handler>
+class trace_scope
+{
+public:
+    trace_scope(const Handler& handler)
+      : handler_(handler)
+    {
+    }
+
+    ~trace_scope()
+    {
+        handler_();
+    }
+
+private:
+    const Handler& handler_;
+};
+
+} // namespace database
+} // namespace libbitcoin
+
+#else
+    #define BCD_TRACE(name)
+    #define BCD_TRACE1(name, a)
+    #define BCD_TRACE2(name, a, b)
+    #define BCD_TRACE3(name, a, b, c)
+    #define BCD_TRACE_SCOPE(name)
+#endif
+
+#endif
@@ -22,10 +22,13 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <boost/bimap.hpp>
 #include <boost/bimap/set_of.hpp>
 #include <boost/bimap/unordered_set_of.hpp>
+#include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/cache_policy.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/unspent_transaction.hpp>
 
@@ -33,13 +36,28 @@ namespace libbitcoin {
 namespace database {
 
 /// This class is thread safe.
-/// A circular-by-age hash table of [point, output].
+/// A circular-by-age hash table of [point, output], split into shards by tx
+/// hash. Each shard is independently locked and aged, with an equal share of
+/// the capacity and byte budget, so the oldest entries of a shard are evicted
+/// when either is reached. A granular cache holds each output as an entry of
+/// its own, so outputs are aged and evicted individually and capacity counts
+/// outputs, keeping the unspent outputs of large txs without their siblings.
+/// Under the clock policy an entry hit since it was last passed over is
+/// promoted to newest in place of eviction.
 class BCD_API unspent_outputs
   : system::noncopyable
 {
 public:
-    // Construct a cache with the specified transaction count limit.
-    unspent_outputs(size_t capacity);
+    typedef boost::filesystem::path path;
+
+    static const size_t default_shards;
+
+    // Construct a cache with the specified transaction count limit and
+    // approximate memory budget (zero is unbudgeted), with shards limited to
+    // the capacity.
+    unspent_outputs(size_t capacity, size_t bytes=0,
+        size_t shards=default_shards, bool granular=false,
+        cache_policy policy=cache_policy::fifo);
 
     /// The cache capacity is zero.
     bool disabled() const;
@@ -50,19 +68,62 @@ public:
     /// The number of elements in the cache.
     size_t size() const;
 
+    /// The approximate memory of the cached entries and their outputs.
+    size_t bytes() const;
+
     /// The cache performance as a ratio of hits to accesses.
     float hit_rate() const;
 
-    /// Add outputs to cache, unconfirmed height is forks (purges matching tx).
+    /// The number of entries evicted to make room for others.
+    size_t evictions() const;
+
+    /// The number of entries promoted in place of eviction (clock policy).
+    size_t promotions() const;
+
+    /// The eviction policy of the cache.
+    cache_policy policy() const;
+
+    /// The number of independently locked shards.
+    size_t shards() const;
+
+    /// Add outputs to cache, unconfirmed height is forks (cached tx retained).
     void add(const system::chain::transaction& tx, size_t height,
         uint32_t median_time_past, bool confirmed);
 
+    /// Add the outputs of a stored tx, those of an output not retained by the
+    /// store are unspent, as above (cached tx retained).
+    void add(const system::hash_digest& tx_hash,
+        const unspent_transaction::output_map& outputs, size_t height,
+        uint32_t median_time_past, bool coinbase, bool confirmed);
+
+    /// Promote cached outputs of the pooled tx to confirmed, in place.
+    /// False if no output of the tx is cached (add the confirmed tx).
+    bool promote(const system::chain::transaction& tx, size_t height,
+        uint32_t median_time_past);
+
     /// Remove outputs from the cache (tx has been reorganized out).
+    void remove(const system::chain::transaction& tx);
+
+    /// Remove outputs from the cache, ungranular only (as above).
     void remove(const system::hash_digest& tx_hash);
 
     /// Remove one output from the cache (has been confirmed spent).
     void remove(const system::chain::output_point& point);
 
+    /// Empty the cache.
+    void clear();
+
+    /// Save the entries to a sidecar file, oldest first within each shard,
+    /// tagged with the state of the store and confirmed top height.
+    bool save(const path& filename, uint64_t tag, size_t height) const;
+
+    /// Load entries saved for the same tag, height and granularity, as with
+    /// add (false and cleared on any mismatch or read failure).
+    bool load(const path& filename, uint64_t tag, size_t height);
+
+    /// True if the output is cached (not counted as a query).
+    bool contains(const system::chain::output_point& point) const;
+
     /// Populate output if cached/unspent relative to fork height.
     bool populate(const system::chain::output_point& point,
         size_t fork_height=max_size_t) const;
@@ -74,15 +135,38 @@ private:
         boost::bimaps::unordered_set_of<unspent_transaction>,
         boost::bimaps::set_of<uint32_t>> unspent_transactions;
 
+    // A shard of the cache, selected by tx hash.
+    struct shard
+    {
+        shard();
+
+        // These are thread safe.
+        mutable std::atomic<size_t> hits;
+        mutable std::atomic<size_t> queries;
+        std::atomic<size_t> evictions;
+        std::atomic<size_t> promotions;
+
+        // These are protected by mutex.
+        uint32_t sequence;
+        size_t bytes;
+        unspent_transactions unspent;
+        mutable system::upgrade_mutex mutex;
+    };
+
+    void insert(shard& part, unspent_transaction&& entry);
+    shard& select(const system::hash_digest& tx_hash) const;
+    unspent_transaction make_key(
+        const system::chain::output_point& point) const;
+
     // These are thread safe.
+    const bool granular_;
+    const cache_policy policy_;
     const size_t capacity_;
-    mutable std::atomic<size_t> hits_;
-    mutable std::atomic<size_t> queries_;
-
-    // These are protected by mutex.
-    uint32_t sequence_;
-    unspent_transactions unspent_;
-    mutable system::upgrade_mutex mutex_;
+    const size_t bytes_;
+    const size_t shards_;
+    const size_t shard_capacity_;
+    const size_t shard_bytes_;
+    const std::unique_ptr<shard[]> shard_;
 };
 
 } // namespace database
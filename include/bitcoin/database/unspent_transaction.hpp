@@ -19,11 +19,12 @@
 #ifndef LIBBITCOIN_DATABASE_UNSPENT_TRANSACTION_HPP
 #define LIBBITCOIN_DATABASE_UNSPENT_TRANSACTION_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
-#include <boost/functional/hash_fwd.hpp>
+#include <boost/functional/hash.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/define.hpp>
 
@@ -37,6 +38,9 @@ public:
     typedef std::unordered_map<uint32_t, system::chain::output> output_map;
     typedef std::shared_ptr<output_map> output_map_ptr;
 
+    /// The index of an entry of all outputs of the tx.
+    static const uint32_t all_outputs;
+
     // Move/copy constructors.
     unspent_transaction(unspent_transaction&& other);
     unspent_transaction(const unspent_transaction& other);
@@ -47,16 +51,46 @@ public:
     explicit unspent_transaction(const system::chain::transaction& tx,
         size_t height, uint32_t median_time_past, bool confirmed);
 
+    /// Constructors of a single output entry, identified by its point.
+    unspent_transaction(const system::hash_digest& hash, uint32_t index);
+    unspent_transaction(const system::chain::transaction& tx, uint32_t index,
+        size_t height, uint32_t median_time_past, bool confirmed);
+
+    /// Constructor of an entry of outputs read from the store, the index is
+    /// that of its single output, or all_outputs.
+    unspent_transaction(const system::hash_digest& hash, uint32_t index,
+        const output_map& outputs, size_t height, uint32_t median_time_past,
+        bool coinbase, bool confirmed);
+
     /// Properties.
     size_t height() const;
     uint32_t median_time_past() const;
     bool is_coinbase() const;
     bool is_confirmed() const;
     const system::hash_digest& hash() const;
+    uint32_t index() const;
+
+    /// The approximate heap memory of the entry, including its outputs.
+    size_t footprint() const;
+
+    /// The approximate heap memory of one output of an entry.
+    static size_t footprint(const system::chain::output& output);
 
     /// Access to outputs is mutable and unprotected (not thread safe).
     output_map_ptr outputs() const;
 
+    /// Promote the entry to confirmed at the height (not thread safe).
+    void confirm(size_t height, uint32_t median_time_past) const;
+
+    /// The entry has been hit since last cleared (thread safe).
+    bool referenced() const;
+    void set_referenced(bool value) const;
+
+    /// Serialization of the entry and its outputs (not thread safe).
+    bool from_data(system::reader& source);
+    void to_data(system::writer& sink) const;
+    size_t serialized_size() const;
+
     /// Operators.
     bool operator==(const unspent_transaction& other) const;
     unspent_transaction& operator=(unspent_transaction&& other);
@@ -64,16 +98,21 @@ public:
 
 private:
 
-    // These are thread safe (non-const only for assignment operator).
-    size_t height_;
-    uint32_t median_time_past_;
+    // These are thread safe (non-const only for assignment operator), except
+    // the mutable confirmation state, which is promoted in place.
+    mutable size_t height_;
+    mutable uint32_t median_time_past_;
     bool is_coinbase_;
-    bool is_confirmed_;
+    mutable bool is_confirmed_;
     system::hash_digest hash_;
+    uint32_t index_;
 
     // This is not thread safe and is publicly reachable.
     // The outputs can be changed without affecting the bimapping.
     mutable output_map_ptr outputs_;
+
+    // This is thread safe, and also does not affect the bimapping.
+    mutable std::atomic<bool> referenced_;
 };
 
 } // namespace database
@@ -91,7 +130,9 @@ struct hash<bc::database::unspent_transaction>
 {
     size_t operator()(const bc::database::unspent_transaction& unspent) const
     {
-        return boost::hash<bc::system::hash_digest>()(unspent.hash());
+        auto seed = boost::hash<bc::system::hash_digest>()(unspent.hash());
+        boost::hash_combine(seed, unspent.index());
+        return seed;
     }
 };
 
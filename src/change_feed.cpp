@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/change_feed.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+static constexpr auto last_operation =
+    change_feed::operation::catalog_transaction;
+
+bool change_feed::change::from_data(change& out, const data_chunk& data)
+{
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    out.sequence = deserial.read_8_bytes_little_endian();
+    const auto type = deserial.read_byte();
+    const auto size = deserial.read_size_little_endian();
+    out.data = deserial.read_bytes(size);
+
+    if (!deserial || !deserial.is_exhausted() ||
+        type > static_cast<uint8_t>(last_operation))
+        return false;
+
+    out.type = static_cast<operation>(type);
+    return true;
+}
+
+data_chunk change_feed::change::to_data() const
+{
+    data_chunk out(sizeof(uint64_t) + sizeof(uint8_t) +
+        variable_uint_size(data.size()) + data.size());
+
+    auto serial = make_unsafe_serializer(out.begin());
+    serial.write_8_bytes_little_endian(sequence);
+    serial.write_byte(static_cast<uint8_t>(type));
+    serial.write_size_little_endian(data.size());
+    serial.write_bytes(data);
+    return out;
+}
+
+change_feed::change_feed(size_t capacity)
+  : capacity_(capacity), sequence_(0)
+{
+}
+
+void change_feed::publish(operation type, data_chunk&& data)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (capacity_ == 0)
+        return;
+
+    if (changes_.size() == capacity_)
+        changes_.pop_front();
+
+    changes_.push_back({ ++sequence_, type, std::move(data) });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool change_feed::read(list& out, uint64_t after, size_t limit) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (after > sequence_)
+        return false;
+
+    // The oldest retained change must follow the sequence (if any remain).
+    const auto first = sequence_ - changes_.size() + 1u;
+    if (after + 1u < first)
+        return false;
+
+    const auto begin = changes_.begin() + (after + 1u - first);
+    for (auto it = begin; it != changes_.end() && limit > 0; ++it, --limit)
+        out.push_back(*it);
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+uint64_t change_feed::sequence() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return sequence_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/compact_filter.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/sip_hash.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// Filter: [ count:varint ][ golomb-rice coded deltas, most significant bit
+// first, zero padded to a byte ]. Each element hashes (siphash-2-4 keyed by
+// the first 16 bytes of the block hash) to [0, count * m), and the sorted
+// values are coded as deltas, quotient (delta >> p) in unary and remainder
+// in p bits.
+const uint8_t compact_filter::basic_p = 19;
+const uint64_t compact_filter::basic_m = 784931;
+
+static constexpr uint8_t op_return = 0x6a;
+
+// The high 64 bits of the 128 bit product.
+static uint64_t multiply_high(uint64_t left, uint64_t right)
+{
+    const auto left_low = left & max_uint32;
+    const auto left_high = left >> 32;
+    const auto right_low = right & max_uint32;
+    const auto right_high = right >> 32;
+
+    const auto low_low = left_low * right_low;
+    const auto low_high = left_low * right_high;
+    const auto high_low = left_high * right_low;
+    const auto high_high = left_high * right_high;
+
+    const auto middle = (low_low >> 32) + (low_high & max_uint32) +
+        (high_low & max_uint32);
+
+    return high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+}
+
+// The element is mapped uniformly to [0, range) without division.
+static uint64_t hash_to_range(const hash_digest& block_hash,
+    const data_chunk& element, uint64_t range)
+{
+    uint64_t k0;
+    uint64_t k1;
+    sip_hash_key(k0, k1, block_hash);
+    return multiply_high(sip_hash(k0, k1, element), range);
+}
+
+static std::vector<uint64_t> hashed_set(const hash_digest& block_hash,
+    const data_stack& elements, uint64_t range)
+{
+    std::vector<uint64_t> values;
+    values.reserve(elements.size());
+
+    for (const auto& element: elements)
+        values.push_back(hash_to_range(block_hash, element, range));
+
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+static bool filtered(const data_chunk& script)
+{
+    return script.empty() || script.front() == op_return;
+}
+
+data_stack compact_filter::elements(const block& block)
+{
+    data_stack out;
+
+    for (const auto& tx: block.transactions())
+    {
+        // The coinbase input has no prevout.
+        if (!tx.is_coinbase())
+        {
+            for (const auto& input: tx.inputs())
+            {
+                const auto& prevout = input.previous_output().metadata.cache;
+                BITCOIN_ASSERT(prevout.is_valid());
+                auto script = prevout.script().to_data(false);
+
+                if (!script.empty())
+                    out.push_back(std::move(script));
+            }
+        }
+
+        for (const auto& output: tx.outputs())
+        {
+            auto script = output.script().to_data(false);
+
+            if (!filtered(script))
+                out.push_back(std::move(script));
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+data_chunk compact_filter::encode(const hash_digest& block_hash,
+    const data_stack& elements)
+{
+    const uint64_t count = elements.size();
+    const auto values = hashed_set(block_hash, elements, count * basic_m);
+
+    data_chunk bits;
+    size_t bit = 0;
+
+    const auto write_bit = [&](bool value)
+    {
+        if (bit % byte_bits == 0)
+            bits.push_back(0);
+
+        if (value)
+            bits.back() |= (0x80 >> (bit % byte_bits));
+
+        ++bit;
+    };
+
+    uint64_t previous = 0;
+
+    for (const auto value: values)
+    {
+        const auto delta = value - previous;
+        previous = value;
+
+        for (auto quotient = delta >> basic_p; quotient != 0; --quotient)
+            write_bit(true);
+
+        write_bit(false);
+
+        for (auto shift = basic_p; shift != 0; --shift)
+            write_bit(((delta >> (shift - 1u)) & 1u) != 0);
+    }
+
+    data_chunk out(variable_uint_size(count) + bits.size());
+    auto serial = make_unsafe_serializer(out.begin());
+    serial.write_size_little_endian(count);
+    serial.write_bytes(bits);
+    return out;
+}
+
+bool compact_filter::match(const data_chunk& filter,
+    const hash_digest& block_hash, const data_chunk& element)
+{
+    auto deserial = make_safe_deserializer(filter.begin(), filter.end());
+    const auto count = deserial.read_size_little_endian();
+
+    if (!deserial || count == 0)
+        return false;
+
+    const auto target = hash_to_range(block_hash, element, count * basic_m);
+    auto bit = variable_uint_size(count) * byte_bits;
+    const auto end = filter.size() * byte_bits;
+
+    const auto read_bit = [&]()
+    {
+        const auto value = (filter[bit / byte_bits] &
+            (0x80 >> (bit % byte_bits))) != 0;
+        ++bit;
+        return value;
+    };
+
+    uint64_t value = 0;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        uint64_t quotient = 0;
+
+        while (bit < end && read_bit())
+            ++quotient;
+
+        if (bit + basic_p > end)
+            return false;
+
+        uint64_t remainder = 0;
+        for (auto shift = basic_p; shift != 0; --shift)
+            remainder = (remainder << 1) | (read_bit() ? 1u : 0u);
+
+        value += (quotient << basic_p) + remainder;
+
+        // The values are sorted, so the target is passed once exceeded.
+        if (value >= target)
+            return value == target;
+    }
+
+    return false;
+}
+
+hash_digest compact_filter::header(const data_chunk& filter,
+    const hash_digest& previous_header)
+{
+    return bitcoin_hash(build_chunk({ bitcoin_hash(filter),
+        previous_header }));
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/compressed_script.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// Stored script:
+// [ template:varint ] (a template below, or size + templates if raw)
+// [ hash:20|32      ] (template) or [ script:size ] (raw)
+enum compressed_template : uint8_t
+{
+    pay_key_hash,
+    pay_script_hash,
+    pay_witness_key_hash,
+    pay_witness_script_hash,
+    templates
+};
+
+static constexpr size_t short_size = 20;
+static constexpr size_t long_size = 32;
+
+// The opcodes surrounding the hash of each template.
+static constexpr uint8_t op_0 = 0x00;
+static constexpr uint8_t op_dup = 0x76;
+static constexpr uint8_t op_hash160 = 0xa9;
+static constexpr uint8_t op_equal = 0x87;
+static constexpr uint8_t op_equalverify = 0x88;
+static constexpr uint8_t op_checksig = 0xac;
+
+static bool is_template(const data_chunk& script, uint8_t& out_template)
+{
+    const auto size = script.size();
+
+    if (size == short_size + 5 && script[0] == op_dup &&
+        script[1] == op_hash160 && script[2] == short_size &&
+        script[23] == op_equalverify && script[24] == op_checksig)
+    {
+        out_template = pay_key_hash;
+        return true;
+    }
+
+    if (size == short_size + 3 && script[0] == op_hash160 &&
+        script[1] == short_size && script[22] == op_equal)
+    {
+        out_template = pay_script_hash;
+        return true;
+    }
+
+    if (size == short_size + 2 && script[0] == op_0 &&
+        script[1] == short_size)
+    {
+        out_template = pay_witness_key_hash;
+        return true;
+    }
+
+    if (size == long_size + 2 && script[0] == op_0 &&
+        script[1] == long_size)
+    {
+        out_template = pay_witness_script_hash;
+        return true;
+    }
+
+    return false;
+}
+
+// The offset of the hash within the script of the template.
+static size_t hash_offset(uint8_t value)
+{
+    return value == pay_key_hash ? 3 : 2;
+}
+
+static size_t hash_size(uint8_t value)
+{
+    return value == pay_witness_script_hash ? long_size : short_size;
+}
+
+size_t compressed_script::size(const data_chunk& script)
+{
+    uint8_t value;
+    if (is_template(script, value))
+        return sizeof(uint8_t) + hash_size(value);
+
+    return variable_uint_size(script.size() + templates) + script.size();
+}
+
+void compressed_script::write(byte_serializer& serial,
+    const data_chunk& script)
+{
+    uint8_t value;
+    if (!is_template(script, value))
+    {
+        serial.write_size_little_endian(script.size() + templates);
+        serial.write_bytes(script.data(), script.size());
+        return;
+    }
+
+    serial.write_byte(value);
+    serial.write_bytes(script.data() + hash_offset(value), hash_size(value));
+}
+
+data_chunk compressed_script::read(byte_deserializer& deserial)
+{
+    const auto value = deserial.read_size_little_endian();
+
+    if (value >= templates)
+        return deserial.read_bytes(value - templates);
+
+    const auto type = static_cast<uint8_t>(value);
+    const auto hash = deserial.read_bytes(hash_size(type));
+    data_chunk script;
+
+    switch (type)
+    {
+        case pay_key_hash:
+            script.reserve(short_size + 5);
+            script.push_back(op_dup);
+            script.push_back(op_hash160);
+            script.push_back(short_size);
+            script.insert(script.end(), hash.begin(), hash.end());
+            script.push_back(op_equalverify);
+            script.push_back(op_checksig);
+            break;
+        case pay_script_hash:
+            script.reserve(short_size + 3);
+            script.push_back(op_hash160);
+            script.push_back(short_size);
+            script.insert(script.end(), hash.begin(), hash.end());
+            script.push_back(op_equal);
+            break;
+        default:
+            script.reserve(hash.size() + 2);
+            script.push_back(op_0);
+            script.push_back(static_cast<uint8_t>(hash.size()));
+            script.insert(script.end(), hash.begin(), hash.end());
+            break;
+    }
+
+    return script;
+}
+
+void compressed_script::skip(byte_deserializer& deserial)
+{
+    const auto value = deserial.read_size_little_endian();
+    deserial.skip(value >= templates ? value - templates :
+        hash_size(static_cast<uint8_t>(value)));
+}
+
+size_t compressed_script::stored_size(byte_deserializer deserial)
+{
+    const auto value = deserial.read_size_little_endian();
+    return variable_uint_size(value) + (value >= templates ? value - templates :
+        hash_size(static_cast<uint8_t>(value)));
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/concurrent.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/processor_affinity.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+void concurrent(threadpool& pool, size_t count, size_t batch,
+    const std::function<void(size_t first, size_t last)>& handler,
+    uint64_t nodes)
+{
+    // Pinning is scoped to each batch, as pool threads are shared.
+    const auto pinned = numa_processors(nodes);
+
+    if (pool.size() == 0 || count <= batch)
+    {
+        const processor_affinity affinity(pinned);
+        handler(0, count);
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable completed;
+    auto pending = (count + batch - 1u) / batch;
+
+    for (size_t first = 0; first < count; first += batch)
+    {
+        const auto last = std::min(first + batch, count);
+
+        pool.service().post([&, first, last]()
+        {
+            const processor_affinity affinity(pinned);
+            handler(first, last);
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (--pending == 0)
+                completed.notify_one();
+            ///////////////////////////////////////////////////////////////////
+        });
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex);
+    completed.wait(lock, [&]() { return pending == 0; });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace database
+} // namespace libbitcoin
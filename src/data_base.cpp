@@ -19,17 +19,26 @@
 #include <bitcoin/database/data_base.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/concurrent.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/result/block_result.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
 #include <bitcoin/database/settings.hpp>
 #include <bitcoin/database/store.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 #include <bitcoin/database/verify.hpp>
 
 namespace libbitcoin {
@@ -44,6 +53,121 @@ using namespace bc::system::wallet;
 
 #define NAME "data_base"
 
+// The number of confirmed blocks gathered before each bulk insert of a build.
+static constexpr size_t build_window = 256;
+
+// The time that a backup waits for the writes in progress to complete.
+static const auto backup_timeout = std::chrono::seconds(60);
+
+// Brackets a write of the confirmations sequence for the scope, so that the
+// sequence is also made even on a failure return (sequence has one stripe).
+class confirmation
+{
+public:
+    confirmation(const striped_sequence& sequence)
+      : sequence_(sequence)
+    {
+        sequence_.begin_write(0);
+    }
+
+    ~confirmation()
+    {
+        sequence_.end_write(0);
+    }
+
+private:
+    const striped_sequence& sequence_;
+};
+
+// Changes are serialized as the arguments of their writer. The blocks, headers
+// and txs that the writer stores are in wire form (with witnesses), those that
+// it reads from the store are referenced by hash.
+static data_chunk to_change(const std::function<void(writer&)>& write)
+{
+    data_chunk out;
+    data_sink ostream(out);
+    ostream_writer sink(ostream);
+    write(sink);
+    ostream.flush();
+    return out;
+}
+
+static data_chunk to_change(const hash_digest& hash, uint64_t value=0)
+{
+    return to_change([&](writer& sink)
+    {
+        sink.write_hash(hash);
+        sink.write_variable_little_endian(value);
+    });
+}
+
+static data_chunk to_change(const block& block, size_t height,
+    uint32_t median_time_past=0)
+{
+    return to_change([&](writer& sink)
+    {
+        sink.write_size_little_endian(height);
+        sink.write_4_bytes_little_endian(median_time_past);
+        block.to_data(sink, true);
+    });
+}
+
+static data_chunk to_change(const transaction& tx, uint32_t forks)
+{
+    return to_change([&](writer& sink)
+    {
+        sink.write_4_bytes_little_endian(forks);
+        tx.to_data(sink, true, true);
+    });
+}
+
+static data_chunk to_change(const config::checkpoint& fork_point,
+    const header_const_ptr_list& headers)
+{
+    return to_change([&](writer& sink)
+    {
+        sink.write_hash(fork_point.hash());
+        sink.write_size_little_endian(fork_point.height());
+        sink.write_size_little_endian(headers.size());
+
+        for (const auto& header: headers)
+        {
+            sink.write_4_bytes_little_endian(
+                header->metadata.median_time_past);
+            header->to_data(sink, true);
+        }
+    });
+}
+
+static data_chunk to_change(const config::checkpoint& fork_point,
+    const block_const_ptr_list& blocks)
+{
+    return to_change([&](writer& sink)
+    {
+        sink.write_hash(fork_point.hash());
+        sink.write_size_little_endian(fork_point.height());
+        sink.write_size_little_endian(blocks.size());
+
+        for (const auto& block: blocks)
+            sink.write_hash(block->hash());
+    });
+}
+
+static store::options to_options(const settings& settings)
+{
+    store::options features;
+    features.spends = settings.transaction_spend_column;
+    features.witnesses = settings.transaction_segregated_witnesses;
+    features.utxos = settings.utxo_table_buckets != 0;
+    features.filters = settings.filter_table_buckets != 0;
+    features.balances = settings.balance_table_buckets != 0;
+    features.undo = settings.transaction_undo;
+    features.times = settings.block_time_index;
+    features.flush_latency = settings.flush_latency;
+    features.read_only = settings.read_only;
+    return features;
+}
+
 // TODO: replace spends with complex query, output gets inpoint:
 // (1) transactions_.get(outpoint, require_confirmed)->spender_height.
 // (2) blocks_.get(spender_height)->transactions().
@@ -61,8 +185,18 @@ using namespace bc::system::wallet;
 data_base::data_base(const settings& settings, bool catalog)
   : closed_(true),
     catalog_(catalog),
+    deferred_(catalog && settings.address_table_deferred),
     settings_(settings),
-    database::store(settings.directory, catalog, settings.flush_writes)
+    pool_(settings.write_threads),
+    cataloging_(false),
+    progress_(0),
+    writing_(0),
+    quiescing_(false),
+    confirmations_(1),
+    feed_(settings.change_feed_size == 0 ? nullptr :
+        std::make_shared<change_feed>(settings.change_feed_size)),
+    database::store(settings.directory, catalog, settings.flush_writes,
+        to_options(settings))
 {
     LOG_DEBUG(LOG_DATABASE)
         << "Buckets: "
@@ -93,17 +227,30 @@ bool data_base::create(const block& genesis)
 
     start();
 
+    if (log_ && !log_->open())
+        return false;
+
     // These leave the databases open.
     auto created = blocks_->create() && transactions_->create();
 
     if (catalog_)
         created &= addresses_->create();
 
+    if (utxos_)
+        created &= utxos_->create();
+
+    if (filters_)
+        created &= filters_->create();
+
+    if (balances_)
+        created &= balances_->create();
+
     created &= push(genesis) == error::success;
 
     if (!created)
         return false;
 
+    load_progress(true);
     closed_ = false;
     return created;
 }
@@ -117,25 +264,271 @@ bool data_base::open()
     if (!store::open())
         return false;
 
+    // Logged writes committed after the last checkpoint are restored.
+    if (!replay())
+        return false;
+
     start();
 
-    auto opened = blocks_->open() && transactions_->open();
+    if (log_ && !log_->open())
+        return false;
 
-    if (catalog_)
-        opened &= addresses_->open();
+    table_tasks tasks
+    {
+        { "block", [this]() { return blocks_->open(); } },
+        { "transaction", [this]() { return transactions_->open(); } }
+    };
+
+    // A lazy address table is not required to open, or to validate blocks.
+    if (catalog_ && settings_.address_table_lazy)
+        address_opening_ = std::async(std::launch::async, [this]()
+        {
+            const auto opened = addresses_->open();
+
+            if (!opened)
+                LOG_ERROR(LOG_DATABASE)
+                    << "Failed to open the address table.";
+
+            return opened;
+        }).share();
+    else if (catalog_)
+        tasks.push_back(
+            { "address", [this]() { return addresses_->open(); } });
+
+    if (utxos_)
+        tasks.push_back(
+            { "utxo", [this]() { return utxos_->open(); } });
+
+    if (filters_)
+        tasks.push_back(
+            { "filter", [this]() { return filters_->open(); } });
+
+    if (balances_)
+        tasks.push_back(
+            { "balance", [this]() { return balances_->open(); } });
+
+    const auto opened = run_tables("Opened", tasks);
 
     if (!opened)
         return false;
 
+    // The saved output cache is discarded if not of the confirmed top.
+    size_t top;
+    if (!read_only() && blocks_->top(top, false))
+        transactions_->load_cache(top);
+
+    load_progress(false);
+
+    // Prefaulting is an optimization, the store remains valid.
+    if (!prefault(settings_))
+        LOG_WARNING(LOG_DATABASE)
+            << "Prefault failed, pinning may exceed the memory lock limit.";
+
     closed_ = false;
+
+    // Deferred indexing resumes from the saved progress.
+    catch_up();
     return opened;
 }
 
+// Reduces the latency of a subsequent flush, and may be called concurrently.
+bool data_base::writeback(bool wait) const
+{
+    auto written = blocks_->writeback(wait) && transactions_->writeback(wait);
+
+    if (catalog_ && addresses_ready())
+        written &= addresses_->writeback(wait);
+
+    if (utxos_)
+        written &= utxos_->writeback(wait);
+
+    if (filters_)
+        written &= filters_->writeback(wait);
+
+    if (balances_)
+        written &= balances_->writeback(wait);
+
+    return written;
+}
+
+// Allows access advice to change at runtime, such as after initial sync.
+bool data_base::advise(const settings& settings)
+{
+    auto advised =
+        blocks_->advise(
+            settings.block_table_advice,
+            settings.candidate_index_advice,
+            settings.confirmed_index_advice,
+            settings.transaction_index_advice) &&
+        transactions_->advise(settings.transaction_table_advice);
+
+    if (catalog_ && addresses_opened())
+        advised &= addresses_->advise(
+            settings.address_table_advice,
+            settings.address_index_advice);
+
+    return advised;
+}
+
+// Placement applies to the tables with batch workers, which are pinned to it.
+bool data_base::place(const settings& settings)
+{
+    auto placed =
+        blocks_->place(
+            settings.block_table_placement,
+            settings.block_table_nodes) &&
+        transactions_->place(
+            settings.transaction_table_placement,
+            settings.transaction_table_nodes);
+
+    if (catalog_ && addresses_opened())
+        placed &= addresses_->place(
+            settings.address_table_placement,
+            settings.address_table_nodes);
+
+    return placed;
+}
+
+// Warms the databases concurrently, as each is bound by its own disk reads.
+bool data_base::prefault(const settings& settings)
+{
+    const auto blocks = settings.block_table_prefault ||
+        settings.block_index_prefault;
+    const auto transactions = settings.transaction_buckets_prefault;
+
+    if (!blocks && !transactions)
+        return true;
+
+    const auto start = asio::steady_clock::now();
+    const auto pin = settings.prefault_pin;
+
+    LOG_INFO(LOG_DATABASE)
+        << "Prefaulting database...";
+
+    auto block_warming = std::async(std::launch::async, [&]()
+    {
+        return !blocks || blocks_->prefault(settings.block_table_prefault,
+            settings.block_index_prefault, pin);
+    });
+
+    auto transaction_warming = std::async(std::launch::async, [&]()
+    {
+        return !transactions || transactions_->prefault(pin);
+    });
+
+    // Both are joined before either result is evaluated.
+    const auto prefaulted = block_warming.get();
+    const auto result = transaction_warming.get() && prefaulted;
+
+    const auto elapsed = asio::steady_clock::now() - start;
+    LOG_INFO(LOG_DATABASE)
+        << "Prefaulted database in "
+        << std::chrono::duration_cast<asio::milliseconds>(elapsed).count()
+        << " ms.";
+
+    return result;
+}
+
+storage_counters data_base::table_counters::total() const
+{
+    auto out = block_table;
+    out += candidate_index;
+    out += confirmed_index;
+    out += transaction_index;
+    out += transaction_table;
+    out += address_table;
+    out += address_index;
+    out += utxo_table;
+    out += filter_table;
+    out += balance_table;
+    return out;
+}
+
+// Each histogram is read independently, so they are not a snapshot.
+data_base::operation_latencies data_base::latencies() const
+{
+    operation_latencies out;
+    out.push = push_latency_.read();
+    out.reorganize = reorganize_latency_.read();
+    out.confirm = confirm_latency_.read();
+    out.update = update_latency_.read();
+    out.candidate = candidate_latency_.read();
+    out.catalog = catalog_latency_.read();
+    out.store = store_latency_.read();
+    out.get_output = transactions_->output_latencies();
+    return out;
+}
+
+// Counters are read from each file independently, so are not a snapshot.
+data_base::table_counters data_base::counters() const
+{
+    table_counters out;
+    blocks_->counters(out.block_table, out.candidate_index,
+        out.confirmed_index, out.transaction_index);
+    out.transaction_table = transactions_->counters();
+
+    if (catalog_ && addresses_ready())
+        addresses_->counters(out.address_table, out.address_index);
+
+    if (utxos_)
+        out.utxo_table = utxos_->counters();
+
+    if (filters_)
+        out.filter_table = filters_->counters();
+
+    if (balances_)
+        out.balance_table = balances_->counters();
+
+    return out;
+}
+
+storage_residency data_base::table_residency::total() const
+{
+    auto out = block_table;
+    out += candidate_index;
+    out += confirmed_index;
+    out += transaction_index;
+    out += transaction_table;
+    out += address_table;
+    out += address_index;
+    out += utxo_table;
+    out += filter_table;
+    out += balance_table;
+    return out;
+}
+
+// Each file is read independently, so the footprint is not a snapshot.
+data_base::table_residency data_base::residency() const
+{
+    table_residency out;
+    blocks_->residency(out.block_table, out.candidate_index,
+        out.confirmed_index, out.transaction_index);
+    out.transaction_table = transactions_->residency();
+    out.output_cache = transactions_->cache_bytes();
+
+    if (catalog_ && addresses_ready())
+        addresses_->residency(out.address_table, out.address_index);
+
+    if (utxos_)
+        out.utxo_table = utxos_->residency();
+
+    if (filters_)
+        out.filter_table = filters_->residency();
+
+    if (balances_)
+        out.balance_table = balances_->residency();
+
+    return out;
+}
+
 // TODO: simplify interface by passing settings reference to databases.
 
 // protected
 void data_base::start()
 {
+    // Values held in memory would not follow the writer of a read-only store.
+    const auto writer = !read_only();
+
     blocks_ = std::make_shared<block_database>(
         block_table,
         candidate_index,
@@ -146,14 +539,68 @@ void data_base::start()
         settings_.confirmed_index_size,
         settings_.transaction_index_size,
         settings_.block_table_buckets,
-        settings_.file_growth_rate);
+        settings_.file_growth_rate,
+        settings_.block_table_huge_pages,
+        settings_.file_reservation_size,
+        settings_.file_populate_size,
+        settings_.file_allocation_extent,
+        writer && settings_.block_resident_headers,
+        writer && settings_.block_time_index ? block_times : path(),
+        writer && settings_.block_candidate_states);
+
+    // The unspent table precedes the transactions, which consult it.
+    if (settings_.utxo_table_buckets != 0)
+    {
+        utxos_ = std::make_shared<utxo_database>(
+            utxo_table,
+            settings_.utxo_table_size,
+            settings_.utxo_table_buckets,
+            settings_.file_growth_rate,
+            false,
+            settings_.file_reservation_size,
+            settings_.file_populate_size,
+            settings_.file_allocation_extent);
+    }
+
+    transaction_database::options features;
+    features.huge_pages = settings_.transaction_table_huge_pages;
+    features.reservation = settings_.file_reservation_size;
+    features.populate = settings_.file_populate_size;
+    features.extent = settings_.file_allocation_extent;
+    features.fingerprints = settings_.transaction_table_fingerprints;
+    features.filter_size = writer ? settings_.transaction_filter_size : 0;
+    features.filter_filename = transaction_filter;
+    features.offsets_minimum = settings_.transaction_output_offsets;
+    features.compress_scripts = settings_.transaction_script_compression;
+    features.prune_scripts = settings_.transaction_prune_depth != 0;
+    features.cache_bytes = writer ? settings_.cache_bytes : 0;
+    features.cache_granular = settings_.cache_granular;
+    features.cache_eviction = settings_.cache_eviction;
+    features.utxos = utxos_.get();
+    features.misses = writer ? settings_.cache_misses : 0;
+
+    if (settings_.transaction_spend_column)
+        features.spends_filename = transaction_spends;
+
+    if (settings_.transaction_segregated_witnesses)
+        features.witnesses_filename = transaction_witnesses;
+
+    if (writer && settings_.cache_persist)
+        features.cache_filename = transaction_cache;
+
+    if (settings_.transaction_undo)
+    {
+        features.undo_filename = transaction_undo;
+        features.undo_index_filename = transaction_undo_index;
+    }
 
     transactions_ = std::make_shared<transaction_database>(
         transaction_table,
         settings_.transaction_table_size,
         settings_.transaction_table_buckets,
         settings_.file_growth_rate,
-        settings_.cache_capacity);
+        writer ? settings_.cache_capacity : 0,
+        features);
 
     if (catalog_)
     {
@@ -163,20 +610,174 @@ void data_base::start()
             settings_.address_table_size,
             settings_.address_index_size,
             settings_.address_table_buckets,
-            settings_.file_growth_rate);
+            settings_.file_growth_rate,
+            settings_.address_table_huge_pages,
+            settings_.file_reservation_size,
+            settings_.file_populate_size,
+            settings_.file_allocation_extent,
+            settings_.address_table_paged,
+            settings_.address_script_hashes,
+            settings_.address_read_ahead);
+    }
+
+    if (settings_.filter_table_buckets != 0)
+    {
+        filters_ = std::make_shared<filter_database>(
+            filter_table,
+            settings_.filter_table_size,
+            settings_.filter_table_buckets,
+            settings_.file_growth_rate,
+            false,
+            settings_.file_reservation_size,
+            settings_.file_populate_size,
+            settings_.file_allocation_extent);
+    }
+
+    if (settings_.balance_table_buckets != 0)
+    {
+        balances_ = std::make_shared<balance_database>(
+            balance_table,
+            settings_.balance_table_size,
+            settings_.balance_table_buckets,
+            settings_.file_growth_rate,
+            false,
+            settings_.file_reservation_size,
+            settings_.file_populate_size,
+            settings_.file_allocation_extent);
     }
+
+    if (!writer)
+    {
+        blocks_->set_read_only();
+        transactions_->set_read_only();
+
+        if (catalog_)
+            addresses_->set_read_only();
+
+        if (utxos_)
+            utxos_->set_read_only();
+
+        if (filters_)
+            filters_->set_read_only();
+
+        if (balances_)
+            balances_->set_read_only();
+    }
+
+    // The logged files are enrolled before the log and files are opened.
+    if (logged())
+    {
+        log_ = std::make_shared<write_log>(write_ahead_log);
+        blocks_->attach(*log_);
+        transactions_->attach(*log_);
+    }
+
+    // Retained by the closed files and applied as each is opened.
+    advise(settings_);
+    place(settings_);
+
+    // Joined at close, so respawned for each open.
+    prefetch_pool_.spawn(settings_.prefetch_threads);
+
+    if (deferred_)
+        catalog_pool_.spawn(1);
+
+    ingest_pool_.spawn(1);
 }
 
 // protected
 void data_base::commit()
 {
-    if (catalog_)
+    // Address writers wait for a lazy open, so there is none before it.
+    if (catalog_ && addresses_ready())
         addresses_->commit();
 
+    if (utxos_)
+        utxos_->commit();
+
+    if (filters_)
+        filters_->commit();
+
+    if (balances_)
+        balances_->commit();
+
     transactions_->commit();
     blocks_->commit();
 }
 
+// protected
+// A write is held while a backup is pending, unless it is nested within a
+// write of the same thread (catalog within push), which the backup drains.
+bool data_base::begin_write() const
+{
+    const auto thread = std::this_thread::get_id();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(quiesce_mutex_);
+        quiesced_.wait(lock, [&]()
+        {
+            return !quiescing_ || nesting_.count(thread) != 0;
+        });
+
+        ++nesting_[thread];
+        ++writing_;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (store::begin_write())
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(quiesce_mutex_);
+
+        if (--nesting_[thread] == 0)
+            nesting_.erase(thread);
+
+        --writing_;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    quiesced_.notify_all();
+    return false;
+}
+
+// protected
+// Against the dirty bytes budget a writer initiates write back of the tables
+// once half of the budget is unwritten, and waits on it once all of it is, so
+// that dirty pages do not accumulate into a write back storm of the kernel.
+bool data_base::end_write() const
+{
+    auto ended = store::end_write();
+    const auto budget = settings_.dirty_bytes_budget;
+
+    if (ended && budget != 0)
+    {
+        const auto unwritten = counters().total().unwritten;
+        ended = unwritten < budget / 2u || writeback(unwritten >= budget);
+    }
+
+    const auto thread = std::this_thread::get_id();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        std::unique_lock<std::mutex> lock(quiesce_mutex_);
+
+        if (--nesting_[thread] == 0)
+            nesting_.erase(thread);
+
+        --writing_;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    quiesced_.notify_all();
+    return ended;
+}
+
 // protected
 bool data_base::flush() const
 {
@@ -187,10 +788,40 @@ bool data_base::flush() const
     ////if (closed_)
     ////    return true;
 
-    auto flushed = blocks_->flush() && transactions_->flush();
+    table_tasks tasks
+    {
+        { "block", [this]() { return blocks_->flush(); } },
+        { "transaction", [this]() { return transactions_->flush(); } }
+    };
 
-    if (catalog_)
-        flushed &= addresses_->flush();
+    if (catalog_ && addresses_ready())
+        tasks.push_back(
+            { "address", [this]() { return addresses_->flush(); } });
+
+    if (utxos_)
+        tasks.push_back(
+            { "utxo", [this]() { return utxos_->flush(); } });
+
+    if (filters_)
+        tasks.push_back(
+            { "filter", [this]() { return filters_->flush(); } });
+
+    if (balances_)
+        tasks.push_back(
+            { "balance", [this]() { return balances_->flush(); } });
+
+    auto flushed = run_tables("Flushed", tasks);
+
+    if (deferred_)
+        flushed &= save_progress();
+
+    // Logged writes are durable once committed, after the other writes are
+    // flushed, and the log is checkpointed once it reaches its size limit.
+    // Each table flush has synced every range written since its last flush,
+    // appends included, so the commit marker follows the writes it covers.
+    if (log_)
+        flushed = flushed && log_->commit() &&
+            (log_->size() < settings_.flush_log_size || checkpoint());
 
     LOG_DEBUG(LOG_DATABASE)
         << "Write flushed to disk: "
@@ -208,10 +839,58 @@ bool data_base::close()
 
     closed_ = true;
 
-    auto closed = blocks_->close() && transactions_->close();
+    // Pending prefetches complete before the tables close.
+    prefetch_pool_.shutdown();
+    prefetch_pool_.join();
 
+    // A block being cataloged completes, and the stage then stops.
+    catalog_pool_.shutdown();
+    catalog_pool_.join();
+
+    // An ingest completes before close (the caller waits on it).
+    ingest_pool_.shutdown();
+    ingest_pool_.join();
+
+    // The output cache is saved for the confirmed top before tables close.
+    size_t top;
+    if (!read_only() && blocks_->top(top, false))
+        transactions_->save_cache(top);
+
+    table_tasks tasks
+    {
+        { "block", [this]() { return blocks_->close(); } },
+        { "transaction", [this]() { return transactions_->close(); } }
+    };
+
+    // A lazy open completes before close (close is the same if it failed).
     if (catalog_)
-        closed &= addresses_->close();
+    {
+        addresses_opened();
+        address_opening_ = std::shared_future<bool>();
+        tasks.push_back(
+            { "address", [this]() { return addresses_->close(); } });
+    }
+
+    if (utxos_)
+        tasks.push_back(
+            { "utxo", [this]() { return utxos_->close(); } });
+
+    if (filters_)
+        tasks.push_back(
+            { "filter", [this]() { return filters_->close(); } });
+
+    if (balances_)
+        tasks.push_back(
+            { "balance", [this]() { return balances_->close(); } });
+
+    auto closed = run_tables("Closed", tasks);
+
+    if (deferred_ && !read_only())
+        closed &= save_progress();
+
+    // The closed files are synced in full, so the log is then redundant.
+    if (log_)
+        closed = closed && log_->reset() && log_->close();
 
     return closed && store::close();
     // Unlock exclusive file access and conditionally the global flush lock.
@@ -236,64 +915,276 @@ const transaction_database& data_base::transactions() const
 // Invalid if indexes not initialized.
 const address_database& data_base::addresses() const
 {
+    addresses_opened();
     return *addresses_;
 }
 
-// Public writers.
-// ----------------------------------------------------------------------------
+bool data_base::addresses_ready() const
+{
+    return !address_opening_.valid() || address_opening_.wait_for(
+        asio::seconds(0)) == std::future_status::ready;
+}
 
-code data_base::catalog(const transaction& tx)
+const filter_database& data_base::filters() const
 {
-    code ec;
+    return *filters_;
+}
 
-    // Existence check prevents duplicated indexing.
-    if (!catalog_ || tx.metadata.existed)
-        return ec;
+const balance_database& data_base::balances() const
+{
+    return *balances_;
+}
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    conditional_lock lock(flush_each_write());
+const change_feed& data_base::changes() const
+{
+    return *feed_;
+}
 
-    if ((ec = verify_exists(*transactions_, tx)))
-        return ec;
+bool data_base::cataloged(size_t& out_height) const
+{
+    if (!catalog_)
+        return false;
 
-    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-    if (!begin_write())
-        return error::store_lock_failure;
+    if (!deferred_)
+        return blocks_->top(out_height, false);
 
-    addresses_->catalog(tx);
-    addresses_->commit();
+    const size_t next = progress_;
 
-    return end_write() ? error::success : error::store_lock_failure;
-    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-    ///////////////////////////////////////////////////////////////////////////
+    if (next == 0)
+        return false;
+
+    out_height = next - 1u;
+    return true;
 }
 
-code data_base::catalog(const block& block)
+bool data_base::block_data(data_chunk& out, const block_result& block,
+    bool witness) const
 {
-    code ec;
-    if (!catalog_)
-        return ec;
+    if (!block || block.transaction_count() == 0)
+        return false;
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    conditional_lock lock(flush_each_write());
+    std::vector<transaction_result> txs;
+    std::vector<size_t> sizes;
+    txs.reserve(block.transaction_count());
+    sizes.reserve(block.transaction_count());
+    auto size = chain::header::satoshi_fixed_size() +
+        variable_uint_size(block.transaction_count());
 
-    const auto start = asio::steady_clock::now();
-    if ((ec = verify_exists(*blocks_, block.header())))
-        return ec;
+    const auto links = block.links();
+    transactions_->prefetch(links);
 
-    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-    if (!begin_write())
-        return error::store_lock_failure;
+    // Size all txs before writing, as a tx with pruned scripts fails.
+    for (size_t index = 0; index < links.size(); ++index)
+    {
+        txs.push_back(transactions_->get(links[index]));
+        sizes.push_back(txs.back() ? txs.back().serialized_size(witness) : 0);
 
-    // Existence check prevents duplicated indexing.
-    for (const auto& tx: block.transactions())
-        if (!tx.metadata.existed)
-            addresses_->catalog(tx);
+        if (sizes.back() == 0)
+            return false;
 
+        size += sizes.back();
+    }
+
+    out.resize(size);
+    auto serial = make_unsafe_serializer(out.data());
+    block.header().to_data(serial);
+    serial.write_size_little_endian(txs.size());
+    auto position = out.data() + chain::header::satoshi_fixed_size() +
+        variable_uint_size(txs.size());
+
+    for (size_t tx = 0; tx < txs.size(); ++tx)
+    {
+        if (!txs[tx].to_data(position, witness))
+            return false;
+
+        position += sizes[tx];
+    }
+
+    return true;
+}
+
+// The top is read within the sequence, so a reader that overlaps no write
+// of confirmations reads the tables as of that top.
+bool data_base::snapshot(const snapshot_reader& reader) const
+{
+    size_t top;
+
+    while (true)
+    {
+        const auto sequence = confirmations_.begin_read(0);
+
+        if (!blocks_->top(top, false))
+            return false;
+
+        reader(top);
+
+        if (confirmations_.end_read(0, sequence))
+            return true;
+    }
+}
+
+// Referenced tables are refreshed first, so that a height within the tops
+// resolves to a block and txs within the refreshed maps, other than those
+// committed during the refresh (which are within any reservation).
+bool data_base::refresh()
+{
+    if (!read_only())
+        return true;
+
+    auto refreshed = transactions_->refresh();
+
+    if (catalog_ && addresses_opened())
+        refreshed &= addresses_->refresh();
+
+    if (utxos_)
+        refreshed &= utxos_->refresh();
+
+    if (filters_)
+        refreshed &= filters_->refresh();
+
+    if (balances_)
+        refreshed &= balances_->refresh();
+
+    return refreshed && blocks_->refresh();
+}
+
+// Public writers.
+// ----------------------------------------------------------------------------
+
+code data_base::catalog(const transaction& tx)
+{
+    BCD_TRACE_SCOPE(catalog);
+
+    code ec;
+
+    // Existence check prevents duplicated indexing.
+    if (!catalog_ || deferred_ || tx.metadata.existed)
+        return ec;
+
+    const latency_histogram::timer timer(catalog_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    conditional_lock lock(flush_each_write());
+
+    if ((ec = verify_exists(*transactions_, tx)))
+        return ec;
+
+    if (!addresses_opened())
+        return error::operation_failed;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    addresses_->catalog(tx);
     addresses_->commit();
 
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::catalog_transaction,
+            to_change(tx.hash()));
+
+    return error::success;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The rank of a row is the height of its tx, unconfirmed txs are newest.
+code data_base::compact(const hash_list& hashes)
+{
+    BCD_TRACE_SCOPE(compact);
+
+    static const auto unconfirmed = transaction_result::unconfirmed;
+
+    if (!catalog_)
+        return error::operation_failed;
+
+    const auto rank = [&](const payment_record& row)
+    {
+        const auto result = transactions_->get(row.link());
+        return !result || result.position() == unconfirmed ? max_size_t :
+            result.height();
+    };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    conditional_lock lock(flush_each_write());
+
+    if (!addresses_opened())
+        return error::operation_failed;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    for (const auto& hash: hashes)
+        addresses_->compact(hash, rank);
+
+    addresses_->commit();
+    return end_write() ? error::success : error::store_lock_failure;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code data_base::catalog(const block& block)
+{
+    BCD_TRACE_SCOPE(catalog);
+
+    const auto ec = catalog_block(block);
+
+    if (!ec && feed_)
+        feed_->publish(change_feed::operation::catalog_block,
+            to_change(block.hash()));
+
+    return ec;
+}
+
+// private
+// Not published to the change feed, as when cataloged by the push writer.
+code data_base::catalog_block(const block& block)
+{
+    code ec;
+    const auto addresses = catalog_ && !deferred_;
+
+    if (!addresses && !filters_)
+        return ec;
+
+    const latency_histogram::timer timer(catalog_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    conditional_lock lock(flush_each_write());
+
+    const auto start = asio::steady_clock::now();
+    if ((ec = verify_exists(*blocks_, block.header())))
+        return ec;
+
+    if (addresses && !addresses_opened())
+        return error::operation_failed;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    // Existence check prevents duplicated indexing.
+    if (addresses)
+    {
+        addresses_->catalog(block, pool_);
+        addresses_->commit();
+    }
+
+    // The prevout scripts of the block are populated for the filter.
+    if (filters_)
+    {
+        if (!filters_->store(block))
+            return error::operation_failed;
+
+        filters_->commit();
+    }
+
     block.metadata.catalog = asio::steady_clock::now() - start;
     return end_write() ? error::success : error::store_lock_failure;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
@@ -302,7 +1193,10 @@ code data_base::catalog(const block& block)
 
 code data_base::store(const transaction& tx, uint32_t forks)
 {
+    BCD_TRACE_SCOPE(store);
+
     code ec;
+    const latency_histogram::timer timer(store_latency_);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
@@ -324,7 +1218,14 @@ code data_base::store(const transaction& tx, uint32_t forks)
 
     transactions_->commit();
 
-    return end_write() ? error::success : error::store_lock_failure;
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::store,
+            to_change(tx, forks));
+
+    return error::success;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -333,6 +1234,8 @@ code data_base::reorganize(const config::checkpoint& fork_point,
     header_const_ptr_list_const_ptr incoming,
     header_const_ptr_list_ptr outgoing)
 {
+    BCD_TRACE_SCOPE(reorganize);
+
     if (fork_point.height() > max_size_t - incoming->size())
         return error::operation_failed;
 
@@ -340,38 +1243,110 @@ code data_base::reorganize(const config::checkpoint& fork_point,
         pop_above(outgoing, fork_point) &&
         push_all(incoming, fork_point);
 
-    return result ? error::success : error::operation_failed;
+    if (!result)
+        return error::operation_failed;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::reorganize_headers,
+            to_change(fork_point, *incoming));
+
+    return error::success;
 }
 
 code data_base::confirm(const hash_digest& block_hash, size_t height)
 {
+    BCD_TRACE_SCOPE(confirm);
+
     code ec;
+    const latency_histogram::timer timer(confirm_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    conditional_lock lock(flush_each_write());
 
     if ((ec = verify_confirm(*blocks_, block_hash, height)))
         return error::operation_failed;
 
     const auto block = blocks().get(block_hash);
     const auto time = block.median_time_past();
-    size_t position = 0;
+    link_list links;
+
+    // The links are read under one access, and their records prefetched.
+    {
+        const auto span = block.links();
+        transactions_->prefetch(span);
+        links = span.to_list();
+    }
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    // Snapshot reads overlapping the confirmation are repeated.
+    const confirmation writing(confirmations_);
 
     // Mark block txs as confirmed without reading transactions.
-    for (const auto tx_offset: block)
-        if (!transactions_->confirm(tx_offset, height, time, position++))
+    if (!transactions_->confirm(links, height, time))
+        return error::operation_failed;
+
+    // The unspent and balance tables require the transactions of the block.
+    if (utxos_ || balances_)
+    {
+        const chain::block full{ block.header(), to_transactions(block) };
+
+        if (utxos_ && !utxos_->confirm(full, height, time))
             return error::operation_failed;
 
-    // TODO: optimize using link.
+        // Prevouts of the stored block are read from the tx table.
+        if (balances_ && !balances_->confirm(full, height, *transactions_))
+            return error::operation_failed;
+    }
+
     // Promote block to confirmed.
-    if (!blocks_->promote(block_hash, height, false))
+    if (!blocks_->promote(block.link(), height, false))
+        return error::operation_failed;
+
+    // Discard scripts spent by the block now at the prune depth.
+    if (!prune(height))
         return error::operation_failed;
 
+    commit();
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    catch_up();
+
+    if (feed_)
+        feed_->publish(change_feed::operation::confirm,
+            to_change(block_hash, height));
+
     return error::success;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The job retains the table, so it may outlive a concurrent close.
+void data_base::prefetch(block_const_ptr block)
+{
+    if (closed_)
+        return;
+
+    const auto transactions = transactions_;
+    prefetch_pool_.service().post([transactions, block]()
+    {
+        transactions->prefetch(*block);
+    });
 }
 
 // Add missing transactions for an existing block header.
 // This allows parallel write when write flushing is not enabled.
 code data_base::update(const chain::block& block, size_t height)
 {
+    BCD_TRACE_SCOPE(update);
+
     code ec;
+    const latency_histogram::timer timer(update_latency_);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
@@ -389,7 +1364,7 @@ code data_base::update(const chain::block& block, size_t height)
         return error::store_lock_failure;
 
     // Store the missing transactions and set tx link metadata for all.
-    if (!transactions_->store(block.transactions()))
+    if (!transactions_->store(block.transactions(), pool_))
         return error::operation_failed;
 
     // Update the block's transaction associations (not its state).
@@ -399,7 +1374,15 @@ code data_base::update(const chain::block& block, size_t height)
     commit();
 
     block.metadata.associate = asio::steady_clock::now() - start;
-    return end_write() ? error::success : error::store_lock_failure;
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::update,
+            to_change(block, height));
+
+    return error::success;
     //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
@@ -407,6 +1390,8 @@ code data_base::update(const chain::block& block, size_t height)
 // Promote unvalidated block to valid|invalid based on error value.
 code data_base::invalidate(const header& header, const code& error)
 {
+    BCD_TRACE_SCOPE(invalidate);
+
     code ec;
 
     // Critical Section
@@ -423,146 +1408,875 @@ code data_base::invalidate(const header& header, const code& error)
     if (!blocks_->validate(header.hash(), error))
         return error::operation_failed;
 
-    header.metadata.error = error;
-    header.metadata.validated = true;
+    header.metadata.error = error;
+    header.metadata.validated = true;
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::invalidate,
+            to_change(header.hash(), error.value()));
+
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Mark candidate as valid, and txs and outputs spent by them as candidate.
+code data_base::candidate(const block& block)
+{
+    BCD_TRACE_SCOPE(candidate);
+
+    code ec;
+    const latency_histogram::timer timer(candidate_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    conditional_lock lock(flush_each_write());
+
+    const auto start = asio::steady_clock::now();
+    if ((ec = verify_not_failed(*blocks_, block)))
+        return ec;
+
+    const auto& header = block.header();
+    BITCOIN_ASSERT(!header.metadata.error);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    // Set candidate validation state to valid.
+    if (!blocks_->validate(header.hash(), error::success))
+        return error::operation_failed;
+
+    // Mark candidate block txs and outputs spent by them as candidate.
+    for (const auto& tx: block.transactions())
+        if (!transactions_->candidate(tx.metadata.link))
+            return error::operation_failed;
+
+    header.metadata.error = error::success;
+    header.metadata.validated = true;
+
+    block.metadata.candidate = asio::steady_clock::now() - start;
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::candidate,
+            to_change(block.hash()));
+
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Block N + 1 is updated (txs stored) while block N is marked as candidate
+// and confirmed. Marking depends only on the updates of the block and of its
+// predecessors. Without a flush latency each flushed write would lock the
+// flush file over the other, so the stages then run in sequence.
+code data_base::ingest(const block_const_ptr_list& blocks, size_t height,
+    bool confirmed)
+{
+    BCD_TRACE_SCOPE(ingest);
+
+    const auto count = blocks.size();
+
+    if (height > max_size_t - count)
+        return error::operation_failed;
+
+    const auto marker = [&](size_t index)
+    {
+        const auto& block = *blocks[index];
+        const auto ec = candidate(block);
+
+        return ec || !confirmed ? ec :
+            confirm(block.hash(), height + index);
+    };
+
+    if (closed_ || (flush_each_write() && settings_.flush_latency == 0))
+    {
+        code ec;
+        for (size_t index = 0; !ec && index < count; ++index)
+            if (!(ec = update(*blocks[index], height + index)))
+                ec = marker(index);
+
+        return ec;
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t updated = 0;
+    auto finished = false;
+    auto stopped = false;
+    code update_ec;
+
+    ingest_pool_.service().post([&]()
+    {
+        for (size_t index = 0; index < count; ++index)
+        {
+            const auto ec = update(*blocks[index], height + index);
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            std::unique_lock<std::mutex> lock(mutex);
+            update_ec = ec;
+
+            if (ec || stopped)
+                break;
+
+            ++updated;
+            condition.notify_one();
+            ///////////////////////////////////////////////////////////////////
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished = true;
+        condition.notify_one();
+    });
+
+    code ec;
+    for (size_t index = 0; !ec && index < count; ++index)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]()
+            {
+                return updated > index || finished;
+            });
+
+            if (updated <= index)
+                break;
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        ec = marker(index);
+    }
+
+    // The update stage stops at its next block and is awaited.
+    std::unique_lock<std::mutex> lock(mutex);
+    stopped = true;
+    condition.wait(lock, [&]()
+    {
+        return finished;
+    });
+
+    return ec ? ec : update_ec;
+}
+
+// Reorganize blocks.
+// Header metadata median_time_past must be set on all incoming blocks.
+code data_base::reorganize(const config::checkpoint& fork_point,
+    block_const_ptr_list_const_ptr incoming,
+    block_const_ptr_list_ptr outgoing)
+{
+    BCD_TRACE_SCOPE(reorganize);
+
+    if (fork_point.height() > max_size_t - incoming->size())
+        return error::operation_failed;
+
+    const latency_histogram::timer timer(reorganize_latency_);
+
+    const auto result =
+        pop_above(outgoing, fork_point) &&
+        push_all(incoming, fork_point);
+
+    if (!result)
+        return error::operation_failed;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::reorganize_blocks,
+            to_change(fork_point, *incoming));
+
+    return error::success;
+}
+
+// Store, update, validate and confirm the presumed valid block.
+code data_base::push(const block& block, size_t height,
+    uint32_t median_time_past)
+{
+    BCD_TRACE_SCOPE(push);
+
+    code ec;
+    const latency_histogram::timer timer(push_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    if ((ec = push_confirmed(block, height, median_time_past)))
+        return ec;
+
+    commit();
+    catch_up();
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        feed_->publish(change_feed::operation::push,
+            to_change(block, height, median_time_past));
+
+    return error::success;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The batch shares one write lock, write bracket (flush) and commit, so a
+// failure leaves the blocks pushed before it uncommitted (restore or rebuild).
+code data_base::push(const block_const_ptr_list& blocks, size_t height)
+{
+    BCD_TRACE_SCOPE(push);
+
+    code ec;
+    const auto count = blocks.size();
+
+    if (height > max_size_t - count)
+        return error::operation_failed;
+
+    const latency_histogram::timer timer(push_latency_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return error::store_lock_failure;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto& block = *blocks[index];
+        const auto median_time_past = block.header().metadata.median_time_past;
+
+        if ((ec = push_confirmed(block, height + index, median_time_past)))
+            return ec;
+    }
+
+    commit();
+    catch_up();
+
+    if (!end_write())
+        return error::store_lock_failure;
+
+    if (feed_)
+        for (size_t index = 0; index < count; ++index)
+            feed_->publish(change_feed::operation::push,
+                to_change(*blocks[index], height + index,
+                    blocks[index]->header().metadata.median_time_past));
+
+    return error::success;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Within the write bracket of the caller, which commits.
+code data_base::push_confirmed(const block& block, size_t height,
+    uint32_t median_time_past)
+{
+    code ec;
+
+    // Store the header, retaining its link for the writers that follow.
+    const auto link = blocks_->store(block.header(), height,
+        median_time_past);
+
+    // Push header reference onto the candidate index and set candidate state.
+    if (!blocks_->promote(link, height, true))
+        return error::operation_failed;
+
+    // Store any missing txs as unconfirmed, set tx link metadata for all.
+    if (!transactions_->store(block.transactions(), pool_))
+        return error::operation_failed;
+
+    // Populate transaction references from link metadata.
+    if (!blocks_->update(link, block))
+        return error::operation_failed;
+
+    const confirmation writing(confirmations_);
+
+    // Confirm all transactions (candidate state transition not requried).
+    if (!transactions_->confirm(block, height, median_time_past))
+        return error::operation_failed;
+
+    // Spend the prevouts and add the outputs of the block (unspent table).
+    if (utxos_ && !utxos_->confirm(block, height, median_time_past))
+        return error::operation_failed;
+
+    // Add the payments of the block to the confirmed balances.
+    if (balances_ && !balances_->confirm(block, height, *transactions_))
+        return error::operation_failed;
+
+    // Promote validation state to valid (presumed valid).
+    if (!blocks_->validate(link, error::success))
+        return error::operation_failed;
+
+    if ((ec = catalog_block(block)))
+        return ec;
+
+    // Push header reference onto the confirmed index and set confirmed state.
+    if (!blocks_->promote(link, height, false))
+        return error::operation_failed;
+
+    // Discard scripts spent by the block now at the prune depth.
+    return prune(height) ? error::success : error::operation_failed;
+}
+
+// Rebuild.
+// ----------------------------------------------------------------------------
+
+// Not idempotent, the address files must not exist.
+bool data_base::build_addresses()
+{
+    if (!catalog_)
+        return false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Lock exclusive file access and conditionally the global flush lock.
+    if (!store::open())
+        return false;
+
+    // Create the address files.
+    if (!create_indexes() || !replay())
+        return false;
+
+    start();
+
+    if (log_ && !log_->open())
+        return false;
+
+    // This leaves the databases open.
+    auto opened = blocks_->open() && transactions_->open() &&
+        addresses_->create();
+
+    if (utxos_)
+        opened &= utxos_->open();
+
+    if (filters_)
+        opened &= filters_->open();
+
+    if (balances_)
+        opened &= balances_->open();
+
+    size_t top;
+    if (!opened || !blocks_->top(top, false))
+        return false;
+
+    closed_ = false;
+    const auto start = asio::steady_clock::now();
+
+    for (size_t first = 0; first <= top; first += build_window)
+    {
+        if (!build_addresses(first, std::min(build_window, top + 1u - first)))
+            return false;
+
+        LOG_INFO(LOG_DATABASE)
+            << "Cataloged blocks through height ["
+            << std::min(first + build_window - 1u, top) << "].";
+    }
+
+    // The deferred stage resumes above the confirmed top.
+    progress_ = top + 1u;
+
+    const auto elapsed = asio::steady_clock::now() - start;
+    LOG_INFO(LOG_DATABASE)
+        << "Built address index in "
+        << std::chrono::duration_cast<asio::seconds>(elapsed).count()
+        << " s.";
+
+    return flush();
+}
+
+bool data_base::defragment()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Lock exclusive file access and conditionally the global flush lock.
+    if (!store::open() || !replay())
+        return false;
+
+    start();
+
+    if (log_ && !log_->open())
+        return false;
+
+    auto opened = blocks_->open() && transactions_->open();
+
+    if (utxos_)
+        opened &= utxos_->open();
+
+    if (filters_)
+        opened &= filters_->open();
+
+    if (balances_)
+        opened &= balances_->open();
+
+    // The address table is not opened, and closes as such.
+    closed_ = false;
+    auto temporary = transaction_table;
+    temporary += "_defragment";
+
+    // The file is created nonzero size (for memory map validation).
+    system::ofstream(temporary.string()).put('x');
+
+    file_storage file(temporary, settings_.transaction_table_size,
+        settings_.file_growth_rate);
+
+    const auto walker = [this](const transaction_database::relinker& relink)
+    {
+        return blocks_->relink(relink);
+    };
+
+    const auto start = asio::steady_clock::now();
+
+    const auto defragmented = opened && file.open() &&
+        transactions_->defragment(file, settings_.transaction_table_buckets,
+            settings_.transaction_table_fingerprints, walker);
+
+    if (defragmented)
+        blocks_->commit();
+
+    if (!file.close() || !close() || !defragmented)
+        return false;
+
+    const auto elapsed = asio::steady_clock::now() - start;
+    LOG_INFO(LOG_DATABASE)
+        << "Defragmented transaction table in "
+        << std::chrono::duration_cast<asio::seconds>(elapsed).count()
+        << " s.";
+
+    boost::system::error_code ec;
+    rename(temporary, transaction_table, ec);
+
+    if (ec)
+        return false;
+
+    // The saved cache and address rows would reference replaced links.
+    for (const auto& stale: { transaction_cache, address_table,
+        address_rows, address_progress })
+    {
+        remove(stale, ec);
+
+        if (ec)
+            return false;
+    }
+
+    return true;
+}
+
+// private
+// Each thread gathers a contiguous range of the window, and the rows are then
+// merged in height order, so the rows of a key remain in height order.
+bool data_base::build_addresses(size_t first, size_t count)
+{
+    std::vector<address_database::key_list> keys(count);
+    std::vector<address_database::payment_list> rows(count);
+    std::atomic<bool> success(true);
+
+    const auto gather = [&](size_t begin, size_t end)
+    {
+        for (auto index = begin; index < end && success; ++index)
+        {
+            const auto height = first + index;
+            const auto result = blocks_->get(height, false);
+
+            if (!result)
+            {
+                success = false;
+                return;
+            }
+
+            const chain::block block{ result.header(),
+                to_transactions(result) };
+
+            // Prevouts are read without the threadpool, which runs this.
+            for (const auto& tx: block.transactions())
+            {
+                if (tx.is_coinbase())
+                    continue;
+
+                for (const auto& input: tx.inputs())
+                {
+                    if (!transactions_->get_output(input.previous_output(),
+                        height))
+                    {
+                        success = false;
+                        return;
+                    }
+                }
+            }
+
+            addresses_->payments(keys[index], rows[index], block);
+        }
+    };
+
+    const auto threads = std::max(pool_.size(), size_t(1));
+    concurrent(pool_, count, (count + threads - 1u) / threads, gather);
+
+    if (!success)
+        return false;
+
+    address_database::key_list merged_keys;
+    address_database::payment_list merged_rows;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        merged_keys.insert(merged_keys.end(), keys[index].begin(),
+            keys[index].end());
+        merged_rows.insert(merged_rows.end(), rows[index].begin(),
+            rows[index].end());
+    }
+
+    addresses_->catalog(merged_keys, merged_rows);
+    addresses_->commit();
+    return true;
+}
+
+// Snapshots.
+// ----------------------------------------------------------------------------
+
+code data_base::export_utxos(const path& filename,
+    hash_digest& out_digest) const
+{
+    size_t height;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    if (!utxos_ || !blocks_->top(height, false))
+        return error::operation_failed;
+
+    const auto result = blocks_->get(height, false);
 
-    return end_write() ? error::success : error::store_lock_failure;
+    if (!result || !utxos_->export_snapshot(filename, height, result.hash(),
+        out_digest))
+        return error::operation_failed;
+
+    return error::success;
     ///////////////////////////////////////////////////////////////////////////
 }
 
-// Mark candidate as valid, and txs and outputs spent by them as candidate.
-code data_base::candidate(const block& block)
+// The blocks to the snapshot height are not required for the import, the
+// node validates forward from the snapshot block once its header is stored.
+code data_base::import_utxos(const path& filename, size_t& out_height,
+    hash_digest& out_block_hash, hash_digest& out_digest)
 {
-    code ec;
+    BCD_TRACE_SCOPE(import_utxos);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    conditional_lock lock(flush_each_write());
-
-    const auto start = asio::steady_clock::now();
-    if ((ec = verify_not_failed(*blocks_, block)))
-        return ec;
+    unique_lock lock(write_mutex_);
 
-    const auto& header = block.header();
-    BITCOIN_ASSERT(!header.metadata.error);
+    // Stored outputs are not replaced, so only an empty table is imported.
+    if (!utxos_ || !utxos_->empty())
+        return error::operation_failed;
 
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
-    // Set candidate validation state to valid.
-    if (!blocks_->validate(header.hash(), error::success))
-        return error::operation_failed;
+    if (!utxos_->import_snapshot(filename, out_height, out_block_hash,
+        out_digest))
+    {
+        // An invalid snapshot stores nothing, so the store remains valid.
+        if (utxos_->empty() && !end_write())
+            return error::store_lock_failure;
 
-    // Mark candidate block txs and outputs spent by them as candidate.
-    for (const auto& tx: block.transactions())
-        if (!transactions_->candidate(tx.metadata.link))
-            return error::operation_failed;
+        return error::operation_failed;
+    }
 
-    header.metadata.error = error::success;
-    header.metadata.validated = true;
+    utxos_->commit();
 
-    block.metadata.candidate = asio::steady_clock::now() - start;
     return end_write() ? error::success : error::store_lock_failure;
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     ///////////////////////////////////////////////////////////////////////////
 }
 
-// Reorganize blocks.
-// Header metadata median_time_past must be set on all incoming blocks.
-code data_base::reorganize(const config::checkpoint& fork_point,
-    block_const_ptr_list_const_ptr incoming,
-    block_const_ptr_list_ptr outgoing)
+// Backup.
+// ----------------------------------------------------------------------------
+
+// A failed write is not ended, so its count remains and the backup times out.
+// The tables and deferral progress are flushed and the log checkpointed before
+// the files are copied, so the log, lock files and saved caches are not.
+code data_base::backup(const path& directory)
 {
-    if (fork_point.height() > max_size_t - incoming->size())
+    if (closed_ || read_only() || !is_directory(directory))
         return error::operation_failed;
 
-    const auto result =
-        pop_above(outgoing, fork_point) &&
-        push_all(incoming, fork_point);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(quiesce_mutex_);
 
-    return result ? error::success : error::operation_failed;
-}
+    if (quiescing_)
+        return error::operation_failed;
 
-// Store, update, validate and confirm the presumed valid block.
-code data_base::push(const block& block, size_t height,
-    uint32_t median_time_past)
-{
-    code ec;
+    quiescing_ = true;
+    const auto drained = quiesced_.wait_for(lock, backup_timeout, [this]()
+    {
+        return writing_ == 0;
+    });
 
-    // Critical Section
+    // The lazy open of the address table is not a write.
+    auto copied = drained && addresses_opened() && flush() &&
+        (!log_ || checkpoint());
+
+    for (const auto& file:
+    {
+        block_table, candidate_index, confirmed_index, transaction_index,
+        transaction_table, transaction_spends, transaction_witnesses,
+        address_table, address_rows, utxo_table, filter_table, balance_table,
+        transaction_undo, transaction_undo_index, block_times,
+        address_progress
+    })
+    {
+        if (!copied)
+            break;
+
+        if (exists(file))
+            copied = file_storage::copy(file, directory / file.filename());
+    }
+
+    quiescing_ = false;
+    lock.unlock();
     ///////////////////////////////////////////////////////////////////////////
-    unique_lock lock(write_mutex_);
 
-    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
-    if (!begin_write())
-        return error::store_lock_failure;
+    quiesced_.notify_all();
+    return copied ? error::success : error::operation_failed;
+}
 
-    // Store the header.
-    blocks_->store(block.header(), height, median_time_past);
+// Replication.
+// ----------------------------------------------------------------------------
 
-    // Push header reference onto the candidate index and set candidate state.
-    if (!blocks_->promote(block.hash(), height, true))
-        return error::operation_failed;
+// A tx of the store change may be stored by an update of the leader that it
+// overlapped, and is then a duplicate. Payments are cataloged from prevouts
+// read from the follower store, as by a build.
+code data_base::apply(const change_feed::change& change)
+{
+    BCD_TRACE_SCOPE(apply);
 
-    // Store any missing txs as unconfirmed, set tx link metadata for all.
-    if (!transactions_->store(block.transactions()))
-        return error::operation_failed;
+    typedef change_feed::operation operation;
+    const auto& data = change.data;
+    auto source = make_safe_deserializer(data.begin(), data.end());
 
-    // Populate transaction references from link metadata.
-    if (!blocks_->update(block))
-        return error::operation_failed;
+    switch (change.type)
+    {
+        case operation::push:
+        case operation::update:
+        {
+            const auto height = source.read_size_little_endian();
+            const auto median_time_past = source.read_4_bytes_little_endian();
+            chain::block block;
+
+            if (!block.from_data(source, true) || !source.is_exhausted())
+                return error::operation_failed;
+
+            return change.type == operation::push ?
+                push(block, height, median_time_past) :
+                update(block, height);
+        }
+
+        case operation::reorganize_headers:
+        {
+            const auto hash = source.read_hash();
+            const config::checkpoint fork_point(hash,
+                source.read_size_little_endian());
+            const auto count = source.read_size_little_endian();
+            const auto incoming = std::make_shared<header_const_ptr_list>();
+
+            for (size_t index = 0; source && index < count; ++index)
+            {
+                chain::header header;
+                const auto median_time_past =
+                    source.read_4_bytes_little_endian();
+
+                if (!header.from_data(source, true))
+                    return error::operation_failed;
+
+                const auto next = std::make_shared<message::header>(
+                    std::move(header));
+                next->metadata.median_time_past = median_time_past;
+                next->metadata.exists = blocks_->get(next->hash());
+                incoming->push_back(next);
+            }
+
+            if (!source || !source.is_exhausted())
+                return error::operation_failed;
+
+            return reorganize(fork_point, incoming,
+                std::make_shared<header_const_ptr_list>());
+        }
+
+        case operation::reorganize_blocks:
+        {
+            const auto hash = source.read_hash();
+            const config::checkpoint fork_point(hash,
+                source.read_size_little_endian());
+            const auto count = source.read_size_little_endian();
+            const auto incoming = std::make_shared<block_const_ptr_list>();
+
+            for (size_t index = 0; source && index < count; ++index)
+            {
+                chain::block block;
+
+                if (!get_block(block, source.read_hash()))
+                    return error::operation_failed;
+
+                incoming->push_back(
+                    std::make_shared<const message::block>(std::move(block)));
+            }
+
+            if (!source || !source.is_exhausted())
+                return error::operation_failed;
+
+            return reorganize(fork_point, incoming,
+                std::make_shared<block_const_ptr_list>());
+        }
+
+        case operation::invalidate:
+        {
+            const auto hash = source.read_hash();
+            const auto value = source.read_variable_little_endian();
+            const auto result = blocks_->get(hash);
+
+            if (!source || !source.is_exhausted() || !result)
+                return error::operation_failed;
+
+            return invalidate(result.header(),
+                static_cast<error::error_code_t>(value));
+        }
+
+        case operation::candidate:
+        case operation::catalog_block:
+        {
+            chain::block block;
+
+            if (!get_block(block, source.read_hash()) ||
+                !source.is_exhausted())
+                return error::operation_failed;
+
+            if (change.type == operation::candidate)
+                return candidate(block);
+
+            const auto height = blocks_->get(block.hash()).height();
+
+            for (const auto& tx: block.transactions())
+                if (!tx.is_coinbase())
+                    for (const auto& input: tx.inputs())
+                        transactions_->get_output(input.previous_output(),
+                            height);
+
+            return catalog(block);
+        }
+
+        case operation::confirm:
+        {
+            const auto hash = source.read_hash();
+            const auto height = source.read_size_little_endian();
+
+            if (!source || !source.is_exhausted())
+                return error::operation_failed;
+
+            return confirm(hash, height);
+        }
+
+        case operation::store:
+        {
+            const auto forks = source.read_4_bytes_little_endian();
+            transaction tx;
 
-    // Confirm all transactions (candidate state transition not requried).
-    if (!transactions_->confirm(block, height, median_time_past))
-        return error::operation_failed;
+            if (!tx.from_data(source, true, true) || !source.is_exhausted())
+                return error::operation_failed;
 
-    // Promote validation state to valid (presumed valid).
-    if (!blocks_->validate(block.hash(), error::success))
-        return error::operation_failed;
+            const auto ec = store(tx, forks);
+            return ec == error::duplicate_transaction ? error::success : ec;
+        }
 
-    if ((ec = catalog(block)))
-        return ec;
+        case operation::catalog_transaction:
+        {
+            const auto result = transactions_->get(source.read_hash());
 
-    // TODO: optimize using link.
-    // Push header reference onto the confirmed index and set confirmed state.
-    if (!blocks_->promote(block.hash(), height, false))
-        return error::operation_failed;
+            if (!source || !source.is_exhausted() || !result)
+                return error::operation_failed;
 
-    commit();
+            // The stored tx is read as existing, which catalog skips.
+            auto tx = result.transaction();
+            tx.metadata.existed = false;
 
-    return end_write() ? error::success : error::store_lock_failure;
-    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-    ///////////////////////////////////////////////////////////////////////////
+            for (const auto& input: tx.inputs())
+                transactions_->get_output(input.previous_output(),
+                    max_size_t);
+
+            return catalog(tx);
+        }
+
+        default:
+            return error::operation_failed;
+    }
 }
 
 // Header reorganization.
 // ----------------------------------------------------------------------------
 // protected
 
+// The headers are stored and indexed in one critical section and resize.
 bool data_base::push_all(header_const_ptr_list_const_ptr headers,
     const config::checkpoint& fork_point)
 {
-    code ec;
     const auto first_height = fork_point.height() + 1;
 
-    // Push all headers onto the fork point.
+    if (headers->empty())
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    if (verify_push(*blocks_, *headers->front(), first_height))
+        return false;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return false;
+
+    hash_list hashes;
+    hashes.reserve(headers->size());
+
     for (size_t index = 0; index < headers->size(); ++index)
     {
         const auto& header = *((*headers)[index]);
-        const auto median_time_past = header.metadata.median_time_past;
-        if ((ec = push_header(header, first_height + index, median_time_past)))
-            return false;
+
+        if (!header.metadata.exists)
+            blocks_->store(header, first_height + index,
+                header.metadata.median_time_past);
+
+        hashes.push_back(header.hash());
     }
 
-    return true;
+    if (!blocks_->promote(hashes, first_height, true))
+        return false;
+
+    blocks_->commit();
+    return end_write();
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
 }
 
+// The headers are unindexed in one critical section and resize.
 bool data_base::pop_above(header_const_ptr_list_ptr headers,
     const config::checkpoint& fork_point)
 {
-    code ec;
     headers->clear();
-    if ((ec = verify(*blocks_, fork_point, true)))
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    if (verify(*blocks_, fork_point, true))
         return false;
 
     size_t top;
@@ -575,17 +2289,38 @@ bool data_base::pop_above(header_const_ptr_list_ptr headers,
     if (depth == 0)
         return true;
 
-    // Pop all headers above the fork point.
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return false;
+
+    // Uncandidate previous outputs spent by txs of the candidate blocks.
     for (size_t height = top; height > fork; --height)
     {
-        const auto next = std::make_shared<message::header>();
-        if ((ec = pop_header(*next, height)))
+        const auto result = blocks_->get(height, true);
+
+        if (!result)
             return false;
 
-        headers->insert(headers->begin(), next);
+        for (const auto link: result)
+            if (!transactions_->uncandidate(link))
+                return false;
+
+        const auto next = std::make_shared<message::header>(result.header());
+        BITCOIN_ASSERT(next->is_valid());
+        headers->push_back(next);
     }
 
-    return true;
+    // The headers are returned in ascending height order.
+    std::reverse(headers->begin(), headers->end());
+
+    // Demote the candidate headers.
+    if (!blocks_->demote(fork, true))
+        return false;
+
+    blocks_->commit();
+    return end_write();
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 // Expects header is next candidate and metadata.exists is populated.
@@ -606,11 +2341,13 @@ code data_base::push_header(const chain::header& header, size_t height,
     if (!begin_write())
         return error::store_lock_failure;
 
-    if (!header.metadata.exists)
-        blocks_->store(header, height, median_time_past);
+    // A new header is promoted by the link of its store, without a lookup.
+    if (header.metadata.exists)
+        blocks_->promote(header.hash(), height, true);
+    else
+        blocks_->promote(blocks_->store(header, height, median_time_past),
+            height, true);
 
-    // TODO: optimize using link.
-    blocks_->promote(header.hash(), height, true);
     blocks_->commit();
 
     return end_write() ? error::success : error::store_lock_failure;
@@ -644,9 +2381,8 @@ code data_base::pop_header(chain::header& out_header, size_t height)
         if (!transactions_->uncandidate(link))
             return error::operation_failed;
 
-    // TODO: optimize using link.
     // Demote the candidate header.
-    if (!blocks_->demote(result.hash(), height, true))
+    if (!blocks_->demote(result.link(), height, true))
         return error::operation_failed;
 
     // Commit everything that was changed and return header.
@@ -724,20 +2460,43 @@ code data_base::push_block(const block& block, size_t height)
     if ((ec = verify_push(*blocks_, block, height)))
         return ec;
 
+    if (deferred_ && height < progress_ && !addresses_opened())
+        return error::operation_failed;
+
     //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
     if (!begin_write())
         return error::store_lock_failure;
 
+    const confirmation writing(confirmations_);
+
     // Confirm txs (and thereby also address indexes), spend prevouts.
     if (!transactions_->confirm(block, height, median_time_past))
         return error::operation_failed;
 
+    // Spend the prevouts and add the outputs of the block (unspent table).
+    if (utxos_ && !utxos_->confirm(block, height, median_time_past))
+        return error::operation_failed;
+
+    // Add the payments of the block to the confirmed balances.
+    if (balances_ && !balances_->confirm(block, height, *transactions_))
+        return error::operation_failed;
+
+    // A block below the deferred progress replaces one of a reorganization,
+    // so its txs that did not exist are cataloged here.
+    if (deferred_ && height < progress_)
+        addresses_->catalog(block, pool_);
+
     // TODO: optimize using link.
     // Confirm candidate block (candidate index unchanged).
     if (!blocks_->promote(block.hash(), height, false))
         return error::operation_failed;
 
+    // Discard scripts spent by the block now at the prune depth.
+    if (!prune(height))
+        return error::operation_failed;
+
     commit();
+    catch_up();
 
     block.metadata.confirm = asio::steady_clock::now() - start;
     return end_write() ? error::success : error::store_lock_failure;
@@ -756,6 +2515,10 @@ code data_base::pop_block(chain::block& out_block, size_t height)
     if ((ec = verify_top(*blocks_, height, false)))
         return ec;
 
+    // Balances of the popped block are restored from the address table.
+    if (balances_ && catalog_ && !addresses_opened())
+        return error::operation_failed;
+
     const auto result = blocks_->get(height, false);
 
     if (!result)
@@ -769,13 +2532,24 @@ code data_base::pop_block(chain::block& out_block, size_t height)
     if (!begin_write())
         return error::store_lock_failure;
 
+    const confirmation writing(confirmations_);
+
     // Deconfirm txs (and thereby also address indexes), unspend prevouts.
-    if (!transactions_->unconfirm(out_block))
+    // The undo record of the block replays its spends without lookups.
+    if (!transactions_->unconfirm(out_block, height))
+        return error::operation_failed;
+
+    // Remove the outputs and restore the prevouts of the block (unspent).
+    if (utxos_ && !utxos_->unconfirm(out_block, *transactions_))
+        return error::operation_failed;
+
+    // Remove the payments of the block from the confirmed balances.
+    if (balances_ && !balances_->unconfirm(out_block, height,
+        *transactions_, addresses_.get()))
         return error::operation_failed;
 
-    // TODO: optimize using link.
     // Demote the confirmed block (candidate index unchanged).
-    if (!blocks_->demote(result.hash(), height, false))
+    if (!blocks_->demote(result.link(), height, false))
         return error::operation_failed;
 
     commit();
@@ -846,10 +2620,12 @@ transaction::list data_base::to_transactions(const block_result& result) const
 {
     transaction::list txs;
     txs.reserve(result.transaction_count());
+    const auto links = result.links();
+    transactions_->prefetch(links);
 
-    for (const auto link: result)
+    for (size_t position = 0; position < links.size(); ++position)
     {
-        const auto tx = transactions_->get(link);
+        const auto tx = transactions_->get(links[position]);
         BITCOIN_ASSERT(tx);
         txs.push_back(tx.transaction());
     }
@@ -857,5 +2633,222 @@ transaction::list data_base::to_transactions(const block_result& result) const
     return txs;
 }
 
+// private
+bool data_base::get_block(block& out, const hash_digest& hash) const
+{
+    const auto result = blocks_->get(hash);
+
+    if (!result)
+        return false;
+
+    out = chain::block{ result.header(), to_transactions(result) };
+    out.header().metadata.median_time_past = result.median_time_past();
+    return true;
+}
+
+// private
+// Confirmed blocks are cataloged through the lag below the confirmed top on
+// the catalog thread. A confirmation while the stage is exiting is caught up
+// at the next. The lag should be less than any prune depth, as the prevout
+// scripts of the block are read from the tx table.
+void data_base::catch_up()
+{
+    if (!deferred_ || read_only() || closed_ || cataloging_.exchange(true))
+        return;
+
+    catalog_pool_.service().post([this]()
+    {
+        const size_t lag = settings_.address_table_lag;
+        size_t top;
+
+        while (!closed_ && blocks_->top(top, false) && progress_ + lag <= top)
+            if (!catalog_confirmed(progress_))
+                break;
+
+        cataloging_ = false;
+    });
+}
+
+// private
+// The block is read and its prevouts populated without the write lock.
+bool data_base::catalog_confirmed(size_t height)
+{
+    const auto result = blocks_->get(height, false);
+
+    if (!result)
+        return false;
+
+    const chain::block block{ result.header(), to_transactions(result) };
+    transactions_->get_outputs(block, height, pool_);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(write_mutex_);
+
+    // A reorganization may have replaced the block since it was read.
+    const auto current = blocks_->get(height, false);
+
+    if (closed_ || !current || current.hash() != result.hash() ||
+        !addresses_opened())
+        return false;
+
+    //vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv
+    if (!begin_write())
+        return false;
+
+    addresses_->catalog(block, pool_);
+    addresses_->commit();
+    progress_ = height + 1u;
+
+    return end_write();
+    //^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Progress is current with the confirmed top if not saved, as for a store
+// indexed before deferral was enabled. A new store has cataloged nothing.
+void data_base::load_progress(bool created)
+{
+    if (!deferred_)
+        return;
+
+    progress_ = 0;
+
+    if (created)
+        return;
+
+    data_chunk buffer(sizeof(uint64_t));
+    ifstream file(address_progress.string(), std::ios::binary);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+    if (file.good())
+    {
+        progress_ = make_unsafe_deserializer(buffer.begin())
+            .read_8_bytes_little_endian();
+        return;
+    }
+
+    size_t top;
+    if (blocks_->top(top, false))
+        progress_ = top + 1u;
+}
+
+// private
+bool data_base::save_progress() const
+{
+    ofstream file(address_progress.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(sizeof(uint64_t));
+    make_unsafe_serializer(buffer.begin()).write_8_bytes_little_endian(
+        progress_);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.flush();
+    return file.good();
+}
+
+// private
+// Pruning trails confirmation by the depth, below which there is no reorg.
+bool data_base::prune(size_t height)
+{
+    const auto depth = settings_.transaction_prune_depth;
+
+    if (depth == 0 || height < depth)
+        return true;
+
+    const auto block = blocks_->get(height - depth, false);
+
+    if (!block)
+        return false;
+
+    link_list links;
+
+    for (const auto tx_offset: block)
+        links.push_back(tx_offset);
+
+    return transactions_->prune(links);
+}
+
+// Table phases.
+// ----------------------------------------------------------------------------
+
+// private
+// Each table is bound by its own files (map, sync, unmap), so the phase runs
+// a thread per table and takes the time of the slowest. The first task runs
+// on the calling thread. All are joined before any result is evaluated.
+bool data_base::run_tables(const std::string& phase,
+    const table_tasks& tasks) const
+{
+    typedef asio::steady_clock::time_point time_point;
+    const auto timed = [](const table_task& task, time_point& finish)
+    {
+        const auto result = task.second();
+        finish = asio::steady_clock::now();
+        return result;
+    };
+
+    if (tasks.empty())
+        return true;
+
+    const auto start = asio::steady_clock::now();
+    std::vector<time_point> finishes(tasks.size());
+    std::vector<std::future<bool>> results;
+    results.reserve(tasks.size() - 1u);
+
+    for (size_t task = 1; task < tasks.size(); ++task)
+        results.push_back(std::async(std::launch::async,
+            std::bind(timed, std::cref(tasks[task]),
+                std::ref(finishes[task]))));
+
+    auto result = timed(tasks.front(), finishes.front());
+
+    for (auto& table: results)
+        result &= table.get();
+
+    for (size_t task = 0; task < tasks.size(); ++task)
+        LOG_DEBUG(LOG_DATABASE)
+            << phase << " " << tasks[task].first << " table in "
+            << std::chrono::duration_cast<asio::microseconds>(
+                finishes[task] - start).count() << " us.";
+
+    return result;
+}
+
+// Lazy open.
+// ----------------------------------------------------------------------------
+
+// private
+bool data_base::addresses_opened() const
+{
+    return !address_opening_.valid() || address_opening_.get();
+}
+
+// Write-ahead log.
+// ----------------------------------------------------------------------------
+
+// private
+// Without flushed writes the maps are synced only when closed.
+bool data_base::logged() const
+{
+    return flush_each_write() && settings_.flush_log && !read_only();
+}
+
+// private
+bool data_base::replay() const
+{
+    return !logged() || write_log::replay(write_ahead_log);
+}
+
+// private
+// Records pending since the commit are not discarded by the reset.
+bool data_base::checkpoint() const
+{
+    return blocks_->checkpoint() && transactions_->checkpoint() &&
+        log_->reset();
+}
+
 } // namespace database
 } // namespace libbitcoin
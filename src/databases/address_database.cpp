@@ -18,11 +18,15 @@
  */
 #include <bitcoin/database/databases/address_database.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
+#include <numeric>
 #include <tuple>
 #include <utility>
+#include <vector>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/concurrent.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/hash_table_multimap.hpp>
 
@@ -34,6 +38,11 @@
 // [ height:4      - const]
 // [ checksum:8    - const]
 
+// Paged format (rows in ascending order, the root is the table value):
+// ----------------------------------------------------------------------------
+// root: [ head:8 ][ head_count:2 ]
+// page: [ next:8 ][ capacity:2 ][ row * capacity ]
+
 namespace libbitcoin {
 namespace database {
 
@@ -43,22 +52,48 @@ using namespace bc::system::chain;
 // Total size of address storage (using tx link vs. hash for point).
 static const auto value_size = payment_record::satoshi_fixed_size(false);
 
+// Pages double in capacity from the first, so that the many addresses of one
+// or two payments remain compact, while long histories read sequentially.
+static constexpr auto root_size = sizeof(file_offset) + sizeof(uint16_t);
+static constexpr auto page_header_size = root_size;
+static constexpr size_t first_page_rows = 2;
+static constexpr size_t max_page_rows = 128;
+
+// The number of scripts hashed by each threadpool job.
+static const size_t script_batch = 64;
+
+// The number of keys found by each threadpool job of a batch query.
+static const size_t query_batch = 256;
+
 // History uses a hash table index, O(1).
 // The hash table stores indexes to the first element of unkeyed linked lists.
 address_database::address_database(const path& lookup_filename,
     const path& rows_filename, size_t table_minimum, size_t index_minimum,
-    size_t buckets, size_t expansion)
-  : hash_table_file_(lookup_filename, table_minimum, expansion),
+    size_t buckets, size_t expansion, bool huge_pages, size_t reservation,
+    size_t populate, size_t extent, bool paged, size_t script_hashes,
+    size_t read_ahead)
+  : hash_table_file_(lookup_filename, table_minimum, expansion, huge_pages ?
+        hash_table_header<index_type, link_type>::size(buckets) : 0,
+        reservation, populate, extent),
 
     // THIS sizeof(link_type) IS ASSUMED BY hash_table_multimap.
-    hash_table_(hash_table_file_, buckets, sizeof(link_type)),
+    hash_table_(hash_table_file_, buckets, paged ? root_size :
+        sizeof(link_type)),
 
     // Linked-list storage for multimap.
-    address_index_file_(rows_filename, index_minimum, expansion),
+    address_index_file_(rows_filename, index_minimum, expansion, 0,
+        reservation, populate, extent),
     address_index_(address_index_file_, 0,
         hash_table_multimap<key_type, index_type, link_type>::size(value_size)),
 
-    address_multimap_(hash_table_, address_index_)
+    address_multimap_(hash_table_, address_index_),
+
+    // Page storage for paged rows, over the same file (one is used).
+    paged_(paged),
+    pages_(address_index_file_, 0),
+    script_hashes_(script_hashes),
+    read_ahead_(read_ahead),
+    worker_nodes_(0)
 {
 }
 
@@ -79,7 +114,7 @@ bool address_database::create()
     // No need to call open after create.
     return
         hash_table_.create() &&
-        address_index_.create();
+        (paged_ ? pages_.create() : address_index_.create());
 }
 
 bool address_database::open()
@@ -88,13 +123,30 @@ bool address_database::open()
         hash_table_file_.open() &&
         address_index_file_.open() &&
         hash_table_.start() &&
-        address_index_.start();
+        (paged_ ? pages_.start() : address_index_.start());
+}
+
+void address_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+    address_index_file_.set_read_only();
+}
+
+bool address_database::refresh()
+{
+    return
+        hash_table_.refresh() &&
+        (paged_ ? pages_.refresh() : address_index_.refresh());
 }
 
 void address_database::commit()
 {
     hash_table_.commit();
-    address_index_.commit();
+
+    if (paged_)
+        pages_.commit();
+    else
+        address_index_.commit();
 }
 
 bool address_database::flush() const
@@ -104,6 +156,13 @@ bool address_database::flush() const
         address_index_file_.flush();
 }
 
+bool address_database::writeback(bool wait) const
+{
+    return
+        hash_table_file_.writeback(wait) &&
+        address_index_file_.writeback(wait);
+}
+
 bool address_database::close()
 {
     return
@@ -111,13 +170,129 @@ bool address_database::close()
         address_index_file_.close();
 }
 
+bool address_database::advise(access_advice table, access_advice rows)
+{
+    return
+        hash_table_file_.advise(table) &&
+        address_index_file_.advise(rows);
+}
+
+bool address_database::place(memory_placement placement, uint64_t nodes)
+{
+    // Workers are pinned only where page placement is confined to the nodes.
+    worker_nodes_ = placement == memory_placement::bind ? nodes : 0;
+
+    return
+        hash_table_file_.place(placement, nodes) &&
+        address_index_file_.place(placement, nodes);
+}
+
+void address_database::counters(storage_counters& out_table,
+    storage_counters& out_rows) const
+{
+    out_table = hash_table_file_.counters();
+    out_rows = address_index_file_.counters();
+}
+
+void address_database::residency(storage_residency& out_table,
+    storage_residency& out_rows) const
+{
+    out_table = hash_table_file_.residency(hash_table_.header_size());
+    out_rows = address_index_file_.residency();
+}
+
+table_statistics address_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+bool address_database::rehash(storage& file, size_t buckets) const
+{
+    record_map target(file, buckets, paged_ ? root_size : sizeof(link_type));
+    return hash_table_.rehash(target);
+}
+
 // Queries.
 // ----------------------------------------------------------------------------
 
 address_result address_database::get(const hash_digest& hash) const
 {
     // This does not populate hash or height, caller can dereference link.
-    return { address_multimap_.find(hash), hash };
+    if (!paged_)
+        return { address_multimap_.find(hash), hash, read_ahead_ };
+
+    auto head = page_manager::not_allocated;
+    size_t count = 0;
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        head = deserial.read_8_bytes_little_endian();
+        count = deserial.read_2_bytes_little_endian();
+    };
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        shared_lock lock(page_mutex_[hash_table_.bucket_index(hash)]);
+        const auto root = hash_table_.find(hash);
+
+        if (root)
+            root.read(reader);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Rows of the head page beyond the count are not read, others are full.
+    return { address_multimap_.terminator(), pages_, head, count, hash,
+        read_ahead_ };
+}
+
+std::vector<address_result> address_database::get(const hash_list& hashes,
+    threadpool& pool) const
+{
+    const auto count = hashes.size();
+    std::vector<index_type> buckets(count);
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+
+    for (size_t index = 0; index < count; ++index)
+        buckets[index] = hash_table_.bucket_index(hashes[index]);
+
+    // Keys are found in bucket order, so that buckets are read ascending.
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t left, size_t right)
+        {
+            return buckets[left] < buckets[right];
+        });
+
+    key_list keys;
+    keys.reserve(count);
+
+    for (const auto index: order)
+        keys.push_back(hashes[index]);
+
+    // Each job writes only the results of its own batch.
+    std::vector<std::vector<address_result>> batches(
+        (count + query_batch - 1u) / query_batch);
+
+    const auto finder = [&](size_t first, size_t last)
+    {
+        const key_list batch(keys.begin() + first, keys.begin() + last);
+        find(batches[first / query_batch], batch);
+    };
+
+    concurrent(pool, count, query_batch, finder, worker_nodes_);
+
+    std::vector<size_t> positions(count);
+
+    for (size_t index = 0; index < count; ++index)
+        positions[order[index]] = index;
+
+    std::vector<address_result> out;
+    out.reserve(count);
+
+    for (const auto position: positions)
+        out.push_back(batches[position / query_batch][position % query_batch]);
+
+    return out;
 }
 
 // Store.
@@ -135,6 +310,12 @@ void address_database::store(const hash_digest& script_hash, const point& point,
         output
     };
 
+    if (paged_)
+    {
+        append(script_hash, { record });
+        return;
+    }
+
     const auto write = [&](byte_serializer& serial)
     {
         record.to_data(serial, false);
@@ -145,8 +326,10 @@ void address_database::store(const hash_digest& script_hash, const point& point,
     address_multimap_.link(script_hash, element);
 }
 
-// Confirmation of payment is dynamically derived from current tx state.
-void address_database::catalog(const transaction& tx)
+// Gather the scripts and rows of each payment of the transaction.
+static void gather(const transaction& tx,
+    std::vector<const script*>& scripts, std::vector<point>& points,
+    std::vector<payment_record>& rows)
 {
     BITCOIN_ASSERT(tx.metadata.link);
     BITCOIN_ASSERT(!tx.metadata.existed);
@@ -154,7 +337,9 @@ void address_database::catalog(const transaction& tx)
     const auto tx_hash = tx.hash();
     const auto link = tx.metadata.link;
     const auto& inputs = tx.inputs();
+    const auto& outputs = tx.outputs();
     BITCOIN_ASSERT(inputs.size() <= max_uint32);
+    BITCOIN_ASSERT(outputs.size() <= max_uint32);
 
     for (uint32_t index = 0; index < inputs.size(); ++index)
     {
@@ -167,22 +352,419 @@ void address_database::catalog(const transaction& tx)
         BITCOIN_ASSERT(input.previous_output().metadata.cache.is_valid());
 
         const input_point inpoint{ tx_hash, index };
-        const auto& script = input.previous_output().metadata.cache.script();
-        const auto script_hash = sha256_hash(script.to_data(false));
-        store(script_hash, inpoint, link, false);
+        scripts.push_back(&input.previous_output().metadata.cache.script());
+        points.push_back(input.previous_output());
+        rows.push_back(payment_record{ link, inpoint.index(),
+            inpoint.checksum(), false });
     }
 
-    const auto& outputs = tx.outputs();
-    BITCOIN_ASSERT(outputs.size() <= max_uint32);
-
     for (uint32_t index = 0; index < outputs.size(); ++index)
     {
-        const auto& output = outputs[index];
         const output_point outpoint{ tx_hash, index };
-        const auto& script = output.script();
-        const auto script_hash = sha256_hash(script.to_data(false));
-        store(script_hash, outpoint, link, true);
+        scripts.push_back(&outputs[index].script());
+        points.emplace_back(tx_hash, index);
+        rows.push_back(payment_record{ link, outpoint.index(),
+            outpoint.checksum(), true });
+    }
+}
+
+// Scripts are serialized into one buffer reused across the range.
+// A null script has a key already (reused from the script hash cache).
+static void hash_scripts(std::vector<hash_digest>& keys,
+    const std::vector<const script*>& scripts, size_t first, size_t last)
+{
+    data_chunk buffer;
+
+    for (auto index = first; index < last; ++index)
+    {
+        if (scripts[index] == nullptr)
+            continue;
+
+        const auto& script = *scripts[index];
+        buffer.resize(script.serialized_size(false));
+        auto serial = make_unsafe_serializer(buffer.data());
+        script.to_data(serial, false);
+        keys[index] = sha256_hash(buffer);
+    }
+}
+
+// Confirmation of payment is dynamically derived from current tx state.
+// All rows of the transaction are written to one contiguous allocation.
+void address_database::catalog(const transaction& tx)
+{
+    std::vector<const script*> scripts;
+    std::vector<point> points;
+    payment_list rows;
+    gather(tx, scripts, points, rows);
+
+    std::vector<key_type> keys(scripts.size());
+    reuse(keys, scripts, points, rows);
+    hash_scripts(keys, scripts, 0, scripts.size());
+    retain(keys, points, rows);
+    insert(keys, rows);
+}
+
+// The scripts of all txs are hashed concurrently, and all rows of the block
+// are written to one contiguous allocation (or appended by key if paged).
+void address_database::catalog(const block& block, threadpool& pool)
+{
+    std::vector<const script*> scripts;
+    std::vector<point> points;
+    payment_list rows;
+
+    for (const auto& tx: block.transactions())
+        if (!tx.metadata.existed)
+            gather(tx, scripts, points, rows);
+
+    std::vector<key_type> keys(scripts.size());
+    reuse(keys, scripts, points, rows);
+
+    const auto hasher = [&](size_t first, size_t last)
+    {
+        hash_scripts(keys, scripts, first, last);
+    };
+
+    concurrent(pool, scripts.size(), script_batch, hasher, worker_nodes_);
+    retain(keys, points, rows);
+    insert(keys, rows);
+}
+
+// Rows of a common key are grouped here, as the list layout links each
+// contiguous run of a key to its root in one step.
+void address_database::catalog(const key_list& keys, const payment_list& rows)
+{
+    BITCOIN_ASSERT(keys.size() == rows.size());
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t left, size_t right)
+        {
+            return keys[left] < keys[right];
+        });
+
+    key_list sorted_keys;
+    payment_list sorted_rows;
+    sorted_keys.reserve(keys.size());
+    sorted_rows.reserve(rows.size());
+
+    for (const auto index: order)
+    {
+        sorted_keys.push_back(keys[index]);
+        sorted_rows.push_back(rows[index]);
+    }
+
+    insert(sorted_keys, sorted_rows);
+}
+
+void address_database::payments(key_list& out_keys, payment_list& out_rows,
+    const block& block)
+{
+    std::vector<const script*> scripts;
+    std::vector<point> points;
+    payment_list rows;
+
+    for (const auto& tx: block.transactions())
+        if (!tx.metadata.existed)
+            gather(tx, scripts, points, rows);
+
+    key_list keys(scripts.size());
+    reuse(keys, scripts, points, rows);
+    hash_scripts(keys, scripts, 0, scripts.size());
+    retain(keys, points, rows);
+    out_keys.insert(out_keys.end(), keys.begin(), keys.end());
+    out_rows.insert(out_rows.end(), rows.begin(), rows.end());
+}
+
+// private
+// Chains are walked interleaved, and the newest rows of each key (the head of
+// its list, or the used rows of its head page) are prefetched before return.
+void address_database::find(std::vector<address_result>& out,
+    const key_list& keys) const
+{
+    out.reserve(keys.size());
+
+    if (!paged_)
+    {
+        const auto elements = address_multimap_.find(keys, true);
+
+        for (size_t index = 0; index < keys.size(); ++index)
+        {
+            const auto& element = elements[index];
+
+            if (element)
+            {
+                // The guard must remain in scope until the prefetch.
+                const auto memory = address_index_.access(element.link());
+                address_index_.prefetch(memory,
+                    record_multimap::size(value_size), true);
+            }
+
+            out.push_back({ element, keys[index], read_ahead_ });
+        }
+
+        return;
+    }
+
+    const auto roots = hash_table_.find(keys, true);
+
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+        auto head = page_manager::not_allocated;
+        size_t count = 0;
+        const auto reader = [&](byte_deserializer& deserial)
+        {
+            head = deserial.read_8_bytes_little_endian();
+            count = deserial.read_2_bytes_little_endian();
+        };
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        {
+            const auto& key = keys[index];
+            shared_lock lock(page_mutex_[hash_table_.bucket_index(key)]);
+
+            if (roots[index])
+                roots[index].read(reader);
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        if (head != page_manager::not_allocated)
+        {
+            // The guard must remain in scope until the prefetch.
+            const auto memory = pages_.access(head);
+            pages_.prefetch(memory, page_header_size + count * value_size,
+                true);
+        }
+
+        out.push_back({ address_multimap_.terminator(), pages_, head, count,
+            keys[index], read_ahead_ });
+    }
+}
+
+// private
+// The key of an input is reused if its prevout was recently cataloged, and
+// its script is then nulled so that it is not hashed.
+void address_database::reuse(key_list& keys,
+    std::vector<const script*>& scripts, const std::vector<point>& points,
+    const payment_list& rows) const
+{
+    if (script_hashes_.disabled())
+        return;
+
+    for (size_t index = 0; index < rows.size(); ++index)
+        if (!rows[index].is_output() &&
+            script_hashes_.find(keys[index], points[index]))
+            scripts[index] = nullptr;
+}
+
+// private
+// The key of each output is recorded for the input that later spends it.
+void address_database::retain(const key_list& keys,
+    const std::vector<point>& points, const payment_list& rows)
+{
+    if (script_hashes_.disabled())
+        return;
+
+    for (size_t index = 0; index < rows.size(); ++index)
+        if (rows[index].is_output())
+            script_hashes_.insert(points[index], keys[index]);
+}
+
+// Compaction.
+// ----------------------------------------------------------------------------
+
+// Linked rows are immutable, so the list is read without a lock and swapped
+// only if its head is unchanged. A list already in a ranked run is retained.
+bool address_database::compact(const hash_digest& hash,
+    const rank_function& rank)
+{
+    if (paged_)
+        return false;
+
+    typedef std::pair<size_t, payment_record> ranked_row;
+    std::vector<ranked_row> rows;
+    auto element = address_multimap_.find(hash);
+    const auto head = element.link();
+    auto contiguous = true;
+
+    for (auto link = head; element; element.jump_next())
+    {
+        contiguous &= element.link() == link++;
+
+        element.read([&](byte_deserializer& deserial)
+        {
+            payment_record row;
+            row.from_data(deserial, false);
+            rows.emplace_back(rank(row), row);
+        });
+    }
+
+    const auto descending = [](const ranked_row& left,
+        const ranked_row& right)
+    {
+        return left.first > right.first;
+    };
+
+    if (rows.size() < 2u || (contiguous &&
+        std::is_sorted(rows.begin(), rows.end(), descending)))
+        return true;
+
+    std::stable_sort(rows.begin(), rows.end(), descending);
+    const auto first = address_multimap_.allocate(rows.size());
+
+    // The run is not yet reachable, so chaining requires no lock.
+    for (size_t index = 0; index < rows.size(); ++index)
+    {
+        const auto writer = [&](byte_serializer& serial)
+        {
+            rows[index].second.to_data(serial, false);
+        };
+
+        auto next = address_multimap_.allocator(first + index);
+        next.populate(writer);
+        next.set_next(index + 1u == rows.size() ? next.not_found :
+            static_cast<link_type>(first + index + 1u));
+    }
+
+    return address_multimap_.relink(hash, head, first);
+}
+
+// private
+void address_database::insert(const std::vector<key_type>& keys,
+    const payment_list& records)
+{
+    if (records.empty())
+        return;
+
+    if (paged_)
+    {
+        std::vector<size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0u);
+
+        // Group rows by key, preserving their order within each key.
+        std::stable_sort(order.begin(), order.end(),
+            [&](size_t left, size_t right)
+            {
+                return keys[left] < keys[right];
+            });
+
+        for (auto it = order.begin(); it != order.end();)
+        {
+            const auto& key = keys[*it];
+            payment_list rows;
+
+            for (; it != order.end() && keys[*it] == key; ++it)
+                rows.push_back(records[*it]);
+
+            append(key, rows);
+        }
+
+        return;
+    }
+
+    const auto first = address_multimap_.allocate(records.size());
+
+    for (size_t row = 0; row < records.size(); ++row)
+    {
+        const auto write = [&](byte_serializer& serial)
+        {
+            records[row].to_data(serial, false);
+        };
+
+        address_multimap_.allocator(first + row).populate(write);
     }
+
+    address_multimap_.link(keys, first);
+}
+
+// private
+// Rows fill the head page, then a new head page of doubled capacity is
+// chained to it. Counted rows are immutable, so readers of a root need only
+// the row count of its head page, which is published with the head.
+void address_database::append(const key_type& key, const payment_list& rows)
+{
+    static const auto no_page = page_manager::not_allocated;
+    auto head = no_page;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        head = deserial.read_8_bytes_little_endian();
+        count = deserial.read_2_bytes_little_endian();
+    };
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_8_bytes_little_endian(head);
+        serial.write_2_bytes_little_endian(static_cast<uint16_t>(count));
+    };
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(page_mutex_[hash_table_.bucket_index(key)]);
+    auto root = hash_table_.find(key);
+
+    if (root)
+    {
+        root.read(reader);
+
+        // The guard must remain in scope until the end of the block.
+        const auto memory = pages_.access(head);
+        capacity = from_little_endian_unsafe<uint16_t>(memory.buffer() +
+            sizeof(file_offset));
+    }
+
+    for (size_t row = 0; row < rows.size();)
+    {
+        if (count == capacity)
+        {
+            const auto rows_size = capacity == 0 ? first_page_rows :
+                std::min(capacity * 2u, max_page_rows);
+            const auto page = pages_.allocate(page_header_size +
+                rows_size * value_size);
+
+            if (page == no_page)
+                return;
+
+            // The guard must remain in scope until the end of the block.
+            const auto memory = pages_.access(page);
+            auto serial = make_unsafe_serializer(memory.buffer());
+            serial.write_8_bytes_little_endian(head);
+            serial.write_2_bytes_little_endian(
+                static_cast<uint16_t>(rows_size));
+            pages_.dirty(memory, page_header_size);
+
+            head = page;
+            capacity = rows_size;
+            count = 0;
+        }
+
+        const auto fill = std::min(rows.size() - row, capacity - count);
+
+        // The guard must remain in scope until the end of the block.
+        auto memory = pages_.access(head);
+        memory.increment(page_header_size + count * value_size);
+        auto serial = make_unsafe_serializer(memory.buffer());
+
+        for (auto end = row + fill; row < end; ++row)
+            rows[row].to_data(serial, false);
+
+        pages_.dirty(memory, fill * value_size);
+        count += fill;
+    }
+
+    if (root)
+    {
+        root.write(writer, root_size);
+        return;
+    }
+
+    auto next = hash_table_.allocator();
+    next.create(key, writer);
+    hash_table_.link(next);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 } // namespace database
@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/balance_database.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/databases/address_database.hpp>
+#include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/result/address_result.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+
+// Record format [24 bytes, 60 with key/link]:
+// ----------------------------------------------------------------------------
+// [ received:8     - atomic ]
+// [ spent:8        - atomic ]
+// [ transactions:4 - atomic ]
+// [ height:4       - atomic ]
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+static constexpr auto value_size = 2u * sizeof(uint64_t) +
+    2u * sizeof(uint32_t);
+
+// The output of the prevout, from its metadata if populated.
+static output previous_output(const output_point& point,
+    const transaction_database& transactions)
+{
+    if (point.metadata.cache.is_valid())
+        return point.metadata.cache;
+
+    const auto result = transactions.get(point.hash());
+    return result ? result.output(point.index()) : output{};
+}
+
+// Balances use a hash table index, O(1).
+balance_database::balance_database(const path& map_filename,
+    size_t table_minimum, size_t buckets, size_t expansion, bool huge_pages,
+    size_t reservation, size_t populate, size_t extent)
+  : hash_table_file_(map_filename, table_minimum, expansion, huge_pages ?
+        hash_table_header<index_type, link_type>::size(buckets) : 0,
+        reservation, populate, extent),
+    hash_table_(hash_table_file_, buckets, value_size)
+{
+}
+
+balance_database::~balance_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool balance_database::create()
+{
+    if (!hash_table_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return hash_table_.create();
+}
+
+bool balance_database::open()
+{
+    return
+        hash_table_file_.open() &&
+        hash_table_.start();
+}
+
+void balance_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+}
+
+bool balance_database::refresh()
+{
+    return hash_table_.refresh();
+}
+
+void balance_database::commit()
+{
+    hash_table_.commit();
+}
+
+bool balance_database::flush() const
+{
+    return hash_table_file_.flush();
+}
+
+bool balance_database::writeback(bool wait) const
+{
+    return hash_table_file_.writeback(wait);
+}
+
+bool balance_database::close()
+{
+    return hash_table_file_.close();
+}
+
+bool balance_database::advise(access_advice table)
+{
+    return hash_table_file_.advise(table);
+}
+
+storage_counters balance_database::counters() const
+{
+    return hash_table_file_.counters();
+}
+
+storage_residency balance_database::residency() const
+{
+    return hash_table_file_.residency(hash_table_.header_size());
+}
+
+table_statistics balance_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+bool balance_database::get(summary& out, const hash_digest& hash) const
+{
+    const auto element = hash_table_.find(hash);
+
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+        out.received = deserial.read_8_bytes_little_endian();
+        out.spent = deserial.read_8_bytes_little_endian();
+        out.transactions = deserial.read_4_bytes_little_endian();
+        out.height = deserial.read_4_bytes_little_endian();
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    element.read(reader);
+    return out.transactions != 0;
+}
+
+// Store.
+// ----------------------------------------------------------------------------
+
+bool balance_database::confirm(const block& block, size_t height,
+    const transaction_database& transactions)
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+
+    change_map changes;
+    gather(changes, block, transactions);
+
+    for (const auto& entry: changes)
+    {
+        const auto& delta = entry.second;
+        summary value{ 0, 0, 0, 0 };
+        get(value, entry.first);
+
+        value.received += delta.received;
+        value.spent += delta.spent;
+        value.transactions += delta.transactions;
+        value.height = static_cast<uint32_t>(height);
+
+        if (!write(entry.first, value))
+            return false;
+    }
+
+    return true;
+}
+
+// The reverse of confirm, scripts not found were confirmed before indexing.
+bool balance_database::unconfirm(const block& block, size_t height,
+    const transaction_database& transactions,
+    const address_database* addresses)
+{
+    change_map changes;
+    gather(changes, block, transactions);
+
+    for (const auto& entry: changes)
+    {
+        const auto& delta = entry.second;
+        summary value;
+
+        if (!get(value, entry.first))
+            continue;
+
+        value.received -= std::min(value.received, delta.received);
+        value.spent -= std::min(value.spent, delta.spent);
+        value.transactions -= std::min(value.transactions,
+            delta.transactions);
+
+        if (value.transactions == 0)
+            value.height = 0;
+        else if (value.height == height)
+            value.height = last_height(entry.first, height, transactions,
+                addresses);
+
+        if (!write(entry.first, value))
+            return false;
+    }
+
+    return true;
+}
+
+// private
+// The key is the hash of the script, as in the address table.
+balance_database::key_type balance_database::to_key(const script& script)
+{
+    return sha256_hash(script.to_data(false));
+}
+
+// private
+// Prevouts that cannot be resolved (such as pruned scripts) are not spent.
+void balance_database::gather(change_map& out, const block& block,
+    const transaction_database& transactions)
+{
+    for (const auto& tx: block.transactions())
+    {
+        change_map changes;
+
+        if (!tx.is_coinbase())
+        {
+            for (const auto& input: tx.inputs())
+            {
+                const auto prevout = previous_output(input.previous_output(),
+                    transactions);
+
+                if (prevout.is_valid())
+                    changes[to_key(prevout.script())].spent +=
+                        prevout.value();
+            }
+        }
+
+        for (const auto& output: tx.outputs())
+            changes[to_key(output.script())].received += output.value();
+
+        for (const auto& entry: changes)
+        {
+            auto& total = out[entry.first];
+            total.received += entry.second.received;
+            total.spent += entry.second.spent;
+            ++total.transactions;
+        }
+    }
+}
+
+// private
+// Writes are serialized by the caller, readers are excluded per record.
+bool balance_database::write(const key_type& key, const summary& value)
+{
+    const auto writer = [&](byte_serializer& serial)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(mutex_);
+        serial.write_8_bytes_little_endian(value.received);
+        serial.write_8_bytes_little_endian(value.spent);
+        serial.write_4_bytes_little_endian(value.transactions);
+        serial.write_4_bytes_little_endian(value.height);
+        ///////////////////////////////////////////////////////////////////////
+    };
+
+    const auto element = hash_table_.find(key);
+
+    if (element)
+    {
+        element.write(writer, value_size);
+        return true;
+    }
+
+    const auto link = hash_table_.allocate(1);
+
+    if (link == manager_type::not_allocated)
+        return false;
+
+    auto next = hash_table_.allocator(link);
+    next.populate(key, writer);
+    hash_table_.link(next);
+    return true;
+}
+
+// private
+// The greatest height below that of the block among confirmed history txs.
+uint32_t balance_database::last_height(const key_type& key, size_t height,
+    const transaction_database& transactions,
+    const address_database* addresses) const
+{
+    BITCOIN_ASSERT(height != 0);
+
+    // Without the history the height is bounded by the preceding block.
+    if (addresses == nullptr)
+        return static_cast<uint32_t>(height - 1u);
+
+    size_t last = 0;
+
+    for (const auto payment: addresses->get(key))
+    {
+        const auto result = transactions.get(payment.link());
+
+        if (result && result.position() != transaction_result::unconfirmed &&
+            result.height() < height)
+            last = std::max(last, result.height());
+    }
+
+    return static_cast<uint32_t>(last);
+}
+
+} // namespace database
+} // namespace libbitcoin
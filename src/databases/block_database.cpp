@@ -18,16 +18,24 @@
  */
 #include <bitcoin/database/databases/block_database.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/block_state.hpp>
+#include <bitcoin/database/concurrent.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/list_element.hpp>
 #include <bitcoin/database/result/block_result.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+#include <bitcoin/database/sip_hash.hpp>
 
 // Record format (v4) [99 bytes, 135 with key/link]:
 // Below excludes block height and tx hash indexes (arrays).
@@ -36,10 +44,17 @@
 // [ median_time_past:4 - const   ]
 // [ height:4           - const   ] (in any branch)
 // [ state:1            - atomic1 ] (invalid, empty, stored, pooled, indexed, confirmed)
-// [ checksum/code:4    - atomic2 ] (optional, zero if not cached, code if invalid)
+// [ checksum/code:4    - atomic2 ] (short id salt, zero if unset, code if invalid)
 // [ tx_start:4         - atomic3 ] (array index into the transaction_index, or zero)
 // [ tx_count:2         - atomic3 ] (atomic with start, zero if block unpopulated)
 
+// Times record [8 bytes] (optional, by confirmed height):
+// ----------------------------------------------------------------------------
+// [ timestamp:4        - const ] (maximum of the timestamps to this height)
+// [ median_time_past:4 - const ]
+// Both are nondecreasing with height, so a search is a binary search. The
+// first timestamp at or after a time is where its running maximum is.
+
 // Record format (v3) [variable bytes] (median_time_past added in v3.3):
 // Below excludes block height index (array).
 // ----------------------------------------------------------------------------
@@ -55,22 +70,27 @@ namespace database {
 using namespace bc::system;
 using namespace bc::system::chain;
 
-static const auto header_size = header::satoshi_fixed_size();
-static constexpr auto median_time_past_size = sizeof(uint32_t);
-static constexpr auto height_size = sizeof(uint32_t);
-static constexpr auto state_size = sizeof(uint8_t);
-static constexpr auto checksum_size = sizeof(uint32_t);
-static constexpr auto tx_start_size = sizeof(uint32_t);
-static constexpr auto tx_count_size = sizeof(uint16_t);
+// Fields of the block record are read in place by their fixed offsets.
+typedef block_result::layout layout;
 
-static const auto height_offset = header_size + median_time_past_size;
-static const auto state_offset = height_offset + height_size;
-static const auto checksum_offset = state_offset + state_size;
-static const auto transactions_offset = checksum_offset + checksum_size;
+static constexpr auto checksum_size = layout::checksum::size;
+static constexpr auto state_offset = layout::state::offset;
+static constexpr auto checksum_offset = layout::checksum::offset;
+static constexpr auto transactions_offset = layout::tx_start::offset;
 
 // Total size of block header and metadata storage.
-static const auto block_size = header_size + median_time_past_size +
-    height_size + state_size + checksum_size + tx_start_size + tx_count_size;
+static constexpr auto block_size = layout::size;
+
+static constexpr auto time_size = 2u * sizeof(uint32_t);
+
+// Candidate state: the validation state bits, with a populated bit.
+static constexpr uint8_t populated = 1u << 7;
+static constexpr uint64_t valid_lanes = UINT64_C(0x0202020202020202);
+static constexpr uint64_t populated_lanes = UINT64_C(0x8080808080808080);
+static constexpr auto lane_count = sizeof(uint64_t);
+
+// The number of headers hashed by each threadpool job.
+static const size_t header_batch = 256;
 
 // Blocks uses a hash table and two array indexes, all O(1).
 // The block database keys off of block hash and has block value.
@@ -78,24 +98,39 @@ block_database::block_database(const path& map_filename,
     const path& candidate_index_filename, const path& confirmed_index_filename,
     const path& tx_index_filename, size_t table_minimum,
     size_t candidate_index_minimum, size_t confirmed_index_minimum,
-    size_t tx_index_minimum, size_t buckets, size_t expansion)
-  : hash_table_file_(map_filename, table_minimum, expansion),
+    size_t tx_index_minimum, size_t buckets, size_t expansion,
+    bool huge_pages, size_t reservation, size_t populate, size_t extent,
+    bool resident_headers, const path& times_filename,
+    bool candidate_states)
+  : hash_table_file_(map_filename, table_minimum, expansion,
+        huge_pages ? max_size_t : 0, reservation, populate, extent),
     hash_table_(hash_table_file_, buckets, block_size),
 
     // Array storage.
     candidate_index_file_(candidate_index_filename,
-        candidate_index_minimum, expansion),
+        candidate_index_minimum, expansion, 0, reservation, populate,
+        extent),
     candidate_index_(candidate_index_file_, 0, sizeof(link_type)),
 
     // Array storage.
     confirmed_index_file_(confirmed_index_filename,
-        confirmed_index_minimum, expansion),
+        confirmed_index_minimum, expansion, 0, reservation, populate,
+        extent),
     confirmed_index_(confirmed_index_file_, 0, sizeof(link_type)),
 
     // Array storage.
-    tx_index_file_(tx_index_filename, tx_index_minimum, expansion),
-    tx_index_(tx_index_file_, 0, sizeof(file_offset))
+    tx_index_file_(tx_index_filename, tx_index_minimum, expansion, 0,
+        reservation, populate, extent),
+    tx_index_(tx_index_file_, 0, sizeof(file_offset)),
+    resident_(resident_headers),
+    timed_(!times_filename.empty()),
+    times_file_(times_filename, 1, expansion, 0, reservation, populate,
+        extent),
+    times_(times_file_, 0, time_size),
+    stateful_(candidate_states),
+    worker_nodes_(0)
 {
+    BITCOIN_ASSERT(header::satoshi_fixed_size() == layout::header_size);
 }
 
 block_database::~block_database()
@@ -111,20 +146,26 @@ bool block_database::create()
     if (!hash_table_file_.open() ||
         !candidate_index_file_.open() ||
         !confirmed_index_file_.open() ||
-        !tx_index_file_.open())
+        !tx_index_file_.open() ||
+        (timed_ && !times_file_.open()))
         return false;
 
+    candidate_headers_.clear();
+    confirmed_headers_.clear();
+    candidate_states_.clear();
+
     // No need to call open after create.
     return
         hash_table_.create() &&
         candidate_index_.create() &&
         confirmed_index_.create() &&
-        tx_index_.create();
+        tx_index_.create() &&
+        (!timed_ || times_.create());
 }
 
 bool block_database::open()
 {
-    return
+    const auto opened =
         hash_table_file_.open() &&
         candidate_index_file_.open() &&
         confirmed_index_file_.open() &&
@@ -133,7 +174,20 @@ bool block_database::open()
         hash_table_.start() &&
         candidate_index_.start() &&
         confirmed_index_.start() &&
-        tx_index_.start();
+        tx_index_.start() &&
+
+        (!timed_ || (times_file_.open() && times_.start() && load_times()));
+
+    if (opened && resident_)
+    {
+        load_resident(candidate_index_);
+        load_resident(confirmed_index_);
+    }
+
+    if (opened && stateful_)
+        load_states();
+
+    return opened;
 }
 
 void block_database::commit()
@@ -142,6 +196,9 @@ void block_database::commit()
     candidate_index_.commit();
     confirmed_index_.commit();
     tx_index_.commit();
+
+    if (timed_)
+        times_.commit();
 }
 
 bool block_database::flush() const
@@ -150,7 +207,62 @@ bool block_database::flush() const
         hash_table_file_.flush() &&
         candidate_index_file_.flush() &&
         confirmed_index_file_.flush() &&
-        tx_index_file_.flush();
+        tx_index_file_.flush() &&
+        (!timed_ || times_file_.flush());
+}
+
+bool block_database::checkpoint() const
+{
+    return
+        hash_table_file_.checkpoint() &&
+        candidate_index_file_.checkpoint() &&
+        confirmed_index_file_.checkpoint() &&
+        tx_index_file_.checkpoint() &&
+        (!timed_ || times_file_.checkpoint());
+}
+
+void block_database::attach(write_log& log)
+{
+    hash_table_file_.attach(log);
+    candidate_index_file_.attach(log);
+    confirmed_index_file_.attach(log);
+    tx_index_file_.attach(log);
+
+    if (timed_)
+        times_file_.attach(log);
+}
+
+void block_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+    candidate_index_file_.set_read_only();
+    confirmed_index_file_.set_read_only();
+    tx_index_file_.set_read_only();
+
+    if (timed_)
+        times_file_.set_read_only();
+}
+
+// The committed tops are the counts of the height indexes, which are read
+// after the records that they reference (the writer commits them last).
+bool block_database::refresh()
+{
+    return
+        hash_table_.refresh() &&
+        tx_index_.refresh() &&
+        candidate_index_.refresh() &&
+        confirmed_index_.refresh() &&
+        (!timed_ || times_.refresh());
+}
+
+bool block_database::writeback(bool wait) const
+{
+    return
+        hash_table_file_.writeback(wait) &&
+        candidate_index_file_.writeback(wait) &&
+        confirmed_index_file_.writeback(wait) &&
+        tx_index_file_.writeback(wait) &&
+        (!timed_ || times_file_.writeback(wait));
 }
 
 bool block_database::close()
@@ -159,7 +271,119 @@ bool block_database::close()
         hash_table_file_.close() &&
         candidate_index_file_.close() &&
         confirmed_index_file_.close() &&
-        tx_index_file_.close();
+        tx_index_file_.close() &&
+        (!timed_ || times_file_.close());
+}
+
+bool block_database::advise(access_advice table,
+    access_advice candidate_index, access_advice confirmed_index,
+    access_advice tx_index)
+{
+    return
+        hash_table_file_.advise(table) &&
+        candidate_index_file_.advise(candidate_index) &&
+        confirmed_index_file_.advise(confirmed_index) &&
+        tx_index_file_.advise(tx_index);
+}
+
+bool block_database::place(memory_placement placement, uint64_t nodes)
+{
+    // Workers are pinned only where page placement is confined to the nodes.
+    worker_nodes_ = placement == memory_placement::bind ? nodes : 0;
+
+    return
+        hash_table_file_.place(placement, nodes) &&
+        candidate_index_file_.place(placement, nodes) &&
+        confirmed_index_file_.place(placement, nodes) &&
+        tx_index_file_.place(placement, nodes) &&
+        (!timed_ || times_file_.place(placement, nodes));
+}
+
+bool block_database::prefault(bool table, bool indexes, bool pin)
+{
+    return
+        (!table || hash_table_file_.prefault(max_size_t, pin)) &&
+        (!indexes || candidate_index_file_.prefault(max_size_t, pin)) &&
+        (!indexes || confirmed_index_file_.prefault(max_size_t, pin));
+}
+
+void block_database::counters(storage_counters& out_table,
+    storage_counters& out_candidate_index,
+    storage_counters& out_confirmed_index,
+    storage_counters& out_tx_index) const
+{
+    out_table = hash_table_file_.counters();
+    out_candidate_index = candidate_index_file_.counters();
+    out_confirmed_index = confirmed_index_file_.counters();
+    out_tx_index = tx_index_file_.counters();
+}
+
+void block_database::residency(storage_residency& out_table,
+    storage_residency& out_candidate_index,
+    storage_residency& out_confirmed_index,
+    storage_residency& out_tx_index) const
+{
+    out_table = hash_table_file_.residency(hash_table_.header_size());
+    out_candidate_index = candidate_index_file_.residency();
+    out_confirmed_index = confirmed_index_file_.residency();
+    out_tx_index = tx_index_file_.residency();
+}
+
+table_statistics block_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+bool block_database::rehash(storage& file, size_t buckets) const
+{
+    record_map target(file, buckets, block_size);
+    return hash_table_.rehash(target);
+}
+
+// The transaction index is a contiguous array of the (unique) link spans of
+// populated blocks, so those of unconfirmed blocks are found by exclusion.
+bool block_database::relink(const transaction_database::relinker& relinker)
+{
+    const auto count = tx_index_.count();
+    std::vector<bool> relinked(count, false);
+
+    const auto relink = [&](array_index start, size_t size)
+    {
+        for (auto index = start; index < start + size; ++index)
+        {
+            if (relinked[index])
+                continue;
+
+            const auto memory = tx_index_.access(index);
+            auto link = make_unsafe_deserializer(memory.buffer())
+                .read_8_bytes_little_endian();
+
+            if (!relinker(link))
+                return false;
+
+            make_unsafe_serializer(memory.buffer())
+                .write_8_bytes_little_endian(link);
+            tx_index_.dirty(memory, sizeof(file_offset));
+            relinked[index] = true;
+        }
+
+        return true;
+    };
+
+    size_t confirmed_top;
+    if (top(confirmed_top, false))
+    {
+        for (size_t height = 0; height <= confirmed_top; ++height)
+        {
+            const auto result = get(height, false);
+
+            if (!result || !relink(result.transaction_start(),
+                result.transaction_count()))
+                return false;
+        }
+    }
+
+    return relink(0, count);
 }
 
 // Queries.
@@ -174,11 +398,29 @@ bool block_database::top(size_t& out_height, bool candidate) const
 block_result block_database::get(size_t height, bool candidate) const
 {
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
+    auto link = record_map::not_found;
+
+    if (resident_)
+    {
+        const auto& chain = resident(manager);
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(resident_mutex_);
+
+        if (height < chain.size())
+            link = chain[height].link;
+        ///////////////////////////////////////////////////////////////////////
+    }
+    else
+    {
+        link = read_link(height, manager);
+    }
 
     return
     {
         // A not_found link value produces a terminator element.
-        hash_table_.get(read_link(height, manager)),
+        hash_table_.get(link),
         metadata_mutex_,
         tx_index_
     };
@@ -195,18 +437,290 @@ block_result block_database::get(const hash_digest& hash) const
     };
 }
 
+bool block_database::get_header(chain::header& out_header,
+    uint32_t& out_median_time_past, size_t height, bool candidate) const
+{
+    if (!resident_)
+    {
+        const auto result = get(height, candidate);
+
+        if (!result)
+            return false;
+
+        out_header = result.header();
+        out_median_time_past = result.median_time_past();
+        return true;
+    }
+
+    const auto& chain = resident(candidate ? candidate_index_ :
+        confirmed_index_);
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(resident_mutex_);
+
+    if (height >= chain.size())
+        return false;
+
+    const auto& entry = chain[height];
+    auto deserial = make_unsafe_deserializer(entry.header.begin());
+    out_header.from_data(deserial, entry.hash, false);
+    out_median_time_past = entry.median_time_past;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool block_database::get_hash(hash_digest& out_hash, size_t height,
+    bool candidate) const
+{
+    if (!resident_)
+    {
+        const auto result = get(height, candidate);
+
+        if (!result)
+            return false;
+
+        out_hash = result.hash();
+        return true;
+    }
+
+    const auto& chain = resident(candidate ? candidate_index_ :
+        confirmed_index_);
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(resident_mutex_);
+
+    if (height >= chain.size())
+        return false;
+
+    out_hash = chain[height].hash;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The column is contiguous, so the search holds one memory object.
+bool block_database::find_height(size_t& out_height, uint32_t time,
+    bool median) const
+{
+    if (!timed_)
+        return false;
+
+    const size_t count = times_.count();
+
+    if (count == 0)
+        return false;
+
+    const auto memory = times_.get(0);
+    const auto buffer = memory->buffer() + (median ? sizeof(uint32_t) : 0u);
+    size_t first = 0;
+    size_t last = count;
+
+    // Find the first record at or after the time, in nondecreasing records.
+    while (first < last)
+    {
+        const auto middle = first + (last - first) / 2u;
+        const auto value = from_little_endian_unsafe<uint32_t>(buffer +
+            middle * time_size);
+
+        if (value < time)
+            first = middle + 1u;
+        else
+            last = middle;
+    }
+
+    if (first == count)
+        return false;
+
+    out_height = first;
+    return true;
+}
+
+// States are tested eight at a time, as the lanes of a word.
+bool block_database::find_unvalidated(size_t& out_height,
+    size_t from_height) const
+{
+    if (!stateful_)
+        return false;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(states_mutex_);
+    const auto count = candidate_states_.size();
+    const auto states = candidate_states_.data();
+    auto height = from_height;
+
+    for (; height + lane_count <= count; height += lane_count)
+    {
+        uint64_t lanes;
+        std::memcpy(&lanes, states + height, lane_count);
+
+        if ((lanes & valid_lanes) != valid_lanes)
+            break;
+    }
+
+    for (; height < count; ++height)
+    {
+        if (!is_valid(states[height]))
+        {
+            out_height = height;
+            return true;
+        }
+    }
+
+    return false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Full words of populated states are skipped.
+bool block_database::get_empty(std::vector<size_t>& out_heights,
+    size_t from_height, size_t count) const
+{
+    if (!stateful_)
+        return false;
+
+    out_heights.clear();
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(states_mutex_);
+    const auto states = candidate_states_.data();
+    const auto end = std::min(candidate_states_.size(),
+        from_height > max_size_t - count ? max_size_t : from_height + count);
+
+    for (auto height = from_height; height < end;)
+    {
+        if (height + lane_count <= end)
+        {
+            uint64_t lanes;
+            std::memcpy(&lanes, states + height, lane_count);
+
+            if ((lanes & populated_lanes) == populated_lanes)
+            {
+                height += lane_count;
+                continue;
+            }
+        }
+
+        if ((states[height] & populated) == 0)
+            out_heights.push_back(height);
+
+        ++height;
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The tx hashes are read from the table keys, no tx is deserialized.
+bool block_database::get_short_ids(short_id_list& out_ids,
+    uint64_t& out_nonce, const hash_digest& hash,
+    const transaction_database& transactions) const
+{
+    const auto result = get(hash);
+
+    if (!result || is_failed(result.state()) || result.checksum() == 0 ||
+        result.transaction_count() == 0)
+        return false;
+
+    // The keys are the leading words of sha256(header || nonce).
+    out_nonce = result.checksum();
+    auto data = result.header().to_data();
+    extend_data(data, to_little_endian(out_nonce));
+    uint64_t k0;
+    uint64_t k1;
+    sip_hash_key(k0, k1, sha256_hash(data));
+
+    out_ids.clear();
+    out_ids.reserve(result.transaction_count() - 1u);
+    auto link = result.begin();
+
+    // Skip the (prefilled) coinbase.
+    for (++link; link != result.end(); ++link)
+    {
+        const auto tx = transactions.get(*link);
+
+        if (!tx)
+            return false;
+
+        const auto id = to_little_endian(sip_hash(k0, k1, tx.hash()));
+        short_id_list::value_type short_id;
+        std::copy_n(id.begin(), short_id.size(), short_id.begin());
+        out_ids.push_back(short_id);
+    }
+
+    return true;
+}
+
 void block_database::get_header_metadata(const chain::header& header) const
 {
     get(header.hash()).set_metadata(header);
 }
 
+// A header is stored only above its stored parent, so when the first header
+// of a linear extension of the candidate top is not stored neither is any.
+void block_database::get_header_metadata(const header::list& headers,
+    threadpool& pool) const
+{
+    const auto count = headers.size();
+
+    if (count == 0)
+        return;
+
+    // Hashes are cached by each header, so compute them concurrently.
+    const auto hasher = [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+            headers[index].hash();
+    };
+
+    concurrent(pool, count, header_batch, hasher, worker_nodes_);
+
+    auto linear = true;
+
+    for (size_t index = 1; linear && index < count; ++index)
+        linear = headers[index].previous_block_hash() ==
+            headers[index - 1u].hash();
+
+    size_t top;
+    const auto& front = headers.front();
+
+    if (linear && read_top(top, candidate_index_) &&
+        get(top, true).hash() == front.previous_block_hash())
+    {
+        get_header_metadata(front);
+
+        if (!front.metadata.exists)
+        {
+            for (size_t index = 1; index < count; ++index)
+                headers[index].metadata.exists = false;
+
+            return;
+        }
+    }
+
+    hash_list hashes;
+    hashes.reserve(count);
+
+    for (const auto& header: headers)
+        hashes.push_back(header.hash());
+
+    const auto found = hash_table_.find(hashes, true);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        const block_result result(found[index], metadata_mutex_, tx_index_);
+        result.set_metadata(headers[index]);
+    }
+}
+
 // Store.
 // ----------------------------------------------------------------------------
 
 // private
-void block_database::store(const chain::header& header, size_t height,
-    uint32_t median_time_past, uint32_t checksum, link_type tx_start,
-    size_t tx_count, uint8_t state)
+block_database::link_type block_database::store(const chain::header& header,
+    size_t height, uint32_t median_time_past, uint32_t checksum,
+    link_type tx_start, size_t tx_count, uint8_t state)
 {
     BITCOIN_ASSERT(height <= max_uint32);
     BITCOIN_ASSERT(tx_start <= max_uint32);
@@ -227,9 +741,10 @@ void block_database::store(const chain::header& header, size_t height,
     auto next = hash_table_.allocator();
     next.create(header.hash(), writer);
     hash_table_.link(next);
+    return next.link();
 }
 
-void block_database::store(const chain::header& header, size_t height,
+array_index block_database::store(const chain::header& header, size_t height,
     uint32_t median_time_past)
 {
     static constexpr auto tx_start = 0u;
@@ -237,7 +752,7 @@ void block_database::store(const chain::header& header, size_t height,
     static constexpr auto no_checksum = 0u;
 
     // New headers are only accepted in the candidate state.
-    store(header, height, median_time_past, no_checksum, tx_start, tx_count,
+    return store(header, height, median_time_past, no_checksum, tx_start, tx_count,
         block_state::candidate);
 }
 
@@ -254,6 +769,7 @@ block_database::link_type block_database::associate(
     for (const auto& tx: transactions)
         serial.write_8_bytes_little_endian(tx.metadata.link);
 
+    tx_index_.dirty(record, transactions.size() * sizeof(file_offset));
     return start;
 }
 
@@ -264,7 +780,12 @@ block_database::link_type block_database::associate(
 // Populate transaction references, state is unchanged.
 bool block_database::update(const chain::block& block)
 {
-    auto element = hash_table_.find(block.hash());
+    return update(hash_table_.find(block.hash()).link(), block);
+}
+
+bool block_database::update(array_index link, const chain::block& block)
+{
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -276,19 +797,51 @@ bool block_database::update(const chain::block& block)
     BITCOIN_ASSERT(tx_start <= max_uint32);
     BITCOIN_ASSERT(tx_count <= max_uint16);
 
+    uint32_t height;
+    uint8_t state;
+    uint32_t checksum;
+
+    {
+        const auto memory = element.access();
+        height = layout::height::read(memory.buffer());
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        state = layout::state::read(memory.buffer());
+        checksum = layout::checksum::read(memory.buffer());
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    // The salt is random (nonzero) so that peers cannot predict short ids.
+    // An error code of an invalid block is not overwritten.
+    const auto salted = checksum == 0 && !is_failed(state);
+    const auto salt = static_cast<uint32_t>(pseudo_random::next(1,
+        max_uint32));
+
     const auto updater = [&](byte_serializer& serial)
     {
-        serial.skip(transactions_offset);
+        serial.skip(checksum_offset);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
         unique_lock lock(metadata_mutex_);
+
+        if (salted)
+            serial.write_4_bytes_little_endian(salt);
+        else
+            serial.skip(checksum_size);
+
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(tx_start));
         serial.write_2_bytes_little_endian(static_cast<uint16_t>(tx_count));
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(updater);
+    element.write(updater, block_size);
+
+    if (tx_count != 0)
+        set_candidate_state(element.link(), height, populated);
+
     return true;
 }
 
@@ -309,27 +862,35 @@ static uint8_t update_validation_state(uint8_t original, bool positive)
 // Promote unvalidated block to valid|invalid based on error value.
 bool block_database::validate(const hash_digest& hash, const code& error)
 {
-    auto element = hash_table_.find(hash);
+    return validate(hash_table_.find(hash).link(), error);
+}
+
+bool block_database::validate(array_index link, const code& error)
+{
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
 
+    uint32_t height;
     uint8_t state;
-    const auto reader = [&](byte_deserializer& deserial)
+
     {
-        deserial.skip(state_offset);
+        const auto memory = element.access();
+        height = layout::height::read(memory.buffer());
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
         shared_lock lock(metadata_mutex_);
-        state = deserial.read_byte();
+        state = layout::state::read(memory.buffer());
         ///////////////////////////////////////////////////////////////////////
-    };
+    }
+
+    const auto updated = update_validation_state(state, !error);
 
     const auto updater = [&](byte_serializer& serial)
     {
         serial.skip(state_offset);
-        const auto updated = update_validation_state(state, !error);
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
@@ -342,8 +903,9 @@ bool block_database::validate(const hash_digest& hash, const code& error)
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.read(reader);
-    element.write(updater);
+    element.write(updater, transactions_offset);
+    set_candidate_state(element.link(), height,
+        updated & block_state::validations);
     return true;
 }
 
@@ -379,16 +941,16 @@ void block_database::promote(const_element& element, bool positive,
     bool candidate)
 {
     uint8_t original;
-    const auto reader = [&](byte_deserializer& deserial)
+
     {
-        deserial.skip(state_offset);
+        const auto memory = element.access();
 
         // Critical Section.
         ///////////////////////////////////////////////////////////////////////
         shared_lock lock(metadata_mutex_);
-        original = deserial.read_byte();
+        original = layout::state::read(memory.buffer());
         ///////////////////////////////////////////////////////////////////////
-    };
+    }
 
     const auto updater = [&](byte_serializer& serial)
     {
@@ -402,12 +964,16 @@ void block_database::promote(const_element& element, bool positive,
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.read(reader);
-    element.write(updater);
+    element.write(updater, checksum_offset);
 }
 
 bool block_database::promote(const hash_digest& hash, size_t height,
     bool candidate)
+{
+    return promote(hash_table_.find(hash).link(), height, candidate);
+}
+
+bool block_database::promote(array_index link, size_t height, bool candidate)
 {
     BITCOIN_ASSERT(height != max_uint32);
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
@@ -416,7 +982,7 @@ bool block_database::promote(const hash_digest& hash, size_t height,
     if (height != manager.count())
         return false;
 
-    auto element = hash_table_.find(hash);
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -428,6 +994,11 @@ bool block_database::promote(const hash_digest& hash, size_t height,
 
 bool block_database::demote(const hash_digest& hash, size_t height,
     bool candidate)
+{
+    return demote(hash_table_.find(hash).link(), height, candidate);
+}
+
+bool block_database::demote(array_index link, size_t height, bool candidate)
 {
     BITCOIN_ASSERT(height != max_uint32);
     auto& manager = candidate ? candidate_index_ : confirmed_index_;
@@ -436,7 +1007,7 @@ bool block_database::demote(const hash_digest& hash, size_t height,
     if (height + 1u != manager.count())
         return false;
 
-    auto element = hash_table_.find(hash);
+    auto element = hash_table_.get(link);
 
     if (!element)
         return false;
@@ -446,6 +1017,58 @@ bool block_database::demote(const hash_digest& hash, size_t height,
     return true;
 }
 
+// All blocks are found before any is promoted, so a failure changes nothing.
+bool block_database::promote(const hash_list& hashes, size_t first_height,
+    bool candidate)
+{
+    BITCOIN_ASSERT(first_height + hashes.size() < max_uint32);
+    auto& manager = candidate ? candidate_index_ : confirmed_index_;
+
+    // Can only add to the top of an index (push).
+    if (first_height != manager.count())
+        return false;
+
+    // The chains of all hashes are walked as one prefetched batch.
+    auto elements = hash_table_.find(hashes);
+
+    for (const auto& element: elements)
+        if (!element)
+            return false;
+
+    std::vector<link_type> links;
+    links.reserve(elements.size());
+
+    for (auto& element: elements)
+    {
+        promote(element, true, candidate);
+        links.push_back(element.link());
+    }
+
+    push_links(links, first_height, manager);
+    return true;
+}
+
+// The indexed links are demoted without a hash lookup.
+bool block_database::demote(size_t fork_height, bool candidate)
+{
+    BITCOIN_ASSERT(fork_height < max_uint32);
+    auto& manager = candidate ? candidate_index_ : confirmed_index_;
+    const size_t count = manager.count();
+
+    // Can only remove from the top of an index (pop), above the fork.
+    if (fork_height >= count)
+        return false;
+
+    for (auto height = count - 1u; height > fork_height; --height)
+    {
+        auto element = hash_table_.get(read_link(height, manager));
+        promote(element, false, candidate);
+    }
+
+    pop_links(fork_height + 1u, manager);
+    return true;
+}
+
 // Index Utilities.
 // ----------------------------------------------------------------------------
 
@@ -482,19 +1105,276 @@ void block_database::pop_link(link_type DEBUG_ONLY(link), size_t height,
     BITCOIN_ASSERT(height + 1u == manager.count());
     BITCOIN_ASSERT(link == read_link(height, manager));
 
-    manager.set_count(static_cast<uint32_t>(height));
+    pop_links(height, manager);
 }
 
 void block_database::push_link(link_type link, size_t height,
     manager_type& manager)
+{
+    push_links({ link }, height, manager);
+}
+
+// Remove the links at and above the height.
+void block_database::pop_links(size_t height, manager_type& manager)
 {
     BITCOIN_ASSERT(height < max_uint32);
-    BITCOIN_ASSERT(height == manager.count());
+    BITCOIN_ASSERT(height <= manager.count());
 
-    manager.allocate(1);
-    const auto record = manager.get(static_cast<uint32_t>(height));
-    auto serial = make_unsafe_serializer(record->buffer());
-    serial.write_4_bytes_little_endian(link);
+    manager.set_count(static_cast<uint32_t>(height));
+
+    if (timed_ && &manager == &confirmed_index_)
+        times_.set_count(static_cast<uint32_t>(height));
+
+    if (stateful_ && &manager == &candidate_index_)
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(states_mutex_);
+        candidate_states_.resize(height);
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    if (!resident_)
+        return;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(resident_mutex_);
+    resident(manager).resize(height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Append the links from the first height, with one resize of the index.
+void block_database::push_links(const std::vector<link_type>& links,
+    size_t first_height, manager_type& manager)
+{
+    BITCOIN_ASSERT(first_height + links.size() < max_uint32);
+    BITCOIN_ASSERT(first_height == manager.count());
+
+    if (links.empty())
+        return;
+
+    manager.allocate(links.size());
+    auto height = static_cast<uint32_t>(first_height);
+
+    for (const auto link: links)
+    {
+        const auto record = manager.get(height++);
+        auto serial = make_unsafe_serializer(record->buffer());
+        serial.write_4_bytes_little_endian(link);
+        manager.dirty(record, sizeof(link_type));
+    }
+
+    if (timed_ && &manager == &confirmed_index_)
+        push_times(links, first_height);
+
+    if (stateful_ && &manager == &candidate_index_)
+    {
+        std::vector<uint8_t> states;
+        states.reserve(links.size());
+
+        for (const auto link: links)
+            states.push_back(read_state(link));
+
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(states_mutex_);
+        candidate_states_.insert(candidate_states_.end(), states.begin(),
+            states.end());
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    if (!resident_)
+        return;
+
+    // The records are read before the lock, they are not written once stored.
+    resident_chain entries;
+    entries.reserve(links.size());
+
+    for (const auto link: links)
+        entries.push_back(read_resident(link));
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(resident_mutex_);
+    auto& chain = resident(manager);
+    chain.insert(chain.end(), entries.begin(), entries.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Resident Utilities.
+// ----------------------------------------------------------------------------
+
+block_database::resident_chain& block_database::resident(
+    const manager_type& manager)
+{
+    return &manager == &candidate_index_ ? candidate_headers_ :
+        confirmed_headers_;
+}
+
+const block_database::resident_chain& block_database::resident(
+    const manager_type& manager) const
+{
+    return &manager == &candidate_index_ ? candidate_headers_ :
+        confirmed_headers_;
+}
+
+// The header and median time past lead the record.
+block_database::resident_header block_database::read_resident(
+    link_type link) const
+{
+    resident_header entry;
+    const auto element = hash_table_.get(link);
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        entry.header = deserial.read_forward<
+            std::tuple_size<decltype(entry.header)>::value>();
+        entry.median_time_past = deserial.read_4_bytes_little_endian();
+    };
+
+    element.read(reader);
+    entry.hash = element.key();
+    entry.link = link;
+    return entry;
+}
+
+// Reserve for growth, as pushes are at the rate of the chain.
+void block_database::load_resident(const manager_type& manager)
+{
+    const auto count = manager.count();
+    resident_chain chain;
+    chain.reserve(count + count / 8u);
+
+    for (size_t height = 0; height < count; ++height)
+        chain.push_back(read_resident(read_link(height, manager)));
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(resident_mutex_);
+    resident(manager).swap(chain);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// State Utilities.
+// ----------------------------------------------------------------------------
+
+// The candidate state of the block record.
+uint8_t block_database::read_state(link_type link) const
+{
+    uint8_t state;
+    size_t tx_count;
+    const auto memory = hash_table_.get(link).access();
+
+    {
+        // Critical Section.
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(metadata_mutex_);
+        state = layout::state::read(memory.buffer());
+        tx_count = layout::tx_count::read(memory.buffer());
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return (state & block_state::validations) | (tx_count == 0 ? 0 :
+        populated);
+}
+
+// Merge the state of the block if it is the candidate at its height.
+void block_database::set_candidate_state(link_type link, size_t height,
+    uint8_t state)
+{
+    if (!stateful_)
+        return;
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(states_mutex_);
+
+    if (height < candidate_states_.size() &&
+        read_link(height, candidate_index_) == link)
+        candidate_states_[height] |= state;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Reserve for growth, as pushes are at the rate of the chain.
+void block_database::load_states()
+{
+    const auto count = candidate_index_.count();
+    std::vector<uint8_t> states;
+    states.reserve(count + count / 8u);
+
+    for (size_t height = 0; height < count; ++height)
+        states.push_back(read_state(read_link(height, candidate_index_)));
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(states_mutex_);
+    candidate_states_.swap(states);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Time Utilities.
+// ----------------------------------------------------------------------------
+
+// The records of the links are read, they are not written once stored.
+void block_database::push_times(const std::vector<link_type>& links,
+    size_t first_height)
+{
+    BITCOIN_ASSERT(first_height == times_.count());
+
+    if (links.empty())
+        return;
+
+    uint32_t maximum = 0;
+
+    if (first_height != 0)
+    {
+        const auto record = times_.get(static_cast<uint32_t>(
+            first_height - 1u));
+        maximum = from_little_endian_unsafe<uint32_t>(record->buffer());
+    }
+
+    auto height = static_cast<uint32_t>(times_.allocate(links.size()));
+
+    for (const auto link: links)
+    {
+        uint32_t median_time_past;
+
+        {
+            const auto memory = hash_table_.get(link).access();
+            maximum = std::max(maximum,
+                layout::timestamp::read(memory.buffer()));
+            median_time_past = layout::median_time_past::read(
+                memory.buffer());
+        }
+
+        const auto record = times_.get(height++);
+        auto serial = make_unsafe_serializer(record->buffer());
+        serial.write_4_bytes_little_endian(maximum);
+        serial.write_4_bytes_little_endian(median_time_past);
+        times_.dirty(record, 2u * sizeof(uint32_t));
+    }
+}
+
+// Times not of the confirmed index (such as enabled since) are rebuilt.
+bool block_database::load_times()
+{
+    const auto count = confirmed_index_.count();
+    const auto indexed = times_.count();
+
+    if (indexed == count)
+        return true;
+
+    const auto first = indexed > count ? 0u : indexed;
+    times_.set_count(first);
+    std::vector<link_type> links;
+    links.reserve(count - first);
+
+    for (auto height = first; height < count; ++height)
+        links.push_back(read_link(height, confirmed_index_));
+
+    push_times(links, first);
+    times_.commit();
+    return true;
 }
 
 } // namespace database
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/filter_database.hpp>
+
+#include <cstddef>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/compact_filter.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
+// Record format [variable bytes, 44+ with key/link]:
+// ----------------------------------------------------------------------------
+// [ header:32     - const ]
+// [ filter:varint - const ]
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// Filters use a hash table index, O(1).
+filter_database::filter_database(const path& map_filename,
+    size_t table_minimum, size_t buckets, size_t expansion, bool huge_pages,
+    size_t reservation, size_t populate, size_t extent)
+  : hash_table_file_(map_filename, table_minimum, expansion, huge_pages ?
+        hash_table_header<index_type, link_type>::size(buckets) : 0,
+        reservation, populate, extent),
+    hash_table_(hash_table_file_, buckets)
+{
+}
+
+filter_database::~filter_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool filter_database::create()
+{
+    if (!hash_table_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return hash_table_.create();
+}
+
+bool filter_database::open()
+{
+    return
+        hash_table_file_.open() &&
+        hash_table_.start();
+}
+
+void filter_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+}
+
+bool filter_database::refresh()
+{
+    return hash_table_.refresh();
+}
+
+void filter_database::commit()
+{
+    hash_table_.commit();
+}
+
+bool filter_database::flush() const
+{
+    return hash_table_file_.flush();
+}
+
+bool filter_database::writeback(bool wait) const
+{
+    return hash_table_file_.writeback(wait);
+}
+
+bool filter_database::close()
+{
+    return hash_table_file_.close();
+}
+
+bool filter_database::advise(access_advice table)
+{
+    return hash_table_file_.advise(table);
+}
+
+storage_counters filter_database::counters() const
+{
+    return hash_table_file_.counters();
+}
+
+storage_residency filter_database::residency() const
+{
+    return hash_table_file_.residency(hash_table_.header_size());
+}
+
+table_statistics filter_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+bool filter_database::get(hash_digest& out_header, data_chunk& out_filter,
+    const hash_digest& block_hash) const
+{
+    const auto element = hash_table_.find(block_hash);
+
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        out_header = deserial.read_hash();
+        out_filter = deserial.read_bytes(deserial.read_size_little_endian());
+    };
+
+    element.read(reader);
+    return true;
+}
+
+bool filter_database::get_header(hash_digest& out_header,
+    const hash_digest& block_hash) const
+{
+    const auto element = hash_table_.find(block_hash);
+
+    if (!element)
+        return false;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        out_header = deserial.read_hash();
+    };
+
+    element.read(reader);
+    return true;
+}
+
+// Store.
+// ----------------------------------------------------------------------------
+
+bool filter_database::store(const block& block)
+{
+    const auto block_hash = block.hash();
+
+    // A block cataloged again (reorganized) retains its filter.
+    if (hash_table_.find(block_hash))
+        return true;
+
+    // The genesis filter header chains to the null hash.
+    const auto& parent = block.header().previous_block_hash();
+    auto previous = null_hash;
+
+    if (parent != null_hash && !get_header(previous, parent))
+        return false;
+
+    const auto filter = compact_filter::encode(block_hash,
+        compact_filter::elements(block));
+    const auto header = compact_filter::header(filter, previous);
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_hash(header);
+        serial.write_size_little_endian(filter.size());
+        serial.write_bytes(filter);
+    };
+
+    auto next = hash_table_.allocator();
+    next.create(block_hash, writer, hash_size +
+        variable_uint_size(filter.size()) + filter.size());
+    hash_table_.link(next);
+    return true;
+}
+
+} // namespace database
+} // namespace libbitcoin
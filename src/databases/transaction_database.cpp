@@ -18,13 +18,27 @@
  */
 #include <bitcoin/database/databases/transaction_database.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/concurrent.hpp>
 #include <bitcoin/database/define.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/result/transaction_result.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -33,6 +47,12 @@ using namespace bc::system;
 using namespace bc::system::chain;
 using namespace bc::system::machine;
 
+// The number of uncached prevouts looked up by each threadpool job.
+static const size_t prevout_batch = 64;
+
+// The number of transactions sized or serialized by each threadpool job.
+static const size_t transaction_batch = 16;
+
 // Record format (v4):
 // ----------------------------------------------------------------------------
 // [ height/forks/code:4 - atomic1  ] (code if invalid)
@@ -56,6 +76,27 @@ using namespace bc::system::machine;
 // [ locktime:varint      - const    ]
 // [ version:varint       - const    ]
 
+// Spend column (optional, enabled by configuration of a spends file):
+// ----------------------------------------------------------------------------
+// All records carry an output offset table (see transaction_result) which
+// links to the records of the outputs in the spends file. The spend state
+// within the tx is then not updated, so the tx is unwritten after store.
+// [
+//   [ candidate_spent:1 - atomic2 ]
+//   [ spender_height:4  - atomic2 ]
+// ]...
+
+// Undo record (optional, enabled by configuration of an undo file):
+// ----------------------------------------------------------------------------
+// Each block confirmed with the undo file has a record, linked from the undo
+// index at its height. The (sorted) spend positions of
+// its prevouts are those written at confirmation, their prior state is
+// unspent (no double spend), so unconfirm replays the record as unverified.
+// [ spend_count:4 ]
+// [ [ spend:8 ] ]...
+// [ position_count:4 ]
+// [ [ position:8 ][ link:8 ] ]...
+
 // Record format (v3.3):
 // ----------------------------------------------------------------------------
 // [ height/forks:4         - atomic1 ]
@@ -84,13 +125,63 @@ static constexpr auto metadata_size = height_size + position_size +
 
 static constexpr auto no_time = 0u;
 
+transaction_database::options::options()
+  : huge_pages(false),
+    reservation(0),
+    populate(0),
+    extent(0),
+    fingerprints(false),
+    filter_size(0),
+    offsets_minimum(0),
+    compress_scripts(false),
+    prune_scripts(false),
+    cache_bytes(0),
+    cache_granular(false),
+    cache_eviction(cache_policy::fifo),
+    utxos(nullptr),
+    misses(0)
+{
+}
+
 // Transactions uses a hash table index, O(1).
 transaction_database::transaction_database(const path& map_filename,
     size_t table_minimum, size_t buckets, size_t expansion,
-    size_t cache_capacity)
-  : hash_table_file_(map_filename, table_minimum, expansion),
-    hash_table_(hash_table_file_, buckets),
-    cache_(cache_capacity)
+    size_t cache_capacity, const options& features)
+  : buckets_size_(hash_table_header<index_type, link_type>::size(buckets,
+        features.fingerprints)),
+    hash_table_file_(map_filename, table_minimum, expansion,
+        features.huge_pages ? buckets_size_ : 0, features.reservation,
+        features.populate, features.extent),
+    hash_table_(hash_table_file_, buckets, features.fingerprints ?
+        bucket_tags::fingerprint : bucket_tags::none),
+    columnar_(!features.spends_filename.empty()),
+    spends_file_(features.spends_filename, 1, expansion, 0,
+        features.reservation, features.populate, features.extent),
+    spends_(spends_file_, 0, transaction_result::spend_record_size),
+    segregated_(!features.witnesses_filename.empty()),
+    witnesses_file_(features.witnesses_filename, 1, expansion, 0,
+        features.reservation, features.populate, features.extent),
+    witnesses_(witnesses_file_, 0),
+    undoable_(!features.undo_filename.empty()),
+    undo_file_(features.undo_filename, 1, expansion, 0,
+        features.reservation, features.populate, features.extent),
+    undo_(undo_file_, 0),
+    undo_index_file_(features.undo_index_filename, 1, expansion, 0,
+        features.reservation, features.populate, features.extent),
+    undo_index_(undo_index_file_, 0, sizeof(link_type)),
+    cache_(cache_capacity, features.cache_bytes,
+        unspent_outputs::default_shards, features.cache_granular,
+        features.cache_eviction),
+    cache_filename_(features.cache_filename),
+    cache_loading_(false),
+    utxos_(features.utxos),
+    misses_(features.misses),
+    filter_filename_(features.filter_filename),
+    filter_(features.filter_size),
+    offsets_minimum_(features.offsets_minimum),
+    compress_scripts_(features.compress_scripts),
+    prune_scripts_(features.prune_scripts),
+    worker_nodes_(0)
 {
 }
 
@@ -104,34 +195,318 @@ transaction_database::~transaction_database()
 
 bool transaction_database::create()
 {
-    if (!hash_table_file_.open())
+    if (!hash_table_file_.open() || (columnar_ && !spends_file_.open()) ||
+        (segregated_ && !witnesses_file_.open()) ||
+        (undoable_ && (!undo_file_.open() || !undo_index_file_.open())))
         return false;
 
+    // The filter of an empty table is empty.
+    filter_.clear();
+
     // No need to call open after create.
     return
-        hash_table_.create();
+        hash_table_.create() &&
+        (!columnar_ || spends_.create()) &&
+        (!segregated_ || witnesses_.create()) &&
+        (!undoable_ || (undo_.create() && undo_index_.create()));
 }
 
 bool transaction_database::open()
 {
-    return
-        hash_table_file_.open() &&
-        hash_table_.start();
+    if (!hash_table_file_.open() || !hash_table_.start())
+        return false;
+
+    if (columnar_ && (!spends_file_.open() || !spends_.start()))
+        return false;
+
+    if (segregated_ && (!witnesses_file_.open() || !witnesses_.start()))
+        return false;
+
+    if (undoable_ && (!undo_file_.open() || !undo_.start() ||
+        !undo_index_file_.open() || !undo_index_.start()))
+        return false;
+
+    if (filter_.disabled())
+        return true;
+
+    // The sidecar is consumed, so a failure to close cleanly forces rebuild.
+    const auto tag = hash_table_file_.logical();
+    const auto loaded = filter_.load(filter_filename_, tag);
+    boost::system::error_code ec;
+    boost::filesystem::remove(filter_filename_, ec);
+
+    if (loaded)
+        return true;
+
+    // Rebuilding walks every chain of the table, which is slow when large.
+    LOG_INFO(LOG_DATABASE)
+        << "Rebuilding transaction filter [" << filter_.size() << "]";
+
+    hash_table_.for_each([&](const hash_digest& hash)
+    {
+        filter_.insert(hash);
+    });
+
+    return true;
 }
 
 void transaction_database::commit()
 {
     hash_table_.commit();
+
+    if (columnar_)
+        spends_.commit();
+
+    if (segregated_)
+        witnesses_.commit();
+
+    if (undoable_)
+    {
+        undo_.commit();
+        undo_index_.commit();
+    }
 }
 
 bool transaction_database::flush() const
 {
-    return hash_table_file_.flush();
+    return
+        hash_table_file_.flush() &&
+        (!columnar_ || spends_file_.flush()) &&
+        (!segregated_ || witnesses_file_.flush()) &&
+        (!undoable_ || (undo_file_.flush() && undo_index_file_.flush()));
+}
+
+bool transaction_database::checkpoint() const
+{
+    return
+        hash_table_file_.checkpoint() &&
+        (!columnar_ || spends_file_.checkpoint()) &&
+        (!segregated_ || witnesses_file_.checkpoint()) &&
+        (!undoable_ ||
+            (undo_file_.checkpoint() && undo_index_file_.checkpoint()));
+}
+
+void transaction_database::attach(write_log& log)
+{
+    hash_table_file_.attach(log);
+
+    if (columnar_)
+        spends_file_.attach(log);
+
+    if (segregated_)
+        witnesses_file_.attach(log);
+
+    if (undoable_)
+    {
+        undo_file_.attach(log);
+        undo_index_file_.attach(log);
+    }
+}
+
+void transaction_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+
+    if (columnar_)
+        spends_file_.set_read_only();
+
+    if (segregated_)
+        witnesses_file_.set_read_only();
+
+    if (undoable_)
+    {
+        undo_file_.set_read_only();
+        undo_index_file_.set_read_only();
+    }
+}
+
+bool transaction_database::refresh()
+{
+    return
+        hash_table_.refresh() &&
+        (!columnar_ || spends_.refresh()) &&
+        (!segregated_ || witnesses_.refresh()) &&
+        (!undoable_ || (undo_.refresh() && undo_index_.refresh()));
+}
+
+bool transaction_database::writeback(bool wait) const
+{
+    return
+        hash_table_file_.writeback(wait) &&
+        (!columnar_ || spends_file_.writeback(wait)) &&
+        (!segregated_ || witnesses_file_.writeback(wait)) &&
+        (!undoable_ ||
+            (undo_file_.writeback(wait) && undo_index_file_.writeback(wait)));
+}
+
+// The cache is thread safe, so reads may hit it while it loads.
+void transaction_database::load_cache(size_t top_height)
+{
+    if (cache_filename_.empty() || cache_.disabled())
+        return;
+
+    wait_cache();
+    cache_loading_ = true;
+    const auto tag = hash_table_file_.logical();
+
+    cache_loader_ = std::thread([=]()
+    {
+        // The sidecar is consumed, so a failure to close cleanly discards it.
+        const auto loaded = cache_.load(cache_filename_, tag, top_height);
+        boost::system::error_code ec;
+        boost::filesystem::remove(cache_filename_, ec);
+
+        LOG_INFO(LOG_DATABASE)
+            << "Output cache " << (loaded ? "loaded [" : "discarded [")
+            << cache_.size() << "]";
+    });
+}
+
+bool transaction_database::save_cache(size_t top_height)
+{
+    wait_cache();
+
+    return cache_filename_.empty() || cache_.disabled() ||
+        hash_table_file_.closed() ||
+        cache_.save(cache_filename_, hash_table_file_.logical(), top_height);
+}
+
+// private
+void transaction_database::wait_cache()
+{
+    if (!cache_loading_)
+        return;
+
+    std::unique_lock<std::mutex> lock(cache_mutex_);
+
+    if (cache_loader_.joinable())
+        cache_loader_.join();
+
+    cache_loading_ = false;
 }
 
 bool transaction_database::close()
 {
-    return hash_table_file_.close();
+    wait_cache();
+
+    // A filter that cannot be saved is rebuilt at the next open.
+    if (!filter_.disabled() && !hash_table_file_.closed())
+        filter_.save(filter_filename_, hash_table_file_.logical());
+
+    return
+        hash_table_file_.close() &&
+        (!columnar_ || spends_file_.close()) &&
+        (!segregated_ || witnesses_file_.close()) &&
+        (!undoable_ || (undo_file_.close() && undo_index_file_.close()));
+}
+
+bool transaction_database::advise(access_advice table)
+{
+    return hash_table_file_.advise(table);
+}
+
+bool transaction_database::place(memory_placement table, uint64_t nodes)
+{
+    // Workers are pinned only where page placement is confined to the nodes.
+    worker_nodes_ = table == memory_placement::bind ? nodes : 0;
+
+    return
+        hash_table_file_.place(table, nodes) &&
+        (!columnar_ || spends_file_.place(table, nodes)) &&
+        (!segregated_ || witnesses_file_.place(table, nodes));
+}
+
+bool transaction_database::prefault(bool pin)
+{
+    // The spend column is small and hot, so it is prefaulted in full.
+    return
+        hash_table_file_.prefault(buckets_size_, pin) &&
+        (!columnar_ || spends_file_.prefault(max_size_t, pin));
+}
+
+storage_counters transaction_database::counters() const
+{
+    return hash_table_file_.counters();
+}
+
+storage_residency transaction_database::residency() const
+{
+    return hash_table_file_.residency(buckets_size_);
+}
+
+size_t transaction_database::cache_bytes() const
+{
+    return cache_.bytes();
+}
+
+latency_histogram::values transaction_database::output_latencies() const
+{
+    return output_latency_.read();
+}
+
+table_statistics transaction_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+bool transaction_database::rehash(storage& file, size_t buckets,
+    bool fingerprints) const
+{
+    slab_map target(file, buckets, fingerprints ? bucket_tags::fingerprint :
+        bucket_tags::none);
+
+    return hash_table_.rehash(target);
+}
+
+// The allocation of each tx is the distance to the next by link, as slabs are
+// allocated contiguously. The copied txs carry their metadata and the links
+// of their spend column and witnesses records, which are retained.
+bool transaction_database::defragment(storage& file, size_t buckets,
+    bool fingerprints, const relink_walker& walker)
+{
+    slab_map target(file, buckets, fingerprints ? bucket_tags::fingerprint :
+        bucket_tags::none);
+
+    if (!target.create())
+        return false;
+
+    const auto links = hash_table_.links();
+    const auto end = hash_table_.payload_size();
+
+    const auto relinker = [&](file_offset& link)
+    {
+        const auto it = std::lower_bound(links.begin(), links.end(), link);
+
+        if (it == links.end() || *it != link)
+            return false;
+
+        const auto copied = target.find(hash_table_.get(link).key());
+
+        if (copied)
+        {
+            link = copied.link();
+            return true;
+        }
+
+        const auto next = std::next(it);
+        const auto size = (next == links.end() ? end : *next) - link;
+        link = hash_table_.copy(link, size, target);
+        return link != slab_map::not_found;
+    };
+
+    if (!walker(relinker))
+        return false;
+
+    target.commit();
+
+    // Heights confirmed without undo records unconfirm by lookups.
+    if (undoable_)
+    {
+        undo_index_.set_count(0);
+        undo_index_.commit();
+    }
+
+    return true;
 }
 
 // Queries.
@@ -140,12 +515,29 @@ bool transaction_database::close()
 transaction_result transaction_database::get(file_offset link) const
 {
     // This is not guarded for an invalid offset.
-    return { hash_table_.get(link), metadata_mutex_ };
+    return { hash_table_.get(link), metadata_sequence_, spends_, witnesses_ };
 }
 
 transaction_result transaction_database::get(const hash_digest& hash) const
 {
-    return { hash_table_.find(hash), metadata_mutex_ };
+    // A filter miss is definitive, so the table is not read.
+    if (!filter_.contains(hash))
+        return { hash_table_.terminator(), metadata_sequence_, spends_,
+            witnesses_ };
+
+    return { hash_table_.find(hash), metadata_sequence_, spends_, witnesses_ };
+}
+
+std::vector<transaction_result> transaction_database::get(
+    const hash_list& hashes, bool advise) const
+{
+    std::vector<transaction_result> out;
+    out.reserve(hashes.size());
+
+    for (const auto& element: hash_table_.find(hashes, advise))
+        out.push_back({ element, metadata_sequence_, spends_, witnesses_ });
+
+    return out;
 }
 
 void transaction_database::get_block_metadata(const chain::transaction& tx,
@@ -214,19 +606,120 @@ void transaction_database::get_pool_metadata(const chain::transaction& tx,
 bool transaction_database::get_output(const output_point& point,
     size_t fork_height) const
 {
-    static const auto not_spent = output::validation::not_spent;
-    static const auto unconfirmed = transaction_result::unconfirmed;
-    auto& prevout = point.metadata;
+    BCD_TRACE_SCOPE(get_output);
 
     // If the input is a coinbase there is no prevout to populate.
     if (point.is_null())
         return false;
 
+    const latency_histogram::timer timer(output_latency_);
+
     if (cache_.populate(point, fork_height))
         return true;
 
+    if (utxos_ != nullptr && utxos_->populate(point, fork_height))
+        return true;
+
+    // A repeated probe of a missing tx (orphan) is not looked up again.
+    if (misses_.contains(point.hash()))
+        return false;
+
+    const auto sequence = misses_.sequence();
     const auto result = get(point.hash());
 
+    if (!result)
+    {
+        misses_.insert(point.hash(), sequence);
+        return false;
+    }
+
+    return get_output(point, result, fork_height);
+}
+
+// Cached or unspent table prevouts are populated in place, the remainder are
+// looked up in batches by the threadpool and this call returns once all are
+// populated.
+void transaction_database::get_outputs(const block& block, size_t fork_height,
+    threadpool& pool) const
+{
+    std::vector<const output_point*> points;
+
+    for (const auto& tx: block.transactions())
+        for (const auto& input: tx.inputs())
+            if (!input.previous_output().is_null() &&
+                !cache_.populate(input.previous_output(), fork_height) &&
+                (utxos_ == nullptr ||
+                    !utxos_->populate(input.previous_output(), fork_height)))
+                points.push_back(&input.previous_output());
+
+    const auto populate = [&](size_t first, size_t last)
+    {
+        hash_list hashes;
+        hashes.reserve(last - first);
+
+        for (auto point = first; point < last; ++point)
+            hashes.push_back(points[point]->hash());
+
+        // The batch overlaps the page faults of its lookups.
+        const auto results = get(hashes, true);
+
+        for (auto point = first; point < last; ++point)
+            get_output(*points[point], results[point - first], fork_height);
+    };
+
+    concurrent(pool, points.size(), prevout_batch, populate, worker_nodes_);
+}
+
+// Readahead is not advised, as that is a system call for each record.
+void transaction_database::prefetch(const transaction_links& links) const
+{
+    for (size_t position = 0; position < links.size(); ++position)
+        hash_table_.prefetch(links[position], false);
+}
+
+// Each tx is read once for all of its uncached prevouts in the block, in
+// batches that overlap the page faults of their lookups.
+void transaction_database::prefetch(const block& block)
+{
+    if (cache_.disabled())
+        return;
+
+    wait_cache();
+    std::map<hash_digest, std::vector<uint32_t>> prevouts;
+
+    for (const auto& tx: block.transactions())
+        for (const auto& input: tx.inputs())
+            if (!input.previous_output().is_null() &&
+                !cache_.contains(input.previous_output()))
+                prevouts[input.previous_output().hash()].push_back(
+                    input.previous_output().index());
+
+    hash_list hashes;
+    hashes.reserve(prevouts.size());
+
+    for (const auto& prevout: prevouts)
+        hashes.push_back(prevout.first);
+
+    for (size_t first = 0; first < hashes.size(); first += prevout_batch)
+    {
+        const auto last = std::min(first + prevout_batch, hashes.size());
+        const hash_list batch(hashes.begin() + first, hashes.begin() + last);
+        const auto results = get(batch, true);
+
+        for (size_t index = 0; index < batch.size(); ++index)
+            prevout(results[index], prevouts[batch[index]]);
+    }
+}
+
+// private
+// Metadata should be defaulted by caller.
+bool transaction_database::get_output(const output_point& point,
+    const transaction_result& result, size_t fork_height) const
+{
+    static const auto not_spent = output::validation::not_spent;
+    static const auto unconfirmed = transaction_result::unconfirmed;
+    auto& prevout = point.metadata;
+
     if (!result)
         return false;
 
@@ -267,6 +760,55 @@ bool transaction_database::get_output(const output_point& point,
     return true;
 }
 
+// private
+// The entry is checked against the store once cached. Spends are written to
+// the store before their outputs are removed from the cache, so a spend since
+// the read is either seen by the check or removes the entry after it.
+void transaction_database::prefetch(const transaction_result& result,
+    const std::vector<uint32_t>& indexes)
+{
+    static const auto not_spent = output::validation::not_spent;
+    static const auto unconfirmed = transaction_result::unconfirmed;
+
+    // The genesis coinbase output is not spendable (see get_output).
+    if (!result || result.height() == 0)
+        return;
+
+    const auto unspent = [&](const transaction_result& tx,
+        unspent_transaction::output_map& out)
+    {
+        for (const auto index: indexes)
+        {
+            auto output = tx.output(index);
+
+            if (output.is_valid() &&
+                output.metadata.confirmed_spent_height == not_spent)
+                out.emplace(index, std::move(output));
+        }
+    };
+
+    unspent_transaction::output_map outputs;
+    unspent(result, outputs);
+
+    if (outputs.empty())
+        return;
+
+    const auto hash = result.hash();
+    const auto position = result.position();
+    cache_.add(hash, outputs, result.height(), result.median_time_past(),
+        position == 0, position != unconfirmed);
+
+    const auto current = get(hash);
+    unspent_transaction::output_map remaining;
+    unspent(current, remaining);
+
+    if (current.position() == position && remaining.size() == outputs.size())
+        return;
+
+    for (const auto& output: outputs)
+        cache_.remove(output_point{ hash, output.first });
+}
+
 // Store.
 // ----------------------------------------------------------------------------
 
@@ -274,6 +816,7 @@ bool transaction_database::get_output(const output_point& point,
 bool transaction_database::store(const chain::transaction& tx, uint32_t forks)
 {
     // Cache the unspent outputs of the unconfirmed transaction.
+    wait_cache();
     cache_.add(tx, forks, no_time, false);
 
     return storize(tx, forks, no_time, transaction_result::unconfirmed);
@@ -290,46 +833,326 @@ bool transaction_database::store(const transaction::list& transactions)
     return true;
 }
 
-// private
-bool transaction_database::storize(const chain::transaction& tx, size_t height,
-    uint32_t median_time_past, size_t position)
+// Store each tx and set tx link metadata for all, as one bulk write.
+// Hashing, sizing and serialization are distributed over the threadpool.
+bool transaction_database::store(const transaction::list& transactions,
+    threadpool& pool)
 {
-    BITCOIN_ASSERT(height <= max_uint32);
-    BITCOIN_ASSERT(position <= max_uint16);
+    static const auto unlinked = transaction::validation::unlinked;
+    const auto count = transactions.size();
+    std::vector<size_t> sizes(count);
+
+    // Hashes and sizes are cached by each tx, so compute them concurrently.
+    const auto measure = [&](size_t first, size_t last)
+    {
+        for (auto index = first; index < last; ++index)
+        {
+            const auto& tx = transactions[index];
+            tx.hash();
+            sizes[index] = record_size(tx);
+        }
+    };
+
+    concurrent(pool, count, transaction_batch, measure, worker_nodes_);
+
+    hash_list hashes;
+    std::vector<size_t> unresolved;
 
     // Assume the caller has not tested for existence (true for block update).
-    if (tx.metadata.link == transaction::validation::unlinked)
+    for (size_t index = 0; index < count; ++index)
     {
-        const auto element = hash_table_.find(tx.hash());
+        const auto& tx = transactions[index];
 
-        if (element)
-            tx.metadata.link = element.link();
+        if (tx.metadata.link == unlinked && filter_.contains(tx.hash()))
+        {
+            hashes.push_back(tx.hash());
+            unresolved.push_back(index);
+        }
     }
 
-    // This allows address indexer to bypass indexing despite link existence.
-    tx.metadata.existed = tx.metadata.link != transaction::validation::unlinked;
+    const auto found = hash_table_.find(hashes, true);
 
-    // If the transaction already exists just return (with link set).
-    if (tx.metadata.existed)
-        return true;
+    for (size_t row = 0; row < found.size(); ++row)
+        if (found[row])
+            transactions[unresolved[row]].metadata.link = found[row].link();
 
-    const auto writer = [&](byte_serializer& serial)
+    std::vector<size_t> created;
+    std::vector<std::pair<size_t, size_t>> repeated;
+    std::unordered_map<hash_digest, size_t> positions;
+    size_t total = 0;
+
+    for (size_t index = 0; index < count; ++index)
     {
-        serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
-        serial.write_2_bytes_little_endian(static_cast<uint16_t>(position));
-        serial.write_byte(transaction_result::candidate_false);
-        serial.write_4_bytes_little_endian(median_time_past);
-        tx.to_data(serial, false, true);
-    };
+        const auto& tx = transactions[index];
 
-    // Transactions are variable-sized.
-    const auto size = metadata_size + tx.serialized_size(false, true);
+        // This allows address indexer to bypass indexing despite existence.
+        tx.metadata.existed = tx.metadata.link != unlinked;
 
-    // Write the new transaction.
-    auto next = hash_table_.allocator();
-    tx.metadata.link = next.create(tx.hash(), writer, size);
-    hash_table_.link(next);
-    return true;
+        if (tx.metadata.existed)
+            continue;
+
+        // A repeated tx exists once its first instance is stored.
+        const auto position = positions.emplace(tx.hash(), index);
+
+        if (!position.second)
+        {
+            tx.metadata.existed = true;
+            repeated.emplace_back(index, position.first->second);
+            continue;
+        }
+
+        created.push_back(index);
+        total += slab_map::value_type::size(sizes[index]);
+    }
+
+    if (created.empty())
+        return true;
+
+    // Reserve one contiguous region for all new transactions.
+    auto link = hash_table_.allocate(total);
+
+    if (link == manager_type::not_allocated)
+        return false;
+
+    for (const auto index: created)
+    {
+        transactions[index].metadata.link = link;
+        link += slab_map::value_type::size(sizes[index]);
+    }
+
+    for (const auto& repeat: repeated)
+        transactions[repeat.first].metadata.link =
+            transactions[repeat.second].metadata.link;
+
+    std::atomic<bool> failed(false);
+
+    // Serialize each new tx into its offset of the region concurrently.
+    const auto serialize = [&](size_t first, size_t last)
+    {
+        for (auto row = first; row < last; ++row)
+        {
+            const auto& tx = transactions[created[row]];
+            const auto spends = store_spends(tx);
+            const auto witnesses = store_witnesses(tx);
+
+            // The region is left unlinked, as upon failure to allocate it.
+            if (segregate(tx) && witnesses == manager_type::not_allocated)
+            {
+                failed = true;
+                return;
+            }
+            const auto writer = [&](byte_serializer& serial)
+            {
+                write_record(serial, tx, rule_fork::unverified, no_time,
+                    transaction_result::unconfirmed, spends, witnesses);
+            };
+
+            hash_table_.allocator(tx.metadata.link).populate(tx.hash(),
+                writer, sizes[created[row]]);
+        }
+    };
+
+    concurrent(pool, created.size(), transaction_batch, serialize,
+        worker_nodes_);
+
+    if (failed)
+        return false;
+
+    // Link in block order, each filtered before it becomes reachable.
+    for (const auto index: created)
+    {
+        const auto& tx = transactions[index];
+        auto element = hash_table_.allocator(tx.metadata.link);
+        filter_.insert(tx.hash());
+        hash_table_.link(element);
+        misses_.erase(tx.hash());
+    }
+
+    return true;
+}
+
+// private
+bool transaction_database::storize(const chain::transaction& tx, size_t height,
+    uint32_t median_time_past, size_t position)
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+    BITCOIN_ASSERT(position <= max_uint16);
+
+    // Assume the caller has not tested for existence (true for block update).
+    if (tx.metadata.link == transaction::validation::unlinked &&
+        filter_.contains(tx.hash()))
+    {
+        const auto element = hash_table_.find(tx.hash());
+
+        if (element)
+            tx.metadata.link = element.link();
+    }
+
+    // This allows address indexer to bypass indexing despite link existence.
+    tx.metadata.existed = tx.metadata.link != transaction::validation::unlinked;
+
+    // If the transaction already exists just return (with link set).
+    if (tx.metadata.existed)
+        return true;
+
+    const auto spends = store_spends(tx);
+    const auto witnesses = store_witnesses(tx);
+
+    if (segregate(tx) && witnesses == manager_type::not_allocated)
+        return false;
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        write_record(serial, tx, height, median_time_past, position, spends,
+            witnesses);
+    };
+
+    // Transactions are variable-sized.
+    const auto size = record_size(tx);
+
+    // Write the new transaction, filtered before it becomes reachable.
+    auto next = hash_table_.allocator();
+    tx.metadata.link = next.create(tx.hash(), writer, size);
+    filter_.insert(tx.hash());
+    hash_table_.link(next);
+    misses_.erase(tx.hash());
+    return true;
+}
+
+// private
+bool transaction_database::tabled(const chain::transaction& tx) const
+{
+    // The spend column is linked from the offset table, so requires it.
+    // Compressed scripts, segregated witnesses and pruning also require it.
+    return columnar_ || compress_scripts_ || prune_scripts_ ||
+        segregate(tx) ||
+        (offsets_minimum_ != 0 && tx.outputs().size() >= offsets_minimum_);
+}
+
+// private
+bool transaction_database::segregate(const chain::transaction& tx) const
+{
+    return segregated_ && tx.is_segregated();
+}
+
+// private
+size_t transaction_database::record_size(const chain::transaction& tx) const
+{
+    const auto table = tabled(tx) ?
+        transaction_result::offsets_size(tx.outputs().size()) : 0;
+
+    return metadata_size + table +
+        transaction_result::stored_size(tx, compress_scripts_, segregate(tx));
+}
+
+// private
+void transaction_database::write_record(byte_serializer& serial,
+    const chain::transaction& tx, size_t height, uint32_t median_time_past,
+    size_t position, link_type spends, link_type witnesses) const
+{
+    const auto segregated = witnesses != manager_type::not_allocated;
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    serial.write_2_bytes_little_endian(static_cast<uint16_t>(position));
+    serial.write_byte(transaction_result::candidate_false);
+    serial.write_4_bytes_little_endian(median_time_past);
+
+    if (tabled(tx))
+        transaction_result::write_offsets(serial, tx, spends,
+            compress_scripts_, witnesses);
+
+    transaction_result::write_transaction(serial, tx, compress_scripts_,
+        segregated);
+}
+
+// private
+transaction_database::link_type transaction_database::store_spends(
+    const chain::transaction& tx)
+{
+    if (!columnar_)
+        return spend_manager::not_allocated;
+
+    const auto& outputs = tx.outputs();
+    const auto first = spends_.allocate(outputs.size());
+
+    for (size_t index = 0; index < outputs.size(); ++index)
+    {
+        const auto& metadata = outputs[index].metadata;
+
+        // The guard must remain in scope until the end of the block.
+        const auto memory = spends_.access(first + index);
+        auto serial = make_unsafe_serializer(memory.buffer());
+        serial.write_byte(metadata.candidate_spent ?
+            transaction_result::candidate_true :
+            transaction_result::candidate_false);
+        serial.write_4_bytes_little_endian(metadata.confirmed_spent_height);
+        spends_.dirty(memory, transaction_result::spend_record_size);
+    }
+
+    return first;
+}
+
+// private
+transaction_database::link_type transaction_database::store_witnesses(
+    const chain::transaction& tx)
+{
+    if (!segregate(tx))
+        return manager_type::not_allocated;
+
+    size_t size = 0;
+    for (const auto& input: tx.inputs())
+        size += input.witness().serialized_size(true);
+
+    const auto slab = witnesses_.allocate(size);
+
+    if (slab == manager_type::not_allocated)
+        return slab;
+
+    // The guard must remain in scope until the end of the block.
+    const auto memory = witnesses_.access(slab);
+    auto serial = make_unsafe_serializer(memory.buffer());
+
+    for (const auto& input: tx.inputs())
+        input.witness().to_data(serial, true);
+
+    witnesses_.dirty(memory, size);
+    return slab;
+}
+
+// private
+void transaction_database::write_candidate_spent(link_type spend,
+    bool positive)
+{
+    const auto memory = spends_.access(spend);
+    auto serial = make_unsafe_serializer(memory.buffer());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    metadata_sequence_.begin_write(spend);
+    serial.write_byte(positive ? transaction_result::candidate_true :
+        transaction_result::candidate_false);
+    metadata_sequence_.end_write(spend);
+    ///////////////////////////////////////////////////////////////////////////
+
+    spends_.dirty(memory, candidate_spent_size);
+}
+
+// private
+void transaction_database::write_spender_height(link_type spend,
+    size_t spender_height)
+{
+    const auto memory = spends_.access(spend);
+    auto serial = make_unsafe_serializer(memory.buffer() +
+        candidate_spent_size);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    metadata_sequence_.begin_write(spend);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(spender_height));
+    metadata_sequence_.end_write(spend);
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The height follows the flag, so dirty the record through the height.
+    spends_.dirty(memory, candidate_spent_size + height_size);
 }
 
 // Candidate/Uncandidate.
@@ -369,44 +1192,35 @@ bool transaction_database::candidate_spend(const chain::output_point& point,
     if (!element)
         return false;
 
-    size_t outputs;
-    const auto reader = [&](byte_deserializer& deserial)
-    {
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        shared_lock lock(metadata_mutex_);
-        deserial.skip(metadata_size);
-        outputs = deserial.read_size_little_endian();
-        ///////////////////////////////////////////////////////////////////////
-    };
-
-    element.read(reader);
+    size_t offset;
+    link_type spend;
+    size_t height;
+    uint16_t position;
 
-    // The index is not in the transaction.
-    if (point.index() >= outputs)
+    // Candidate spend is not limited by the confirmation state of the tx.
+    if (!get_spend(element, point, offset, spend, height, position))
         return false;
 
-    const auto writer = [&](byte_serializer& serial)
+    if (spend != spend_manager::not_allocated)
     {
-        serial.skip(metadata_size);
-        serial.read_size_little_endian();
+        write_candidate_spent(spend, positive);
+        return true;
+    }
 
-        // Skip outputs until the target output.
-        for (auto output = 0u; output < point.index(); ++output)
-        {
-            serial.skip(spend_size);
-            serial.skip(serial.read_size_little_endian());
-        }
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.skip(offset);
 
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(metadata_mutex_);
+        metadata_sequence_.begin_write(element.link());
         serial.write_byte(positive ? transaction_result::candidate_true :
             transaction_result::candidate_false);
+        metadata_sequence_.end_write(element.link());
         ///////////////////////////////////////////////////////////////////////
     };
 
-    element.write(writer);
+    element.write(writer, offset + candidate_spent_size);
     return true;
 }
 
@@ -415,17 +1229,19 @@ bool transaction_database::candidize(link_type link, bool positive)
 {
     const auto writer = [&](byte_serializer& serial)
     {
+        serial.skip(height_size + position_size);
+
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(metadata_mutex_);
-        serial.skip(height_size + position_size);
+        metadata_sequence_.begin_write(link);
         serial.write_byte(positive ? transaction_result::candidate_true :
             transaction_result::candidate_false);
+        metadata_sequence_.end_write(link);
         ///////////////////////////////////////////////////////////////////////
     };
 
     const auto element = hash_table_.get(link);
-    element.write(writer);
+    element.write(writer, height_size + position_size + candidate_size);
     return true;
 }
 
@@ -459,32 +1275,195 @@ bool transaction_database::confirm(file_offset link, size_t height,
 bool transaction_database::confirm(const block& block, size_t height,
     uint32_t median_time_past)
 {
-    uint32_t position = 0;
+    link_list links;
+    links.reserve(block.transactions().size());
+
+    for (const auto& tx: block.transactions())
+        links.push_back(tx.metadata.link);
+
+    if (!confirm(links, height, median_time_past))
+        return false;
+
+    wait_cache();
+
+    // Candidates are not cached but this only affects branch length > 1.
+    // Promote the cached outputs of pooled txs, otherwise cache the outputs.
+    for (const auto& tx: block.transactions())
+        if (!cache_.promote(tx, height, median_time_past))
+            cache_.add(tx, height, median_time_past, true);
+
+    // Outputs spent within the block were cached above, so are removed.
+    std::unordered_set<hash_digest> hashes;
+    hashes.reserve(block.transactions().size());
+
+    for (const auto& tx: block.transactions())
+        hashes.insert(tx.hash());
+
+    for (const auto& tx: block.transactions())
+        for (const auto& input: tx.inputs())
+            if (hashes.count(input.previous_output().hash()) != 0)
+                cache_.remove(input.previous_output());
+
+    return true;
+}
+
+bool transaction_database::confirm(const link_list& links, size_t height,
+    uint32_t median_time_past)
+{
+    BITCOIN_ASSERT(links.size() <= max_uint16);
+
+    if (!confirmed_spends(links, height))
+        return false;
+
+    // Promote the txs, in their positions within the block.
+    for (size_t position = 0; position < links.size(); ++position)
+        if (!confirmize(links[position], height, median_time_past, position))
+            return false;
+
+    return true;
+}
+
+bool transaction_database::unconfirm(const block& block)
+{
     for (const auto& tx: block.transactions())
     {
-        if (!confirm(tx.metadata.link, height, median_time_past, position++))
+        if (!confirm(tx.metadata.link, rule_fork::unverified, no_time,
+            transaction_result::unconfirmed))
             return false;
 
-        // Candidates are not cached but this only affects branch length > 1.
-        // Cache the unspent outputs of the confirmed transaction.
-        cache_.add(tx, height, median_time_past, true);
+        // Uncache the unspent outputs of the unconfirmed transaction.
+        wait_cache();
+        cache_.remove(tx);
     }
 
     return true;
 }
 
-bool transaction_database::unconfirm(const block& block)
+bool transaction_database::unconfirm(const block& block, size_t height)
 {
+    std::vector<link_type> spends;
+    position_list positions;
+
+    // Without a record the prevouts of the block are found by hash.
+    if (!read_undo(height, spends, positions))
+    {
+        if (undoable_ && undo_index_.count() > height)
+            undo_index_.set_count(static_cast<array_index>(height));
+
+        return unconfirm(block);
+    }
+
+    // The slab of the record is not reclaimed.
+    undo_index_.set_count(static_cast<array_index>(height));
+    write_spender_heights(spends, positions, rule_fork::unverified);
+
     for (const auto& tx: block.transactions())
     {
-        if (!confirm(tx.metadata.link, rule_fork::unverified, no_time,
+        if (!confirmize(tx.metadata.link, rule_fork::unverified, no_time,
             transaction_result::unconfirmed))
             return false;
 
         // Uncache the unspent outputs of the unconfirmed transaction.
-        cache_.remove(tx.hash());
+        wait_cache();
+        cache_.remove(tx);
+    }
+
+    return true;
+}
+
+// Prune.
+// ----------------------------------------------------------------------------
+
+// Discard the prevout scripts of all txs in one pass, ordered by position.
+bool transaction_database::prune(const link_list& links)
+{
+    hash_list hashes;
+    std::vector<output_point> points;
+
+    // Coinbase has no prevouts.
+    for (size_t position = 1; position < links.size(); ++position)
+    {
+        const auto result = get(links[position]);
+
+        if (!result)
+            return false;
+
+        for (const auto inpoint: result)
+        {
+            hashes.push_back(inpoint.hash());
+            points.push_back(inpoint);
+        }
+    }
+
+    const auto elements = hash_table_.find(hashes, true);
+    std::vector<std::pair<file_offset, link_type>> entries;
+    std::vector<std::pair<file_offset, file_offset>> scripts;
+    entries.reserve(elements.size());
+    scripts.reserve(elements.size());
+
+    for (size_t point = 0; point < elements.size(); ++point)
+    {
+        size_t entry;
+        size_t begin;
+        size_t end;
+        auto prunable = false;
+        const auto& element = elements[point];
+
+        if (!element)
+            return false;
+
+        const auto reader = [&](byte_deserializer& deserial)
+        {
+            deserial.skip(metadata_size);
+            prunable = transaction_result::read_prunable(deserial,
+                points[point].index(), entry, begin, end);
+        };
+
+        element.read(reader);
+
+        // Untabled and previously pruned prevouts are skipped.
+        if (!prunable)
+            continue;
+
+        const auto base = buckets_size_ + element.link();
+        entries.emplace_back(base +
+            slab_map::value_type::size(metadata_size + entry), element.link());
+        scripts.emplace_back(
+            base + slab_map::value_type::size(metadata_size + begin),
+            base + slab_map::value_type::size(metadata_size + end));
+    }
+
+    if (entries.empty())
+        return true;
+
+    std::sort(entries.begin(), entries.end());
+    std::sort(scripts.begin(), scripts.end());
+
+    // The memory object remains in scope for the pass.
+    const auto memory = hash_table_file_.access();
+    const auto buffer = memory->buffer();
+
+    for (const auto& entry: entries)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        metadata_sequence_.begin_write(entry.second);
+        transaction_result::write_pruned(buffer + entry.first);
+        metadata_sequence_.end_write(entry.second);
+        ///////////////////////////////////////////////////////////////////////
+
+        hash_table_file_.dirty(buffer + entry.first, sizeof(uint32_t));
     }
 
+    // Order the marks before the zeroing of their scripts. A reader of the
+    // script rechecks its mark after the read, so a zeroed script that it
+    // reads is then found marked and treated as pruned.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (const auto& script: scripts)
+        hash_table_file_.punch(buffer + script.first,
+            script.second - script.first);
+
     return true;
 }
 
@@ -497,57 +1476,344 @@ bool transaction_database::confirmed_spend(const output_point& point,
         return true;
 
     const auto element = hash_table_.find(point.hash());
+    size_t offset;
+    link_type spend;
 
-    if (!element)
+    if (!element || !get_spend(element, point, spender_height, offset, spend))
         return false;
 
-    size_t outputs;
-    uint32_t height;
+    if (spend != spend_manager::not_allocated)
+    {
+        write_spender_height(spend, spender_height);
+    }
+    else
+    {
+        const auto writer = [&](byte_serializer& serial)
+        {
+            serial.skip(offset + candidate_spent_size);
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            metadata_sequence_.begin_write(element.link());
+            serial.write_4_bytes_little_endian(spender_height);
+            metadata_sequence_.end_write(element.link());
+            ///////////////////////////////////////////////////////////////////
+        };
+
+        element.write(writer, offset + candidate_spent_size + height_size);
+    }
+
+    // A confirmed spent output leaves the cache (unspent is not recached).
+    // This follows the write, so a concurrent prefetch sees the spend on its
+    // check of the store or has cached the output before its removal here.
+    if (spender_height != rule_fork::unverified)
+    {
+        wait_cache();
+        cache_.remove(point);
+    }
+
+    return true;
+}
+
+// private
+// Set the value offset of the point's output spend in the (found) element.
+bool transaction_database::get_spend(const slab_map::const_value_type& element,
+    const output_point& point, size_t spender_height, size_t& offset,
+    link_type& spend) const
+{
+    size_t height;
     uint16_t position;
+
+    if (!get_spend(element, point, offset, spend, height, position))
+        return false;
+
+    // Limit to confirmed prevouts at or below the spender height.
+    return position != transaction_result::unconfirmed &&
+        height <= spender_height;
+}
+
+// private
+// Set the spend offset and the tx height/position, regardless of confirmation.
+bool transaction_database::get_spend(const slab_map::const_value_type& element,
+    const output_point& point, size_t& offset, link_type& spend,
+    size_t& height, uint16_t& position) const
+{
+    size_t outputs;
+    size_t direct;
+    link_type spends;
     const auto reader = [&](byte_deserializer& deserial)
     {
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
-        shared_lock lock(metadata_mutex_);
-        height = deserial.read_4_bytes_little_endian();
-        position = deserial.read_2_bytes_little_endian();
-        deserial.skip(candidate_size + median_time_past_size);
-        outputs = deserial.read_size_little_endian();
+        uint32_t sequence;
+
+        do
+        {
+            auto metadata = deserial;
+            sequence = metadata_sequence_.begin_read(element.link());
+            height = metadata.read_4_bytes_little_endian();
+            position = metadata.read_2_bytes_little_endian();
+        } while (!metadata_sequence_.end_read(element.link(), sequence));
+
+        deserial.skip(metadata_size);
         ///////////////////////////////////////////////////////////////////////
+
+        size_t end;
+        bool compressed;
+        link_type witnesses;
+        const auto table = transaction_result::read_offsets(deserial,
+            point.index(), direct, spends, witnesses, end, compressed);
+        outputs = deserial.read_size_little_endian();
+        offset = metadata_size + table + variable_uint_size(outputs);
+
+        // The table gives direct access to the target output.
+        if (direct != 0)
+        {
+            offset = metadata_size + table + direct;
+            return;
+        }
+
+        // Skip outputs until the target output.
+        for (auto output = 0u; output < point.index() && output < outputs;
+            ++output)
+        {
+            deserial.skip(spend_size);
+            const auto script_size = deserial.read_size_little_endian();
+            deserial.skip(script_size);
+            offset += spend_size + variable_uint_size(script_size) +
+                script_size;
+        }
     };
 
     element.read(reader);
 
-    // Limit to confirmed prevouts at or below the spender height.
-    if (position == transaction_result::unconfirmed || height > spender_height)
-        return false;
+    // The records of the outputs are contiguous within the spend column.
+    spend = spends == spend_manager::not_allocated ? spends :
+        spends + point.index();
 
     // The index is not in the transaction.
-    if (point.index() >= outputs)
-        return false;
+    return point.index() < outputs;
+}
 
-    const auto writer = [&](byte_serializer& serial)
+// private
+// Spend the prevouts of all txs in one pass, ordered by file position.
+// The txs of the block are not yet confirmed, so a prevout of a preceding tx
+// of the block is accepted as if confirmed (as when confirmed tx by tx).
+bool transaction_database::confirmed_spends(const link_list& links,
+    size_t spender_height)
+{
+    hash_list hashes;
+    std::vector<output_point> points;
+    std::vector<size_t> spenders;
+    std::unordered_map<link_type, size_t> block_positions;
+    block_positions.reserve(links.size());
+
+    for (size_t position = 0; position < links.size(); ++position)
+        block_positions.emplace(links[position], position);
+
+    // Avoid population of prevouts for coinbase (confirmation optimization).
+    for (size_t position = 1; position < links.size(); ++position)
     {
-        serial.skip(metadata_size);
-        serial.read_size_little_endian();
+        const auto result = get(links[position]);
 
-        // Skip outputs until the target output.
-        for (auto output = 0u; output < point.index(); ++output)
+        if (!result)
+            return false;
+
+        for (const auto inpoint: result)
+        {
+            if (inpoint.is_null())
+                continue;
+
+            hashes.push_back(inpoint.hash());
+            points.push_back(inpoint);
+            spenders.push_back(position);
+        }
+    }
+
+    const auto elements = hash_table_.find(hashes, true);
+    position_list positions;
+    std::vector<link_type> spends;
+    positions.reserve(elements.size());
+
+    for (size_t point = 0; point < elements.size(); ++point)
+    {
+        size_t offset;
+        link_type spend;
+        const auto& element = elements[point];
+
+        if (!element)
+            return false;
+
+        if (!get_spend(element, points[point], spender_height, offset, spend))
+        {
+            size_t height;
+            uint16_t position;
+            const auto it = block_positions.find(element.link());
+
+            if (it == block_positions.end() || it->second >= spenders[point] ||
+                !get_spend(element, points[point], offset, spend, height,
+                    position))
+                return false;
+        }
+
+        if (spend != spend_manager::not_allocated)
         {
-            serial.skip(spend_size);
-            serial.skip(serial.read_size_little_endian());
+            spends.push_back(spend);
+            continue;
         }
 
-        serial.skip(candidate_spent_size);
+        // The spender height follows the candidate spent flag of the output.
+        positions.emplace_back(buckets_size_ + element.link() +
+            slab_map::value_type::size(offset + candidate_spent_size),
+            element.link());
+    }
+
+    // Scattered prevout writes become a mostly sequential walk of the file.
+    std::sort(spends.begin(), spends.end());
+    std::sort(positions.begin(), positions.end());
+
+    if (undoable_ && !store_undo(spender_height, spends, positions))
+        return false;
+
+    write_spender_heights(spends, positions, spender_height);
+
+    // Confirmed spent outputs leave the cache, once spent in the store (see
+    // confirmed_spend).
+    wait_cache();
+
+    for (const auto& point: points)
+        cache_.remove(point);
+
+    return true;
+}
+
+// private
+void transaction_database::write_spender_heights(
+    const std::vector<link_type>& spends, const position_list& positions,
+    size_t spender_height)
+{
+    // Column writes are confined to the (small) spends file.
+    for (const auto spend: spends)
+        write_spender_height(spend, spender_height);
+
+    if (positions.empty())
+        return;
+
+    // The memory object remains in scope for the pass.
+    const auto memory = hash_table_file_.access();
+    const auto buffer = memory->buffer();
+
+    for (const auto& position: positions)
+    {
+        auto serial = make_unsafe_serializer(buffer + position.first);
 
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(metadata_mutex_);
-        serial.write_4_bytes_little_endian(spender_height);
+        metadata_sequence_.begin_write(position.second);
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(spender_height));
+        metadata_sequence_.end_write(position.second);
         ///////////////////////////////////////////////////////////////////////
-    };
 
-    element.write(writer);
+        hash_table_file_.dirty(buffer + position.first, height_size);
+    }
+}
+
+// private
+bool transaction_database::store_undo(size_t height,
+    const std::vector<link_type>& spends, const position_list& positions)
+{
+    // Records above the height are of blocks since unconfirmed.
+    if (undo_index_.count() > height)
+        undo_index_.set_count(static_cast<array_index>(height));
+
+    const auto size = 2u * sizeof(uint32_t) +
+        spends.size() * sizeof(link_type) +
+        positions.size() * (sizeof(file_offset) + sizeof(link_type));
+
+    const auto slab = undo_.allocate(size);
+
+    if (slab == manager_type::not_allocated)
+        return false;
+
+    // The guard must remain in scope until the end of the block.
+    {
+        const auto memory = undo_.access(slab);
+        auto serial = make_unsafe_serializer(memory.buffer());
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(spends.size()));
+
+        for (const auto spend: spends)
+            serial.write_8_bytes_little_endian(spend);
+
+        serial.write_4_bytes_little_endian(
+            static_cast<uint32_t>(positions.size()));
+
+        for (const auto& position: positions)
+        {
+            serial.write_8_bytes_little_endian(position.first);
+            serial.write_8_bytes_little_endian(position.second);
+        }
+
+        undo_.dirty(memory, size);
+    }
+
+    // The index is by height, heights confirmed without the file have none.
+    const auto first = undo_index_.count();
+    const auto count = height + 1u - first;
+    const auto record = undo_index_.allocate(count);
+
+    if (record == height_manager::not_allocated)
+        return false;
+
+    for (auto index = record; index < record + count; ++index)
+    {
+        const auto memory = undo_index_.access(index);
+        auto serial = make_unsafe_serializer(memory.buffer());
+        serial.write_8_bytes_little_endian(index == height ? slab :
+            manager_type::not_allocated);
+        undo_index_.dirty(memory, sizeof(link_type));
+    }
+
+    return true;
+}
+
+// private
+bool transaction_database::read_undo(size_t height,
+    std::vector<link_type>& spends, position_list& positions) const
+{
+    if (!undoable_ || height + 1u != undo_index_.count())
+        return false;
+
+    link_type slab;
+    {
+        const auto memory = undo_index_.access(static_cast<array_index>(
+            height));
+        slab = make_unsafe_deserializer(memory.buffer())
+            .read_8_bytes_little_endian();
+    }
+
+    if (slab == manager_type::not_allocated)
+        return false;
+
+    const auto memory = undo_.access(slab);
+    auto deserial = make_unsafe_deserializer(memory.buffer());
+    const auto spend_count = deserial.read_4_bytes_little_endian();
+    spends.reserve(spend_count);
+
+    for (size_t index = 0; index < spend_count; ++index)
+        spends.push_back(deserial.read_8_bytes_little_endian());
+
+    const auto position_count = deserial.read_4_bytes_little_endian();
+    positions.reserve(position_count);
+
+    for (size_t index = 0; index < position_count; ++index)
+    {
+        const auto position = deserial.read_8_bytes_little_endian();
+        const auto link = deserial.read_8_bytes_little_endian();
+        positions.emplace_back(position, link);
+    }
+
     return true;
 }
 
@@ -562,16 +1828,17 @@ bool transaction_database::confirmize(link_type link, size_t height,
     {
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(metadata_mutex_);
+        metadata_sequence_.begin_write(link);
         serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
         serial.write_2_bytes_little_endian(static_cast<uint16_t>(position));
         serial.write_byte(transaction_result::candidate_false);
         serial.write_4_bytes_little_endian(median_time_past);
+        metadata_sequence_.end_write(link);
         ///////////////////////////////////////////////////////////////////////
     };
 
     const auto element = hash_table_.get(link);
-    element.write(writer);
+    element.write(writer, metadata_size);
     return true;
 }
 
@@ -0,0 +1,517 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/databases/utxo_database.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/databases/transaction_database.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+
+// Record format [variable bytes, 48+ with key/link]:
+// ----------------------------------------------------------------------------
+// [ height:4           - const ]
+// [ median_time_past:4 - const ]
+// [ coinbase:1         - const ]
+// [ value:8            - const ]
+// [ script:varint+     - const ]
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto median_time_past_size = sizeof(uint32_t);
+static constexpr auto coinbase_size = sizeof(uint8_t);
+static constexpr auto metadata_size = height_size + median_time_past_size +
+    coinbase_size;
+
+// Snapshot file: [magic:4][height:4][block_hash:32], chunks of whole entries
+// [size:4][entries...] ended by a zero size, then [count:8][digest:32].
+// Entry: [hash:32][index:4][height:4][median_time_past:4][coinbase:1][output]
+// The digest chains the chunks, digest = sha256(digest || sha256(chunk)).
+static constexpr uint32_t snapshot_magic = 0x75786462;
+static constexpr size_t snapshot_chunk = 1024 * 1024;
+static constexpr size_t snapshot_header_size = sizeof(uint32_t) +
+    height_size + hash_size;
+static constexpr size_t snapshot_trailer_size = sizeof(uint64_t) + hash_size;
+
+static hash_digest chain_digest(const hash_digest& digest,
+    const data_chunk& chunk)
+{
+    return sha256_hash(build_chunk({ digest, sha256_hash(chunk) }));
+}
+
+// Unspent outputs use a hash table index, O(1).
+utxo_database::utxo_database(const path& map_filename, size_t table_minimum,
+    size_t buckets, size_t expansion, bool huge_pages, size_t reservation,
+    size_t populate, size_t extent)
+  : hash_table_file_(map_filename, table_minimum, expansion, huge_pages ?
+        hash_table_header<index_type, link_type>::size(buckets) : 0,
+        reservation, populate, extent),
+    hash_table_(hash_table_file_, buckets)
+{
+}
+
+utxo_database::~utxo_database()
+{
+    close();
+}
+
+// Startup and shutdown.
+// ----------------------------------------------------------------------------
+
+bool utxo_database::create()
+{
+    if (!hash_table_file_.open())
+        return false;
+
+    // No need to call open after create.
+    return hash_table_.create();
+}
+
+bool utxo_database::open()
+{
+    return
+        hash_table_file_.open() &&
+        hash_table_.start();
+}
+
+void utxo_database::set_read_only()
+{
+    hash_table_file_.set_read_only();
+}
+
+bool utxo_database::refresh()
+{
+    return hash_table_.refresh();
+}
+
+void utxo_database::commit()
+{
+    hash_table_.commit();
+}
+
+bool utxo_database::flush() const
+{
+    return hash_table_file_.flush();
+}
+
+bool utxo_database::writeback(bool wait) const
+{
+    return hash_table_file_.writeback(wait);
+}
+
+bool utxo_database::close()
+{
+    return hash_table_file_.close();
+}
+
+bool utxo_database::advise(access_advice table)
+{
+    return hash_table_file_.advise(table);
+}
+
+storage_counters utxo_database::counters() const
+{
+    return hash_table_file_.counters();
+}
+
+storage_residency utxo_database::residency() const
+{
+    return hash_table_file_.residency(hash_table_.header_size());
+}
+
+table_statistics utxo_database::statistics(size_t samples) const
+{
+    return hash_table_.statistics(samples);
+}
+
+// Queries.
+// ----------------------------------------------------------------------------
+
+// All responses are confirmed unspent, metadata should be defaulted by caller.
+bool utxo_database::populate(const output_point& point,
+    size_t fork_height) const
+{
+    const auto element = hash_table_.find(to_key(point));
+
+    if (!element)
+        return false;
+
+    size_t height = 0;
+    uint32_t median_time_past = 0;
+    auto coinbase = false;
+    chain::output output;
+
+    const auto reader = [&](byte_deserializer& deserial)
+    {
+        height = deserial.read_4_bytes_little_endian();
+        median_time_past = deserial.read_4_bytes_little_endian();
+        coinbase = deserial.read_byte() != 0;
+        output.from_data(deserial, true);
+    };
+
+    element.read(reader);
+
+    // An output confirmed above the fork point may be a candidate there.
+    if (height > fork_height)
+        return false;
+
+    auto& prevout = point.metadata;
+
+    // The table retains only the confirmed unspent state.
+    prevout.candidate = false;
+    prevout.candidate_spent = false;
+    prevout.confirmed_spent = false;
+    prevout.confirmed = true;
+    prevout.height = height;
+    prevout.coinbase = coinbase;
+    prevout.median_time_past = median_time_past;
+    prevout.cache = std::move(output);
+    return true;
+}
+
+// Store.
+// ----------------------------------------------------------------------------
+
+bool utxo_database::store(const output_point& point,
+    const chain::output& output, size_t height, uint32_t median_time_past,
+    bool coinbase)
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+
+    const auto writer = [&](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+        serial.write_4_bytes_little_endian(median_time_past);
+        serial.write_byte(coinbase ? 1 : 0);
+        output.to_data(serial, true);
+    };
+
+    const auto size = metadata_size + output.serialized_size(true);
+    const auto link = hash_table_.allocate(slab_map::value_type::size(size));
+
+    if (link == manager_type::not_allocated)
+        return false;
+
+    auto next = hash_table_.allocator(link);
+    next.populate(to_key(point), writer, size);
+    hash_table_.link(next);
+    return true;
+}
+
+// The payload size includes its own (link sized) prefix.
+bool utxo_database::empty() const
+{
+    return hash_table_.payload_size() == sizeof(link_type);
+}
+
+// The slab of a removed output is not reclaimed, but is no longer read.
+bool utxo_database::remove(const output_point& point)
+{
+    return hash_table_.unlink(to_key(point));
+}
+
+// Outputs spent within the block are added and removed in tx order.
+bool utxo_database::confirm(const block& block, size_t height,
+    uint32_t median_time_past)
+{
+    const auto& txs = block.transactions();
+
+    for (size_t position = 0; position < txs.size(); ++position)
+    {
+        const auto& tx = txs[position];
+        const auto coinbase = position == 0;
+
+        // Prevouts confirmed before the table was populated are not found.
+        if (!coinbase)
+            for (const auto& input: tx.inputs())
+                remove(input.previous_output());
+
+        const auto& outputs = tx.outputs();
+        const auto hash = tx.hash();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+            if (!store({ hash, index }, outputs[index], height,
+                median_time_past, coinbase))
+                return false;
+    }
+
+    return true;
+}
+
+// The reverse of confirm, so prevouts of the block are restored and removed.
+bool utxo_database::unconfirm(const block& block,
+    const transaction_database& transactions)
+{
+    static const auto unconfirmed = transaction_result::unconfirmed;
+    const auto& txs = block.transactions();
+
+    for (auto position = txs.size(); position > 0; --position)
+    {
+        const auto& tx = txs[position - 1];
+        const auto& outputs = tx.outputs();
+        const auto hash = tx.hash();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+            remove({ hash, index });
+
+        if (position == 1)
+            continue;
+
+        for (const auto& input: tx.inputs())
+        {
+            const auto& prevout = input.previous_output();
+            const auto result = transactions.get(prevout.hash());
+
+            // Only a confirmed prevout is restored.
+            if (!result || result.position() == unconfirmed)
+                continue;
+
+            const auto output = result.output(prevout.index());
+
+            if (output.is_valid() && !store(prevout, output,
+                result.height(), result.median_time_past(),
+                result.position() == 0))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Snapshot.
+// ----------------------------------------------------------------------------
+
+// The caller must preclude writes for the duration of the export.
+bool utxo_database::export_snapshot(const path& filename, size_t height,
+    const hash_digest& block_hash, hash_digest& out_digest) const
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+    ofstream file(filename.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(snapshot_header_size);
+    auto header = make_unsafe_serializer(buffer.begin());
+    header.write_4_bytes_little_endian(snapshot_magic);
+    header.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    header.write_hash(block_hash);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    uint64_t count = 0;
+    auto digest = null_hash;
+    data_chunk chunk;
+    chunk.reserve(snapshot_chunk);
+
+    const auto write_chunk = [&]()
+    {
+        data_chunk size(sizeof(uint32_t));
+        make_unsafe_serializer(size.begin()).write_4_bytes_little_endian(
+            static_cast<uint32_t>(chunk.size()));
+        file.write(reinterpret_cast<const char*>(size.data()), size.size());
+        file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+    };
+
+    const auto writer = [&](const key_type& key)
+    {
+        const auto element = hash_table_.find(key);
+
+        if (!element)
+            return;
+
+        uint32_t confirmed = 0;
+        uint32_t median_time_past = 0;
+        uint8_t coinbase = 0;
+        chain::output output;
+
+        element.read([&](byte_deserializer& deserial)
+        {
+            confirmed = deserial.read_4_bytes_little_endian();
+            median_time_past = deserial.read_4_bytes_little_endian();
+            coinbase = deserial.read_byte();
+            output.from_data(deserial, true);
+        });
+
+        // The key is the entry point, [hash:32][index:4].
+        const auto start = chunk.size();
+        chunk.resize(start + key.size() + metadata_size +
+            output.serialized_size(true));
+        auto serial = make_unsafe_serializer(chunk.begin() + start);
+        serial.write_bytes(key);
+        serial.write_4_bytes_little_endian(confirmed);
+        serial.write_4_bytes_little_endian(median_time_past);
+        serial.write_byte(coinbase);
+        output.to_data(serial, true);
+        ++count;
+
+        if (chunk.size() >= snapshot_chunk)
+        {
+            write_chunk();
+            digest = chain_digest(digest, chunk);
+            chunk.clear();
+        }
+    };
+
+    hash_table_.for_each(writer);
+
+    if (!chunk.empty())
+    {
+        write_chunk();
+        digest = chain_digest(digest, chunk);
+        chunk.clear();
+    }
+
+    // The empty chunk terminates the entries.
+    write_chunk();
+
+    buffer.resize(snapshot_trailer_size);
+    auto trailer = make_unsafe_serializer(buffer.begin());
+    trailer.write_8_bytes_little_endian(count);
+    trailer.write_hash(digest);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.flush();
+
+    if (!file.good())
+        return false;
+
+    out_digest = digest;
+    return true;
+}
+
+// The first pass verifies the snapshot, so a corrupted file stores nothing.
+// Stored keys are not unique, so the outputs are stored only into an empty
+// table.
+bool utxo_database::import_snapshot(const path& filename, size_t& out_height,
+    hash_digest& out_block_hash, hash_digest& out_digest)
+{
+    return empty() &&
+        read_snapshot(filename, out_height, out_block_hash, out_digest,
+            false) &&
+        read_snapshot(filename, out_height, out_block_hash, out_digest, true);
+}
+
+// private
+bool utxo_database::read_snapshot(const path& filename, size_t& out_height,
+    hash_digest& out_block_hash, hash_digest& out_digest, bool store)
+{
+    ifstream file(filename.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(snapshot_header_size);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    auto header = make_unsafe_deserializer(buffer.begin());
+
+    if (!file.good() || header.read_4_bytes_little_endian() != snapshot_magic)
+        return false;
+
+    const size_t snapshot_height = header.read_4_bytes_little_endian();
+    const auto block_hash = header.read_hash();
+
+    boost::system::error_code ec;
+    const auto remaining = boost::filesystem::file_size(filename, ec);
+    uint64_t consumed = snapshot_header_size;
+    uint64_t count = 0;
+    auto digest = null_hash;
+
+    while (true)
+    {
+        buffer.resize(sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        const auto size = make_unsafe_deserializer(buffer.begin())
+            .read_4_bytes_little_endian();
+
+        // Guard the allocation against a corrupted chunk size.
+        consumed += sizeof(uint32_t) + size;
+
+        if (!file.good() || ec || consumed > remaining)
+            return false;
+
+        if (size == 0)
+            break;
+
+        buffer.resize(size);
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+        if (!file.good())
+            return false;
+
+        digest = chain_digest(digest, buffer);
+        auto deserial = make_safe_deserializer(buffer.begin(), buffer.end());
+
+        while (!deserial.is_exhausted())
+        {
+            const auto hash = deserial.read_hash();
+            const auto index = deserial.read_4_bytes_little_endian();
+            const auto height = deserial.read_4_bytes_little_endian();
+            const auto time = deserial.read_4_bytes_little_endian();
+            const auto coinbase = deserial.read_byte() != 0;
+            chain::output output;
+            output.from_data(deserial, true);
+
+            if (!deserial)
+                return false;
+
+            if (store && !this->store({ hash, index }, output, height, time,
+                coinbase))
+                return false;
+
+            ++count;
+        }
+    }
+
+    buffer.resize(snapshot_trailer_size);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    auto trailer = make_unsafe_deserializer(buffer.begin());
+
+    if (!file.good() ||
+        trailer.read_8_bytes_little_endian() != count ||
+        trailer.read_hash() != digest)
+        return false;
+
+    out_height = snapshot_height;
+    out_block_hash = block_hash;
+    out_digest = digest;
+    return true;
+}
+
+// private
+// The key is the tx hash followed by the output index (little endian).
+utxo_database::key_type utxo_database::to_key(const output_point& point)
+{
+    key_type key;
+    auto serial = make_unsafe_serializer(key.begin());
+    serial.write_hash(point.hash());
+    serial.write_4_bytes_little_endian(point.index());
+    return key;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/existence_filter.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// The block is a 64 byte cache line of eight words.
+static constexpr size_t block_words = 8;
+static constexpr size_t block_bytes = block_words * sizeof(uint64_t);
+static constexpr size_t block_bits = block_bytes * 8;
+
+// Bits set per digest, each selected by two bytes of the digest.
+static constexpr size_t bits = 8;
+static constexpr size_t bits_offset = sizeof(uint64_t);
+
+// Sidecar file: [magic:4][words:8][tag:8][words...].
+static constexpr uint32_t magic = 0x66786462;
+static constexpr size_t chunk_words = 8192;
+
+existence_filter::existence_filter(size_t size)
+  : blocks_(size / block_bytes), words_(blocks_ * block_words)
+{
+    clear();
+}
+
+bool existence_filter::disabled() const
+{
+    return blocks_ == 0;
+}
+
+size_t existence_filter::size() const
+{
+    return blocks_ * block_bytes;
+}
+
+void existence_filter::clear()
+{
+    for (auto& value: words_)
+        value.store(0, std::memory_order_relaxed);
+}
+
+void existence_filter::insert(const hash_digest& hash)
+{
+    if (disabled())
+        return;
+
+    const auto first = block(hash) * block_words;
+
+    for (size_t bit = 0; bit < bits; ++bit)
+    {
+        const auto offset = bits_offset + bit * 2;
+        const auto index = (hash[offset] | (hash[offset + 1] << 8)) %
+            block_bits;
+
+        words_[first + index / 64].fetch_or(uint64_t(1) << (index % 64));
+    }
+}
+
+bool existence_filter::contains(const hash_digest& hash) const
+{
+    if (disabled())
+        return true;
+
+    const auto first = block(hash) * block_words;
+
+    for (size_t bit = 0; bit < bits; ++bit)
+    {
+        const auto offset = bits_offset + bit * 2;
+        const auto index = (hash[offset] | (hash[offset + 1] << 8)) %
+            block_bits;
+
+        if ((words_[first + index / 64].load() & (uint64_t(1) <<
+            (index % 64))) == 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool existence_filter::save(const path& filename, uint64_t tag) const
+{
+    ofstream file(filename.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(sizeof(uint32_t) + 2 * sizeof(uint64_t));
+    auto header = make_unsafe_serializer(buffer.begin());
+    header.write_4_bytes_little_endian(magic);
+    header.write_8_bytes_little_endian(words_.size());
+    header.write_8_bytes_little_endian(tag);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    for (size_t start = 0; start < words_.size(); start += chunk_words)
+    {
+        const auto end = std::min(start + chunk_words, words_.size());
+        buffer.resize((end - start) * sizeof(uint64_t));
+        auto serial = make_unsafe_serializer(buffer.begin());
+
+        for (auto index = start; index < end; ++index)
+            serial.write_8_bytes_little_endian(words_[index].load());
+
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+            buffer.size());
+    }
+
+    file.flush();
+    return file.good();
+}
+
+bool existence_filter::load(const path& filename, uint64_t tag)
+{
+    clear();
+    ifstream file(filename.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(sizeof(uint32_t) + 2 * sizeof(uint64_t));
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    auto header = make_unsafe_deserializer(buffer.begin());
+
+    if (!file.good() ||
+        header.read_4_bytes_little_endian() != magic ||
+        header.read_8_bytes_little_endian() != words_.size() ||
+        header.read_8_bytes_little_endian() != tag)
+        return false;
+
+    for (size_t start = 0; start < words_.size(); start += chunk_words)
+    {
+        const auto end = std::min(start + chunk_words, words_.size());
+        buffer.resize((end - start) * sizeof(uint64_t));
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+        if (!file.good())
+        {
+            clear();
+            return false;
+        }
+
+        auto deserial = make_unsafe_deserializer(buffer.begin());
+
+        for (auto index = start; index < end; ++index)
+            words_[index].store(deserial.read_8_bytes_little_endian());
+    }
+
+    return true;
+}
+
+// private
+size_t existence_filter::block(const hash_digest& hash) const
+{
+    // The digest is uniformly distributed, so its leading bytes suffice.
+    return from_little_endian_unsafe<uint64_t>(hash.begin()) % blocks_;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/latency_histogram.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+const size_t latency_histogram::buckets = 32;
+
+latency_histogram::values::values()
+  : count(0),
+    total(asio::duration::zero()),
+    maximum(asio::duration::zero()),
+    buckets(latency_histogram::buckets, 0)
+{
+}
+
+asio::microseconds latency_histogram::values::quantile(double fraction) const
+{
+    if (count == 0)
+        return asio::microseconds::zero();
+
+    const auto bounded = std::min(std::max(fraction, 0.0), 1.0);
+    const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(
+        bounded * count + 0.5));
+
+    uint64_t counted = 0;
+    size_t index = 0;
+
+    for (; index + 1u < buckets.size(); ++index)
+        if ((counted += buckets[index]) >= target)
+            break;
+
+    // The last bucket is unbounded, so its bound is the maximum.
+    if (index + 1u == buckets.size())
+        return std::chrono::duration_cast<asio::microseconds>(maximum);
+
+    return asio::microseconds(uint64_t(1) << index);
+}
+
+latency_histogram::timer::timer(latency_histogram& histogram)
+  : histogram_(histogram), start_(asio::steady_clock::now())
+{
+}
+
+latency_histogram::timer::~timer()
+{
+    histogram_.record(asio::steady_clock::now() - start_);
+}
+
+latency_histogram::latency_histogram()
+  : count_(0), total_(0), maximum_(0), buckets_(buckets)
+{
+    for (auto& bucket: buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void latency_histogram::record(const asio::duration& latency)
+{
+    const auto ticks = static_cast<int64_t>(latency.count());
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(ticks, std::memory_order_relaxed);
+    buckets_[bucket(latency)].fetch_add(1, std::memory_order_relaxed);
+
+    auto maximum = maximum_.load(std::memory_order_relaxed);
+
+    while (ticks > maximum && !maximum_.compare_exchange_weak(maximum, ticks,
+        std::memory_order_relaxed));
+}
+
+latency_histogram::values latency_histogram::read() const
+{
+    values out;
+    out.count = count_.load(std::memory_order_relaxed);
+    out.total = asio::duration(total_.load(std::memory_order_relaxed));
+    out.maximum = asio::duration(maximum_.load(std::memory_order_relaxed));
+
+    for (size_t index = 0; index < buckets_.size(); ++index)
+        out.buckets[index] = buckets_[index].load(std::memory_order_relaxed);
+
+    return out;
+}
+
+void latency_histogram::reset()
+{
+    count_.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    maximum_.store(0, std::memory_order_relaxed);
+
+    for (auto& bucket: buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+// private
+// The bucket is the bit width of the whole microseconds, below the last.
+size_t latency_histogram::bucket(const asio::duration& latency)
+{
+    auto micro = std::chrono::duration_cast<asio::microseconds>(latency)
+        .count();
+    size_t index = 0;
+
+    for (; micro > 0 && index + 1u < buckets; micro >>= 1)
+        ++index;
+
+    return index;
+}
+
+} // namespace database
+} // namespace libbitcoin
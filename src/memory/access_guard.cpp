@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/access_guard.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+#include <bitcoin/database/memory/storage.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+access_guard::access_guard(storage& file)
+  : file_(&file),
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Begin Critical Section
+    data_(file.lock_shared())
+{
+}
+
+access_guard::access_guard(access_guard&& other)
+  : file_(other.file_), data_(other.data_)
+{
+    other.file_ = nullptr;
+    other.data_ = nullptr;
+}
+
+uint8_t* access_guard::buffer() const
+{
+    return data_;
+}
+
+void access_guard::increment(size_t value)
+{
+    BITCOIN_ASSERT_MSG(data_ != nullptr, "Buffer not assigned.");
+    BITCOIN_ASSERT((size_t)data_ <= bc::max_size_t - value);
+
+    data_ += value;
+}
+
+access_guard::~access_guard()
+{
+    // A moved guard no longer holds the lock.
+    if (file_ != nullptr)
+        file_->unlock_shared();
+
+    // End Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace database
+} // namespace libbitcoin
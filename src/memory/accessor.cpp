@@ -36,6 +36,15 @@ accessor::accessor(upgrade_mutex& mutex)
     mutex_.lock_upgrade();
 }
 
+accessor::accessor(upgrade_mutex& mutex, uint8_t* const& data)
+  : mutex_(mutex)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Begin Critical Section
+    mutex_.lock_shared();
+    data_ = data;
+}
+
 uint8_t* accessor::buffer()
 {
     return data_;
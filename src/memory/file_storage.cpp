@@ -26,21 +26,33 @@
 #else
     #include <unistd.h>
     #include <stddef.h>
+    #include <sys/ioctl.h>
     #include <sys/mman.h>
 #endif
+#ifdef __linux__
+    #include <linux/fs.h>
+    #include <linux/mempolicy.h>
+    #include <sys/syscall.h>
+#endif
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <fcntl.h>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 #include <bitcoin/database/memory/accessor.hpp>
 #include <bitcoin/database/memory/memory.hpp>
+#include <bitcoin/database/memory/processor_affinity.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 
 // file_storage is able to support 32 bit, but because the database
 // requires a larger file this is neither validated nor supported.
@@ -89,14 +101,16 @@ size_t file_storage::file_size(int file_handle)
     return static_cast<size_t>(sbuf.st_size);
 }
 
-int file_storage::open_file(const path& filename)
+int file_storage::open_file(const path& filename, bool read_only)
 {
 #ifdef _WIN32
     int handle = _wopen(filename.wstring().c_str(),
-        (O_RDWR | _O_BINARY | _O_RANDOM), (_S_IREAD | _S_IWRITE));
+        ((read_only ? _O_RDONLY : O_RDWR) | _O_BINARY | _O_RANDOM),
+        (_S_IREAD | _S_IWRITE));
 #else
     int handle = ::open(filename.string().c_str(),
-        (O_RDWR), (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+        (read_only ? O_RDONLY : O_RDWR),
+        (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
 #endif
     return handle;
 }
@@ -122,12 +136,57 @@ void file_storage::log_mapping() const
         << page() << ")";
 }
 
+void file_storage::log_huge_pages() const
+{
+    LOG_WARNING(LOG_DATABASE)
+        << "Huge pages unavailable: " << filename_ << " [" << huge_pages_
+        << "]";
+}
+
+void file_storage::log_advice() const
+{
+    LOG_WARNING(LOG_DATABASE)
+        << "Access advice failed: " << filename_ << " ["
+        << static_cast<uint32_t>(advice_) << "]";
+}
+
+void file_storage::log_placement() const
+{
+    LOG_WARNING(LOG_DATABASE)
+        << "Memory placement failed: " << filename_ << " ["
+        << static_cast<uint32_t>(placement_) << ", " << nodes_ << "]";
+}
+
+void file_storage::log_populate() const
+{
+    LOG_WARNING(LOG_DATABASE)
+        << "Populate failed: " << filename_ << " [" << populated_ << "]";
+}
+
+void file_storage::log_prefaulted(size_t size,
+    const asio::duration& elapsed) const
+{
+    LOG_DEBUG(LOG_DATABASE)
+        << "Prefaulted: " << filename_ << " [" << size << "] ("
+        << std::chrono::duration_cast<asio::milliseconds>(elapsed).count()
+        << " ms)";
+}
+
 void file_storage::log_resizing(size_t size) const
 {
     LOG_DEBUG(LOG_DATABASE)
         << "Resizing: " << filename_ << " [" << size << "]";
 }
 
+void file_storage::log_allocated(size_t size,
+    const asio::duration& elapsed) const
+{
+    LOG_DEBUG(LOG_DATABASE)
+        << "Allocated: " << filename_ << " [" << size << "] ("
+        << std::chrono::duration_cast<asio::microseconds>(elapsed).count()
+        << " us)";
+}
+
 void file_storage::log_flushed() const
 {
     LOG_DEBUG(LOG_DATABASE)
@@ -154,15 +213,32 @@ file_storage::file_storage(const path& filename)
 
 // mmap documentation: tinyurl.com/hnbw8t5
 file_storage::file_storage(const path& filename, size_t minimum,
-    size_t expansion)
-  : file_handle_(open_file(filename)),
+    size_t expansion, size_t huge_pages, size_t reservation, size_t populate,
+    size_t extent)
+  : file_handle_(open_file(filename, false)),
     minimum_(minimum),
     expansion_(expansion),
+    huge_pages_(huge_pages),
+    reservation_(reservation),
+    populate_(populate),
+    extent_(extent),
     filename_(filename),
+    page_size_(std::max(page(), size_t(1))),
     closed_(true),
     data_(nullptr),
     capacity_(file_size(file_handle_)),
-    logical_size_(capacity_)
+    allocated_(capacity_),
+    reserved_(0),
+    populated_(0),
+    pinned_(0),
+    logical_size_(capacity_),
+    advice_(access_advice::random),
+    placement_(memory_placement::local),
+    nodes_(0),
+    unwritten_bytes_(0),
+    log_(nullptr),
+    log_file_(0),
+    read_only_(false)
 {
 }
 
@@ -193,15 +269,25 @@ bool file_storage::open()
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     std::string error_name;
+    auto huge_pages = true;
+    auto placed = true;
+
+    // Pages beyond the logical size are not populated, and none are pinned.
+    populated_ = 0;
+    pinned_ = 0;
 
     // Initialize data_.
     // For unknown reason madvise(minimum_) with large value fails on linux.
     if (!map(capacity_))
         error_name = "map";
-    else if (madvise(data_, 0, MADV_RANDOM) == FAIL)
+    else if (!advise_access())
         error_name = "madvise";
     else
+    {
+        huge_pages = advise_huge_pages();
+        placed = place_memory(false);
         closed_ = false;
+    }
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
@@ -210,16 +296,25 @@ bool file_storage::open()
     if (!error_name.empty())
         return handle_error(error_name, filename_);
 
+    if (!huge_pages)
+        log_huge_pages();
+
+    if (!placed)
+        log_placement();
+
     log_mapping();
     return true;
 }
 
+// Only the ranges written since the last flush are synchronized.
 bool file_storage::flush() const
 {
     std::string error_name;
+    ranges dirty;
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    // The upgrade lock precludes a remap but not concurrent reads.
     mutex_.lock_upgrade();
 
     if (closed_)
@@ -229,13 +324,31 @@ bool file_storage::flush() const
         return true;
     }
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    // Writes recorded after this point are deferred to the next flush.
+    dirty_mutex_.lock();
+    dirty.swap(dirty_);
+    unwritten_.clear();
+    unwritten_bytes_ = 0;
+    dirty_mutex_.unlock();
+
+    const auto start = asio::steady_clock::now();
 
-    if (msync(data_, logical_size_, MS_SYNC) == FAIL)
+    // Pages of logged bytes may share a file, they are synced by checkpoint.
+    if (!sync(dirty, log_ != nullptr))
         error_name = "flush";
 
-    mutex_.unlock();
+    const auto synchronized = asio::steady_clock::now() - start;
+
+    counters_mutex_.lock();
+    counters_.flushes++;
+    counters_.flush_duration += synchronized;
+    counters_mutex_.unlock();
+
+    BCD_TRACE3(flush, filename_.c_str(), dirty.size(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            synchronized).count());
+
+    mutex_.unlock_upgrade();
     ///////////////////////////////////////////////////////////////////////////
 
     // Keep logging out of the critical section.
@@ -246,7 +359,164 @@ bool file_storage::flush() const
     return true;
 }
 
+// Logged pages are synchronized with any others, so the file is synced whole.
+bool file_storage::checkpoint() const
+{
+    std::string error_name;
+    ranges dirty;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (closed_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    dirty_mutex_.lock();
+    dirty.swap(dirty_);
+
+    for (const auto& range: logged_)
+        insert(dirty, range.first, range.second);
+
+    logged_.clear();
+    unwritten_.clear();
+    unwritten_bytes_ = 0;
+    dirty_mutex_.unlock();
+
+    if (!sync(dirty, false))
+        error_name = "checkpoint";
+
+    mutex_.unlock_upgrade();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    return error_name.empty() || handle_error(error_name, filename_);
+}
+
+void file_storage::attach(write_log& log)
+{
+    log_ = &log;
+    log_file_ = log.enroll(filename_);
+}
+
+// A reader may not have write permission to the file, so the (failed) read
+// and write handle of the constructor is replaced by a read only handle.
+void file_storage::set_read_only()
+{
+    if (read_only_)
+        return;
+
+    if (file_handle_ != INVALID_HANDLE)
+        ::close(file_handle_);
+
+    read_only_ = true;
+    file_handle_ = open_file(filename_, true);
+    capacity_ = file_size(file_handle_);
+    allocated_ = capacity_;
+    logical_size_ = capacity_;
+}
+
+// Growth within the reservation is readable without a remap, as the pages
+// beyond the end of the file were mapped at open.
+bool file_storage::refresh()
+{
+    std::string error_name;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (closed_ || !read_only_)
+    {
+        const auto opened = !closed_;
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return opened;
+    }
+
+    const auto size = file_size(file_handle_);
+
+    if (size == capacity_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    if (size == 0)
+        error_name = "fstat";
+    else if (size > reserved_ && !remap(size))
+        error_name = "remap";
+    else
+        capacity_ = logical_size_ = size;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    return error_name.empty() || handle_error(error_name, filename_);
+}
+
 // Close is idempotent and thread safe.
+// Write back is initiated without waiting on the disk, idempotent.
+bool file_storage::writeback(bool wait) const
+{
+    auto success = true;
+    ranges unwritten;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (closed_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    // Writes recorded after this point are deferred to the next write back.
+    dirty_mutex_.lock();
+    unwritten.swap(unwritten_);
+    unwritten_bytes_ = 0;
+    dirty_mutex_.unlock();
+
+#ifdef __linux__
+    const auto flags = wait ? SYNC_FILE_RANGE_WAIT_BEFORE |
+        SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER :
+        SYNC_FILE_RANGE_WRITE;
+#endif
+
+    for (const auto& range: unwritten)
+    {
+        if (range.first >= capacity_)
+            break;
+
+        const auto size = std::min(range.second, capacity_) - range.first;
+
+#ifdef __linux__
+        success &= sync_file_range(file_handle_, range.first, size, flags) !=
+            FAIL;
+#else
+        success &= msync(data_ + range.first, size,
+            wait ? MS_SYNC : MS_ASYNC) != FAIL;
+#endif
+    }
+
+    mutex_.unlock_upgrade();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    return success || handle_error("writeback", filename_);
+}
+
 bool file_storage::close()
 {
     std::string error_name;
@@ -270,11 +540,32 @@ bool file_storage::close()
 
     closed_ = true;
 
+    // The file is owned by its writer, so it is only unmapped.
+    if (read_only_)
+    {
+        if (munmap(data_, reserved_) == FAIL)
+            error_name = "munmap";
+        else if (::close(file_handle_) == FAIL)
+            error_name = "close";
+
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return error_name.empty() || handle_error(error_name, filename_);
+    }
+
+    // The full logical size is synchronized below.
+    dirty_mutex_.lock();
+    dirty_.clear();
+    logged_.clear();
+    unwritten_.clear();
+    unwritten_bytes_ = 0;
+    dirty_mutex_.unlock();
+
     if (logical_size_ > capacity_)
         error_name = "fit";
     else if (msync(data_, logical_size_, MS_SYNC) == FAIL)
         error_name = "msync";
-    else if (munmap(data_, capacity_) == FAIL)
+    else if (munmap(data_, reserved_) == FAIL)
         error_name = "munmap";
     else if (ftruncate(file_handle_, logical_size_) == FAIL)
         error_name = "ftruncate";
@@ -324,13 +615,67 @@ size_t file_storage::logical() const
     ///////////////////////////////////////////////////////////////////////////
 }
 
-memory_ptr file_storage::access()
+storage_counters file_storage::counters() const
 {
+    storage_counters out;
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    auto memory = std::make_shared<accessor>(mutex_);
+    mutex_.lock_shared();
 
-    memory->assign(data_);
+    counters_mutex_.lock_shared();
+    out = counters_;
+    counters_mutex_.unlock_shared();
+
+    dirty_mutex_.lock_shared();
+    out.unwritten = unwritten_bytes_;
+    dirty_mutex_.unlock_shared();
+
+    out.reserved = reserved_;
+    out.capacity = capacity_;
+    out.logical = logical_size_;
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return out;
+}
+
+// A page spanning the end of the head is queried for both regions.
+storage_residency file_storage::residency(size_t head) const
+{
+    storage_residency out;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    dirty_mutex_.lock_shared();
+    out.dirty = unwritten_bytes_;
+    dirty_mutex_.unlock_shared();
+
+    out.mapped = capacity_;
+    out.logical = logical_size_;
+    out.head = std::min(head, logical_size_);
+
+    if (!closed_)
+    {
+        out.head_resident = resident(0, out.head);
+        out.body_resident = resident(out.head, logical_size_);
+    }
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return out;
+}
+
+memory_ptr file_storage::access()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    // Readers take the shared lock directly, blocking only on a remap.
+    auto memory = std::make_shared<accessor>(mutex_, data_);
 
     // The store should only have been closed after all threads terminated.
     if (closed_)
@@ -339,6 +684,31 @@ memory_ptr file_storage::access()
     return memory;
 }
 
+uint8_t* file_storage::lock_shared()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Begin Critical Section
+    // Readers take the shared lock directly, blocking only on a remap.
+    mutex_.lock_shared();
+
+    // The store should only have been closed after all threads terminated.
+    if (closed_)
+    {
+        mutex_.unlock_shared();
+        //---------------------------------------------------------------------
+        throw std::runtime_error("Access failure, store closed.");
+    }
+
+    return data_;
+}
+
+void file_storage::unlock_shared()
+{
+    mutex_.unlock_shared();
+    // End Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // Throws runtime_error if insufficient space.
 memory_ptr file_storage::resize(size_t required)
 {
@@ -363,9 +733,15 @@ memory_ptr file_storage::reserve(size_t required, size_t minimum,
     // Internally preventing resize during close is not possible because of
     // cross-file integrity. So we must coalesce all threads before closing.
 
+    const auto waiting = asio::steady_clock::now();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     auto memory = std::make_shared<accessor>(mutex_);
+    const auto waited = asio::steady_clock::now() - waiting;
+    const auto resizing = required > capacity_;
+    auto remapping = false;
+    auto resized = asio::duration::zero();
 
     // The store should only have been closed after all threads terminated.
     if (closed_)
@@ -374,37 +750,353 @@ memory_ptr file_storage::reserve(size_t required, size_t minimum,
         throw std::runtime_error("Resize failure, store already closed.");
     }
 
-    if (required > capacity_)
+    if (read_only_)
+    {
+        memory->assign(data_);
+        throw std::runtime_error("Resize failure, store is read only.");
+    }
+
+    if (resizing)
     {
+        const auto start = asio::steady_clock::now();
+
         // TODO: manage overflow (requires ceiling_multiply).
         // Expansion is an integral number that represents a real number factor.
         const size_t resize = required * ((expansion + 100.0) / 100.0);
         const size_t target = std::max(minimum, resize);
 
-        mutex_.unlock_upgrade_and_lock();
-        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        // Growth within the reserved map requires no remap, so readers holding
+        // the shared lock are unaffected and writers remain excluded by the
+        // upgrade lock.
+        if (target <= reserved_)
+        {
+            log_resizing(target);
+
+            if (!truncate(target))
+            {
+                memory->assign(data_);
+                handle_error("resize", filename_);
+                throw std::runtime_error(
+                    "Resize failure, disk space may be low.");
+            }
 
-        // TODO: isolate cause and if recoverable (disk size) return nullptr.
-        // All existing database pointers are invalidated by this call.
-        if (!truncate_mapped(target))
+            capacity_ = target;
+        }
+        else
         {
-            handle_error("resize", filename_);
-            throw std::runtime_error("Resize failure, disk space may be low.");
+            remapping = true;
+            mutex_.unlock_upgrade_and_lock();
+            //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+            // TODO: isolate cause and if recoverable (disk size) return null.
+            // All existing database pointers are invalidated by this call.
+            if (!truncate_mapped(target))
+            {
+                handle_error("resize", filename_);
+                throw std::runtime_error(
+                    "Resize failure, disk space may be low.");
+            }
+
+            // Huge pages are an optimization, the remapped store remains valid.
+            if (!advise_huge_pages())
+                log_huge_pages();
+
+            // Access advice is an optimization, the remapped store is valid.
+            if (!advise_access())
+                log_advice();
+
+            // Placement is an optimization, the remapped store is valid.
+            if (!place_memory(false))
+                log_placement();
+
+            //-----------------------------------------------------------------
+            mutex_.unlock_and_lock_upgrade();
         }
 
-        //---------------------------------------------------------------------
-        mutex_.unlock_and_lock_upgrade();
+        resized = asio::steady_clock::now() - start;
     }
 
+    // Population is an optimization, the store remains valid.
+    if (!populate(required))
+        log_populate();
+
     logical_size_ = required;
     memory->assign(data_);
 
+    counters_mutex_.lock();
+    counters_.upgrades++;
+    counters_.upgrade_wait += waited;
+
+    if (resizing)
+    {
+        counters_.resizes++;
+        counters_.resize_duration += resized;
+        counters_.resize_maximum = std::max(counters_.resize_maximum, resized);
+
+        if (remapping)
+            counters_.remaps++;
+    }
+
+    counters_mutex_.unlock();
+
+    if (remapping)
+        BCD_TRACE3(remap, filename_.c_str(), capacity_,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                resized).count());
+
     // Always return in shared lock state.
     // The critical section does not end until this shared pointer is freed.
     return memory;
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// The caller holds a memory object, which precludes a remap of data_.
+void file_storage::dirty(const uint8_t* position, size_t size)
+{
+    if (size == 0)
+        return;
+
+    BITCOIN_ASSERT(position >= data_);
+    const auto offset = static_cast<size_t>(position - data_);
+    const auto begin = offset - (offset % page_size_);
+    const auto last = offset + size - 1u;
+    const auto end = last - (last % page_size_) + page_size_;
+    const auto logged = log_ != nullptr && size <= write_log::max_write;
+
+    // The bytes are copied to the log after they are written, so the last
+    // record of a range holds the latest bytes, whatever the order of writers.
+    if (logged)
+        log_->record(log_file_, offset, position, size);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(dirty_mutex_);
+
+    if (logged)
+    {
+        insert(logged_, begin, end);
+        return;
+    }
+
+    insert(dirty_, begin, end);
+    unwritten_bytes_ += insert(unwritten_, begin, end);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// static
+// Insert the range, coalescing with the ranges that it reaches, and return
+// the number of bytes that it adds to them.
+size_t file_storage::insert(ranges& dirty, size_t begin, size_t end)
+{
+    auto start = begin;
+    size_t covered = 0;
+
+    // Coalesce with a preceding range that reaches the new range.
+    auto it = dirty.upper_bound(begin);
+    if (it != dirty.begin() && std::prev(it)->second >= begin)
+    {
+        --it;
+        start = it->first;
+        end = std::max(end, it->second);
+    }
+
+    // Coalesce with succeeding ranges that the new range reaches.
+    while (it != dirty.end() && it->first <= end)
+    {
+        covered += it->second - it->first;
+        end = std::max(end, it->second);
+        it = dirty.erase(it);
+    }
+
+    dirty.emplace(start, end);
+    return (end - start) - covered;
+}
+
+// The caller holds a memory object, which precludes a remap of data_.
+void file_storage::prefetch(const uint8_t* position, size_t size, bool advise)
+{
+    if (size == 0)
+        return;
+
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(position);
+#endif
+
+    if (!advise)
+        return;
+
+    BITCOIN_ASSERT(position >= data_);
+    const auto offset = static_cast<size_t>(position - data_);
+    const auto begin = offset - (offset % page_size_);
+    const auto last = offset + size - 1u;
+    const auto end = last - (last % page_size_) + page_size_;
+
+    // Readahead is advisory, so failure is inconsequential.
+    madvise(data_ + begin, end - begin, MADV_WILLNEED);
+}
+
+// The caller holds a memory object, which precludes a remap of data_.
+void file_storage::punch(uint8_t* position, size_t size)
+{
+    if (size == 0)
+        return;
+
+    BITCOIN_ASSERT(position >= data_);
+    const auto offset = static_cast<size_t>(position - data_);
+    const auto end = offset + size;
+    const auto first = offset + (page_size_ - offset % page_size_) %
+        page_size_;
+    const auto last = end - (end % page_size_);
+
+#ifdef FALLOC_FL_PUNCH_HOLE
+    // A punched hole reads as zeros through the mapping and is not flushed.
+    if (first < last && fallocate(file_handle_, FALLOC_FL_PUNCH_HOLE |
+        FALLOC_FL_KEEP_SIZE, first, last - first) != FAIL)
+    {
+        std::fill(data_ + offset, data_ + first, 0x00);
+        std::fill(data_ + last, data_ + end, 0x00);
+        dirty(data_ + offset, first - offset);
+        dirty(data_ + last, end - last);
+        return;
+    }
+#endif
+
+    // Without hole support (or whole pages) the range is zeroed in place.
+    std::fill_n(position, size, 0x00);
+    dirty(position, size);
+}
+
+bool file_storage::advise(access_advice advice)
+{
+    auto success = true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    // The upgrade lock precludes a concurrent remap but not concurrent reads.
+    mutex_.lock_upgrade();
+
+    advice_ = advice;
+
+    if (!closed_)
+        success = advise_access();
+
+    mutex_.unlock_upgrade();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    return success || handle_error("madvise", filename_);
+}
+
+bool file_storage::place(memory_placement placement, uint64_t nodes)
+{
+    auto success = true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    // The upgrade lock precludes a concurrent remap but not concurrent reads.
+    mutex_.lock_upgrade();
+
+    placement_ = placement;
+    nodes_ = nodes;
+
+    if (!closed_)
+        success = place_memory(true);
+
+    mutex_.unlock_upgrade();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    return success || handle_error("mbind", filename_);
+}
+
+// Pages are read in so that a first query does not wait on the disk. Close
+// releases pinned pages, and pinning is limited by RLIMIT_MEMLOCK.
+bool file_storage::prefault(size_t size, bool pin)
+{
+    const auto start = asio::steady_clock::now();
+    auto success = true;
+    size_t bytes;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    // The upgrade lock precludes a remap but not concurrent access.
+    mutex_.lock_upgrade();
+
+    if (closed_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    bytes = std::min(size, logical_size_);
+
+    if (bytes != 0)
+    {
+#ifdef MADV_POPULATE_READ
+        if (madvise(data_, bytes, MADV_POPULATE_READ) == FAIL)
+#endif
+        {
+            // Readahead is advisory, the touch below faults in any remainder.
+            madvise(data_, bytes, MADV_WILLNEED);
+
+            // The volatile read cannot be elided by the compiler.
+            const volatile uint8_t* pages = data_;
+            for (size_t offset = 0; offset < bytes; offset += page_size_)
+                pages[offset];
+        }
+
+        if (pin && (success = mlock(data_, bytes) != FAIL))
+            pinned_ = std::max(pinned_, bytes);
+    }
+
+    mutex_.unlock_upgrade();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Keep logging out of the critical section.
+    if (success)
+        log_prefaulted(bytes, asio::steady_clock::now() - start);
+
+    return success;
+}
+
+// A reflink completes in time proportional to the extents, not the bytes.
+// Unmapped writes pending in the page cache are included by either copy.
+bool file_storage::copy(const path& from, const path& to)
+{
+#ifdef FICLONE
+    const auto source = ::open(from.string().c_str(), O_RDONLY);
+
+    if (source != INVALID_HANDLE)
+    {
+        const auto target = ::open(to.string().c_str(),
+            (O_WRONLY | O_CREAT | O_EXCL),
+            (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+
+        const auto cloned = target != INVALID_HANDLE &&
+            ::ioctl(target, FICLONE, source) != FAIL;
+
+        ::close(source);
+
+        if (target != INVALID_HANDLE)
+        {
+            ::close(target);
+
+            if (cloned)
+                return true;
+
+            // Not supported by the file system, the target is empty.
+            boost::system::error_code ec;
+            boost::filesystem::remove(to, ec);
+        }
+    }
+#endif
+
+    boost::system::error_code ec;
+    boost::filesystem::copy_file(from, to, ec);
+    return !ec;
+}
+
 // privates
 // ----------------------------------------------------------------------------
 
@@ -431,10 +1123,63 @@ size_t file_storage::page() const
 #endif
 }
 
+// Call under the shared lock. Pages are queried in bounded batches, as the
+// vector holds a byte per page. The bytes are limited to the range size.
+size_t file_storage::resident(size_t begin, size_t end) const
+{
+#ifdef _WIN32
+    return 0;
+#else
+    static constexpr size_t batch_pages = 1024u * 1024u;
+
+    if (begin >= end)
+        return 0;
+
+    size_t pages = 0;
+    const auto start = begin - (begin % page_size_);
+    std::vector<unsigned char> flags;
+
+    for (auto offset = start; offset < end;)
+    {
+        const auto size = std::min(end - offset, batch_pages * page_size_);
+        flags.resize((size + page_size_ - 1u) / page_size_);
+
+#ifdef __APPLE__
+        const auto result = mincore(data_ + offset, size,
+            reinterpret_cast<char*>(flags.data()));
+#else
+        const auto result = mincore(data_ + offset, size, flags.data());
+#endif
+
+        if (result == FAIL)
+            return 0;
+
+        for (const auto flag: flags)
+            pages += flag & 1u;
+
+        offset += size;
+    }
+
+    return std::min(pages * page_size_, end - begin);
+#endif
+}
+
+// The mapped length, which may exceed the file size when reserving.
+// Windows extends the file to the length of its mapping, so does not reserve.
+size_t file_storage::reservation(size_t size) const
+{
+#ifdef _WIN32
+    return size;
+#else
+    return std::max(size, reservation_);
+#endif
+}
+
 bool file_storage::unmap()
 {
-    const auto success = (munmap(data_, capacity_) != FAIL);
+    const auto success = (munmap(data_, reserved_) != FAIL);
     capacity_ = 0;
+    reserved_ = 0;
     data_ = nullptr;
     return success;
 }
@@ -444,27 +1189,83 @@ bool file_storage::map(size_t size)
     if (size == 0)
         return false;
 
-    data_ = reinterpret_cast<uint8_t*>(mmap(0, size, PROT_READ | PROT_WRITE,
+    // Pages beyond the end of the file are not accessed until it is extended.
+    const auto length = reservation(size);
+    const auto protection = read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+    data_ = reinterpret_cast<uint8_t*>(mmap(0, length, protection,
         MAP_SHARED, file_handle_, 0));
 
-    return validate(size);
+    return validate(size, length);
 }
 
 bool file_storage::remap(size_t size)
 {
 #ifdef MREMAP_MAYMOVE
-    data_ = reinterpret_cast<uint8_t*>(mremap(data_, capacity_, size,
+    // Advising a leading range splits the mapping, which mremap rejects.
+    if (huge_pages_ != 0 && huge_pages_ < reserved_)
+        return unmap() && map(size) && repin();
+
+    // Pinning a leading range also splits the mapping, so the pinned range
+    // is released for the remap (which merges the mapping) and pinned again.
+    if (pinned_ != 0 && munlock(data_, pinned_) == FAIL)
+        return false;
+
+    const auto length = reservation(size);
+    data_ = reinterpret_cast<uint8_t*>(mremap(data_, reserved_, length,
         MREMAP_MAYMOVE));
 
-    return validate(size);
+    return validate(size, length) && repin();
 #else
-    return unmap() && map(size);
+    return unmap() && map(size) && repin();
 #endif
 }
 
+// Pinned pages are released by a remap, a failure to pin them again (such as
+// by a lower RLIMIT_MEMLOCK) leaves them unpinned and does not fail growth.
+bool file_storage::repin()
+{
+    if (pinned_ != 0 && mlock(data_, std::min(pinned_, capacity_)) == FAIL)
+        pinned_ = 0;
+
+    return true;
+}
+
+// Growth is preallocated in multiples of a nonzero extent so that the file
+// remains physically contiguous. Blocks allocated beyond the file size are kept
+// for subsequent growth, and are released by any shrink (including close).
 bool file_storage::truncate(size_t size)
 {
-    return ftruncate(file_handle_, size) != FAIL;
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (extent_ != 0 && size > allocated_)
+    {
+        // Round up to the next extent multiple, clamped to size on overflow.
+        const auto remainder = size % extent_;
+        const auto padding = remainder == 0 ? 0 : extent_ - remainder;
+        const auto allocation = size > max_size_t - padding ? size :
+            size + padding;
+
+        const auto start = asio::steady_clock::now();
+
+        if (fallocate(file_handle_, FALLOC_FL_KEEP_SIZE, allocated_,
+            allocation - allocated_) != FAIL)
+        {
+            log_allocated(allocation, asio::steady_clock::now() - start);
+            allocated_ = allocation;
+        }
+
+        // A file system without preallocation support remains sparse.
+        else if (errno != EOPNOTSUPP)
+            return false;
+    }
+#endif
+
+    if (ftruncate(file_handle_, size) == FAIL)
+        return false;
+
+    if (size < capacity_)
+        allocated_ = size;
+
+    return true;
 }
 
 bool file_storage::truncate_mapped(size_t size)
@@ -486,16 +1287,162 @@ bool file_storage::truncate_mapped(size_t size)
 #endif
 }
 
-bool file_storage::validate(size_t size)
+// Advise transparent huge pages over the configured leading range of the map.
+// Explicit (hugetlbfs) pages cannot back a regular file mapping, so this is
+// advisory only and is ignored where the platform does not support it.
+bool file_storage::advise_huge_pages()
+{
+    if (huge_pages_ == 0 || data_ == nullptr)
+        return true;
+
+#ifdef MADV_HUGEPAGE
+    const auto size = std::min(huge_pages_, reserved_);
+    return madvise(data_, size, MADV_HUGEPAGE) != FAIL;
+#else
+    return true;
+#endif
+}
+
+// Linux tracks the pages written through a shared map, so synchronizing the
+// file completes exactly the written pages. Otherwise each range is synced,
+// as it is when exact (other written pages are then not synced).
+bool file_storage::sync(const ranges& dirty, bool exact) const
+{
+    if (dirty.empty())
+        return true;
+
+#ifdef __linux__
+    if (!exact)
+        return fdatasync(file_handle_) != FAIL;
+#endif
+
+    for (const auto& range: dirty)
+    {
+        // Ranges beyond a shrunken file are no longer mapped.
+        if (range.first >= capacity_)
+            break;
+
+        const auto size = std::min(range.second, capacity_) - range.first;
+
+        if (msync(data_ + range.first, size, MS_SYNC) == FAIL)
+            return false;
+    }
+
+    return true;
+}
+
+// Advise the access pattern over the full map, which avoids splitting it.
+// Willneed initiates reads, so is limited to the extent of the file.
+bool file_storage::advise_access()
+{
+    switch (advice_)
+    {
+        case access_advice::normal:
+            return madvise(data_, reserved_, MADV_NORMAL) != FAIL;
+        case access_advice::sequential:
+            return madvise(data_, reserved_, MADV_SEQUENTIAL) != FAIL;
+        case access_advice::willneed:
+            return madvise(data_, reserved_, MADV_NORMAL) != FAIL &&
+                madvise(data_, capacity_, MADV_WILLNEED) != FAIL;
+        default:
+        case access_advice::random:
+            return madvise(data_, reserved_, MADV_RANDOM) != FAIL;
+    }
+}
+
+// Place the full map, which avoids splitting it. Page cache pages are
+// allocated under the policy of the faulting thread, so the policy of the map
+// migrates the resident pages (mapped only here) and pinned workers place the
+// pages that they fault. A new map has no faulted pages and default policy,
+// so migration and reset apply only to the placement of an open map.
+bool file_storage::place_memory(bool migrate)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (data_ == nullptr)
+        return true;
+
+    // The kernel takes one more than the number of bits in the mask.
+    const unsigned long mask = nodes_ == 0 ? numa_nodes() : nodes_;
+    const unsigned long bits = sizeof(mask) * 8u + 1u;
+    const unsigned flags = migrate ? MPOL_MF_MOVE : 0;
+
+    switch (placement_)
+    {
+        case memory_placement::bind:
+            return mask == 0 || syscall(SYS_mbind, data_, reserved_,
+                MPOL_BIND, &mask, bits, flags) != FAIL;
+        case memory_placement::interleave:
+            return mask == 0 || syscall(SYS_mbind, data_, reserved_,
+                MPOL_INTERLEAVE, &mask, bits, flags) != FAIL;
+        default:
+        case memory_placement::local:
+            return !migrate || syscall(SYS_mbind, data_, reserved_,
+                MPOL_DEFAULT, nullptr, 0, 0) != FAIL || errno == ENOSYS;
+    }
+#else
+    return placement_ == memory_placement::local;
+#endif
+}
+
+// Populate pages beyond the logical end in batches of the configured size, so
+// that writers do not take a page fault on each newly-allocated page. Space
+// beyond the logical end is unused, so it may be zero filled. Batches are
+// deferred until less than half of the populated space remains.
+bool file_storage::populate(size_t required)
+{
+    if (populate_ == 0)
+        return true;
+
+    const auto start = std::max(populated_, logical_size_);
+    const auto end = std::min(required + populate_, capacity_);
+
+    if (start >= std::min(required + populate_ / 2, capacity_))
+        return true;
+
+    populated_ = end;
+
+#ifdef MADV_POPULATE_WRITE
+    // Does not change content, so the start may be rounded down to a page.
+    const auto page_start = start - (start % page_size_);
+    if (madvise(data_ + page_start, end - page_start, MADV_POPULATE_WRITE) !=
+        FAIL)
+        return true;
+#endif
+
+#ifdef _WIN32
+    return true;
+#else
+    // Fall back to batched writes through the file, coherent with the map.
+    static const size_t chunk = 1024u * 1024u;
+    const data_chunk zeros(std::min(end - start, chunk), 0);
+
+    for (auto offset = start; offset < end;)
+    {
+        const auto size = std::min(end - offset, zeros.size());
+        const auto written = pwrite(file_handle_, zeros.data(), size, offset);
+
+        if (written <= 0)
+            return false;
+
+        offset += static_cast<size_t>(written);
+    }
+
+    return true;
+#endif
+}
+
+bool file_storage::validate(size_t size, size_t length)
 {
     if (data_ == MAP_FAILED)
     {
         capacity_ = 0;
+        reserved_ = 0;
         data_ = nullptr;
         return false;
     }
 
     capacity_ = size;
+    reserved_ = length;
     return true;
 }
 
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/processor_affinity.hpp>
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+#ifdef __linux__
+static const std::string node_directory = "/sys/devices/system/node/";
+
+// Parse a sysfs list, such as "0-3,8,10-11", empty if missing or invalid.
+static processors read_list(const std::string& filename)
+{
+    std::ifstream file(filename);
+    std::string text;
+    processors values;
+
+    if (!std::getline(file, text))
+        return values;
+
+    size_t position = 0;
+    while (position < text.size())
+    {
+        const auto comma = std::min(text.find(',', position), text.size());
+        const auto range = text.substr(position, comma - position);
+        const auto dash = range.find('-');
+        position = comma + 1u;
+
+        try
+        {
+            const size_t first = std::stoul(range.substr(0, dash));
+            const size_t last = dash == std::string::npos ? first :
+                std::stoul(range.substr(dash + 1u));
+
+            for (auto value = first; value <= last; ++value)
+                values.push_back(value);
+        }
+        catch (const std::exception&)
+        {
+            return {};
+        }
+    }
+
+    return values;
+}
+#endif
+
+uint64_t numa_nodes()
+{
+    uint64_t nodes = 0;
+
+#ifdef __linux__
+    for (const auto node: read_list(node_directory + "online"))
+        if (node < 64u)
+            nodes |= uint64_t(1) << node;
+#endif
+
+    return nodes;
+}
+
+processors numa_processors(uint64_t nodes)
+{
+    processors cpus;
+
+#ifdef __linux__
+    for (size_t node = 0; node < 64u; ++node)
+    {
+        if ((nodes & (uint64_t(1) << node)) == 0)
+            continue;
+
+        const auto name = node_directory + "node" + std::to_string(node) +
+            "/cpulist";
+
+        for (const auto cpu: read_list(name))
+            cpus.push_back(cpu);
+    }
+#endif
+
+    return cpus;
+}
+
+// The prior set is retained only when the thread is pinned.
+processor_affinity::processor_affinity(const processors& pinned)
+{
+#ifdef __linux__
+    if (pinned.empty())
+        return;
+
+    cpu_set_t prior;
+    cpu_set_t target;
+    CPU_ZERO(&target);
+
+    for (const auto cpu: pinned)
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &target);
+
+    if (sched_getaffinity(0, sizeof(prior), &prior) != 0 ||
+        sched_setaffinity(0, sizeof(target), &target) != 0)
+        return;
+
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &prior))
+            prior_.push_back(cpu);
+#endif
+}
+
+processor_affinity::~processor_affinity()
+{
+#ifdef __linux__
+    if (prior_.empty())
+        return;
+
+    cpu_set_t prior;
+    CPU_ZERO(&prior);
+
+    for (const auto cpu: prior_)
+        CPU_SET(cpu, &prior);
+
+    sched_setaffinity(0, sizeof(prior), &prior);
+#endif
+}
+
+bool processor_affinity::pinned() const
+{
+    return !prior_.empty();
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/storage_counters.hpp>
+
+#include <algorithm>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+storage_counters::storage_counters()
+  : resizes(0),
+    remaps(0),
+    resize_duration(asio::duration::zero()),
+    resize_maximum(asio::duration::zero()),
+    flushes(0),
+    flush_duration(asio::duration::zero()),
+    upgrades(0),
+    upgrade_wait(asio::duration::zero()),
+    unwritten(0),
+    reserved(0),
+    capacity(0),
+    logical(0)
+{
+}
+
+storage_counters& storage_counters::operator+=(const storage_counters& other)
+{
+    resizes += other.resizes;
+    remaps += other.remaps;
+    resize_duration += other.resize_duration;
+    resize_maximum = std::max(resize_maximum, other.resize_maximum);
+    flushes += other.flushes;
+    flush_duration += other.flush_duration;
+    upgrades += other.upgrades;
+    upgrade_wait += other.upgrade_wait;
+    unwritten += other.unwritten;
+    reserved += other.reserved;
+    capacity += other.capacity;
+    logical += other.logical;
+    return *this;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/storage_residency.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+storage_residency::storage_residency()
+  : mapped(0),
+    logical(0),
+    head(0),
+    head_resident(0),
+    body_resident(0),
+    dirty(0)
+{
+}
+
+storage_residency& storage_residency::operator+=(
+    const storage_residency& other)
+{
+    mapped += other.mapped;
+    logical += other.logical;
+    head += other.head;
+    head_resident += other.head_resident;
+    body_resident += other.body_resident;
+    dirty += other.dirty;
+    return *this;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/striped_mutex.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// Each mutex is larger than a cache line, so stripes do not false share.
+const size_t striped_mutex::default_stripes = 64;
+
+striped_mutex::striped_mutex(size_t stripes)
+  : stripes_(stripes),
+    mutexes_(new shared_mutex[stripes])
+{
+    BITCOIN_ASSERT(stripes != 0);
+}
+
+shared_mutex& striped_mutex::operator[](size_t index) const
+{
+    return mutexes_[index % stripes_];
+}
+
+size_t striped_mutex::stripes() const
+{
+    return stripes_;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/striped_sequence.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// An odd sequence indicates a write in progress.
+static inline bool is_writing(uint32_t sequence)
+{
+    return (sequence & 1u) != 0;
+}
+
+const size_t striped_sequence::default_stripes = 1024;
+
+striped_sequence::striped_sequence(size_t stripes)
+  : stripes_(stripes),
+    sequences_(new sequence[stripes])
+{
+    BITCOIN_ASSERT(stripes != 0);
+
+    for (size_t stripe = 0; stripe < stripes_; ++stripe)
+        sequences_[stripe].value.store(0, std::memory_order_relaxed);
+}
+
+uint32_t striped_sequence::begin_read(size_t index) const
+{
+    const auto& sequence = at(index);
+    auto value = sequence.load(std::memory_order_acquire);
+
+    while (is_writing(value))
+    {
+        std::this_thread::yield();
+        value = sequence.load(std::memory_order_acquire);
+    }
+
+    return value;
+}
+
+bool striped_sequence::end_read(size_t index, uint32_t sequence) const
+{
+    // Order the reads of values before the reread of the sequence.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return at(index).load(std::memory_order_relaxed) == sequence;
+}
+
+void striped_sequence::begin_write(size_t index) const
+{
+    auto& sequence = at(index);
+    auto value = sequence.load(std::memory_order_relaxed);
+
+    // Move the sequence from even to odd, once no other write is in progress.
+    while (is_writing(value) || !sequence.compare_exchange_weak(value,
+        value + 1u, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        if (is_writing(value))
+        {
+            std::this_thread::yield();
+            value = sequence.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Order the odd sequence before the writes of values.
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void striped_sequence::end_write(size_t index) const
+{
+    // Release the writes of values with the even sequence.
+    at(index).fetch_add(1u, std::memory_order_release);
+}
+
+size_t striped_sequence::stripes() const
+{
+    return stripes_;
+}
+
+// private
+std::atomic<uint32_t>& striped_sequence::at(size_t index) const
+{
+    return sequences_[index % stripes_].value;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,418 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/memory/write_log.hpp>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include "../mman-win32/mman.h"
+#else
+    #include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/file_storage.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
+// Log format (batches of records, each batch ending in a commit marker):
+// ----------------------------------------------------------------------------
+// enroll: [ kind:1 = 0 ][ file:1 ][ length:1 ][ name:length ]
+// write:  [ kind:1 = 1 ][ file:1 ][ offset:8 ][ size:1 ][ bytes:size ]
+// commit: [ kind:1 = 2 ][ length:4 ][ checksum:4 ] (of the batch)
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+#define FAIL -1
+#define INVALID_HANDLE -1
+
+static constexpr uint8_t kind_enroll = 0;
+static constexpr uint8_t kind_write = 1;
+static constexpr uint8_t kind_commit = 2;
+static constexpr size_t enroll_size = 3;
+static constexpr size_t write_size = 11;
+static constexpr size_t commit_size = 9;
+
+const size_t write_log::max_write = 32;
+
+struct change
+{
+    uint8_t file;
+    uint64_t offset;
+    data_chunk bytes;
+};
+
+static int open_file(const boost::filesystem::path& filename)
+{
+#ifdef _WIN32
+    return _wopen(filename.wstring().c_str(),
+        (O_RDWR | O_CREAT | O_APPEND | _O_BINARY), (_S_IREAD | _S_IWRITE));
+#else
+    return ::open(filename.string().c_str(), (O_RDWR | O_CREAT | O_APPEND),
+        (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+#endif
+}
+
+static void append_marker(data_chunk& batch)
+{
+    const auto length = static_cast<uint32_t>(batch.size());
+    const auto checksum = bitcoin_checksum(batch);
+    const auto start = batch.size();
+    batch.resize(start + commit_size);
+    auto serial = make_unsafe_serializer(batch.begin() + start);
+    serial.write_byte(kind_commit);
+    serial.write_4_bytes_little_endian(length);
+    serial.write_4_bytes_little_endian(checksum);
+}
+
+static bool apply(const boost::filesystem::path& filename,
+    const std::vector<change>& changes)
+{
+    file_storage file(filename);
+
+    if (!file.open())
+        return false;
+
+    for (const auto& change: changes)
+    {
+        const auto end = change.offset + change.bytes.size();
+
+        // The growth of the file may not have been synced.
+        if (end > file.logical())
+            file.reserve(end);
+
+        // The memory object must be released before any later resize.
+        const auto memory = file.access();
+        const auto position = memory->buffer() + change.offset;
+        std::copy(change.bytes.begin(), change.bytes.end(), position);
+        file.dirty(position, change.bytes.size());
+    }
+
+    // Close synchronizes the full logical size of the file.
+    return file.close();
+}
+
+// static
+// Records of a batch apply only once its marker is read and matches the
+// batch, so a torn or partial batch at the end of the log is discarded.
+bool write_log::replay(const path& filename)
+{
+    data_chunk log;
+
+    {
+        ifstream file(filename.string(), std::ios::binary);
+
+        if (!file.good())
+            return true;
+
+        log.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    }
+
+    std::map<uint8_t, std::string> names;
+    std::map<uint8_t, std::vector<change>> changes;
+    std::map<uint8_t, std::string> batch_names;
+    std::vector<change> batch_changes;
+    size_t batch = 0;
+    size_t position = 0;
+
+    while (position < log.size())
+    {
+        auto deserial = make_unsafe_deserializer(log.begin() + position);
+        const auto remaining = log.size() - position;
+        const auto kind = deserial.read_byte();
+
+        if (kind == kind_commit)
+        {
+            if (remaining < commit_size)
+                break;
+
+            const data_slice bytes(log.data() + batch, log.data() + position);
+            const size_t length = deserial.read_4_bytes_little_endian();
+            const auto checksum = deserial.read_4_bytes_little_endian();
+
+            if (length != position - batch ||
+                checksum != bitcoin_checksum(bytes))
+                break;
+
+            for (const auto& name: batch_names)
+                names[name.first] = name.second;
+
+            for (auto& change: batch_changes)
+                changes[change.file].push_back(std::move(change));
+
+            batch_names.clear();
+            batch_changes.clear();
+            position += commit_size;
+            batch = position;
+        }
+        else if (kind == kind_enroll)
+        {
+            if (remaining < enroll_size)
+                break;
+
+            const auto file = deserial.read_byte();
+            const size_t length = deserial.read_byte();
+
+            if (remaining < enroll_size + length)
+                break;
+
+            const auto name = log.begin() + position + enroll_size;
+            batch_names[file] = std::string(name, name + length);
+            position += enroll_size + length;
+        }
+        else if (kind == kind_write)
+        {
+            if (remaining < write_size)
+                break;
+
+            change record;
+            record.file = deserial.read_byte();
+            record.offset = deserial.read_8_bytes_little_endian();
+            const size_t size = deserial.read_byte();
+
+            if (remaining < write_size + size)
+                break;
+
+            const auto bytes = log.begin() + position + write_size;
+            record.bytes.assign(bytes, bytes + size);
+            batch_changes.push_back(std::move(record));
+            position += write_size + size;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    const auto directory = filename.parent_path();
+
+    for (const auto& file: changes)
+    {
+        const auto name = names.find(file.first);
+
+        if (name == names.end() || !apply(directory / name->second,
+            file.second))
+            return false;
+    }
+
+    ofstream file(filename.string(), std::ios::binary | std::ios::trunc);
+    return file.good();
+}
+
+write_log::write_log(const path& filename)
+  : filename_(filename),
+    file_handle_(INVALID_HANDLE),
+    size_(0)
+{
+}
+
+write_log::~write_log()
+{
+    close();
+}
+
+// Enrollments are written as the first batch, so that they are replayed.
+bool write_log::open()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+
+    if (file_handle_ == INVALID_HANDLE &&
+        (file_handle_ = open_file(filename_)) == INVALID_HANDLE)
+        return false;
+
+    if (ftruncate(file_handle_, 0) == FAIL)
+        return false;
+
+    size_ = 0;
+    return write(enrollments());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool write_log::close()
+{
+    if (file_handle_ == INVALID_HANDLE)
+        return true;
+
+    const auto committed = commit();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    const auto closed = ::close(file_handle_) != FAIL;
+    file_handle_ = INVALID_HANDLE;
+    return committed && closed;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+uint8_t write_log::enroll(const path& filename)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto name = filename.filename().string();
+    BITCOIN_ASSERT(names_.size() <= max_uint8);
+    BITCOIN_ASSERT(name.size() <= max_uint8);
+    const auto file = static_cast<uint8_t>(names_.size());
+    names_.push_back(name);
+
+    // A file enrolled after open is enrolled with the next commit.
+    if (file_handle_ == INVALID_HANDLE)
+        return file;
+
+    const auto start = pending_.size();
+    pending_.resize(start + enroll_size + name.size());
+    auto serial = make_unsafe_serializer(pending_.begin() + start);
+    serial.write_byte(kind_enroll);
+    serial.write_byte(file);
+    serial.write_byte(static_cast<uint8_t>(name.size()));
+    serial.write_string(name, name.size());
+    return file;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void write_log::record(uint8_t file, size_t offset, const uint8_t* data,
+    size_t size)
+{
+    BITCOIN_ASSERT(size <= max_write);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto start = pending_.size();
+    pending_.resize(start + write_size + size);
+    auto serial = make_unsafe_serializer(pending_.begin() + start);
+    serial.write_byte(kind_write);
+    serial.write_byte(file);
+    serial.write_8_bytes_little_endian(offset);
+    serial.write_byte(static_cast<uint8_t>(size));
+    std::copy_n(data, size, pending_.begin() + start + write_size);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Records are taken from pending under the mutex, so that writers continue
+// to log while the batch is synced.
+bool write_log::commit()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> commit_lock(commit_mutex_);
+
+    if (file_handle_ == INVALID_HANDLE)
+        return false;
+
+    data_chunk batch;
+    mutex_.lock();
+    batch.swap(pending_);
+    mutex_.unlock();
+
+    if (batch.empty())
+        return true;
+
+    append_marker(batch);
+    return write(batch);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Committed records precede the checkpoint that covers them, pending records
+// may follow it, so only committed records are discarded.
+bool write_log::reset()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+
+    if (file_handle_ == INVALID_HANDLE || ftruncate(file_handle_, 0) == FAIL)
+        return false;
+
+    size_ = 0;
+    return write(enrollments());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t write_log::size() const
+{
+    return size_;
+}
+
+// private
+// Called under the commit mutex.
+bool write_log::write(const data_chunk& data)
+{
+    size_t written = 0;
+
+    while (written < data.size())
+    {
+        const auto result = ::write(file_handle_, data.data() + written,
+            static_cast<unsigned>(data.size() - written));
+
+        if (result <= 0)
+            return false;
+
+        written += static_cast<size_t>(result);
+    }
+
+    size_ += written;
+    return fsync(file_handle_) != FAIL;
+}
+
+// private
+data_chunk write_log::enrollments() const
+{
+    data_chunk batch;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    for (size_t file = 0; file < names_.size(); ++file)
+    {
+        const auto& name = names_[file];
+        const auto start = batch.size();
+        batch.resize(start + enroll_size + name.size());
+        auto serial = make_unsafe_serializer(batch.begin() + start);
+        serial.write_byte(kind_enroll);
+        serial.write_byte(static_cast<uint8_t>(file));
+        serial.write_byte(static_cast<uint8_t>(name.size()));
+        serial.write_string(name, name.size());
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    append_marker(batch);
+    return batch;
+}
+
+} // namespace database
+} // namespace libbitcoin
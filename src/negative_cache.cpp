@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/negative_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+// The null hash marks an empty slot, it is never looked up.
+negative_cache::negative_cache(size_t capacity)
+  : hits_(0), sequence_(0), capacity_(capacity), slots_(capacity, null_hash)
+{
+}
+
+bool negative_cache::disabled() const
+{
+    return capacity_ == 0;
+}
+
+size_t negative_cache::capacity() const
+{
+    return capacity_;
+}
+
+size_t negative_cache::hits() const
+{
+    return hits_.load();
+}
+
+uint64_t negative_cache::sequence() const
+{
+    return sequence_.load();
+}
+
+// A store between the lookup and this call may have erased an earlier miss,
+// so the miss is not recorded if any erase has occurred since the lookup.
+void negative_cache::insert(const hash_digest& hash, uint64_t sequence)
+{
+    if (disabled())
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (sequence_.load() == sequence)
+        slots_[slot(hash)] = hash;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool negative_cache::contains(const hash_digest& hash) const
+{
+    if (disabled())
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (slots_[slot(hash)] != hash)
+        return false;
+    ///////////////////////////////////////////////////////////////////////////
+
+    ++hits_;
+    return true;
+}
+
+void negative_cache::erase(const hash_digest& hash)
+{
+    if (disabled())
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    ++sequence_;
+    auto& entry = slots_[slot(hash)];
+
+    if (entry == hash)
+        entry = null_hash;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void negative_cache::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    ++sequence_;
+    std::fill(slots_.begin(), slots_.end(), null_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+size_t negative_cache::slot(const hash_digest& hash) const
+{
+    // The digest is uniformly distributed, so its leading bytes suffice.
+    return from_little_endian_unsafe<uint64_t>(hash.begin()) % capacity_;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/primitives/table_statistics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace libbitcoin {
+namespace database {
+
+const size_t table_statistics::histogram_size = 16;
+
+table_statistics::table_statistics()
+  : buckets(0),
+    sampled(0),
+    elements(0),
+    empty(0),
+    maximum(0),
+    histogram(histogram_size, 0)
+{
+}
+
+void table_statistics::add(size_t length)
+{
+    ++sampled;
+    elements += length;
+    empty += (length == 0 ? 1 : 0);
+    maximum = std::max(maximum, static_cast<uint64_t>(length));
+    ++histogram[std::min(length, histogram_size - 1)];
+}
+
+double table_statistics::load_factor() const
+{
+    return sampled == 0 ? 0.0 : static_cast<double>(elements) / sampled;
+}
+
+uint64_t table_statistics::estimated_elements() const
+{
+    return sampled == 0 ? 0 : static_cast<uint64_t>(
+        std::llround(load_factor() * buckets));
+}
+
+uint64_t table_statistics::recommended_buckets(double load) const
+{
+    if (load <= 0.0)
+        return buckets;
+
+    const auto ideal = std::ceil(estimated_elements() / load);
+    return std::max(static_cast<uint64_t>(ideal), uint64_t(1));
+}
+
+} // namespace database
+} // namespace libbitcoin
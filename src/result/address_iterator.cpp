@@ -18,14 +18,38 @@
  */
 #include <bitcoin/database/result/address_iterator.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/memory/memory.hpp>
+
 namespace libbitcoin {
 namespace database {
 
 using namespace bc::system;
 using namespace bc::system::chain;
 
-address_iterator::address_iterator(const const_element& element)
-  : element_(element)
+// Page format: [ next:8 ][ capacity:2 ][ row * capacity ] (rows ascending).
+static constexpr auto page_header_size = sizeof(file_offset) +
+    sizeof(uint16_t);
+static const auto row_size = payment_record::satoshi_fixed_size(false);
+static const auto no_page = address_iterator::page_manager::not_allocated;
+
+// A page token is the page and the count of its rows through the position.
+static constexpr auto position_bits = 8u;
+static constexpr uint64_t position_mask = (1u << position_bits) - 1u;
+
+const uint64_t address_iterator::end_token = max_uint64;
+
+address_iterator::address_iterator(const const_element& element,
+    size_t read_ahead)
+  : element_(element),
+    read_ahead_(read_ahead),
+    stride_(0),
+    pages_(nullptr),
+    page_(no_page),
+    next_(no_page),
+    position_(0)
 {
     // Because it is common to not return all addresses, based on a total count
     // and/or height limitation, and because the set is contained in a
@@ -34,6 +58,35 @@ address_iterator::address_iterator(const const_element& element)
     populate();
 }
 
+// Each page is read in one pass, as its rows are contiguous.
+address_iterator::address_iterator(const const_element& terminator,
+    const page_manager& pages, file_offset head, size_t count,
+    size_t read_ahead)
+  : element_(terminator),
+    read_ahead_(read_ahead),
+    stride_(0),
+    pages_(&pages),
+    page_(no_page),
+    next_(no_page),
+    position_(0)
+{
+    read_page(head, count);
+}
+
+address_iterator::address_iterator(const const_element& terminator,
+    const page_manager& pages, uint64_t token, size_t read_ahead)
+  : element_(terminator),
+    read_ahead_(read_ahead),
+    stride_(0),
+    pages_(&pages),
+    page_(no_page),
+    next_(no_page),
+    position_(0)
+{
+    if (token != end_token)
+        read_page(token >> position_bits, token & position_mask);
+}
+
 void address_iterator::populate()
 {
     if (!element_.terminal())
@@ -45,6 +98,79 @@ void address_iterator::populate()
     }
 }
 
+// Rows linked at a regular stride (contiguous runs) are prefetched ahead, a
+// new stride over the full distance, an established one a row further.
+void address_iterator::prefetch(array_index previous)
+{
+    if (read_ahead_ == 0 || element_.terminal() ||
+        previous == const_element::not_found)
+        return;
+
+    const int64_t link = element_.link();
+    const auto stride = link - static_cast<int64_t>(previous);
+    const auto first = stride == stride_ ? read_ahead_ : 1u;
+    stride_ = stride;
+
+    for (auto step = first; step <= read_ahead_; ++step)
+    {
+        const auto ahead = link + stride * static_cast<int64_t>(step);
+
+        if (ahead >= 0 && ahead < const_element::not_found)
+            element_.prefetch(static_cast<array_index>(ahead), row_size,
+                true);
+    }
+}
+
+void address_iterator::read_page(file_offset page, size_t count)
+{
+    page_ = page;
+    rows_.clear();
+
+    if (page_ == no_page)
+    {
+        position_ = 0;
+        return;
+    }
+
+    const auto memory = pages_->get(page_);
+    auto deserial = make_unsafe_deserializer(memory->buffer());
+    next_ = deserial.read_8_bytes_little_endian();
+    const size_t capacity = deserial.read_2_bytes_little_endian();
+
+    // Pages other than the head are full.
+    position_ = count == 0 ? capacity : count;
+    rows_.resize(position_);
+
+    // The next (older) page is no larger than this one.
+    if (read_ahead_ != 0 && next_ != no_page)
+    {
+        const auto ahead = pages_->access(next_);
+        pages_->prefetch(ahead, page_header_size + capacity * row_size, true);
+    }
+
+    for (auto& row: rows_)
+        row.from_data(deserial, false);
+
+    payment_ = rows_.back();
+}
+
+void address_iterator::increment()
+{
+    if (pages_ == nullptr)
+    {
+        const auto previous = element_.link();
+        element_.jump_next();
+        prefetch(previous);
+        populate();
+        return;
+    }
+
+    if (--position_ != 0)
+        payment_ = rows_[position_ - 1u];
+    else
+        read_page(next_, 0);
+}
+
 address_iterator::pointer address_iterator::operator->() const
 {
     return payment_;
@@ -57,24 +183,24 @@ address_iterator::reference address_iterator::operator*() const
 
 address_iterator::iterator& address_iterator::operator++()
 {
-    element_.jump_next();
-    populate();
+    increment();
     return *this;
 }
 
 address_iterator::iterator address_iterator::operator++(int)
 {
     auto it = *this;
-    element_.jump_next();
-    populate();
+    increment();
     return it;
 }
 
 bool address_iterator::operator==(const address_iterator& other) const
 {
     // This is sufficient due to the behavior of the list_element equality
-    // operator override. Only the link values are compared.
-    return element_ == other.element_;
+    // operator override. Only the link values are compared. Paged rows are
+    // compared by page and position, the element is then a terminator.
+    return element_ == other.element_ && page_ == other.page_ &&
+        position_ == other.position_;
 }
 
 bool address_iterator::operator!=(const address_iterator& other) const
@@ -82,5 +208,60 @@ bool address_iterator::operator!=(const address_iterator& other) const
     return !(*this == other);
 }
 
+// Positioning.
+// ----------------------------------------------------------------------------
+
+uint64_t address_iterator::token() const
+{
+    if (pages_ == nullptr)
+        return element_.terminal() ? end_token : element_.link();
+
+    if (page_ == no_page)
+        return end_token;
+
+    BITCOIN_ASSERT(page_ < (end_token >> position_bits));
+    return (page_ << position_bits) | position_;
+}
+
+void address_iterator::skip(size_t count)
+{
+    if (pages_ == nullptr)
+    {
+        for (; count != 0 && !element_.terminal(); --count)
+            element_.jump_next();
+
+        populate();
+        return;
+    }
+
+    auto page = page_;
+    auto next = next_;
+    auto rows = position_;
+
+    // Whole pages are skipped by reading only their headers.
+    while (page != no_page && count >= rows)
+    {
+        count -= rows;
+        page = next;
+
+        if (page == no_page)
+            break;
+
+        const auto memory = pages_->get(page);
+        auto deserial = make_unsafe_deserializer(memory->buffer());
+        next = deserial.read_8_bytes_little_endian();
+        rows = deserial.read_2_bytes_little_endian();
+    }
+
+    if (page != page_)
+        read_page(page, rows);
+
+    if (page_ == no_page || count == 0)
+        return;
+
+    position_ -= count;
+    payment_ = rows_[position_ - 1u];
+}
+
 } // namespace database
 } // namespace libbitcoin
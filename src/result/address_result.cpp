@@ -30,14 +30,31 @@ namespace database {
 using namespace bc::system;
 
 address_result::address_result(const const_value_type& element,
-    const hash_digest& hash)
-  : hash_(hash), element_(element)
+    const hash_digest& hash, size_t read_ahead)
+  : hash_(hash),
+    element_(element),
+    pages_(nullptr),
+    head_(page_manager::not_allocated),
+    count_(0),
+    read_ahead_(read_ahead)
+{
+}
+
+address_result::address_result(const const_value_type& terminator,
+    const page_manager& pages, file_offset head, size_t count,
+    const hash_digest& hash, size_t read_ahead)
+  : hash_(hash),
+    element_(terminator),
+    pages_(&pages),
+    head_(head),
+    count_(count),
+    read_ahead_(read_ahead)
 {
 }
 
 address_result::operator bool() const
 {
-    return element_;
+    return element_ || head_ != page_manager::not_allocated;
 }
 
 const hash_digest& address_result::hash() const
@@ -47,7 +64,10 @@ const hash_digest& address_result::hash() const
 
 address_iterator address_result::begin() const
 {
-    return { element_ };
+    if (pages_ != nullptr && head_ != page_manager::not_allocated)
+        return { element_, *pages_, head_, count_, read_ahead_ };
+
+    return { element_, read_ahead_ };
 }
 
 address_iterator address_result::end() const
@@ -55,5 +75,21 @@ address_iterator address_result::end() const
     return { element_.terminator() };
 }
 
+address_iterator address_result::begin(uint64_t token) const
+{
+    if (pages_ != nullptr)
+        return { element_, *pages_, token, read_ahead_ };
+
+    return { token == address_iterator::end_token ? element_.terminator() :
+        element_.at(static_cast<link_type>(token)), read_ahead_ };
+}
+
+address_iterator address_result::seek(size_t offset) const
+{
+    auto it = begin();
+    it.skip(offset);
+    return it;
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -26,6 +26,7 @@
 #include <bitcoin/database/memory/memory.hpp>
 #include <bitcoin/database/primitives/record_manager.hpp>
 #include <bitcoin/database/result/transaction_iterator.hpp>
+#include <bitcoin/database/result/transaction_links.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -33,12 +34,18 @@ namespace database {
 using namespace bc::system;
 using namespace bc::system::chain;
 
-// Placeholder for unimplemented checksum caching.
+// The checksum of a block without a short id salt.
 static constexpr auto no_checksum = 0u;
 
+constexpr size_t block_result::layout::header_size;
+constexpr size_t block_result::layout::size;
+
 block_result::block_result(const const_element_type& element,
     shared_mutex& metadata_mutex, const manager& index_manager)
-  : height_(0),
+  : version_(0),
+    timestamp_(0),
+    bits_(0),
+    height_(0),
     median_time_past_(0),
     state_(block_state::missing),
     checksum_(no_checksum),
@@ -51,25 +58,25 @@ block_result::block_result(const const_element_type& element,
     if (!element_)
         return;
 
-    const auto reader = [&](byte_deserializer& deserial)
-    {
-        // These are never updated.
-        header_.from_data(deserial, element_.key(), false);
-        median_time_past_ = deserial.read_4_bytes_little_endian();
-        height_ = deserial.read_4_bytes_little_endian();
-
-        // Critical Section.
-        ///////////////////////////////////////////////////////////////////////
-        shared_lock lock(metadata_mutex_);
-        state_ = deserial.read_byte();
-        checksum_ = deserial.read_4_bytes_little_endian();
-        tx_start_ = deserial.read_4_bytes_little_endian();
-        tx_count_ = deserial.read_2_bytes_little_endian();
-        ///////////////////////////////////////////////////////////////////////
-    };
-
     // Reads not deferred for updatable values as consistency is required.
-    element_.read(reader);
+    const auto memory = element_.access();
+    const auto record = memory.buffer();
+
+    // These are never updated.
+    version_ = layout::version::read(record);
+    timestamp_ = layout::timestamp::read(record);
+    bits_ = layout::bits::read(record);
+    median_time_past_ = layout::median_time_past::read(record);
+    height_ = layout::height::read(record);
+
+    // Critical Section.
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(metadata_mutex_);
+    state_ = layout::state::read(record);
+    checksum_ = layout::checksum::read(record);
+    tx_start_ = layout::tx_start::read(record);
+    tx_count_ = layout::tx_count::read(record);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 block_result::operator bool() const
@@ -116,12 +123,12 @@ chain::header block_result::header(bool metadata) const
         return {};
 
     chain::header header;
-    const auto reader = [&](byte_deserializer& deserial)
+
     {
+        const auto memory = element_.access();
+        auto deserial = make_unsafe_deserializer(memory.buffer());
         header.from_data(deserial, element_.key(), false);
-    };
-
-    element_.read(reader);
+    }
 
     if (metadata)
         set_metadata(header);
@@ -131,17 +138,17 @@ chain::header block_result::header(bool metadata) const
 
 uint32_t block_result::bits() const
 {
-    return header_.bits();
+    return bits_;
 }
 
 uint32_t block_result::timestamp() const
 {
-    return header_.timestamp();
+    return timestamp_;
 }
 
 uint32_t block_result::version() const
 {
-    return header_.version();
+    return version_;
 }
 
 uint32_t block_result::median_time_past() const
@@ -169,6 +176,11 @@ size_t block_result::transaction_count() const
     return tx_count_;
 }
 
+array_index block_result::transaction_start() const
+{
+    return tx_start_;
+}
+
 transaction_iterator block_result::begin() const
 {
     return { index_manager_, tx_start_, tx_count_ };
@@ -179,5 +191,10 @@ transaction_iterator block_result::end() const
     return { index_manager_, tx_start_, 0 };
 }
 
+transaction_links block_result::links() const
+{
+    return { index_manager_, tx_start_, tx_count_ };
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -18,7 +18,9 @@
  */
 #include <bitcoin/database/result/inpoint_iterator.hpp>
 
+#include <cstddef>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -50,14 +52,24 @@ inpoint_iterator::inpoint_iterator(const const_element& element)
     {
         element.read([&](byte_deserializer& deserial)
         {
+            size_t offset;
             deserial.skip(metadata_size);
-            const auto outputs = deserial.read_size_little_endian();
+            transaction_result::read_offsets(deserial, max_uint32, offset);
 
-            // Skip outputs.
-            for (auto output = 0u; output < outputs; ++output)
+            // The table gives the offset of the inputs, otherwise skip outputs.
+            if (offset != 0)
             {
-                deserial.skip(spend_size);
-                deserial.skip(deserial.read_size_little_endian());
+                deserial.skip(offset);
+            }
+            else
+            {
+                const auto outputs = deserial.read_size_little_endian();
+
+                for (auto output = 0u; output < outputs; ++output)
+                {
+                    deserial.skip(spend_size);
+                    deserial.skip(deserial.read_size_little_endian());
+                }
             }
 
             const auto inputs = deserial.read_size_little_endian();
@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/result/output_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/compressed_script.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+static constexpr auto candidate_spent_size = sizeof(uint8_t);
+static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto value_size = sizeof(uint64_t);
+static constexpr auto spend_size = candidate_spent_size + height_size +
+    value_size;
+
+output_view::output_view()
+  : data_(nullptr), compressed_(false), table_(nullptr), index_(0)
+{
+}
+
+output_view::output_view(uint8_t* data, bool compressed,
+    uint8_t* table, uint32_t index)
+  : data_(data), compressed_(compressed), table_(table), index_(index)
+{
+}
+
+output_view::operator bool() const
+{
+    return data_ != nullptr;
+}
+
+bool output_view::compressed() const
+{
+    return compressed_;
+}
+
+// A prune marks the table before zeroing the script, so this is ordered after
+// any preceding read of the script.
+bool output_view::pruned() const
+{
+    return table_ != nullptr && transaction_result::reread_pruned(
+        make_unsafe_deserializer(table_), index_);
+}
+
+uint64_t output_view::value() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    auto deserial = make_unsafe_deserializer(data_ +
+        candidate_spent_size + height_size);
+    return deserial.read_8_bytes_little_endian();
+}
+
+size_t output_view::size() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    auto deserial = make_unsafe_deserializer(data_ + spend_size);
+
+    if (compressed_)
+        return spend_size + compressed_script::stored_size(deserial);
+
+    const auto script_size = deserial.read_size_little_endian();
+    return spend_size + variable_uint_size(script_size) + script_size;
+}
+
+data_slice output_view::data() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    return { data_, data_ + size() };
+}
+
+data_slice output_view::stored_script() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    auto deserial = make_unsafe_deserializer(data_ + spend_size);
+    const auto end = data_ + size();
+
+    // The compressed form starts with its template (or raw size prefix).
+    if (compressed_)
+        return { data_ + spend_size, end };
+
+    const auto script_size = deserial.read_size_little_endian();
+    return { end - script_size, end };
+}
+
+chain::script output_view::script() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    data_chunk bytes;
+
+    if (!compressed_)
+    {
+        const auto stored = stored_script();
+        bytes.assign(stored.begin(), stored.end());
+    }
+    else
+    {
+        auto deserial = make_unsafe_deserializer(data_ + spend_size);
+        bytes = compressed_script::read(deserial);
+    }
+
+    // The mark is checked after the copy, so a zeroed script is not returned.
+    return pruned() ? chain::script{} : chain::script(std::move(bytes), false);
+}
+
+hash_digest output_view::script_hash() const
+{
+    BITCOIN_ASSERT(data_ != nullptr);
+    hash_digest hash;
+
+    // Only a compressed script is expanded, otherwise hashed in place.
+    if (!compressed_)
+    {
+        hash = sha256_hash(stored_script());
+    }
+    else
+    {
+        auto deserial = make_unsafe_deserializer(data_ + spend_size);
+        hash = sha256_hash(compressed_script::read(deserial));
+    }
+
+    // The mark is checked after the hash, so a zeroed script is not hashed.
+    return pruned() ? null_hash : hash;
+}
+
+} // namespace database
+} // namespace libbitcoin
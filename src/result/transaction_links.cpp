@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/result/transaction_links.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/define.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+static constexpr auto link_size = sizeof(file_offset);
+
+transaction_links::transaction_links(const manager& records,
+    array_index start, size_t count)
+  : memory_(records.access(start)),
+    count_(count)
+{
+}
+
+transaction_links::transaction_links(transaction_links&& other)
+  : memory_(std::move(other.memory_)),
+    count_(other.count_)
+{
+}
+
+size_t transaction_links::size() const
+{
+    return count_;
+}
+
+file_offset transaction_links::operator[](size_t position) const
+{
+    BITCOIN_ASSERT(position < count_);
+    const auto link = memory_.buffer() + position * link_size;
+    return from_little_endian_unsafe<file_offset>(link);
+}
+
+link_list transaction_links::to_list() const
+{
+    link_list links;
+    links.reserve(count_);
+
+    for (size_t position = 0; position < count_; ++position)
+        links.push_back((*this)[position]);
+
+    return links;
+}
+
+} // namespace database
+} // namespace libbitcoin
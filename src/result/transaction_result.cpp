@@ -18,10 +18,14 @@
  */
 #include <bitcoin/database/result/transaction_result.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
+#include <vector>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/compressed_script.hpp>
 #include <bitcoin/database/databases/transaction_database.hpp>
 #include <bitcoin/database/memory/memory.hpp>
 
@@ -33,50 +37,480 @@ using namespace bc::system::chain;
 using namespace bc::system::machine;
 
 static constexpr auto height_size = sizeof(uint32_t);
-static constexpr auto position_size = sizeof(uint16_t);
-static constexpr auto state_size = sizeof(uint8_t);
-static constexpr auto median_time_past_size = sizeof(uint32_t);
 
 static constexpr auto index_spend_size = sizeof(uint8_t);
 ////static constexpr auto height_size = sizeof(uint32_t);
 static constexpr auto value_size = sizeof(uint64_t);
 
 static constexpr auto spend_size = index_spend_size + height_size + value_size;
-static constexpr auto metadata_size = height_size + position_size +
-    state_size + median_time_past_size;
+static constexpr auto metadata_size = transaction_result::layout::size;
+
+static constexpr auto point_size = hash_size + sizeof(uint32_t);
+static constexpr auto sequence_size = sizeof(uint32_t);
+static constexpr auto locktime_size = sizeof(uint32_t);
+static constexpr auto version_size = sizeof(uint32_t);
+static constexpr uint8_t witness_marker = 0x00;
+static constexpr uint8_t witness_flag = 0x01;
+
+// Output offset table (optional, precedes the tx):
+// [ marker:1      ] (0xff, never the first byte of a v4 output count)
+// [ flags:1       ] (compressed output scripts)
+// [ outputs:4     ]
+// [ spends:8      ] (first spend column record, or not_allocated)
+// [ witnesses:8   ] (segregated witnesses slab, or not_allocated)
+// [ offset:4      ]... (outputs + 2, of the input count and of the tx end)
+static constexpr uint8_t offsets_marker = 0xff;
+static constexpr uint8_t flag_compressed = 0x01;
+static constexpr uint32_t offset_pruned = 0x80000000;
+static constexpr auto offset_size = sizeof(uint32_t);
+static constexpr auto spends_size = sizeof(uint64_t);
+static constexpr auto witnesses_size = sizeof(uint64_t);
+static constexpr auto table_header_size = sizeof(offsets_marker) +
+    sizeof(flag_compressed) + offset_size + spends_size + witnesses_size;
+
+// Pruned output (high bit of its table offset, script bytes zeroed):
+// [ spend:13      ] (as stored, the output remains walkable)
+// [ prefix:varint ] (script size or compressed template, as stored)
+// [ zero:size     ]
+
+// Compressed output (scripts by compressed_script, all else as stored):
+// [ candidate_spent:1 ]
+// [ spender_height:4  ]
+// [ value:8           ]
+// [ script:compressed ]
+
+// Segregated witnesses slab (inputs are stored with empty witnesses):
+// [ witness:varint ]... (one per input, as prefixed witness serialization)
+
+// Spend column record (when spends link is allocated, supersedes tx values):
+// [ candidate_spent:1 ]
+// [ spender_height:4  ]
 
 const uint8_t transaction_result::candidate_true = 1;
 const uint8_t transaction_result::candidate_false = 0;
 const uint16_t transaction_result::unconfirmed = max_uint16;
 const uint32_t transaction_result::unverified = rule_fork::unverified;
+constexpr size_t transaction_result::layout::size;
+const size_t transaction_result::spend_record_size = index_spend_size +
+    height_size;
+
+// The stored size of the script of the output, with size prefix.
+static size_t script_size(const chain::output& output, bool compressed)
+{
+    const auto& script = output.script();
+    return compressed ? compressed_script::size(script.to_data(false)) :
+        script.serialized_size(true);
+}
+
+static chain::output read_output(byte_deserializer& deserial, bool compressed)
+{
+    chain::output output;
+
+    if (!compressed)
+    {
+        output.from_data(deserial, false);
+        return output;
+    }
+
+    const auto candidate = deserial.read_byte();
+    const auto height = deserial.read_4_bytes_little_endian();
+    const auto value = deserial.read_8_bytes_little_endian();
+    output = chain::output(value,
+        chain::script(compressed_script::read(deserial), false));
+
+    output.metadata.candidate_spent =
+        candidate == transaction_result::candidate_true;
+    output.metadata.confirmed_spent_height = height;
+    return output;
+}
+
+// Read a size prefix at the position, advancing the position past it.
+static uint64_t read_size(uint8_t*& position)
+{
+    const auto value = make_unsafe_deserializer(position)
+        .read_size_little_endian();
+    position += variable_uint_size(value);
+    return value;
+}
+
+// Advance the position past size prefixed bytes.
+static void skip_sized(uint8_t*& position)
+{
+    const auto size = read_size(position);
+    position += size;
+}
+
+// Advance the position past a (prefixed) witness.
+static void skip_witness(uint8_t*& position)
+{
+    for (auto count = read_size(position); count > 0; --count)
+        skip_sized(position);
+}
+
+// Copies bytes to the buffer (if not null), counting the bytes written.
+class wire_sink
+{
+public:
+    wire_sink(uint8_t* buffer)
+      : buffer_(buffer), size_(0)
+    {
+    }
+
+    void write_bytes(const uint8_t* data, size_t size)
+    {
+        if (buffer_ != nullptr)
+            std::copy_n(data, size, buffer_ + size_);
+
+        size_ += size;
+    }
+
+    void write_byte(uint8_t value)
+    {
+        write_bytes(&value, sizeof(uint8_t));
+    }
+
+    void write_size(uint64_t value)
+    {
+        uint8_t prefix[sizeof(uint8_t) + sizeof(uint64_t)];
+        make_unsafe_serializer(prefix).write_size_little_endian(value);
+        write_bytes(prefix, variable_uint_size(value));
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    uint8_t* const buffer_;
+    size_t size_;
+};
+
+// Write the wire serialization of the stored tx, optionally with witness,
+// from the witnesses slab if not null, otherwise from the stored inputs.
+static void write_wire(wire_sink& sink, uint8_t* tx, bool compressed,
+    uint8_t* witnesses, bool witness)
+{
+    auto position = tx;
+    const auto outputs = read_size(position);
+
+    for (auto output = 0u; output < outputs; ++output)
+    {
+        position += spend_size;
+
+        if (compressed)
+            position += compressed_script::stored_size(
+                make_unsafe_deserializer(position));
+        else
+            skip_sized(position);
+    }
+
+    // Witnesses are in place unless segregated, but may all be empty.
+    const auto inputs_position = position;
+    const auto inputs = read_size(position);
+    auto segregated = witnesses != nullptr;
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        position += point_size;
+        skip_sized(position);
+        segregated |= *position != 0x00;
+        skip_witness(position);
+        position += sequence_size;
+    }
+
+    const auto locktime = position;
+    const auto version = position + locktime_size;
+    segregated &= witness;
+
+    sink.write_bytes(version, version_size);
+
+    if (segregated)
+    {
+        sink.write_byte(witness_marker);
+        sink.write_byte(witness_flag);
+    }
+
+    // Inputs are copied without their (stored) witnesses.
+    position = inputs_position;
+    sink.write_size(read_size(position));
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        const auto start = position;
+        position += point_size;
+        skip_sized(position);
+        sink.write_bytes(start, position - start);
+        skip_witness(position);
+        sink.write_bytes(position, sequence_size);
+        position += sequence_size;
+    }
+
+    // Outputs are copied without spend state, expanded if compressed.
+    position = tx;
+    sink.write_size(read_size(position));
+
+    for (auto output = 0u; output < outputs; ++output)
+    {
+        position += index_spend_size + height_size;
+        sink.write_bytes(position, value_size);
+        position += value_size;
+
+        if (compressed)
+        {
+            auto deserial = make_unsafe_deserializer(position);
+            const auto script = compressed_script::read(deserial);
+            position += compressed_script::stored_size(
+                make_unsafe_deserializer(position));
+            sink.write_size(script.size());
+            sink.write_bytes(script.data(), script.size());
+            continue;
+        }
+
+        const auto start = position;
+        skip_sized(position);
+        sink.write_bytes(start, position - start);
+    }
+
+    if (segregated)
+    {
+        position = witnesses != nullptr ? witnesses : inputs_position;
+
+        if (witnesses == nullptr)
+            read_size(position);
+
+        for (auto input = 0u; input < inputs; ++input)
+        {
+            if (witnesses == nullptr)
+            {
+                position += point_size;
+                skip_sized(position);
+            }
+
+            const auto start = position;
+            skip_witness(position);
+            sink.write_bytes(start, position - start);
+
+            if (witnesses == nullptr)
+                position += sequence_size;
+        }
+    }
+
+    sink.write_bytes(locktime, locktime_size);
+}
+
+// static
+size_t transaction_result::stored_size(const chain::transaction& tx,
+    bool compressed, bool segregated)
+{
+    auto size = tx.serialized_size(false, !segregated);
+
+    if (!compressed)
+        return size;
+
+    for (const auto& output: tx.outputs())
+        size = size - script_size(output, false) + script_size(output, true);
+
+    return size;
+}
+
+// static
+void transaction_result::write_transaction(byte_serializer& serial,
+    const chain::transaction& tx, bool compressed, bool segregated)
+{
+    if (!compressed)
+    {
+        tx.to_data(serial, false, !segregated);
+        return;
+    }
+
+    const auto& outputs = tx.outputs();
+    auto outputs_size = variable_uint_size(outputs.size());
+    serial.write_size_little_endian(outputs.size());
+
+    for (const auto& output: outputs)
+    {
+        serial.write_byte(output.metadata.candidate_spent ? candidate_true :
+            candidate_false);
+        serial.write_4_bytes_little_endian(
+            output.metadata.confirmed_spent_height);
+        serial.write_8_bytes_little_endian(output.value());
+        compressed_script::write(serial, output.script().to_data(false));
+        outputs_size += spend_size + script_size(output, false);
+    }
+
+    // The remainder of the tx is stored as when not compressed.
+    const auto data = tx.to_data(false, !segregated);
+    serial.write_bytes(data.data() + outputs_size, data.size() - outputs_size);
+}
+
+// static
+size_t transaction_result::offsets_size(size_t outputs)
+{
+    return table_header_size + (outputs + 2) * offset_size;
+}
+
+// static
+void transaction_result::write_offsets(byte_serializer& serial,
+    const chain::transaction& tx, link_type spends, bool compressed,
+    link_type witnesses)
+{
+    const auto segregated = witnesses != manager::not_allocated;
+    const auto& outputs = tx.outputs();
+    BITCOIN_ASSERT(outputs.size() < max_uint32);
+    auto offset = variable_uint_size(outputs.size());
+
+    serial.write_byte(offsets_marker);
+    serial.write_byte(compressed ? flag_compressed : 0);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(outputs.size()));
+    serial.write_8_bytes_little_endian(spends);
+    serial.write_8_bytes_little_endian(witnesses);
+
+    for (const auto& output: outputs)
+    {
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(offset));
+        offset += spend_size + script_size(output, compressed);
+    }
+
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(offset));
+    serial.write_4_bytes_little_endian(
+        static_cast<uint32_t>(stored_size(tx, compressed, segregated)));
+}
+
+// static
+size_t transaction_result::read_offsets(byte_deserializer& deserial,
+    uint32_t index, size_t& offset)
+{
+    link_type spends;
+    link_type witnesses;
+    size_t end;
+    bool compressed;
+    return read_offsets(deserial, index, offset, spends, witnesses, end,
+        compressed);
+}
+
+// static
+size_t transaction_result::read_offsets(byte_deserializer& deserial,
+    uint32_t index, size_t& offset, link_type& spends, link_type& witnesses,
+    size_t& end, bool& compressed)
+{
+    offset = 0;
+    end = 0;
+    compressed = false;
+    spends = spend_manager::not_allocated;
+    witnesses = manager::not_allocated;
+
+    // A v4 record (without table) is left unread.
+    auto peek = deserial;
+    if (peek.read_byte() != offsets_marker)
+        return 0;
+
+    deserial.skip(sizeof(offsets_marker));
+    compressed = (deserial.read_byte() & flag_compressed) != 0;
+    const auto outputs = deserial.read_4_bytes_little_endian();
+    spends = deserial.read_8_bytes_little_endian();
+    witnesses = deserial.read_8_bytes_little_endian();
+    const auto position = std::min(index, outputs);
+
+    deserial.skip(position * offset_size);
+    offset = deserial.read_4_bytes_little_endian() & ~offset_pruned;
+    deserial.skip((outputs - position) * offset_size);
+    end = deserial.read_4_bytes_little_endian();
+    return offsets_size(outputs);
+}
+
+// static
+bool transaction_result::read_prunable(byte_deserializer& deserial,
+    uint32_t index, size_t& entry, size_t& begin, size_t& end)
+{
+    // A v4 record (without table) cannot be pruned.
+    auto peek = deserial;
+    if (peek.read_byte() != offsets_marker)
+        return false;
+
+    deserial.skip(sizeof(offsets_marker) + sizeof(flag_compressed));
+    const auto outputs = deserial.read_4_bytes_little_endian();
+    deserial.skip(spends_size + witnesses_size);
+
+    if (index >= outputs)
+        return false;
+
+    deserial.skip(index * offset_size);
+    const auto offset = deserial.read_4_bytes_little_endian();
+    const auto next = deserial.read_4_bytes_little_endian() & ~offset_pruned;
+
+    if ((offset & offset_pruned) != 0)
+        return false;
+
+    // Skip the remaining entries to the output, retaining its script prefix.
+    deserial.skip((outputs - index) * offset_size + offset + spend_size);
+    const auto prefix = variable_uint_size(deserial.read_size_little_endian());
+    const auto table = offsets_size(outputs);
+
+    entry = table_header_size + index * offset_size;
+    begin = table + offset + spend_size + prefix;
+    end = table + next;
+    return true;
+}
+
+// static
+bool transaction_result::read_pruned(byte_deserializer table, uint32_t index)
+{
+    table.skip(table_header_size + index * offset_size);
+    return (table.read_4_bytes_little_endian() & offset_pruned) != 0;
+}
+
+// static
+bool transaction_result::reread_pruned(byte_deserializer table,
+    uint32_t index)
+{
+    // Order the reads of the script before the read of its offset.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return read_pruned(table, index);
+}
+
+// static
+void transaction_result::write_pruned(uint8_t* entry)
+{
+    auto deserial = make_unsafe_deserializer(entry);
+    const auto offset = deserial.read_4_bytes_little_endian();
+    auto serial = make_unsafe_serializer(entry);
+    serial.write_4_bytes_little_endian(offset | offset_pruned);
+}
 
 transaction_result::transaction_result(const const_element_type& element,
-    shared_mutex& metadata_mutex)
+    const striped_sequence& metadata_sequence, const spend_manager& spends,
+    const manager& witnesses)
   : candidate_(false),
     height_(0),
     position_(unconfirmed),
     median_time_past_(0),
     element_(element),
-    metadata_mutex_(metadata_mutex)
+    metadata_sequence_(metadata_sequence),
+    spends_(spends),
+    witnesses_(witnesses)
 {
     if (!element_)
         return;
 
-    // There is only one atomic set here.
-    const auto reader = [&](byte_deserializer& deserial)
-    {
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        shared_lock lock(metadata_mutex_);
-        height_ = deserial.read_4_bytes_little_endian();
-        position_ = deserial.read_2_bytes_little_endian();
-        candidate_ = deserial.read_byte() == candidate_true;
-        median_time_past_ = deserial.read_4_bytes_little_endian();
-        ///////////////////////////////////////////////////////////////////////
-    };
-
     // Metadata reads not deferred for updatable values as atomicity required.
-    element.read(reader);
+    const auto memory = element_.access();
+    const auto record = memory.buffer();
+
+    // There is only one atomic set here, read again if a write overlaps.
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    uint32_t sequence;
+
+    do
+    {
+        sequence = metadata_sequence_.begin_read(element_.link());
+        height_ = layout::height::read(record);
+        position_ = layout::position::read(record);
+        candidate_ = layout::candidate::read(record) == candidate_true;
+        median_time_past_ = layout::median_time_past::read(record);
+    } while (!metadata_sequence_.end_read(element_.link(), sequence));
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 transaction_result::operator bool() const
@@ -126,24 +560,48 @@ bool transaction_result::is_candidate_spent(size_t fork_height) const
 
     BITCOIN_ASSERT(element_);
     auto spent = true;
+    size_t outputs;
+    link_type spends;
 
     // Spentness is unguarded and will be inconsistent during write.
     const auto reader = [&](byte_deserializer& deserial)
     {
+        size_t offset;
+        size_t end;
+        bool compressed;
+        link_type witnesses;
         deserial.skip(metadata_size);
-        const auto outputs = deserial.read_size_little_endian();
+        read_offsets(deserial, 0, offset, spends, witnesses, end, compressed);
+        outputs = deserial.read_size_little_endian();
+
+        // Spend state of the outputs is read from the column below.
+        if (spends != spend_manager::not_allocated)
+            return;
 
         // Search all outputs for an unspent indication.
         for (auto out = 0u; spent && out < outputs; ++out)
         {
             // TODO: This reads full output, which is simple but not optimial.
-            const auto output = output::factory(deserial, false);
+            const auto output = read_output(deserial, compressed);
             spent = output.metadata.candidate_spent ||
                 output.metadata.confirmed_spent_height <= fork_height;
         }
     };
 
     element_.read(reader);
+
+    if (spends == spend_manager::not_allocated)
+        return spent;
+
+    // The column records of the outputs are contiguous.
+    for (auto out = 0u; spent && out < outputs; ++out)
+    {
+        chain::output output;
+        read_spend(spends, out, output);
+        spent = output.metadata.candidate_spent ||
+            output.metadata.confirmed_spent_height <= fork_height;
+    }
+
     return spent;
 }
 
@@ -180,11 +638,37 @@ chain::output transaction_result::output(uint32_t index) const
 {
     BITCOIN_ASSERT(element_);
     chain::output output;
+    link_type spends;
 
     // Spentness is unguarded and will be inconsistent during write.
     const auto reader = [&](byte_deserializer& deserial)
     {
+        size_t offset;
+        size_t end;
+        bool compressed;
+        link_type witnesses;
         deserial.skip(metadata_size);
+        const auto table = deserial;
+        read_offsets(deserial, index, offset, spends, witnesses, end,
+            compressed);
+
+        // The table gives direct access, skipping the output count.
+        if (offset != 0)
+        {
+            auto tx = deserial;
+            if (index >= tx.read_size_little_endian())
+                return;
+
+            deserial.skip(offset);
+            output = read_output(deserial, compressed);
+
+            // A pruned script is returned as empty.
+            if (reread_pruned(table, index))
+                output.set_script(chain::script{});
+
+            return;
+        }
+
         const auto outputs = deserial.read_size_little_endian();
 
         if (index >= outputs)
@@ -203,6 +687,10 @@ chain::output transaction_result::output(uint32_t index) const
 
     // Read and return the target output (including spender height).
     element_.read(reader);
+
+    if (output.is_valid() && spends != spend_manager::not_allocated)
+        read_spend(spends, index, output);
+
     return output;
 }
 
@@ -212,21 +700,172 @@ chain::transaction transaction_result::transaction(bool witness) const
     BITCOIN_ASSERT(element_);
     chain::transaction tx;
     auto key = hash();
+    link_type spends;
+    link_type witnesses;
+    std::vector<uint32_t> pruned;
 
     const auto reader = [&](byte_deserializer& deserial)
     {
+        size_t inputs;
+        size_t end;
+        bool compressed;
         deserial.skip(metadata_size);
-        tx.from_data(deserial, std::move(key), false, witness);
+        const auto table = deserial;
+        read_offsets(deserial, max_uint32, inputs, spends, witnesses, end,
+            compressed);
+
+        // Pruned outputs are marked in the table (present if inputs is set),
+        // read after the scripts that a concurrent prune may have zeroed.
+        const auto read_pruned_outputs = [&]()
+        {
+            if (inputs == 0)
+                return;
+
+            const auto count = tx.outputs().size();
+
+            for (uint32_t index = 0; index < count; ++index)
+                if (reread_pruned(table, index))
+                    pruned.push_back(index);
+        };
+
+        if (!compressed)
+        {
+            tx.from_data(deserial, std::move(key), false, witness);
+            read_pruned_outputs();
+            return;
+        }
+
+        const auto count = deserial.read_size_little_endian();
+        auto size = variable_uint_size(count);
+        output::list outputs;
+        outputs.reserve(count);
+
+        for (auto out = 0u; out < count; ++out)
+        {
+            outputs.push_back(read_output(deserial, true));
+            size += spend_size + script_size(outputs.back(), false);
+        }
+
+        // Expand outputs to the uncompressed form, followed by the remainder.
+        const auto remainder = deserial.read_bytes(end - inputs);
+        data_chunk expanded(size + remainder.size());
+        auto sink = make_unsafe_serializer(expanded.data());
+        sink.write_size_little_endian(count);
+
+        for (const auto& output: outputs)
+            output.to_data(sink, false);
+
+        sink.write_bytes(remainder);
+        auto source = make_unsafe_deserializer(expanded.data());
+        tx.from_data(source, std::move(key), false, witness);
+        read_pruned_outputs();
     };
 
     element_.read(reader);
 
+    // Pruned scripts are returned as empty.
+    for (const auto index: pruned)
+        tx.outputs()[index].set_script(chain::script{});
+
+    if (spends != spend_manager::not_allocated)
+    {
+        auto& outputs = tx.outputs();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+            read_spend(spends, index, outputs[index]);
+    }
+
+    // Segregated witnesses are not read unless requested.
+    if (witness && witnesses != manager::not_allocated)
+    {
+        // The guard must remain in scope until the end of the block.
+        const auto memory = witnesses_.access(witnesses);
+        auto deserial = make_unsafe_deserializer(memory.buffer());
+
+        for (auto& input: tx.inputs())
+            input.set_witness(chain::witness::factory(deserial, true));
+    }
+
     // TODO: populate all metadata or use methods?
     tx.metadata.link = element_.link();
     tx.metadata.existed = true;
     return tx;
 }
 
+transaction_view transaction_result::view() const
+{
+    BITCOIN_ASSERT(element_);
+    return transaction_view(element_);
+}
+
+// private
+void transaction_result::read_spend(link_type spends, uint32_t index,
+    chain::output& output) const
+{
+    // The guard must remain in scope until the end of the block.
+    const auto memory = spends_.access(spends + index);
+    auto deserial = make_unsafe_deserializer(memory.buffer());
+    output.metadata.candidate_spent = deserial.read_byte() == candidate_true;
+    output.metadata.confirmed_spent_height =
+        deserial.read_4_bytes_little_endian();
+}
+
+size_t transaction_result::serialized_size(bool witness) const
+{
+    return write(nullptr, witness);
+}
+
+bool transaction_result::to_data(uint8_t* buffer, bool witness) const
+{
+    BITCOIN_ASSERT(buffer != nullptr);
+    return write(buffer, witness) != 0;
+}
+
+// private
+size_t transaction_result::write(uint8_t* buffer, bool witness) const
+{
+    BITCOIN_ASSERT(element_);
+    size_t offset;
+    size_t end;
+    bool compressed;
+    link_type spends;
+    link_type witnesses;
+
+    // The guard must remain in scope until the end of the block.
+    const auto memory = element_.access();
+    const auto table = memory.buffer() + metadata_size;
+    auto deserial = make_unsafe_deserializer(table);
+    const auto table_size = read_offsets(deserial, 0, offset, spends,
+        witnesses, end, compressed);
+    const auto tx = table + table_size;
+    wire_sink sink(buffer);
+
+    if (!witness || witnesses == manager::not_allocated)
+    {
+        write_wire(sink, tx, compressed, nullptr, witness);
+    }
+    else
+    {
+        // The guard must remain in scope until the end of the block.
+        const auto slab = witnesses_.access(witnesses);
+        write_wire(sink, tx, compressed, slab.buffer(), witness);
+    }
+
+    // Pruned scripts cannot be served, checked after the scripts are written
+    // as a concurrent prune may have zeroed them.
+    if (table_size != 0)
+    {
+        const auto outputs = make_unsafe_deserializer(tx)
+            .read_size_little_endian();
+
+        for (uint32_t index = 0; index < outputs; ++index)
+            if (reread_pruned(make_unsafe_deserializer(table), index))
+                return 0;
+    }
+
+    return sink.size();
+}
+
 inpoint_iterator transaction_result::begin() const
 {
     return { element_ };
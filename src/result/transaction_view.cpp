@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/result/transaction_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/database/result/transaction_result.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto position_size = sizeof(uint16_t);
+static constexpr auto state_size = sizeof(uint8_t);
+static constexpr auto median_time_past_size = sizeof(uint32_t);
+
+static constexpr auto index_spend_size = sizeof(uint8_t);
+////static constexpr auto height_size = sizeof(uint32_t);
+static constexpr auto value_size = sizeof(uint64_t);
+
+static constexpr auto spend_size = index_spend_size + height_size + value_size;
+static constexpr auto metadata_size = height_size + position_size +
+    state_size + median_time_past_size;
+
+static constexpr auto point_size = hash_size + sizeof(uint32_t);
+static constexpr auto sequence_size = sizeof(uint32_t);
+static constexpr auto locktime_size = sizeof(uint32_t);
+static constexpr auto version_size = sizeof(uint32_t);
+
+transaction_view::transaction_view(const const_element& element)
+  : memory_(element.access()),
+    table_(nullptr),
+    transaction_(nullptr),
+    outputs_(0),
+    end_(0),
+    compressed_(false)
+{
+    size_t offset;
+    transaction_result::link_type spends;
+    transaction_result::link_type witnesses;
+    const auto start = memory_.buffer() + metadata_size;
+    auto deserial = make_unsafe_deserializer(start);
+    const auto table = transaction_result::read_offsets(deserial, 0, offset,
+        spends, witnesses, end_, compressed_);
+
+    table_ = table == 0 ? nullptr : start;
+    transaction_ = start + table;
+    outputs_ = deserial.read_size_little_endian();
+}
+
+transaction_view::transaction_view(transaction_view&& other)
+  : memory_(std::move(other.memory_)),
+    table_(other.table_),
+    transaction_(other.transaction_),
+    outputs_(other.outputs_),
+    end_(other.end_),
+    compressed_(other.compressed_)
+{
+}
+
+size_t transaction_view::outputs() const
+{
+    return outputs_;
+}
+
+output_view transaction_view::output(uint32_t index) const
+{
+    if (index >= outputs_)
+        return {};
+
+    // The view rechecks the pruned mark after reading the script.
+    return { output_position(index), compressed_, table_, index };
+}
+
+data_slice transaction_view::data() const
+{
+    // The table records the end of the stored tx.
+    if (end_ != 0)
+        return { transaction_, transaction_ + end_ };
+
+    // Otherwise walk the (uncompressed) outputs and inputs.
+    const auto position = output_position(static_cast<uint32_t>(outputs_));
+    auto deserial = make_unsafe_deserializer(position);
+    auto size = static_cast<size_t>(position - transaction_);
+
+    const auto inputs = deserial.read_size_little_endian();
+    size += variable_uint_size(inputs);
+
+    for (auto input = 0u; input < inputs; ++input)
+    {
+        deserial.skip(point_size);
+        const auto script_size = deserial.read_size_little_endian();
+        deserial.skip(script_size);
+        size += point_size + variable_uint_size(script_size) + script_size;
+
+        const auto count = deserial.read_size_little_endian();
+        size += variable_uint_size(count);
+
+        for (auto item = 0u; item < count; ++item)
+        {
+            const auto item_size = deserial.read_size_little_endian();
+            deserial.skip(item_size);
+            size += variable_uint_size(item_size) + item_size;
+        }
+
+        deserial.skip(sequence_size);
+        size += sequence_size;
+    }
+
+    size += locktime_size + version_size;
+    return { transaction_, transaction_ + size };
+}
+
+// private
+// The position of the indexed output, or of the input count if outputs.
+uint8_t* transaction_view::output_position(uint32_t index) const
+{
+    // The table gives direct access to the output.
+    if (table_ != nullptr)
+    {
+        size_t offset;
+        auto deserial = make_unsafe_deserializer(table_);
+        transaction_result::read_offsets(deserial, index, offset);
+        return transaction_ + offset;
+    }
+
+    auto deserial = make_unsafe_deserializer(transaction_);
+    auto position = transaction_ + variable_uint_size(
+        deserial.read_size_little_endian());
+
+    for (auto output = 0u; output < index; ++output)
+    {
+        deserial.skip(spend_size);
+        const auto script_size = deserial.read_size_little_endian();
+        deserial.skip(script_size);
+        position += spend_size + variable_uint_size(script_size) +
+            script_size;
+    }
+
+    return position;
+}
+
+} // namespace database
+} // namespace libbitcoin
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/script_hash_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// The null hash marks an empty slot, a null point is never looked up.
+
+script_hash_cache::script_hash_cache(size_t capacity)
+  : hits_(0), capacity_(capacity),
+    slots_(capacity, entry{ null_hash, point::null_index, null_hash })
+{
+}
+
+bool script_hash_cache::disabled() const
+{
+    return capacity_ == 0;
+}
+
+size_t script_hash_cache::capacity() const
+{
+    return capacity_;
+}
+
+size_t script_hash_cache::hits() const
+{
+    return hits_.load();
+}
+
+void script_hash_cache::insert(const point& point,
+    const hash_digest& script_hash)
+{
+    if (disabled())
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    slots_[slot(point)] = { point.hash(), point.index(), script_hash };
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool script_hash_cache::find(hash_digest& out_script_hash,
+    const point& point) const
+{
+    if (disabled())
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto& entry = slots_[slot(point)];
+
+    if (entry.index != point.index() || entry.hash != point.hash())
+        return false;
+
+    out_script_hash = entry.script_hash;
+    ///////////////////////////////////////////////////////////////////////////
+
+    ++hits_;
+    return true;
+}
+
+void script_hash_cache::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::fill(slots_.begin(), slots_.end(),
+        entry{ null_hash, point::null_index, null_hash });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+size_t script_hash_cache::slot(const point& point) const
+{
+    // The tx hash is uniformly distributed, so its leading bytes suffice.
+    return (from_little_endian_unsafe<uint64_t>(point.hash().begin()) +
+        point.index()) % capacity_;
+}
+
+} // namespace database
+} // namespace libbitcoin
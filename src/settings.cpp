@@ -18,6 +18,8 @@
  */
 #include <bitcoin/database/settings.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <boost/filesystem.hpp>
 
 namespace libbitcoin {
@@ -26,18 +28,132 @@ namespace database {
 using namespace boost::filesystem;
 using namespace bc::system;
 
+// Table bytes per expected block or transaction, of the mainnet sizes.
+static constexpr uint64_t block_table_bytes = 128;
+static constexpr uint64_t height_index_bytes = 5;
+static constexpr uint64_t transaction_index_bytes = 8;
+static constexpr uint64_t transaction_table_bytes = 500;
+static constexpr uint64_t address_index_bytes = 225;
+static constexpr uint64_t address_table_bytes = 160;
+
+// Expected transactions per hash table bucket.
+static constexpr uint64_t transactions_per_bucket = 4;
+
+// Growth rates (percent) of files sized to the chain, and scaled below it.
+static constexpr uint16_t sized_growth_rate = 5;
+static constexpr uint16_t scaled_growth_rate = 50;
+
+static uint32_t to_buckets(uint64_t count)
+{
+    return static_cast<uint32_t>(std::max(std::min(count,
+        static_cast<uint64_t>(max_uint32)), uint64_t(1)));
+}
+
 settings::settings()
   : directory("blockchain"),
 
     flush_writes(false),
+    flush_latency(0),
+    flush_log(false),
+    flush_log_size(64 * 1024 * 1024),
+    dirty_bytes_budget(0),
+    read_only(false),
+    change_feed_size(0),
     cache_capacity(0),
+    write_threads(0),
+    prefetch_threads(1),
     file_growth_rate(5),
+    file_reservation_size(0),
+    file_populate_size(0),
+    file_allocation_extent(0),
 
     // Hash table sizes (must be configured).
     block_table_buckets(0),
     transaction_table_buckets(0),
     address_table_buckets(0),
 
+    // Huge page backing (bucket arrays, full block table).
+    block_table_huge_pages(false),
+    transaction_table_huge_pages(false),
+    address_table_huge_pages(false),
+
+    // Candidate and confirmed headers held in memory for height queries.
+    block_resident_headers(false),
+
+    // Timestamp and median time past by confirmed height (set at creation).
+    block_time_index(false),
+
+    // Validation and population state by candidate height held in memory.
+    block_candidate_states(false),
+
+    // Bucket fingerprints (part of the table format, set at creation).
+    transaction_table_fingerprints(false),
+
+    // Address history in pages chained per address (set at creation).
+    address_table_paged(false),
+
+    // Address indexing of confirmed blocks by a background stage, trailing
+    // the confirmed top by the lag (in blocks).
+    address_table_deferred(false),
+    address_table_lag(6),
+
+    // Script hashes of recently cataloged outputs, reused by their spends.
+    address_script_hashes(65536),
+
+    // History rows prefetched ahead of iteration (zero for none).
+    address_read_ahead(8),
+
+    // The address table is opened in the background, queries wait for it.
+    address_table_lazy(false),
+
+    // In-memory existence filter of transaction hashes (bytes).
+    transaction_filter_size(0),
+
+    // Minimum outputs for a stored output offset table (zero disables).
+    transaction_output_offsets(0),
+
+    // Output spend state in a separate file (set at creation).
+    transaction_spend_column(false),
+
+    // Template compression of stored output scripts.
+    transaction_script_compression(false),
+
+    // Witnesses in a separate file (set at creation).
+    transaction_segregated_witnesses(false),
+
+    // Prevout spends of confirmed blocks, for unconfirm (set at creation).
+    transaction_undo(false),
+
+    // Confirmation depth below which spent output scripts are pruned.
+    transaction_prune_depth(0),
+
+    // Approximate memory budget of the output cache (zero is unbudgeted).
+    cache_bytes(0),
+
+    // Output cache entries of single outputs, in place of whole txs.
+    cache_granular(false),
+
+    // Output cache eviction policy.
+    cache_eviction(cache_policy::fifo),
+
+    // Output cache saved at close and loaded at open.
+    cache_persist(false),
+
+    // Recently missed prevout tx hashes of the pool path (zero disables).
+    cache_misses(4096),
+
+    // Confirmed unspent output table (zero buckets disables).
+    utxo_table_buckets(0),
+    utxo_table_size(1),
+
+    // Compact block filters of cataloged blocks (zero buckets disables).
+    filter_table_buckets(0),
+    filter_table_size(1),
+
+    // Confirmed balance summaries by script hash (zero buckets disables).
+    balance_table_buckets(0),
+    balance_table_size(1),
+
     // Minimum file sizes.
     block_table_size(1),
     candidate_index_size(1),
@@ -45,7 +161,30 @@ settings::settings()
     transaction_index_size(1),
     transaction_table_size(1),
     address_index_size(1),
-    address_table_size(1)
+    address_table_size(1),
+
+    // Memory map access advice.
+    block_table_advice(access_advice::random),
+    candidate_index_advice(access_advice::random),
+    confirmed_index_advice(access_advice::random),
+    transaction_index_advice(access_advice::random),
+    transaction_table_advice(access_advice::random),
+    address_index_advice(access_advice::random),
+    address_table_advice(access_advice::random),
+
+    // Prefault (and optionally pin) hot regions at open.
+    block_table_prefault(false),
+    block_index_prefault(false),
+    transaction_buckets_prefault(false),
+    prefault_pin(false),
+
+    // NUMA placement of each table, over a mask of nodes (zero for all).
+    block_table_placement(memory_placement::local),
+    transaction_table_placement(memory_placement::local),
+    address_table_placement(memory_placement::local),
+    block_table_nodes(0),
+    transaction_table_nodes(0),
+    address_table_nodes(0)
 {
 }
 
@@ -108,5 +247,50 @@ settings::settings(config::settings context)
     }
 }
 
+void settings::auto_size(uint64_t blocks, uint64_t transactions,
+    uint64_t memory, uint64_t disk)
+{
+    const auto buckets = transactions / transactions_per_bucket;
+    block_table_buckets = to_buckets(blocks);
+    transaction_table_buckets = to_buckets(buckets);
+    address_table_buckets = to_buckets(buckets);
+
+    const auto block_bytes = block_table_bytes + 2 * height_index_bytes +
+        address_table_bytes;
+    const auto transaction_bytes = transaction_index_bytes +
+        transaction_table_bytes + address_index_bytes;
+
+    // Saturate rather than overflow on the expected size.
+    const auto total = std::min(blocks, max_uint64 / block_bytes / 2) *
+        block_bytes + std::min(transactions, max_uint64 /
+            transaction_bytes / 2) * transaction_bytes;
+
+    // The share of the expected size preallocated, in parts per thousand.
+    const auto share = disk == 0 || total <= disk / 2 ? uint64_t(1000) :
+        std::max(disk / 2 / std::max(total / 1000, uint64_t(1)),
+            uint64_t(1));
+
+    const auto size = [share](uint64_t count, uint64_t bytes)
+    {
+        const auto expected = std::min(count, max_uint64 / bytes / 2) * bytes;
+        return share == 1000 ? std::max(expected, uint64_t(1)) :
+            std::max(expected / 1000 * share, uint64_t(1));
+    };
+
+    block_table_size = size(blocks, block_table_bytes);
+    candidate_index_size = size(blocks, height_index_bytes);
+    confirmed_index_size = size(blocks, height_index_bytes);
+    address_table_size = size(blocks, address_table_bytes);
+    transaction_index_size = size(transactions, transaction_index_bytes);
+    transaction_table_size = size(transactions, transaction_table_bytes);
+    address_index_size = size(transactions, address_index_bytes);
+
+    // Files preallocated below the expected size grow in larger steps.
+    file_growth_rate = share < 1000 ? scaled_growth_rate : sized_growth_rate;
+
+    if (memory != 0)
+        cache_bytes = memory / 8u;
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/database/sip_hash.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+
+namespace libbitcoin {
+namespace database {
+
+using namespace bc::system;
+
+static inline uint64_t rotate(uint64_t value, size_t bits)
+{
+    return (value << bits) | (value >> (64u - bits));
+}
+
+static inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2,
+    uint64_t& v3)
+{
+    v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);
+    v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);
+}
+
+// Read the little endian word of up to eight bytes.
+static uint64_t read_word(const uint8_t* data, size_t size)
+{
+    uint64_t word = 0;
+    for (size_t byte = 0; byte < size; ++byte)
+        word |= static_cast<uint64_t>(data[byte]) << (8u * byte);
+
+    return word;
+}
+
+uint64_t sip_hash(uint64_t k0, uint64_t k1, const data_slice& data)
+{
+    auto v0 = UINT64_C(0x736f6d6570736575) ^ k0;
+    auto v1 = UINT64_C(0x646f72616e646f6d) ^ k1;
+    auto v2 = UINT64_C(0x6c7967656e657261) ^ k0;
+    auto v3 = UINT64_C(0x7465646279746573) ^ k1;
+
+    const auto size = data.size();
+    const auto words = size / sizeof(uint64_t);
+    const auto bytes = data.begin();
+
+    for (size_t word = 0; word < words; ++word)
+    {
+        const auto value = read_word(bytes + word * sizeof(uint64_t),
+            sizeof(uint64_t));
+        v3 ^= value;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= value;
+    }
+
+    // The final word is the remaining bytes and the low byte of the size.
+    const auto last = (static_cast<uint64_t>(size & 0xff) << 56) |
+        read_word(bytes + words * sizeof(uint64_t), size % sizeof(uint64_t));
+
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    v2 ^= 0xff;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void sip_hash_key(uint64_t& out_k0, uint64_t& out_k1,
+    const hash_digest& hash)
+{
+    out_k0 = read_word(hash.data(), sizeof(uint64_t));
+    out_k1 = read_word(hash.data() + sizeof(uint64_t), sizeof(uint64_t));
+}
+
+} // namespace database
+} // namespace libbitcoin
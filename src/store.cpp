@@ -18,8 +18,11 @@
  */
 #include <bitcoin/database/store.hpp>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
 
@@ -41,6 +44,18 @@ const std::string store::TRANSACTION_INDEX = "transaction_index";
 const std::string store::TRANSACTION_TABLE = "transaction_table";
 const std::string store::ADDRESS_TABLE = "address_table";
 const std::string store::ADDRESS_ROWS = "address_rows";
+const std::string store::TRANSACTION_FILTER = "transaction_filter";
+const std::string store::TRANSACTION_CACHE = "transaction_cache";
+const std::string store::ADDRESS_PROGRESS = "address_progress";
+const std::string store::WRITE_AHEAD_LOG = "write_ahead_log";
+const std::string store::TRANSACTION_SPENDS = "transaction_spends";
+const std::string store::TRANSACTION_WITNESSES = "transaction_witnesses";
+const std::string store::UTXO_TABLE = "utxo_table";
+const std::string store::FILTER_TABLE = "filter_table";
+const std::string store::BALANCE_TABLE = "balance_table";
+const std::string store::BLOCK_TIMES = "block_times";
+const std::string store::TRANSACTION_UNDO = "transaction_undo";
+const std::string store::TRANSACTION_UNDO_INDEX = "transaction_undo_index";
 
 // Create a single file with one byte of arbitrary data.
 static bool create_file(const path& file_path)
@@ -62,12 +77,42 @@ static bool create_file(const path& file_path)
 // Construct.
 // ------------------------------------------------------------------------
 
-store::store(const path& prefix, bool with_indexes, bool flush_each_write)
+store::options::options()
+  : spends(false),
+    witnesses(false),
+    utxos(false),
+    filters(false),
+    balances(false),
+    undo(false),
+    times(false),
+    flush_latency(0),
+    read_only(false)
+{
+}
+
+store::store(const path& prefix, bool with_indexes, bool flush_each_write,
+    const options& features)
   : prefix_(prefix),
     with_indexes_(with_indexes),
     flush_each_write_(flush_each_write),
+    with_spends_(features.spends),
+    with_witnesses_(features.witnesses),
+    with_utxos_(features.utxos),
+    with_undo_(features.undo),
+    with_filters_(features.filters),
+    with_times_(features.times),
+    with_balances_(features.balances),
+    read_only_(features.read_only),
     flush_lock_(prefix / FLUSH_LOCK),
     exclusive_lock_(prefix / EXCLUSIVE_LOCK),
+    flush_latency_(features.flush_latency),
+    locked_(false),
+    committing_(false),
+    failed_(false),
+    writers_(0),
+    joined_(0),
+    ticket_(1),
+    committed_(0),
 
     // Content store.
     block_table(prefix / BLOCK_TABLE),
@@ -76,9 +121,29 @@ store::store(const path& prefix, bool with_indexes, bool flush_each_write)
     transaction_index(prefix / TRANSACTION_INDEX),
     transaction_table(prefix / TRANSACTION_TABLE),
 
+    // Optional content.
+    transaction_spends(prefix / TRANSACTION_SPENDS),
+    transaction_witnesses(prefix / TRANSACTION_WITNESSES),
+
     // Optional indexes.
     address_table(prefix / ADDRESS_TABLE),
-    address_rows(prefix / ADDRESS_ROWS)
+    address_rows(prefix / ADDRESS_ROWS),
+    utxo_table(prefix / UTXO_TABLE),
+    filter_table(prefix / FILTER_TABLE),
+    balance_table(prefix / BALANCE_TABLE),
+
+    // Optional undo records.
+    transaction_undo(prefix / TRANSACTION_UNDO),
+    transaction_undo_index(prefix / TRANSACTION_UNDO_INDEX),
+
+    // Optional times.
+    block_times(prefix / BLOCK_TIMES),
+
+    // Optional sidecars.
+    transaction_filter(prefix / TRANSACTION_FILTER),
+    transaction_cache(prefix / TRANSACTION_CACHE),
+    address_progress(prefix / ADDRESS_PROGRESS),
+    write_ahead_log(prefix / WRITE_AHEAD_LOG)
 {
 }
 
@@ -88,6 +153,9 @@ store::store(const path& prefix, bool with_indexes, bool flush_each_write)
 // Create files.
 bool store::create()
 {
+    if (read_only_)
+        return false;
+
     error_code ec;
     create_directories(prefix_, ec);
 
@@ -96,43 +164,154 @@ bool store::create()
         create_file(candidate_index) &&
         create_file(confirmed_index) &&
         create_file(transaction_index) &&
-        create_file(transaction_table);
+        create_file(transaction_table) &&
+        (!with_spends_ || create_file(transaction_spends)) &&
+        (!with_witnesses_ || create_file(transaction_witnesses)) &&
+        (!with_utxos_ || create_file(utxo_table)) &&
+        (!with_filters_ || create_file(filter_table)) &&
+        (!with_balances_ || create_file(balance_table)) &&
+        (!with_times_ || create_file(block_times)) &&
+        (!with_undo_ || (create_file(transaction_undo) &&
+            create_file(transaction_undo_index)));
 
     if (!with_indexes_)
         return created;
 
+    return created && create_indexes();
+}
+
+bool store::create_indexes()
+{
     return
-        created &&
+        with_indexes_ && !read_only_ &&
         create_file(address_table) &&
         create_file(address_rows);
 }
 
+// The writer's flush lock is not checked, so a reader does not detect a store
+// left corrupted by a failed writer.
 bool store::open()
 {
+    if (read_only_)
+        return true;
+
     return exclusive_lock_.lock() && flush_lock_.try_lock() &&
         (flush_each_write() || flush_lock_.lock_shared());
 }
 
 bool store::close()
 {
+    if (read_only_)
+        return true;
+
     return (flush_each_write() || flush_lock_.unlock_shared()) &&
         exclusive_lock_.unlock();
 }
 
 bool store::begin_write() const
 {
+    if (read_only_)
+        return false;
+
+    if (flush_each_write() && flush_latency_.count() != 0)
+        return begin_group_write();
+
     return !flush_each_write() || flush_lock_.lock_shared();
 }
 
 bool store::end_write() const
 {
+    if (flush_each_write() && flush_latency_.count() != 0)
+        return end_group_write();
+
     return !flush_each_write() || (flush() && flush_lock_.unlock_shared());
 }
 
+// private
+// The flush lock is held from the first write of a group until its commit,
+// and is released by a commit only once no write is in progress or pending.
+bool store::begin_group_write() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+
+    if (!locked_ && !(locked_ = flush_lock_.lock_shared()))
+        return false;
+
+    ++writers_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The first writer to end after a commit leads the next, waiting the latency
+// for others to join it (end) before one flush that covers them all. Writers
+// that end during a flush join the commit that follows.
+bool store::end_group_write() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+
+    if (!locked_)
+        return true;
+
+    if (writers_ != 0)
+        --writers_;
+
+    ++joined_;
+    const auto ticket = ticket_;
+
+    while (committed_ < ticket)
+    {
+        if (committing_)
+        {
+            commit_condition_.wait(lock);
+            continue;
+        }
+
+        committing_ = true;
+        const auto deadline = std::chrono::steady_clock::now() +
+            flush_latency_;
+
+        // Commits are notified only on completion, so this wakes spuriously.
+        while (std::chrono::steady_clock::now() < deadline)
+            commit_condition_.wait_until(lock, deadline);
+
+        ++ticket_;
+        joined_ = 0;
+        lock.unlock();
+        const auto flushed = flush();
+        lock.lock();
+
+        // A failed flush leaves the flush lock, and fails all later commits.
+        failed_ |= !flushed;
+        committed_ = ticket;
+        committing_ = false;
+
+        if (!failed_ && writers_ == 0 && joined_ == 0)
+        {
+            failed_ = !flush_lock_.unlock_shared();
+            locked_ = failed_;
+        }
+
+        commit_condition_.notify_all();
+    }
+
+    return !failed_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 bool store::flush_each_write() const
 {
     return flush_each_write_;
 }
 
+bool store::read_only() const
+{
+    return read_only_;
+}
+
 } // namespace database
 } // namespace libbitcoin
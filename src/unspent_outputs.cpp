@@ -18,8 +18,13 @@
  */
 #include <bitcoin/database/unspent_outputs.hpp>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/filesystem.hpp>
 #include <bitcoin/system.hpp>
+#include <bitcoin/database/tracepoints.hpp>
 
 namespace libbitcoin {
 namespace database {
@@ -27,10 +32,31 @@ namespace database {
 using namespace bc::system;
 using namespace bc::system::chain;
 
+// Sidecar file: [magic:4][tag:8][height:4][granular:1][shards:4], followed by
+// [size:8][entry...] for each shard.
+static constexpr uint32_t magic = 0x63786462;
+static constexpr size_t header_size = sizeof(uint32_t) + sizeof(uint64_t) +
+    sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+
+const size_t unspent_outputs::default_shards = 16;
+
+unspent_outputs::shard::shard()
+  : hits(0), queries(0), evictions(0), promotions(0), sequence(0), bytes(0)
+{
+}
+
 // This does not differentiate indexed-block transactions. These are treated as
 // unconfirmed, so this optimizes only for a top height fork point and tx pool.
-unspent_outputs::unspent_outputs(size_t capacity)
-  : capacity_(capacity), hits_(1), queries_(1), sequence_(0)
+unspent_outputs::unspent_outputs(size_t capacity, size_t bytes,
+    size_t shards, bool granular, cache_policy policy)
+  : granular_(granular),
+    policy_(policy),
+    capacity_(capacity),
+    bytes_(bytes),
+    shards_(std::max(std::min(shards, capacity), size_t(1))),
+    shard_capacity_((capacity + shards_ - 1) / shards_),
+    shard_bytes_((bytes + shards_ - 1) / shards_),
+    shard_(new shard[shards_])
 {
 }
 
@@ -41,28 +67,90 @@ bool unspent_outputs::disabled() const
 
 size_t unspent_outputs::empty() const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
-
-    return unspent_.empty();
-    ///////////////////////////////////////////////////////////////////////////
+    return size() == 0;
 }
 
+// Shards are summed in turn, so the total is not a point-in-time snapshot.
 size_t unspent_outputs::size() const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    size_t total = 0;
 
-    return unspent_.size();
-    ///////////////////////////////////////////////////////////////////////////
+    for (size_t index = 0; index < shards_; ++index)
+    {
+        const auto& part = shard_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(part.mutex);
+        total += part.unspent.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return total;
+}
+
+// Shards are summed in turn, so the total is not a point-in-time snapshot.
+size_t unspent_outputs::bytes() const
+{
+    size_t total = 0;
+
+    for (size_t index = 0; index < shards_; ++index)
+    {
+        const auto& part = shard_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(part.mutex);
+        total += part.bytes;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return total;
 }
 
 float unspent_outputs::hit_rate() const
 {
-    // These values could overflow or divide by zero, but that's okay.
-    return hits_ * 1.0f / queries_;
+    size_t hits = 1;
+    size_t queries = 1;
+
+    for (size_t index = 0; index < shards_; ++index)
+    {
+        hits += shard_[index].hits;
+        queries += shard_[index].queries;
+    }
+
+    // These values could overflow, but that's okay.
+    return hits * 1.0f / queries;
+}
+
+size_t unspent_outputs::evictions() const
+{
+    size_t total = 0;
+
+    for (size_t index = 0; index < shards_; ++index)
+        total += shard_[index].evictions;
+
+    return total;
+}
+
+size_t unspent_outputs::promotions() const
+{
+    size_t total = 0;
+
+    for (size_t index = 0; index < shards_; ++index)
+        total += shard_[index].promotions;
+
+    return total;
+}
+
+cache_policy unspent_outputs::policy() const
+{
+    return policy_;
+}
+
+size_t unspent_outputs::shards() const
+{
+    return shards_;
 }
 
 void unspent_outputs::add(const transaction& tx, size_t height,
@@ -74,28 +162,137 @@ void unspent_outputs::add(const transaction& tx, size_t height,
     if (tx.is_coinbase())
     {
         LOG_VERBOSE(LOG_DATABASE)
-            << "Output cache hit rate: " << hit_rate() << ", size: " << size();
+            << "Output cache hit rate: " << hit_rate() << ", size: " << size()
+            << ", bytes: " << bytes() << ", evictions: " << evictions()
+            << ", promotions: " << promotions();
     }
 
+    auto& part = select(tx.hash());
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    unique_lock lock(mutex_);
+    unique_lock lock(part.mutex);
 
     // It's been a long time since the last restart (~16 years).
-    if (sequence_ == max_uint32)
-        unspent_.clear();
+    if (part.sequence == max_uint32)
+    {
+        part.unspent.clear();
+        part.bytes = 0;
+    }
+
+    if (!granular_)
+    {
+        insert(part, unspent_transaction{ tx, height, median_time_past,
+            confirmed });
+        return;
+    }
+
+    // All outputs of the tx share the shard, each is an entry of its own.
+    const auto outputs = safe_unsigned<uint32_t>(tx.outputs().size());
+
+    for (uint32_t index = 0; index < outputs; ++index)
+        insert(part, unspent_transaction{ tx, index, height,
+            median_time_past, confirmed });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Outputs read from the store (prefetched) share the shard of their tx.
+void unspent_outputs::add(const hash_digest& tx_hash,
+    const unspent_transaction::output_map& outputs, size_t height,
+    uint32_t median_time_past, bool coinbase, bool confirmed)
+{
+    if (disabled() || outputs.empty())
+        return;
+
+    auto& part = select(tx_hash);
 
-    // Remove the oldest entry if the buffer is at capacity.
-    if (unspent_.size() >= capacity_)
-        unspent_.right.erase(unspent_.right.begin());
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(part.mutex);
 
-    // TODO: promote the unconfirmed tx cache instead of replacing it.
-    // A confirmed tx may replace the same unconfirmed tx here.
-    unspent_.insert(
+    if (part.sequence == max_uint32)
     {
-        unspent_transaction{ tx, height, median_time_past, confirmed },
-        ++sequence_
-    });
+        part.unspent.clear();
+        part.bytes = 0;
+    }
+
+    if (!granular_)
+    {
+        insert(part, unspent_transaction{ tx_hash,
+            unspent_transaction::all_outputs, outputs, height,
+            median_time_past, coinbase, confirmed });
+        return;
+    }
+
+    for (const auto& output: outputs)
+        insert(part, unspent_transaction{ tx_hash, output.first,
+            { { output.first, output.second } }, height, median_time_past,
+            coinbase, confirmed });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The cached outputs are those of mempool acceptance, so are not recopied.
+bool unspent_outputs::promote(const transaction& tx, size_t height,
+    uint32_t median_time_past)
+{
+    if (disabled())
+        return false;
+
+    auto& part = select(tx.hash());
+    const auto outputs = granular_ ?
+        safe_unsigned<uint32_t>(tx.outputs().size()) : 1u;
+    auto promoted = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(part.mutex);
+
+    for (uint32_t index = 0; index < outputs; ++index)
+    {
+        const auto entry = part.unspent.left.find(
+            make_key({ tx.hash(), index }));
+
+        if (entry != part.unspent.left.end())
+        {
+            entry->first.confirm(height, median_time_past);
+            promoted = true;
+        }
+    }
+
+    return promoted;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Output entries of a tx are removed individually, as they are keyed by point.
+void unspent_outputs::remove(const transaction& tx)
+{
+    if (disabled())
+        return;
+
+    if (!granular_)
+    {
+        remove(tx.hash());
+        return;
+    }
+
+    auto& part = select(tx.hash());
+    const auto outputs = safe_unsigned<uint32_t>(tx.outputs().size());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(part.mutex);
+
+    for (uint32_t index = 0; index < outputs; ++index)
+    {
+        const auto entry = part.unspent.left.find(
+            unspent_transaction{ tx.hash(), index });
+
+        if (entry != part.unspent.left.end())
+        {
+            part.bytes -= entry->first.footprint();
+            part.unspent.left.erase(entry);
+        }
+    }
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -107,26 +304,28 @@ void unspent_outputs::remove(const hash_digest& tx_hash)
         return;
 
     const unspent_transaction key{ tx_hash };
+    auto& part = select(tx_hash);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    part.mutex.lock_upgrade();
 
     // Find the unspent tx entry.
-    const auto tx = unspent_.left.find(key);
+    const auto tx = part.unspent.left.find(key);
 
-    if (tx == unspent_.left.end())
+    if (tx == part.unspent.left.end())
     {
-        mutex_.unlock_upgrade();
+        part.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return;
     }
 
-    mutex_.unlock_upgrade_and_lock();
+    part.mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    unspent_.left.erase(tx);
+    part.bytes -= tx->first.footprint();
+    part.unspent.left.erase(tx);
 
-    mutex_.unlock();
+    part.mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -136,37 +335,180 @@ void unspent_outputs::remove(const output_point& point)
     if (disabled())
         return;
 
-    const unspent_transaction key{ point };
+    const auto key = make_key(point);
+    auto& part = select(point.hash());
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    part.mutex.lock_upgrade();
 
     // Find the unspent tx entry that may contain the output.
-    auto tx = unspent_.left.find(key);
+    auto tx = part.unspent.left.find(key);
 
-    if (tx == unspent_.left.end())
+    if (tx == part.unspent.left.end())
     {
-        mutex_.unlock_upgrade();
+        part.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return;
     }
 
     const auto outputs = tx->first.outputs();
-    mutex_.unlock_upgrade_and_lock();
+    part.mutex.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
     // Erase the output if found at the specified index for the found tx.
-    outputs->erase(point.index());
+    const auto output = outputs->find(point.index());
+
+    if (output != outputs->end())
+    {
+        part.bytes -= unspent_transaction::footprint(output->second);
+        outputs->erase(output);
+    }
 
     // Erase the unspent transaction if it is now fully spent.
     if (outputs->empty())
-        unspent_.left.erase(tx);
+    {
+        part.bytes -= tx->first.footprint();
+        part.unspent.left.erase(tx);
+    }
 
-    mutex_.unlock();
+    part.mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
+void unspent_outputs::clear()
+{
+    for (size_t index = 0; index < shards_; ++index)
+    {
+        auto& part = shard_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(part.mutex);
+        part.unspent.clear();
+        part.bytes = 0;
+        ///////////////////////////////////////////////////////////////////////
+    }
+}
+
+bool unspent_outputs::save(const path& filename, uint64_t tag,
+    size_t height) const
+{
+    BITCOIN_ASSERT(height <= max_uint32);
+    ofstream file(filename.string(), std::ios::binary);
+
+    if (!file.good())
+        return false;
+
+    data_chunk buffer(header_size);
+    auto header = make_unsafe_serializer(buffer.begin());
+    header.write_4_bytes_little_endian(magic);
+    header.write_8_bytes_little_endian(tag);
+    header.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    header.write_byte(granular_ ? 1 : 0);
+    header.write_4_bytes_little_endian(static_cast<uint32_t>(shards_));
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    for (size_t index = 0; index < shards_; ++index)
+    {
+        const auto& part = shard_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(part.mutex);
+        uint64_t size = 0;
+
+        for (const auto& entry: part.unspent.right)
+            size += entry.second.serialized_size();
+
+        buffer.resize(sizeof(uint64_t) + size);
+        auto serial = make_unsafe_serializer(buffer.begin());
+        serial.write_8_bytes_little_endian(size);
+
+        // The right view is ordered by age, so the reload preserves it.
+        for (const auto& entry: part.unspent.right)
+            entry.second.to_data(serial);
+        ///////////////////////////////////////////////////////////////////////
+
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+            buffer.size());
+    }
+
+    file.flush();
+    return file.good();
+}
+
+bool unspent_outputs::load(const path& filename, uint64_t tag, size_t height)
+{
+    clear();
+    ifstream file(filename.string(), std::ios::binary);
+
+    if (disabled() || !file.good())
+        return false;
+
+    data_chunk buffer(header_size);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    auto header = make_unsafe_deserializer(buffer.begin());
+
+    if (!file.good() ||
+        header.read_4_bytes_little_endian() != magic ||
+        header.read_8_bytes_little_endian() != tag ||
+        header.read_4_bytes_little_endian() != height ||
+        header.read_byte() != (granular_ ? 1 : 0))
+        return false;
+
+    const auto shards = header.read_4_bytes_little_endian();
+    boost::system::error_code ec;
+    const auto remaining = boost::filesystem::file_size(filename, ec) -
+        header_size;
+    uint64_t consumed = 0;
+
+    for (uint32_t index = 0; index < shards; ++index)
+    {
+        buffer.resize(sizeof(uint64_t));
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        const auto size = make_unsafe_deserializer(buffer.begin())
+            .read_8_bytes_little_endian();
+
+        // Guard the allocation against a corrupted shard size.
+        consumed += sizeof(uint64_t) + size;
+
+        if (!file.good() || consumed > remaining)
+        {
+            clear();
+            return false;
+        }
+
+        buffer.resize(size);
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        auto deserial = make_safe_deserializer(buffer.begin(), buffer.end());
+
+        while (file.good() && !deserial.is_exhausted())
+        {
+            unspent_transaction entry{ null_hash };
+
+            if (!entry.from_data(deserial))
+                break;
+
+            auto& part = select(entry.hash());
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            unique_lock lock(part.mutex);
+            insert(part, std::move(entry));
+            ///////////////////////////////////////////////////////////////////
+        }
+
+        if (!file.good() || !deserial)
+        {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
 // All responses are unspent, metadata should be defaulted by caller.
 bool unspent_outputs::populate(const output_point& point,
     size_t fork_height) const
@@ -174,27 +516,40 @@ bool unspent_outputs::populate(const output_point& point,
     if (disabled())
         return false;
 
-    ++queries_;
+    auto& part = select(point.hash());
+    ++part.queries;
     auto& prevout = point.metadata;
-    const unspent_transaction key{ point };
+    const auto key = make_key(point);
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    shared_lock lock(part.mutex);
 
     // Find the unspent tx entry.
-    const auto tx = unspent_.left.find(key);
-    if (tx == unspent_.left.end())
+    const auto tx = part.unspent.left.find(key);
+    if (tx == part.unspent.left.end())
+    {
+        BCD_TRACE1(cache_miss, point.index());
         return false;
+    }
 
     // Find the output at the specified index for the found unspent tx.
     const auto& transaction = tx->first;
     const auto outputs = transaction.outputs();
     const auto output = outputs->find(point.index());
     if (output == outputs->end())
+    {
+        BCD_TRACE1(cache_miss, point.index());
         return false;
+    }
+
+    ++part.hits;
+    BCD_TRACE2(cache_hit, point.index(), transaction.height());
+
+    // The clock hand passes over this entry once before evicting it.
+    if (policy_ == cache_policy::clock)
+        transaction.set_referenced(true);
 
-    ++hits_;
     const auto prevout_height = transaction.height();
 
     // Populate the output metadata.
@@ -219,5 +574,84 @@ bool unspent_outputs::populate(const output_point& point,
     ///////////////////////////////////////////////////////////////////////////
 }
 
+bool unspent_outputs::contains(const output_point& point) const
+{
+    if (disabled())
+        return false;
+
+    const auto& part = select(point.hash());
+    const auto key = make_key(point);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(part.mutex);
+
+    const auto tx = part.unspent.left.find(key);
+    if (tx == part.unspent.left.end())
+        return false;
+
+    const auto outputs = tx->first.outputs();
+    return outputs->find(point.index()) != outputs->end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The shard must be uniquely locked by the caller.
+void unspent_outputs::insert(shard& part, unspent_transaction&& entry)
+{
+    const auto cost = entry.footprint();
+
+    // An entry beyond the budget of a shard would only empty it.
+    if (shard_bytes_ != 0 && cost > shard_bytes_)
+        return;
+
+    // Remove the oldest entries of the shard until the entry fits.
+    while (!part.unspent.empty() && (part.unspent.size() >= shard_capacity_ ||
+        (shard_bytes_ != 0 && part.bytes + cost > shard_bytes_)))
+    {
+        const auto oldest = part.unspent.right.begin();
+        const auto& unspent = oldest->second;
+
+        // A referenced entry is cleared and becomes the newest, so a pass
+        // over the shard promotes each at most once before evicting.
+        if (unspent.referenced() && part.sequence < max_uint32)
+        {
+            unspent.set_referenced(false);
+            part.unspent.right.replace_key(oldest, ++part.sequence);
+            ++part.promotions;
+            continue;
+        }
+
+        part.bytes -= unspent.footprint();
+        part.unspent.right.erase(oldest);
+        ++part.evictions;
+    }
+
+    // A cached entry is retained, a confirmed tx first promotes in place.
+    const auto result = part.unspent.insert(
+    {
+        std::move(entry),
+        ++part.sequence
+    });
+
+    if (result.second)
+        part.bytes += cost;
+}
+
+// Tx hashes are uniformly distributed, so two of their bytes select a shard.
+unspent_outputs::shard& unspent_outputs::select(
+    const hash_digest& tx_hash) const
+{
+    const auto value = static_cast<size_t>(tx_hash[hash_size - 1]) |
+        static_cast<size_t>(tx_hash[hash_size - 2]) << 8;
+    return shard_[value % shards_];
+}
+
+unspent_transaction unspent_outputs::make_key(const output_point& point) const
+{
+    return granular_ ? unspent_transaction{ point.hash(), point.index() } :
+        unspent_transaction{ point };
+}
+
 } // namespace database
 } // namespace libbitcoin
@@ -30,13 +30,17 @@ using namespace bc::system;
 using namespace bc::system::chain;
 using namespace bc::system::machine;
 
+const uint32_t unspent_transaction::all_outputs = max_uint32;
+
 unspent_transaction::unspent_transaction(unspent_transaction&& other)
   : height_(other.height_),
     median_time_past_(other.median_time_past_),
     is_coinbase_(other.is_coinbase_),
     is_confirmed_(other.is_confirmed_),
     hash_(std::move(other.hash_)),
-    outputs_(other.outputs_)
+    index_(other.index_),
+    outputs_(other.outputs_),
+    referenced_(other.referenced_.load())
 {
 }
 
@@ -46,7 +50,9 @@ unspent_transaction::unspent_transaction(const unspent_transaction& other)
     is_coinbase_(other.is_coinbase_),
     is_confirmed_(other.is_confirmed_),
     hash_(other.hash_),
-    outputs_(other.outputs_)
+    index_(other.index_),
+    outputs_(other.outputs_),
+    referenced_(other.referenced_.load())
 {
 }
 
@@ -56,7 +62,9 @@ unspent_transaction::unspent_transaction(const hash_digest& hash)
     is_coinbase_(false),
     is_confirmed_(false),
     hash_(hash),
-    outputs_(std::make_shared<output_map>())
+    index_(all_outputs),
+    outputs_(std::make_shared<output_map>()),
+    referenced_(false)
 {
 }
 
@@ -72,7 +80,9 @@ unspent_transaction::unspent_transaction(const chain::transaction& tx,
     is_coinbase_(tx.is_coinbase()),
     is_confirmed_(confirmed),
     hash_(tx.hash()),
-    outputs_(std::make_shared<output_map>())
+    index_(all_outputs),
+    outputs_(std::make_shared<output_map>()),
+    referenced_(false)
 {
     const auto& outputs = tx.outputs();
     const auto size = safe_unsigned<uint32_t>(outputs.size());
@@ -83,11 +93,58 @@ unspent_transaction::unspent_transaction(const chain::transaction& tx,
         (*outputs_)[index] = outputs[index];
 }
 
+unspent_transaction::unspent_transaction(const hash_digest& hash,
+    uint32_t index)
+  : height_(rule_fork::unverified),
+    median_time_past_(0),
+    is_coinbase_(false),
+    is_confirmed_(false),
+    hash_(hash),
+    index_(index),
+    outputs_(std::make_shared<output_map>()),
+    referenced_(false)
+{
+}
+
+unspent_transaction::unspent_transaction(const chain::transaction& tx,
+    uint32_t index, size_t height, uint32_t median_time_past, bool confirmed)
+  : height_(height),
+    median_time_past_(median_time_past),
+    is_coinbase_(tx.is_coinbase()),
+    is_confirmed_(confirmed),
+    hash_(tx.hash()),
+    index_(index),
+    outputs_(std::make_shared<output_map>()),
+    referenced_(false)
+{
+    BITCOIN_ASSERT(index < tx.outputs().size());
+    (*outputs_)[index] = tx.outputs()[index];
+}
+
+unspent_transaction::unspent_transaction(const hash_digest& hash,
+    uint32_t index, const output_map& outputs, size_t height,
+    uint32_t median_time_past, bool coinbase, bool confirmed)
+  : height_(height),
+    median_time_past_(median_time_past),
+    is_coinbase_(coinbase),
+    is_confirmed_(confirmed),
+    hash_(hash),
+    index_(index),
+    outputs_(std::make_shared<output_map>(outputs)),
+    referenced_(false)
+{
+}
+
 const hash_digest& unspent_transaction::hash() const
 {
     return hash_;
 }
 
+uint32_t unspent_transaction::index() const
+{
+    return index_;
+}
+
 size_t unspent_transaction::height() const
 {
     return height_;
@@ -108,15 +165,106 @@ bool unspent_transaction::is_confirmed() const
     return is_confirmed_;
 }
 
+// The entry, its output map and the shared control block, plus its outputs.
+size_t unspent_transaction::footprint() const
+{
+    auto total = sizeof(unspent_transaction) + sizeof(output_map) +
+        2 * sizeof(size_t);
+
+    for (const auto& output: *outputs_)
+        total += footprint(output.second);
+
+    return total;
+}
+
+// The map node (value, next) and bucket, plus the script bytes.
+size_t unspent_transaction::footprint(const output& output)
+{
+    return sizeof(output_map::value_type) + 2 * sizeof(void*) +
+        output.script().serialized_size(false);
+}
+
 unspent_transaction::output_map_ptr unspent_transaction::outputs() const
 {
     return outputs_;
 }
 
-// For the purpose of bimap identity only the tx hash matters.
+void unspent_transaction::confirm(size_t height,
+    uint32_t median_time_past) const
+{
+    height_ = height;
+    median_time_past_ = median_time_past;
+    is_confirmed_ = true;
+}
+
+bool unspent_transaction::referenced() const
+{
+    return referenced_;
+}
+
+void unspent_transaction::set_referenced(bool value) const
+{
+    referenced_ = value;
+}
+
+// Entry: [hash:32][index:4][height:4][median_time_past:4][coinbase:1]
+// [confirmed:1][outputs:varint] followed by [index:4][output] per output.
+bool unspent_transaction::from_data(reader& source)
+{
+    hash_ = source.read_hash();
+    index_ = source.read_4_bytes_little_endian();
+    height_ = source.read_4_bytes_little_endian();
+    median_time_past_ = source.read_4_bytes_little_endian();
+    is_coinbase_ = source.read_byte() != 0;
+    is_confirmed_ = source.read_byte() != 0;
+    referenced_ = false;
+
+    const auto count = source.read_size_little_endian();
+    outputs_ = std::make_shared<output_map>();
+
+    for (size_t output = 0; output < count && source; ++output)
+    {
+        const auto index = source.read_4_bytes_little_endian();
+        (*outputs_)[index].from_data(source, true);
+    }
+
+    return source;
+}
+
+void unspent_transaction::to_data(writer& sink) const
+{
+    BITCOIN_ASSERT(height_ <= max_uint32);
+
+    sink.write_hash(hash_);
+    sink.write_4_bytes_little_endian(index_);
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(height_));
+    sink.write_4_bytes_little_endian(median_time_past_);
+    sink.write_byte(is_coinbase_ ? 1 : 0);
+    sink.write_byte(is_confirmed_ ? 1 : 0);
+    sink.write_size_little_endian(outputs_->size());
+
+    for (const auto& output: *outputs_)
+    {
+        sink.write_4_bytes_little_endian(output.first);
+        output.second.to_data(sink, true);
+    }
+}
+
+size_t unspent_transaction::serialized_size() const
+{
+    auto size = hash_size + 3 * sizeof(uint32_t) + 2 * sizeof(uint8_t) +
+        variable_uint_size(outputs_->size());
+
+    for (const auto& output: *outputs_)
+        size += sizeof(uint32_t) + output.second.serialized_size(true);
+
+    return size;
+}
+
+// For the purpose of bimap identity only the tx hash and index matter.
 bool unspent_transaction::operator==(const unspent_transaction& other) const
 {
-    return hash_ == other.hash_;
+    return hash_ == other.hash_ && index_ == other.index_;
 }
 
 unspent_transaction& unspent_transaction::operator=(
@@ -127,7 +275,9 @@ unspent_transaction& unspent_transaction::operator=(
     is_coinbase_ = other.is_coinbase_;
     is_confirmed_ = other.is_confirmed_;
     hash_ = std::move(other.hash_);
+    index_ = other.index_;
     outputs_ = other.outputs_;
+    referenced_ = other.referenced_.load();
     return *this;
 }
 
@@ -139,7 +289,9 @@ unspent_transaction& unspent_transaction::operator=(
     is_coinbase_ = other.is_coinbase_;
     is_confirmed_ = other.is_confirmed_;
     hash_ = other.hash_;
+    index_ = other.index_;
     outputs_ = other.outputs_;
+    referenced_ = other.referenced_.load();
     return *this;
 }
 
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(change_feed_tests)
+
+typedef change_feed::operation operation;
+
+BOOST_AUTO_TEST_CASE(change_feed__read__empty__true_none)
+{
+    const change_feed instance(10);
+    change_feed::list changes;
+    BOOST_REQUIRE(instance.read(changes, 0, 10));
+    BOOST_REQUIRE(changes.empty());
+    BOOST_REQUIRE_EQUAL(instance.sequence(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(change_feed__read__published__in_sequence_to_limit)
+{
+    change_feed instance(10);
+    instance.publish(operation::store, { 1 });
+    instance.publish(operation::confirm, { 2 });
+    instance.publish(operation::candidate, { 3 });
+    BOOST_REQUIRE_EQUAL(instance.sequence(), 3u);
+
+    change_feed::list changes;
+    BOOST_REQUIRE(instance.read(changes, 1, 1));
+    BOOST_REQUIRE_EQUAL(changes.size(), 1u);
+    BOOST_REQUIRE_EQUAL(changes[0].sequence, 2u);
+    BOOST_REQUIRE(changes[0].type == operation::confirm);
+    BOOST_REQUIRE(changes[0].data == data_chunk{ 2 });
+
+    BOOST_REQUIRE(instance.read(changes, 2, 10));
+    BOOST_REQUIRE_EQUAL(changes.size(), 2u);
+    BOOST_REQUIRE_EQUAL(changes[1].sequence, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(change_feed__read__dropped_or_unpublished__false)
+{
+    change_feed instance(2);
+    instance.publish(operation::store, { 1 });
+    instance.publish(operation::store, { 2 });
+    instance.publish(operation::store, { 3 });
+
+    change_feed::list changes;
+    BOOST_REQUIRE(!instance.read(changes, 0, 10));
+    BOOST_REQUIRE(!instance.read(changes, 4, 10));
+    BOOST_REQUIRE(changes.empty());
+
+    BOOST_REQUIRE(instance.read(changes, 1, 10));
+    BOOST_REQUIRE_EQUAL(changes.size(), 2u);
+    BOOST_REQUIRE_EQUAL(changes[0].sequence, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(change_feed__change__round_trip__equal)
+{
+    const change_feed::change expected{ 42, operation::reorganize_blocks,
+        { 1, 2, 3 } };
+
+    change_feed::change change;
+    BOOST_REQUIRE(change_feed::change::from_data(change, expected.to_data()));
+    BOOST_REQUIRE_EQUAL(change.sequence, expected.sequence);
+    BOOST_REQUIRE(change.type == expected.type);
+    BOOST_REQUIRE(change.data == expected.data);
+}
+
+BOOST_AUTO_TEST_CASE(change_feed__change__invalid_operation__false)
+{
+    const change_feed::change expected{ 42, operation::store, { 1 } };
+    auto data = expected.to_data();
+    data[sizeof(uint64_t)] = 0xff;
+
+    change_feed::change change;
+    BOOST_REQUIRE(!change_feed::change::from_data(change, data));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
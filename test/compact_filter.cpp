@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+// BIP158 test vectors (testnet genesis block).
+#define GENESIS_FILTER "019dfca8"
+#define GENESIS_FILTER_HEADER "21584579b7eb08997773e5aeff3a7f932700042d0ed2a6129012b7d7ae81b750"
+
+static block testnet_genesis()
+{
+    return system::settings(system::config::settings::testnet).genesis_block;
+}
+
+BOOST_AUTO_TEST_SUITE(compact_filter_tests)
+
+BOOST_AUTO_TEST_CASE(compact_filter__elements__genesis__coinbase_output_script)
+{
+    const auto genesis = testnet_genesis();
+    const auto elements = compact_filter::elements(genesis);
+    BOOST_REQUIRE_EQUAL(elements.size(), 1u);
+    BOOST_REQUIRE(elements.front() == genesis.transactions().front().outputs().front().script().to_data(false));
+}
+
+BOOST_AUTO_TEST_CASE(compact_filter__encode__genesis__expected)
+{
+    const auto genesis = testnet_genesis();
+    const auto filter = compact_filter::encode(genesis.hash(), compact_filter::elements(genesis));
+    BOOST_REQUIRE_EQUAL(encode_base16(filter), GENESIS_FILTER);
+}
+
+BOOST_AUTO_TEST_CASE(compact_filter__encode__empty__count_only)
+{
+    const auto filter = compact_filter::encode(null_hash, {});
+    BOOST_REQUIRE_EQUAL(filter.size(), 1u);
+    BOOST_REQUIRE_EQUAL(filter.front(), 0u);
+    BOOST_REQUIRE(!compact_filter::match(filter, null_hash, { 0x42 }));
+}
+
+BOOST_AUTO_TEST_CASE(compact_filter__header__genesis__expected)
+{
+    const auto genesis = testnet_genesis();
+    const auto filter = compact_filter::encode(genesis.hash(), compact_filter::elements(genesis));
+    const auto header = compact_filter::header(filter, null_hash);
+    BOOST_REQUIRE_EQUAL(encode_hash(header), GENESIS_FILTER_HEADER);
+}
+
+BOOST_AUTO_TEST_CASE(compact_filter__match__elements__all_matched)
+{
+    data_stack elements;
+    for (size_t index = 0; index < 500; ++index)
+        elements.push_back({ static_cast<uint8_t>(index), static_cast<uint8_t>(index >> 8), 0x51 });
+
+    const auto filter = compact_filter::encode(null_hash, elements);
+
+    for (const auto& element: elements)
+        BOOST_REQUIRE(compact_filter::match(filter, null_hash, element));
+
+    BOOST_REQUIRE(!compact_filter::match(filter, null_hash, { 0x00, 0x00, 0x00, 0x00 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
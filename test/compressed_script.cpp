@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+static data_chunk round_trip(const data_chunk& script, size_t& out_size)
+{
+    out_size = compressed_script::size(script);
+    data_chunk stored(out_size + 1, 0x42);
+    auto serial = make_unsafe_serializer(stored.data());
+    compressed_script::write(serial, script);
+
+    auto skipper = make_unsafe_deserializer(stored.data());
+    compressed_script::skip(skipper);
+    BOOST_REQUIRE_EQUAL(skipper.read_byte(), 0x42u);
+    BOOST_REQUIRE_EQUAL(compressed_script::stored_size(
+        make_unsafe_deserializer(stored.data())), out_size);
+
+    auto deserial = make_unsafe_deserializer(stored.data());
+    return compressed_script::read(deserial);
+}
+
+static data_chunk hashed(const data_chunk& prefix, size_t size,
+    const data_chunk& suffix)
+{
+    auto script = prefix;
+    for (size_t index = 0; index < size; ++index)
+        script.push_back(static_cast<uint8_t>(index * 7 + 1));
+
+    script.insert(script.end(), suffix.begin(), suffix.end());
+    return script;
+}
+
+BOOST_AUTO_TEST_SUITE(compressed_script_tests)
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__pay_key_hash__hash_and_template)
+{
+    size_t size;
+    const auto script = hashed({ 0x76, 0xa9, 0x14 }, 20, { 0x88, 0xac });
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 21u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__pay_script_hash__hash_and_template)
+{
+    size_t size;
+    const auto script = hashed({ 0xa9, 0x14 }, 20, { 0x87 });
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 21u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__pay_witness_key_hash__hash_and_template)
+{
+    size_t size;
+    const auto script = hashed({ 0x00, 0x14 }, 20, {});
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 21u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__pay_witness_script_hash__hash_and_template)
+{
+    size_t size;
+    const auto script = hashed({ 0x00, 0x20 }, 32, {});
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 33u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__nonstandard__raw)
+{
+    size_t size;
+    const auto script = hashed({ 0x76, 0xa9, 0x14 }, 20, { 0x88, 0xad });
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 26u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__empty__raw)
+{
+    size_t size;
+    BOOST_REQUIRE(round_trip({}, size).empty());
+    BOOST_REQUIRE_EQUAL(size, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_script__round_trip__large__raw)
+{
+    size_t size;
+    const auto script = hashed({}, 300, {});
+    BOOST_REQUIRE(round_trip(script, size) == script);
+    BOOST_REQUIRE_EQUAL(size, 303u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,8 +19,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
 #include <future>
 #include <memory>
+#include <thread>
 #include <boost/filesystem.hpp>
 #include <bitcoin/database.hpp>
 #include "utility/utility.hpp"
@@ -395,6 +397,65 @@ BOOST_AUTO_TEST_CASE(data_base__push__adds_to_blocks_and_transactions_validates_
     test_heights(instance, 1u, 1u);
 }
 
+BOOST_AUTO_TEST_CASE(data_base__push__bootstrap_blocks__confirmed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    data_base instance(settings, true);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    const block_const_ptr_list blocks
+    {
+        std::make_shared<const message::block>(block1),
+        std::make_shared<const message::block>(block2)
+    };
+
+    BOOST_REQUIRE_EQUAL(instance.push(blocks, 1), error::success);
+    test_block_exists(instance, 1, block1, true, false);
+    test_block_exists(instance, 2, block2, true, false);
+    test_heights(instance, 2u, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__block_data__pushed__wire_serialization)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    data_base instance(settings, true);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+
+    // setup ends
+
+    data_chunk out;
+    BOOST_REQUIRE(instance.block_data(out, instance.blocks().get(1, false)));
+
+    // test conditions
+
+    BOOST_REQUIRE(out == block1.to_data());
+}
+
 // BLOCK ORGANIZER tests
 // ----------------------------------------------------------------------------
 
@@ -1075,6 +1136,107 @@ BOOST_AUTO_TEST_CASE(data_base__confirm__already_candidated___success)
         BOOST_REQUIRE(!instance.transactions().get(offset).candidate());
 }
 
+/// ingest
+
+BOOST_AUTO_TEST_CASE(data_base__ingest__candidate_headers__updated_and_confirmed)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    BOOST_REQUIRE(instance.create(genesis));
+
+    const auto block1_ptr = std::make_shared<const message::block>(read_block(MAINNET_BLOCK1));
+    const auto block2_ptr = std::make_shared<const message::block>(read_block(MAINNET_BLOCK2));
+    const auto block3_ptr = std::make_shared<const message::block>(read_block(MAINNET_BLOCK3));
+
+    const auto headers_push_ptr = std::make_shared<const header_const_ptr_list>(header_const_ptr_list
+    {
+        std::make_shared<const message::header>(block1_ptr->header()),
+        std::make_shared<const message::header>(block2_ptr->header()),
+        std::make_shared<const message::header>(block3_ptr->header())
+    });
+
+    BOOST_REQUIRE(instance.push_all(headers_push_ptr, config::checkpoint(genesis.hash(), 0)));
+    test_heights(instance, 3u, 0u);
+
+    // setup ends
+
+    const block_const_ptr_list blocks{ block1_ptr, block2_ptr, block3_ptr };
+    BOOST_REQUIRE_EQUAL(instance.ingest(blocks, 1, true), error::success);
+
+    // test conditions
+
+    test_heights(instance, 3u, 3u);
+    test_block_exists(instance, 1, *block1_ptr, false, false);
+    test_block_exists(instance, 2, *block2_ptr, false, false);
+    test_block_exists(instance, 3, *block3_ptr, false, false);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__snapshot__confirmed_blocks__top_block_and_txs_consistent)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    data_base_accessor instance(settings);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const chain::block& genesis = bc_settings.genesis_block;
+    BOOST_REQUIRE(instance.create(genesis));
+
+    const auto block1_ptr = std::make_shared<const message::block>(read_block(MAINNET_BLOCK1));
+    const auto block2_ptr = std::make_shared<const message::block>(read_block(MAINNET_BLOCK2));
+
+    const auto headers_push_ptr = std::make_shared<const header_const_ptr_list>(header_const_ptr_list
+    {
+        std::make_shared<const message::header>(block1_ptr->header()),
+        std::make_shared<const message::header>(block2_ptr->header())
+    });
+
+    BOOST_REQUIRE(instance.push_all(headers_push_ptr, config::checkpoint(genesis.hash(), 0)));
+    const block_const_ptr_list blocks{ block1_ptr, block2_ptr };
+    BOOST_REQUIRE_EQUAL(instance.ingest(blocks, 1, true), error::success);
+
+    // setup ends
+
+    size_t reads = 0;
+    size_t height = 0;
+    hash_digest hash = null_hash;
+    bool confirmed = false;
+
+    BOOST_REQUIRE(instance.snapshot([&](size_t top)
+    {
+        ++reads;
+        height = top;
+        const auto block = instance.blocks().get(top, false);
+        hash = block.hash();
+        const auto tx = instance.transactions().get(*block.begin());
+        confirmed = tx && tx.height() == top;
+    }));
+
+    // test conditions
+
+    BOOST_REQUIRE_EQUAL(reads, 1u);
+    BOOST_REQUIRE_EQUAL(height, 2u);
+    BOOST_REQUIRE(hash == block2_ptr->hash());
+    BOOST_REQUIRE(confirmed);
+}
+
 /// update
 
 #ifndef NDEBUG
@@ -1303,6 +1465,316 @@ BOOST_AUTO_TEST_CASE(data_base__catalog2__enabled__success)
 
 /// reorganize headers
 
+BOOST_AUTO_TEST_CASE(data_base__cataloged__deferred__trails_by_lag_and_resumes)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+    settings.address_table_deferred = true;
+    settings.address_table_lag = 1;
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto& coinbase = block1.transactions().front();
+    const auto cataloged_to = [](const data_base& instance, size_t height)
+    {
+        size_t out;
+        for (size_t poll = 0; poll < 1000; ++poll)
+        {
+            if (instance.cataloged(out) && out == height)
+                return true;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return false;
+    };
+
+    {
+        data_base instance(settings, true);
+        const auto bc_settings = bc::system::settings(config::settings::mainnet);
+        BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+        size_t height;
+        BOOST_REQUIRE(!instance.cataloged(height));
+
+        // The genesis block is cataloged once it is below the lag.
+        BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+        BOOST_REQUIRE(cataloged_to(instance, 0));
+        test_outputs_cataloged(instance.addresses(), coinbase, false);
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // The saved progress resumes, and block1 is cataloged with no lag.
+    settings.address_table_lag = 0;
+    data_base instance(settings, true);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(cataloged_to(instance, 1));
+    test_outputs_cataloged(instance.addresses(), coinbase, true);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__build_addresses__existing_store__cataloged)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+    settings.write_threads = 2;
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto& coinbase = block1.transactions().front();
+
+    {
+        data_base instance(settings, false);
+        const auto bc_settings = bc::system::settings(config::settings::mainnet);
+        BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+        BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+        BOOST_REQUIRE(instance.close());
+    }
+
+    {
+        data_base instance(settings, true);
+        BOOST_REQUIRE(instance.build_addresses());
+        test_outputs_cataloged(instance.addresses(), coinbase, true);
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // The index files now exist, so the store opens with them.
+    data_base instance(settings, true);
+    BOOST_REQUIRE(instance.open());
+    test_outputs_cataloged(instance.addresses(), coinbase, true);
+}
+
+BOOST_AUTO_TEST_CASE(data_base__open__lazy_address_table__cataloged_once_ready)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto& coinbase = block1.transactions().front();
+
+    {
+        data_base instance(settings, true);
+        const auto bc_settings = bc::system::settings(config::settings::mainnet);
+        BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+        BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // The store opens without the address table, queries wait for it.
+    settings.address_table_lazy = true;
+    data_base instance(settings, true);
+    BOOST_REQUIRE(instance.open());
+    test_outputs_cataloged(instance.addresses(), coinbase, true);
+    BOOST_REQUIRE(instance.addresses_ready());
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__refresh__read_only_alongside_writer__follows_top)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    data_base writer(settings, false);
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    BOOST_REQUIRE(writer.create(bc_settings.genesis_block));
+    BOOST_REQUIRE_EQUAL(writer.push(block1, 1), error::success);
+
+    // The reader takes no lock, so it opens while the writer is open.
+    auto reader_settings = settings;
+    reader_settings.read_only = true;
+    data_base reader(reader_settings, false);
+    BOOST_REQUIRE(!reader.create(bc_settings.genesis_block));
+    BOOST_REQUIRE(reader.open());
+
+    size_t top;
+    BOOST_REQUIRE(reader.blocks().top(top, false));
+    BOOST_REQUIRE_EQUAL(top, 1u);
+    BOOST_REQUIRE_EQUAL(reader.push(block2, 2), error::store_lock_failure);
+
+    // The reader follows the committed top once refreshed.
+    BOOST_REQUIRE_EQUAL(writer.push(block2, 2), error::success);
+    BOOST_REQUIRE(reader.refresh());
+    BOOST_REQUIRE(reader.blocks().top(top, false));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+
+    const auto result = reader.blocks().get(2, false);
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE(result.hash() == block2.hash());
+
+    BOOST_REQUIRE(reader.close());
+    BOOST_REQUIRE(writer.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__defragment__pooled_tx__dropped_blocks_retained)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY;
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+    const auto block3 = read_block(MAINNET_BLOCK3);
+    const auto pooled = block3.transactions().front().hash();
+
+    {
+        data_base instance(settings, false);
+        const auto bc_settings = bc::system::settings(config::settings::mainnet);
+        BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+
+        // The pooled tx precedes the txs of the blocks in the table.
+        store_block_transactions(instance, block3, 0);
+        BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+        BOOST_REQUIRE_EQUAL(instance.push(block2, 2), error::success);
+        BOOST_REQUIRE(instance.transactions().get(pooled));
+        BOOST_REQUIRE(instance.close());
+    }
+
+    {
+        data_base instance(settings, false);
+        BOOST_REQUIRE(instance.defragment());
+    }
+
+    data_base instance(settings, false);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(!instance.transactions().get(pooled));
+    BOOST_REQUIRE(instance.transactions().get(
+        block1.transactions().front().hash()));
+    BOOST_REQUIRE(instance.transactions().get(
+        block2.transactions().front().hash()));
+    test_heights(instance, 2u, 2u);
+
+    // The txs of the confirmed blocks are contiguous in height order.
+    const auto link1 = instance.blocks().get(1, false).links()[0];
+    const auto link2 = instance.blocks().get(2, false).links()[0];
+    BOOST_REQUIRE_LT(link1, link2);
+    BOOST_REQUIRE(instance.transactions().get(link2).hash() ==
+        block2.transactions().front().hash());
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__apply__leader_changes__follower_top)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY "/leader";
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+    settings.change_feed_size = 10;
+    create_directory(settings.directory);
+
+    auto follower_settings = settings;
+    follower_settings.directory = DIRECTORY "/follower";
+    follower_settings.change_feed_size = 0;
+    create_directory(follower_settings.directory);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    data_base leader(settings, false);
+    data_base follower(follower_settings, false);
+    BOOST_REQUIRE(leader.create(bc_settings.genesis_block));
+    BOOST_REQUIRE(follower.create(bc_settings.genesis_block));
+    BOOST_REQUIRE_EQUAL(leader.push(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(leader.push(block2, 2), error::success);
+    BOOST_REQUIRE_EQUAL(leader.changes().sequence(), 3u);
+
+    // The first change is the genesis push, with which the follower is
+    // created. Changes are applied from their wire serialization.
+    change_feed::list changes;
+    BOOST_REQUIRE(leader.changes().read(changes, 1, 10));
+    BOOST_REQUIRE_EQUAL(changes.size(), 2u);
+
+    for (const auto& change: changes)
+    {
+        change_feed::change copy;
+        BOOST_REQUIRE(change_feed::change::from_data(copy, change.to_data()));
+        BOOST_REQUIRE(copy.type == change_feed::operation::push);
+        BOOST_REQUIRE_EQUAL(follower.apply(copy), error::success);
+    }
+
+    size_t top;
+    BOOST_REQUIRE(follower.blocks().top(top, false));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+    BOOST_REQUIRE(follower.blocks().get(2, false).hash() == block2.hash());
+    BOOST_REQUIRE(follower.transactions().get(
+        block2.transactions().front().hash()));
+
+    BOOST_REQUIRE(leader.close());
+    BOOST_REQUIRE(follower.close());
+}
+
+BOOST_AUTO_TEST_CASE(data_base__backup__open_store__copy_at_backup_top)
+{
+    create_directory(DIRECTORY);
+    bc::database::settings settings;
+    settings.directory = DIRECTORY "/store";
+    settings.flush_writes = false;
+    settings.file_growth_rate = 42;
+    settings.block_table_buckets = 42;
+    settings.transaction_table_buckets = 42;
+    settings.address_table_buckets = 42;
+    create_directory(settings.directory);
+
+    auto backup_settings = settings;
+    backup_settings.directory = DIRECTORY "/backup";
+    create_directory(backup_settings.directory);
+
+    const auto bc_settings = bc::system::settings(config::settings::mainnet);
+    const auto block1 = read_block(MAINNET_BLOCK1);
+    const auto block2 = read_block(MAINNET_BLOCK2);
+
+    data_base instance(settings, false);
+    BOOST_REQUIRE(instance.create(bc_settings.genesis_block));
+    BOOST_REQUIRE_EQUAL(instance.push(block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.backup(backup_settings.directory),
+        error::success);
+
+    // Writes resume once the backup completes, and are not in the copy.
+    BOOST_REQUIRE_EQUAL(instance.push(block2, 2), error::success);
+    BOOST_REQUIRE(instance.close());
+
+    data_base copy(backup_settings, false);
+    BOOST_REQUIRE(copy.open());
+    test_heights(copy, 1u, 1u);
+    BOOST_REQUIRE(copy.blocks().get(1, false).hash() == block1.hash());
+    BOOST_REQUIRE(copy.transactions().get(
+        block1.transactions().front().hash()));
+    BOOST_REQUIRE(copy.close());
+}
+
 BOOST_AUTO_TEST_CASE(data_base__reorganize__pop_and_push__success)
 {
     create_directory(DIRECTORY);
@@ -79,9 +79,11 @@ class address_database_accessor
 public:
     address_database_accessor(const path& lookup_filename,
         const path& rows_filename, size_t table_minimum, size_t index_minimum,
-        size_t buckets, size_t expansion)
+        size_t buckets, size_t expansion, bool paged=false,
+        size_t read_ahead=0)
       : address_database(lookup_filename, rows_filename, table_minimum,
-          index_minimum, buckets, expansion)
+          index_minimum, buckets, expansion, false, 0, 0, 0, paged, 0,
+          read_ahead)
     {
     }
 
@@ -91,6 +93,8 @@ public:
         address_database::store(hash, point, height, input);
     }
 
+    using address_database::catalog;
+
     void catalog(const system::chain::transaction& tx)
     {
         address_database::catalog(tx);        
@@ -169,6 +173,236 @@ BOOST_AUTO_TEST_CASE(address_database__store__two_inputs_two_outputs_two_transac
     BOOST_REQUIRE(++payments0 == result0.end());
 }
 
+BOOST_AUTO_TEST_CASE(address_database__store__paged_rows__newest_first_across_pages_and_reopen)
+{
+    test::create(lookup_filename);
+    test::create(rows_filename);
+
+    script script0;
+    script0.from_string(OUTPUT_SCRIPT0);
+    const auto script_hash0 = sha256_hash(script0.to_data(false));
+
+    script script1;
+    script1.from_string(OUTPUT_SCRIPT1);
+    const auto script_hash1 = sha256_hash(script1.to_data(false));
+
+    const hash_digest tx_hash = sha256_hash(to_chunk("tx_hash"));
+    static const uint32_t rows = 300;
+
+    {
+        address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50, true);
+        BOOST_REQUIRE(instance.create());
+
+        for (uint32_t index = 0; index < rows; ++index)
+            instance.store(script_hash0, output_point{ tx_hash, index }, index, true);
+
+        instance.store(script_hash1, output_point{ tx_hash, 42 }, 42, true);
+
+        uint32_t expected = rows;
+        const auto result0 = instance.get(script_hash0);
+        BOOST_REQUIRE(result0);
+
+        for (const auto payment: result0)
+        {
+            BOOST_REQUIRE(payment.is_output());
+            BOOST_REQUIRE_EQUAL(payment.index(), --expected);
+            BOOST_REQUIRE_EQUAL(payment.link(), expected);
+        }
+
+        BOOST_REQUIRE_EQUAL(expected, 0u);
+        instance.commit();
+        BOOST_REQUIRE(instance.flush());
+        BOOST_REQUIRE(instance.close());
+    }
+
+    address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50, true);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(!instance.get(sha256_hash(to_chunk("missing"))));
+
+    const auto result1 = instance.get(script_hash1);
+    auto payments1 = result1.begin();
+    BOOST_REQUIRE(payments1 != result1.end());
+    BOOST_REQUIRE_EQUAL((*payments1).index(), 42u);
+    BOOST_REQUIRE(++payments1 == result1.end());
+
+    size_t count = 0;
+    const auto result0 = instance.get(script_hash0);
+
+    for (auto it = result0.begin(); it != result0.end(); ++it)
+        ++count;
+
+    BOOST_REQUIRE_EQUAL(count, rows);
+}
+
+BOOST_AUTO_TEST_CASE(address_database__get__read_ahead_paged_and_list_rows__newest_first)
+{
+    const auto hash = sha256_hash(to_chunk("script"));
+    const auto other = sha256_hash(to_chunk("other"));
+    const hash_digest tx_hash = sha256_hash(to_chunk("tx_hash"));
+    static const uint32_t rows = 300;
+
+    for (const auto paged: { true, false })
+    {
+        test::create(lookup_filename);
+        test::create(rows_filename);
+        address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50, paged, 4);
+        BOOST_REQUIRE(instance.create());
+
+        // Interleaved rows of another address break the stride of the list.
+        for (uint32_t index = 0; index < rows; ++index)
+        {
+            instance.store(hash, output_point{ tx_hash, index }, index, true);
+
+            if (index % 7 == 0)
+                instance.store(other, output_point{ tx_hash, index }, index, true);
+        }
+
+        auto expected = rows;
+        for (const auto payment: instance.get(hash))
+            BOOST_REQUIRE_EQUAL(payment.index(), --expected);
+
+        BOOST_REQUIRE_EQUAL(expected, 0u);
+        BOOST_REQUIRE(instance.close());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(address_database__seek__paged_and_list_rows__resumes_at_token)
+{
+    script script0;
+    script0.from_string(OUTPUT_SCRIPT0);
+    const auto script_hash0 = sha256_hash(script0.to_data(false));
+    const hash_digest tx_hash = sha256_hash(to_chunk("tx_hash"));
+    static const uint32_t rows = 300;
+
+    for (const auto paged: { true, false })
+    {
+        test::create(lookup_filename);
+        test::create(rows_filename);
+        address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50, paged);
+        BOOST_REQUIRE(instance.create());
+
+        for (uint32_t index = 0; index < rows; ++index)
+            instance.store(script_hash0, output_point{ tx_hash, index }, index, true);
+
+        const auto result = instance.get(script_hash0);
+        BOOST_REQUIRE(result.seek(rows) == result.end());
+        BOOST_REQUIRE(result.seek(rows + 1u) == result.end());
+        BOOST_REQUIRE(result.begin(result.end().token()) == result.end());
+        BOOST_REQUIRE(result.seek(0) == result.begin());
+
+        // Page boundaries (newest first) fall at 46, 174, 238, 270, 286.
+        for (const auto offset: { 1u, 45u, 46u, 47u, 173u, 174u, 298u })
+        {
+            auto it = result.seek(offset);
+            BOOST_REQUIRE(it != result.end());
+            BOOST_REQUIRE_EQUAL((*it).index(), rows - 1u - offset);
+
+            // The token remains valid while rows are added to the address.
+            const auto token = it.token();
+            instance.store(script_hash0, output_point{ tx_hash, rows }, rows, true);
+            auto resumed = instance.get(script_hash0).begin(token);
+            BOOST_REQUIRE_EQUAL((*resumed).index(), rows - 1u - offset);
+            BOOST_REQUIRE_EQUAL((*++resumed).index(), rows - 2u - offset);
+        }
+
+        BOOST_REQUIRE(instance.close());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(address_database__get__batch_of_hashes__results_in_hash_order)
+{
+    const hash_digest tx_hash = sha256_hash(to_chunk("tx_hash"));
+    static const uint32_t keys = 600;
+
+    hash_list hashes;
+    for (uint32_t index = 0; index < keys; ++index)
+        hashes.push_back(sha256_hash(to_chunk(std::to_string(index))));
+
+    threadpool pool(2);
+
+    for (const auto paged: { true, false })
+    {
+        test::create(lookup_filename);
+        test::create(rows_filename);
+        address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 100, 50, paged);
+        BOOST_REQUIRE(instance.create());
+
+        // Only even keys have rows, the link of each row is its key index.
+        for (uint32_t index = 0; index < keys; index += 2)
+            instance.store(hashes[index], output_point{ tx_hash, index }, index, true);
+
+        const auto results = instance.get(hashes, pool);
+        BOOST_REQUIRE_EQUAL(results.size(), keys);
+
+        for (uint32_t index = 0; index < keys; ++index)
+        {
+            const auto& result = results[index];
+            BOOST_REQUIRE(result.hash() == hashes[index]);
+
+            if (index % 2 != 0)
+            {
+                BOOST_REQUIRE(result.begin() == result.end());
+                continue;
+            }
+
+            auto it = result.begin();
+            BOOST_REQUIRE(it != result.end());
+            BOOST_REQUIRE_EQUAL((*it).link(), index);
+            BOOST_REQUIRE(++it == result.end());
+        }
+
+        BOOST_REQUIRE(instance.close());
+    }
+
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(address_database__compact__unordered_rows__ranked_run_unless_added)
+{
+    test::create(lookup_filename);
+    test::create(rows_filename);
+    address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto hash = sha256_hash(to_chunk("script"));
+    const hash_digest tx_hash = sha256_hash(to_chunk("tx_hash"));
+
+    for (const auto link: { 10u, 30u, 20u, 50u, 40u })
+        instance.store(hash, output_point{ tx_hash, link }, link, true);
+
+    const auto rank = [](const payment_record& row)
+    {
+        return static_cast<size_t>(row.link());
+    };
+
+    BOOST_REQUIRE(instance.compact(hash, rank));
+    BOOST_REQUIRE(instance.compact(hash, rank));
+
+    uint64_t expected = 60;
+    for (const auto payment: instance.get(hash))
+    {
+        BOOST_REQUIRE_EQUAL(payment.link(), expected -= 10);
+        BOOST_REQUIRE_EQUAL(payment.index(), expected);
+    }
+
+    BOOST_REQUIRE_EQUAL(expected, 10u);
+
+    // A row added while the rows are read is retained, so no swap occurs.
+    auto added = false;
+    const auto adding = [&](const payment_record& row)
+    {
+        if (!added)
+            instance.store(hash, output_point{ tx_hash, 5 }, 5, true);
+
+        added = true;
+        return static_cast<size_t>(max_size_t - row.link());
+    };
+
+    BOOST_REQUIRE(!instance.compact(hash, adding));
+    BOOST_REQUIRE_EQUAL((*instance.get(hash).begin()).link(), 5u);
+}
+
 BOOST_AUTO_TEST_CASE(address_database__catalog__coinbase_transaction__success)
 {
     uint32_t version = 2345u;
@@ -217,6 +451,53 @@ BOOST_AUTO_TEST_CASE(address_database__catalog__coinbase_transaction__success)
     BOOST_REQUIRE(++payments0 == result0.end());
 }
 
+BOOST_AUTO_TEST_CASE(address_database__catalog__block_with_existing_tx__skips_existing)
+{
+    test::create(lookup_filename);
+    test::create(rows_filename);
+    address_database_accessor instance(lookup_filename, rows_filename, 10, 10, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    script script0;
+    script0.from_string(OUTPUT_SCRIPT0);
+    const auto script_hash0 = sha256_hash(script0.to_data(false));
+
+    script script1;
+    script1.from_string(OUTPUT_SCRIPT1);
+    const auto script_hash1 = sha256_hash(script1.to_data(false));
+
+    const chain::input::list inputs
+    {
+        { chain::point{ null_hash, chain::point::null_index }, {}, 0 }
+    };
+
+    chain::transaction tx0{ 1, 0, inputs, { { 100, script0 } } };
+    chain::transaction tx1{ 2, 0, inputs, { { 200, script0 }, { 201, script1 } } };
+    chain::transaction tx2{ 3, 0, inputs, { { 300, script1 } } };
+    tx0.metadata.link = 1000;
+    tx1.metadata.link = 2000;
+    tx2.metadata.link = 3000;
+    tx2.metadata.existed = true;
+
+    const chain::block block{ {}, { tx0, tx1, tx2 } };
+    threadpool pool(2);
+    instance.catalog(block, pool);
+    pool.shutdown();
+    pool.join();
+
+    const auto result0 = instance.get(script_hash0);
+    auto payments0 = result0.begin();
+    BOOST_REQUIRE_EQUAL((*payments0).link(), 2000u);
+    BOOST_REQUIRE_EQUAL((*(++payments0)).link(), 1000u);
+    BOOST_REQUIRE(++payments0 == result0.end());
+
+    const auto result1 = instance.get(script_hash1);
+    auto payments1 = result1.begin();
+    BOOST_REQUIRE_EQUAL((*payments1).link(), 2000u);
+    BOOST_REQUIRE_EQUAL((*payments1).index(), 1u);
+    BOOST_REQUIRE(++payments1 == result1.end());
+}
+
 BOOST_AUTO_TEST_CASE(address_database__catalog__tx1_spends_from_tx0__success)
 {
     uint32_t version = 2345u;
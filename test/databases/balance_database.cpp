@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace boost::system;
+using namespace boost::filesystem;
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+#define DIRECTORY "balance_database"
+
+static BC_CONSTEXPR auto file_path = DIRECTORY "/balance_table";
+static BC_CONSTEXPR auto tx_path = DIRECTORY "/tx_table";
+
+struct balance_database_directory_setup_fixture
+{
+    balance_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+
+    ~balance_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+static transaction coinbase(uint64_t value, const script& script)
+{
+    return { 1, 0, { { { null_hash, point::null_index }, {}, 0 } },
+        { { value, script } } };
+}
+
+BOOST_FIXTURE_TEST_SUITE(balance_database_tests, balance_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(balance_database__confirm_unconfirm__spending_block__expected_summaries)
+{
+    const script script_a;
+    script script_b;
+    BOOST_REQUIRE(script_b.from_string("return"));
+    const auto hash_a = sha256_hash(script_a.to_data(false));
+    const auto hash_b = sha256_hash(script_b.to_data(false));
+
+    const auto tx1 = coinbase(50, script_a);
+    const transaction tx2{ 1, 0, { { { tx1.hash(), 0 }, {}, 0 } },
+        { { 40, script_a }, { 10, script_b } } };
+    const block block1{ {}, { tx1 } };
+    const block block2{ {}, { coinbase(51, script_b), tx2 } };
+
+    // The prevout of tx2 is not populated, so it is read from the tx table.
+    test::create(tx_path);
+    transaction_database transactions(tx_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(transactions.create());
+    BOOST_REQUIRE(transactions.store(tx1, 1));
+    BOOST_REQUIRE(transactions.confirm(transactions.get(tx1.hash()).link(), 1,
+        24, 0));
+
+    test::create(file_path);
+    balance_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    balance_database::summary summary;
+    BOOST_REQUIRE(!instance.get(summary, hash_a));
+
+    BOOST_REQUIRE(instance.confirm(block1, 1, transactions));
+    BOOST_REQUIRE(instance.get(summary, hash_a));
+    BOOST_REQUIRE_EQUAL(summary.received, 50u);
+    BOOST_REQUIRE_EQUAL(summary.spent, 0u);
+    BOOST_REQUIRE_EQUAL(summary.transactions, 1u);
+    BOOST_REQUIRE_EQUAL(summary.height, 1u);
+
+    BOOST_REQUIRE(instance.confirm(block2, 2, transactions));
+    BOOST_REQUIRE(instance.get(summary, hash_a));
+    BOOST_REQUIRE_EQUAL(summary.received, 90u);
+    BOOST_REQUIRE_EQUAL(summary.spent, 50u);
+    BOOST_REQUIRE_EQUAL(summary.transactions, 2u);
+    BOOST_REQUIRE_EQUAL(summary.height, 2u);
+
+    BOOST_REQUIRE(instance.get(summary, hash_b));
+    BOOST_REQUIRE_EQUAL(summary.received, 61u);
+    BOOST_REQUIRE_EQUAL(summary.spent, 0u);
+    BOOST_REQUIRE_EQUAL(summary.transactions, 2u);
+    BOOST_REQUIRE_EQUAL(summary.height, 2u);
+
+    // Without the address table the last height is the preceding height.
+    BOOST_REQUIRE(instance.unconfirm(block2, 2, transactions));
+    BOOST_REQUIRE(!instance.get(summary, hash_b));
+    BOOST_REQUIRE(instance.get(summary, hash_a));
+    BOOST_REQUIRE_EQUAL(summary.received, 50u);
+    BOOST_REQUIRE_EQUAL(summary.spent, 0u);
+    BOOST_REQUIRE_EQUAL(summary.transactions, 1u);
+    BOOST_REQUIRE_EQUAL(summary.height, 1u);
+
+    instance.commit();
+    BOOST_REQUIRE(instance.close());
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.get(summary, hash_a));
+    BOOST_REQUIRE_EQUAL(summary.received, 50u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -251,6 +251,15 @@ BOOST_AUTO_TEST_CASE(block_database__test)
     BOOST_REQUIRE_EQUAL(*it2++, 10u);
     BOOST_REQUIRE(it2 == result2.end());
 
+    // The link span must not be held across a block update.
+    {
+        const auto links2 = result2.links();
+        BOOST_REQUIRE_EQUAL(links2.size(), 5u);
+        BOOST_REQUIRE_EQUAL(links2[0], 6u);
+        BOOST_REQUIRE_EQUAL(links2[4], 10u);
+        BOOST_REQUIRE(links2.to_list() == link_list({ 6, 7, 8, 9, 10 }));
+    }
+
     // no metadata for missing blocks
     instance.get_header_metadata(block4a.header());
 
@@ -328,4 +337,363 @@ BOOST_AUTO_TEST_CASE(block_database__test)
     instance.commit();
 }
 
+BOOST_AUTO_TEST_CASE(block_database__get_header__resident_headers__pushed_popped_and_reloaded)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const auto header0 = settings.genesis_block.header();
+    auto header1 = header0;
+    header1.set_nonce(4);
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+
+    {
+        block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, true);
+        BOOST_REQUIRE(instance.create());
+        instance.store(header0, 0, 42);
+        instance.store(header1, 1, 43);
+        BOOST_REQUIRE(instance.promote(header0.hash(), 0, true));
+        BOOST_REQUIRE(instance.promote(header1.hash(), 1, true));
+        BOOST_REQUIRE(instance.promote(header0.hash(), 0, false));
+
+        chain::header header;
+        uint32_t median_time_past;
+        BOOST_REQUIRE(instance.get_header(header, median_time_past, 1, true));
+        BOOST_REQUIRE(header == header1);
+        BOOST_REQUIRE_EQUAL(median_time_past, 43u);
+        BOOST_REQUIRE(!instance.get_header(header, median_time_past, 1, false));
+        BOOST_REQUIRE(instance.get(1, true).hash() == header1.hash());
+
+        BOOST_REQUIRE(instance.demote(header1.hash(), 1, true));
+        BOOST_REQUIRE(!instance.get_header(header, median_time_past, 1, true));
+        BOOST_REQUIRE(!instance.get(1, true));
+        BOOST_REQUIRE(instance.promote(header1.hash(), 1, true));
+        instance.commit();
+        BOOST_REQUIRE(instance.flush());
+        BOOST_REQUIRE(instance.close());
+    }
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, true);
+    BOOST_REQUIRE(instance.open());
+
+    hash_digest hash;
+    BOOST_REQUIRE(instance.get_hash(hash, 1, true));
+    BOOST_REQUIRE(hash == header1.hash());
+    BOOST_REQUIRE(instance.get_hash(hash, 0, false));
+    BOOST_REQUIRE(hash == header0.hash());
+    BOOST_REQUIRE(!instance.get_hash(hash, 1, false));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__promote_range__headers__indexed_then_demoted_above_fork)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const auto header0 = settings.genesis_block.header();
+    auto header1 = header0;
+    auto header2 = header0;
+    header1.set_nonce(4);
+    header2.set_nonce(5);
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, true);
+    BOOST_REQUIRE(instance.create());
+    instance.store(header0, 0, 0);
+    instance.store(header1, 1, 0);
+    instance.store(header2, 2, 0);
+
+    // A missing header fails without indexing any.
+    BOOST_REQUIRE(!instance.promote(hash_list{ header0.hash(), null_hash }, 0, true));
+    BOOST_REQUIRE(!instance.get(0, true));
+    BOOST_REQUIRE(!instance.promote(hash_list{ header1.hash() }, 1, true));
+
+    BOOST_REQUIRE(instance.promote(hash_list{ header0.hash(), header1.hash(), header2.hash() }, 0, true));
+
+    size_t top;
+    BOOST_REQUIRE(instance.top(top, true));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+    BOOST_REQUIRE(instance.get(2, true).hash() == header2.hash());
+    BOOST_REQUIRE(is_candidate(instance.get(header1.hash()).state()));
+
+    BOOST_REQUIRE(instance.demote(0, true));
+    BOOST_REQUIRE(instance.top(top, true));
+    BOOST_REQUIRE_EQUAL(top, 0u);
+    BOOST_REQUIRE(!instance.get(1, true));
+    BOOST_REQUIRE(!is_candidate(instance.get(header1.hash()).state()));
+    BOOST_REQUIRE(!is_candidate(instance.get(header2.hash()).state()));
+    BOOST_REQUIRE(is_candidate(instance.get(header0.hash()).state()));
+
+    hash_digest hash;
+    BOOST_REQUIRE(!instance.get_hash(hash, 1, true));
+    BOOST_REQUIRE(!instance.demote(0, false));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__find_height__time_index__searched_popped_and_reloaded)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    auto header0 = settings.genesis_block.header();
+    auto header1 = header0;
+    auto header2 = header0;
+    header0.set_timestamp(100);
+    header1.set_timestamp(90);
+    header2.set_timestamp(200);
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+    const auto block_times = DIRECTORY "/block_times";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    test::create(block_times);
+
+    {
+        block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, false, block_times);
+        BOOST_REQUIRE(instance.create());
+        instance.store(header0, 0, 10);
+        instance.store(header1, 1, 20);
+        instance.store(header2, 2, 30);
+        const hash_list hashes{ header0.hash(), header1.hash(), header2.hash() };
+        BOOST_REQUIRE(instance.promote(hashes, 0, true));
+        BOOST_REQUIRE(instance.promote(hashes, 0, false));
+
+        size_t height;
+        BOOST_REQUIRE(instance.find_height(height, 95, false));
+        BOOST_REQUIRE_EQUAL(height, 0u);
+        BOOST_REQUIRE(instance.find_height(height, 150, false));
+        BOOST_REQUIRE_EQUAL(height, 2u);
+        BOOST_REQUIRE(!instance.find_height(height, 201, false));
+        BOOST_REQUIRE(instance.find_height(height, 15, true));
+        BOOST_REQUIRE_EQUAL(height, 1u);
+
+        BOOST_REQUIRE(instance.demote(1, false));
+        BOOST_REQUIRE(!instance.find_height(height, 150, false));
+        instance.commit();
+        BOOST_REQUIRE(instance.flush());
+        BOOST_REQUIRE(instance.close());
+    }
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, false, block_times);
+    BOOST_REQUIRE(instance.open());
+
+    size_t height;
+    BOOST_REQUIRE(instance.find_height(height, 20, true));
+    BOOST_REQUIRE_EQUAL(height, 1u);
+    BOOST_REQUIRE(!instance.find_height(height, 21, true));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__promote__stored_link__same_as_by_hash)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const auto header = settings.genesis_block.header();
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto link = instance.store(header, 0, 0);
+    BOOST_REQUIRE_EQUAL(link, instance.get(header.hash()).link());
+    BOOST_REQUIRE(!instance.promote(link, 1, true));
+    BOOST_REQUIRE(instance.promote(link, 0, true));
+    BOOST_REQUIRE(instance.validate(link, error::success));
+    BOOST_REQUIRE(instance.promote(link, 0, false));
+    BOOST_REQUIRE_EQUAL(instance.get(0, false).state(), block_state::valid | block_state::confirmed);
+
+    BOOST_REQUIRE(instance.demote(link, 0, false));
+    BOOST_REQUIRE(!instance.get(0, false));
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get_header_metadata__batch__extension_and_overlap)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+
+    chain::header::list headers{ settings.genesis_block.header() };
+
+    for (uint32_t height = 1; height < 6; ++height)
+    {
+        auto header = headers.back();
+        header.set_previous_block_hash(headers.back().hash());
+        header.set_timestamp(height);
+        headers.push_back(header);
+    }
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    instance.store(headers[0], 0, 0);
+    instance.store(headers[1], 1, 0);
+    instance.store(headers[2], 2, 0);
+    BOOST_REQUIRE(instance.promote({ headers[0].hash(), headers[1].hash(), headers[2].hash() }, 0, true));
+
+    threadpool pool(2);
+    const chain::header::list extension{ headers[3], headers[4], headers[5] };
+    instance.get_header_metadata(extension, pool);
+    BOOST_REQUIRE(!extension[0].metadata.exists);
+    BOOST_REQUIRE(!extension[1].metadata.exists);
+    BOOST_REQUIRE(!extension[2].metadata.exists);
+
+    const chain::header::list overlap{ headers[1], headers[2], headers[3] };
+    instance.get_header_metadata(overlap, pool);
+    pool.shutdown();
+    pool.join();
+
+    BOOST_REQUIRE(overlap[0].metadata.exists);
+    BOOST_REQUIRE(overlap[0].metadata.candidate);
+    BOOST_REQUIRE(!overlap[0].metadata.populated);
+    BOOST_REQUIRE(overlap[1].metadata.exists);
+    BOOST_REQUIRE(overlap[1].metadata.candidate);
+    BOOST_REQUIRE(!overlap[2].metadata.exists);
+}
+
+BOOST_AUTO_TEST_CASE(block_database__find_unvalidated__candidate_states__scanned_popped_and_reloaded)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+
+    hash_list hashes;
+    auto header = settings.genesis_block.header();
+
+    {
+        block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, false, path(), true);
+        BOOST_REQUIRE(instance.create());
+
+        for (uint32_t height = 0; height < 20; ++height)
+        {
+            header.set_timestamp(height);
+            instance.store(header, height, height);
+            hashes.push_back(header.hash());
+        }
+
+        BOOST_REQUIRE(instance.promote(hashes, 0, true));
+
+        for (size_t height = 0; height < 20; ++height)
+            if (height != 3 && height != 17)
+                BOOST_REQUIRE(instance.validate(hashes[height], error::success));
+
+        size_t height;
+        BOOST_REQUIRE(instance.find_unvalidated(height, 0));
+        BOOST_REQUIRE_EQUAL(height, 3u);
+        BOOST_REQUIRE(instance.find_unvalidated(height, 4));
+        BOOST_REQUIRE_EQUAL(height, 17u);
+        BOOST_REQUIRE(!instance.find_unvalidated(height, 18));
+
+        std::vector<size_t> empty;
+        BOOST_REQUIRE(instance.get_empty(empty, 5, 10));
+        BOOST_REQUIRE_EQUAL(empty.size(), 10u);
+        BOOST_REQUIRE_EQUAL(empty.front(), 5u);
+        BOOST_REQUIRE_EQUAL(empty.back(), 14u);
+
+        BOOST_REQUIRE(instance.demote(16, true));
+        BOOST_REQUIRE(!instance.find_unvalidated(height, 4));
+        instance.commit();
+        BOOST_REQUIRE(instance.flush());
+        BOOST_REQUIRE(instance.close());
+    }
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50, false, 0, 0, 0, false, path(), true);
+    BOOST_REQUIRE(instance.open());
+
+    size_t height;
+    BOOST_REQUIRE(instance.find_unvalidated(height, 0));
+    BOOST_REQUIRE_EQUAL(height, 3u);
+    BOOST_REQUIRE(!instance.find_unvalidated(height, 4));
+
+    std::vector<size_t> empty;
+    BOOST_REQUIRE(instance.get_empty(empty, 15, 10));
+    BOOST_REQUIRE_EQUAL(empty.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(block_database__get_short_ids__updated_block__salted_ids_of_stored_hashes)
+{
+    static const auto settings = system::settings(system::config::settings::mainnet);
+    auto block0 = settings.genesis_block;
+    const auto coinbase = block0.transactions().front();
+    const transaction tx1{ 1, 0, { { { coinbase.hash(), 0 }, {}, 0 } }, { { 42, {} } } };
+    block0.set_transactions({ coinbase, tx1 });
+
+    const auto block_table = DIRECTORY "/block_table";
+    const auto candidate_index = DIRECTORY "/candidate_index";
+    const auto confirmed_index = DIRECTORY "/confirmed_index";
+    const auto tx_index = DIRECTORY "/tx_index";
+    const auto tx_table = DIRECTORY "/tx_table";
+
+    test::create(block_table);
+    test::create(candidate_index);
+    test::create(confirmed_index);
+    test::create(tx_index);
+    test::create(tx_table);
+
+    transaction_database transactions(tx_table, 1, 1000, 50, 0);
+    BOOST_REQUIRE(transactions.create());
+    BOOST_REQUIRE(transactions.store(block0.transactions()));
+
+    block_database instance(block_table, candidate_index, confirmed_index, tx_index, 1, 1, 1, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    instance.store(block0.header(), 0, 0);
+
+    block_database::short_id_list ids;
+    uint64_t nonce;
+    BOOST_REQUIRE(!instance.get_short_ids(ids, nonce, block0.hash(), transactions));
+
+    // setup end
+
+    BOOST_REQUIRE(instance.update(block0));
+    BOOST_REQUIRE(instance.get_short_ids(ids, nonce, block0.hash(), transactions));
+    BOOST_REQUIRE_NE(nonce, 0u);
+    BOOST_REQUIRE_EQUAL(nonce, instance.get(block0.hash()).checksum());
+    BOOST_REQUIRE_EQUAL(ids.size(), 1u);
+
+    auto data = block0.header().to_data();
+    extend_data(data, to_little_endian(nonce));
+    uint64_t k0;
+    uint64_t k1;
+    sip_hash_key(k0, k1, sha256_hash(data));
+    const auto expected = sip_hash(k0, k1, tx1.hash()) & 0xffffffffffff;
+    BOOST_REQUIRE_EQUAL(from_little_endian_unsafe<uint64_t>(data_chunk(ids.front().begin(), ids.front().end()).begin()) & 0xffffffffffff, expected);
+
+    // The salt is retained by a repeated update.
+    BOOST_REQUIRE(instance.update(block0));
+    BOOST_REQUIRE_EQUAL(instance.get(block0.hash()).checksum(), nonce);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace boost::system;
+using namespace boost::filesystem;
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+#define DIRECTORY "filter_database"
+#define GENESIS_FILTER_HEADER "21584579b7eb08997773e5aeff3a7f932700042d0ed2a6129012b7d7ae81b750"
+
+static BC_CONSTEXPR auto file_path = DIRECTORY "/filter_table";
+
+struct filter_database_directory_setup_fixture
+{
+    filter_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+
+    ~filter_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+static block testnet_genesis()
+{
+    return system::settings(system::config::settings::testnet).genesis_block;
+}
+
+static block child(const hash_digest& parent, uint64_t value)
+{
+    const transaction coinbase{ 1, 0, { { { null_hash, point::null_index }, {}, 0 } }, { { value, script{ { opcode::push_positive_1 } } } } };
+    return { { 1, parent, null_hash, 0, 0, 0 }, { coinbase } };
+}
+
+BOOST_FIXTURE_TEST_SUITE(filter_database_tests, filter_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(filter_database__store__genesis__expected_header_and_filter)
+{
+    test::create(file_path);
+    filter_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto genesis = testnet_genesis();
+    BOOST_REQUIRE(instance.store(genesis));
+
+    hash_digest header;
+    data_chunk filter;
+    BOOST_REQUIRE(instance.get(header, filter, genesis.hash()));
+    BOOST_REQUIRE_EQUAL(encode_hash(header), GENESIS_FILTER_HEADER);
+    BOOST_REQUIRE(filter == compact_filter::encode(genesis.hash(), compact_filter::elements(genesis)));
+}
+
+BOOST_AUTO_TEST_CASE(filter_database__store__child__chained_header)
+{
+    test::create(file_path);
+    filter_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto genesis = testnet_genesis();
+    const auto block1 = child(genesis.hash(), 42);
+    BOOST_REQUIRE(instance.store(genesis));
+    BOOST_REQUIRE(instance.store(block1));
+
+    hash_digest previous;
+    hash_digest header;
+    data_chunk filter;
+    BOOST_REQUIRE(instance.get_header(previous, genesis.hash()));
+    BOOST_REQUIRE(instance.get(header, filter, block1.hash()));
+    BOOST_REQUIRE(header == compact_filter::header(filter, previous));
+    BOOST_REQUIRE(compact_filter::match(filter, block1.hash(), block1.transactions().front().outputs().front().script().to_data(false)));
+}
+
+BOOST_AUTO_TEST_CASE(filter_database__store__orphan__false)
+{
+    test::create(file_path);
+    filter_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const auto orphan = child(testnet_genesis().hash(), 42);
+    BOOST_REQUIRE(!instance.store(orphan));
+
+    hash_digest header;
+    BOOST_REQUIRE(!instance.get_header(header, orphan.hash()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
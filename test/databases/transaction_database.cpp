@@ -18,6 +18,8 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <thread>
 #include <boost/filesystem.hpp>
 #include <bitcoin/database.hpp>
 #include "../utility/utility.hpp"
@@ -34,6 +36,10 @@ using namespace bc::system::chain;
 #define TRANSACTION2 "010000000147811c3fc0c0e750af5d0ea7343b16ea2d0c291c002e3db778669216eb689de80000000000ffffffff0118ddf505000000001976a914575c2f0ea88fcbad2389a372d942dea95addc25b88ac00000000"
 
 static BC_CONSTEXPR auto file_path = DIRECTORY "/tx_table";
+static BC_CONSTEXPR auto spends_path = DIRECTORY "/tx_spends";
+static BC_CONSTEXPR auto witnesses_path = DIRECTORY "/tx_witnesses";
+static BC_CONSTEXPR auto undo_path = DIRECTORY "/tx_undo";
+static BC_CONSTEXPR auto undo_index_path = DIRECTORY "/tx_undo_index";
 
 struct transaction_database_directory_setup_fixture
 {
@@ -130,6 +136,45 @@ BOOST_AUTO_TEST_CASE(transaction_database__store2__list_of_transactions__success
     BOOST_REQUIRE(result3.transaction().hash() == hash2);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__store3__list_with_existing_and_repeated__success)
+{
+    transaction tx1;
+    data_chunk wire_tx1;
+    BOOST_REQUIRE(decode_base16(wire_tx1, TRANSACTION1));
+    BOOST_REQUIRE(tx1.from_data(wire_tx1));
+
+    transaction tx2;
+    data_chunk wire_tx2;
+    BOOST_REQUIRE(decode_base16(wire_tx2, TRANSACTION2));
+    BOOST_REQUIRE(tx2.from_data(wire_tx2));
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store(tx1, 0));
+    const auto link1 = instance.get(tx1.hash()).link();
+
+    // Setup end
+
+    threadpool pool(2);
+    const transaction::list transactions{ tx1, tx2, tx2 };
+    BOOST_REQUIRE(instance.store(transactions, pool));
+    pool.shutdown();
+    pool.join();
+
+    BOOST_REQUIRE(transactions[0].metadata.existed);
+    BOOST_REQUIRE_EQUAL(transactions[0].metadata.link, link1);
+    BOOST_REQUIRE(!transactions[1].metadata.existed);
+    BOOST_REQUIRE(transactions[2].metadata.existed);
+    BOOST_REQUIRE_EQUAL(transactions[2].metadata.link, transactions[1].metadata.link);
+
+    const auto result2 = instance.get(tx2.hash());
+    BOOST_REQUIRE(result2);
+    BOOST_REQUIRE_EQUAL(result2.link(), transactions[1].metadata.link);
+    BOOST_REQUIRE(result2.transaction().hash() == tx2.hash());
+    BOOST_REQUIRE(instance.get(link1).transaction().hash() == tx1.hash());
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database__store1__single_unconfirmed__success)
 {
     transaction tx1;
@@ -643,9 +688,535 @@ BOOST_AUTO_TEST_CASE(transaction_database_with_cache__confirm1__block_transactio
    BOOST_REQUIRE(tx1_reloaded2.is_candidate_spent(123));
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database_with_cache__confirm1__in_block_spend__spent_not_cached)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 100);
+    BOOST_REQUIRE(instance.create());
+
+    transaction tx1{ locktime, version, {}, { { 1203, {} } } };
+    transaction tx2{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    transaction tx3{ locktime, version, { { { tx2.hash(), 0 }, {}, 0 } }, { { 1100, {} } } };
+    instance.store({ tx1, tx2, tx3 });
+    tx1.metadata.link = instance.get(tx1.hash()).link();
+    tx2.metadata.link = instance.get(tx2.hash()).link();
+    tx3.metadata.link = instance.get(tx3.hash()).link();
+
+    const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block1 = settings.genesis_block;
+    block1.set_transactions({ tx1, tx2, tx3 });
+
+    // setup end
+
+    BOOST_REQUIRE(instance.confirm(block1, 123, 456));
+
+    output_point point0{ tx2.hash(), 0 };
+    output_point point1{ tx2.hash(), 1 };
+    BOOST_REQUIRE(instance.get_output(point0, 123));
+    BOOST_REQUIRE(instance.get_output(point1, 123));
+    BOOST_REQUIRE(point0.metadata.confirmed_spent);
+    BOOST_REQUIRE(!point1.metadata.confirmed_spent);
+    BOOST_REQUIRE(point1.metadata.confirmed);
+}
+
 // Unconfirm
 // ----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(transaction_database__confirm3__links_with_inputs_in_db__spent)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    const transaction tx2{ locktime, version, {}, { { 1203, {} } } };
+    const transaction tx3{ locktime, version, { { { tx1.hash(), 1 }, {}, 0 }, { { tx1.hash(), 0 }, {}, 0 } }, { { 1100, {} } } };
+
+    instance.store({ tx1, tx2, tx3 });
+    const auto link1 = instance.get(tx1.hash()).link();
+    const auto link2 = instance.get(tx2.hash()).link();
+    const auto link3 = instance.get(tx3.hash()).link();
+    BOOST_REQUIRE(instance.confirm(link_list{ link1 }, 123, 456));
+
+    // setup end
+
+    BOOST_REQUIRE(instance.confirm(link_list{ link2, link3 }, 1230, 4560));
+
+    const auto result3 = instance.get(tx3.hash());
+    BOOST_REQUIRE_EQUAL(result3.height(), 1230u);
+    BOOST_REQUIRE_EQUAL(result3.position(), 1u);
+
+    output_point point0{ tx1.hash(), 0 };
+    output_point point1{ tx1.hash(), 1 };
+    BOOST_REQUIRE(instance.get_output(point0, 1230));
+    BOOST_REQUIRE(instance.get_output(point1, 1230));
+    BOOST_REQUIRE(point0.metadata.confirmed_spent);
+    BOOST_REQUIRE(point1.metadata.confirmed_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__undo__confirm3_then_unconfirm__prevouts_unspent)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    test::create(undo_path);
+    test::create(undo_index_path);
+    transaction_database::options features;
+    features.undo_filename = undo_path;
+    features.undo_index_filename = undo_index_path;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    transaction tx2{ locktime, version, {}, { { 1203, {} } } };
+    transaction tx3{ locktime, version, { { { tx1.hash(), 1 }, {}, 0 }, { { tx1.hash(), 0 }, {}, 0 } }, { { 1100, {} } } };
+
+    instance.store({ tx1, tx2, tx3 });
+    tx1.metadata.link = instance.get(tx1.hash()).link();
+    tx2.metadata.link = instance.get(tx2.hash()).link();
+    tx3.metadata.link = instance.get(tx3.hash()).link();
+    BOOST_REQUIRE(instance.confirm(link_list{ tx1.metadata.link }, 0, 456));
+    BOOST_REQUIRE(instance.confirm(link_list{ tx2.metadata.link, tx3.metadata.link }, 1, 4560));
+
+    const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block1 = settings.genesis_block;
+    block1.set_transactions({ tx2, tx3 });
+
+    // setup end
+
+    BOOST_REQUIRE(instance.unconfirm(block1, 1));
+
+    const auto result3 = instance.get(tx3.hash());
+    BOOST_REQUIRE_EQUAL(result3.height(), machine::rule_fork::unverified);
+    BOOST_REQUIRE_EQUAL(result3.position(), transaction_result::unconfirmed);
+
+    output_point point0{ tx1.hash(), 0 };
+    output_point point1{ tx1.hash(), 1 };
+    BOOST_REQUIRE(instance.get_output(point0, 1));
+    BOOST_REQUIRE(instance.get_output(point1, 1));
+    BOOST_REQUIRE(!point0.metadata.confirmed_spent);
+    BOOST_REQUIRE(!point1.metadata.confirmed_spent);
+
+    // The block reconfirms with a new record at the height.
+    BOOST_REQUIRE(instance.confirm(link_list{ tx2.metadata.link, tx3.metadata.link }, 1, 4560));
+    BOOST_REQUIRE(instance.get_output(point0, 1));
+    BOOST_REQUIRE(point0.metadata.confirmed_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__confirm3__unconfirmed_prevout__failure)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} } } };
+    const transaction tx2{ locktime, version, {}, { { 1203, {} } } };
+    const transaction tx3{ locktime, version, { { { tx1.hash(), 0 }, {}, 0 } }, { { 1100, {} } } };
+
+    instance.store({ tx1, tx2, tx3 });
+    const auto link2 = instance.get(tx2.hash()).link();
+    const auto link3 = instance.get(tx3.hash()).link();
+
+    // setup end
+
+    BOOST_REQUIRE(!instance.confirm(link_list{ link2, link3 }, 1230, 4560));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__confirm3__in_block_spend_chain__spent)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1203, {} } } };
+    const transaction tx2{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    const transaction tx3{ locktime, version, { { { tx2.hash(), 1 }, {}, 0 } }, { { 1100, {} } } };
+    const transaction tx4{ locktime, version, { { { tx3.hash(), 0 }, {}, 0 }, { { tx2.hash(), 0 }, {}, 0 } }, { { 1000, {} } } };
+
+    instance.store({ tx1, tx2, tx3, tx4 });
+    const auto link1 = instance.get(tx1.hash()).link();
+    const auto link2 = instance.get(tx2.hash()).link();
+    const auto link3 = instance.get(tx3.hash()).link();
+    const auto link4 = instance.get(tx4.hash()).link();
+
+    // setup end
+
+    BOOST_REQUIRE(instance.confirm(link_list{ link1, link2, link3, link4 }, 1230, 4560));
+
+    const auto result4 = instance.get(tx4.hash());
+    BOOST_REQUIRE_EQUAL(result4.height(), 1230u);
+    BOOST_REQUIRE_EQUAL(result4.position(), 3u);
+
+    output_point point20{ tx2.hash(), 0 };
+    output_point point21{ tx2.hash(), 1 };
+    output_point point30{ tx3.hash(), 0 };
+    BOOST_REQUIRE(instance.get_output(point20, 1230));
+    BOOST_REQUIRE(instance.get_output(point21, 1230));
+    BOOST_REQUIRE(instance.get_output(point30, 1230));
+    BOOST_REQUIRE(point20.metadata.confirmed_spent);
+    BOOST_REQUIRE(point21.metadata.confirmed_spent);
+    BOOST_REQUIRE(point30.metadata.confirmed_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__confirm3__in_block_spend_of_following_tx__failure)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1203, {} } } };
+    const transaction tx2{ locktime, version, {}, { { 1201, {} } } };
+    const transaction tx3{ locktime, version, { { { tx2.hash(), 0 }, {}, 0 } }, { { 1100, {} } } };
+
+    instance.store({ tx1, tx2, tx3 });
+    const auto link1 = instance.get(tx1.hash()).link();
+    const auto link2 = instance.get(tx2.hash()).link();
+    const auto link3 = instance.get(tx3.hash()).link();
+
+    // setup end
+
+    BOOST_REQUIRE(!instance.confirm(link_list{ link1, link3, link2 }, 1230, 4560));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__output_offsets__tabled_transactions__direct_output_access)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database::options features;
+    features.offsets_minimum = 2;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, { 0x51 } }, { 1203, {} } } };
+    const transaction tx2{ locktime, version, { { { tx1.hash(), 2 }, {}, 0 }, { { tx1.hash(), 1 }, {}, 0 } }, { { 1100, {} } } };
+
+    instance.store({ tx1, tx2 });
+    BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx1.hash()).link() }, 123, 456));
+
+    // setup end
+
+    BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx2.hash()).link() }, 124, 457));
+
+    const auto result1 = instance.get(tx1.hash());
+    BOOST_REQUIRE(result1.transaction().hash() == tx1.hash());
+    BOOST_REQUIRE_EQUAL(result1.output(1).value(), 1202u);
+    BOOST_REQUIRE_EQUAL(result1.output(2).value(), 1203u);
+    BOOST_REQUIRE(!result1.output(3).is_valid());
+
+    const auto result2 = instance.get(tx2.hash());
+    BOOST_REQUIRE(result2.transaction().hash() == tx2.hash());
+
+    output_point point0{ tx1.hash(), 0 };
+    output_point point1{ tx1.hash(), 1 };
+    output_point point2{ tx1.hash(), 2 };
+    BOOST_REQUIRE(instance.get_output(point0, 124));
+    BOOST_REQUIRE(instance.get_output(point1, 124));
+    BOOST_REQUIRE(instance.get_output(point2, 124));
+    BOOST_REQUIRE(!point0.metadata.confirmed_spent);
+    BOOST_REQUIRE(point1.metadata.confirmed_spent);
+    BOOST_REQUIRE(point2.metadata.confirmed_spent);
+    BOOST_REQUIRE_EQUAL(point2.metadata.cache.value(), 1203u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__spend_column__confirm_and_candidate__spends_in_column)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    test::create(spends_path);
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+    const transaction tx2{ locktime, version, {}, { { 1203, {} } } };
+    const transaction tx3{ locktime, version, { { { tx1.hash(), 1 }, {}, 0 } }, { { 1100, {} } } };
+    const transaction tx4{ locktime, version, { { { tx2.hash(), 0 }, {}, 0 } }, { { 1101, {} } } };
+
+    {
+        transaction_database::options features;
+        features.spends_filename = spends_path;
+        transaction_database instance(file_path, 1, 1000, 50, 0, features);
+        BOOST_REQUIRE(instance.create());
+
+        instance.store({ tx1, tx2, tx3, tx4 });
+        BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx1.hash()).link(), instance.get(tx2.hash()).link() }, 123, 456));
+
+        // setup end
+
+        BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx2.hash()).link(), instance.get(tx3.hash()).link() }, 124, 457));
+        BOOST_REQUIRE(instance.candidate(instance.get(tx4.hash()).link()));
+
+        const auto outputs = instance.get(tx1.hash()).transaction().outputs();
+        BOOST_REQUIRE_EQUAL(outputs.size(), 2u);
+        BOOST_REQUIRE_EQUAL(outputs[1].metadata.confirmed_spent_height, 124u);
+        BOOST_REQUIRE(outputs[0].metadata.confirmed_spent_height != 124u);
+        BOOST_REQUIRE(instance.get(tx2.hash()).output(0).metadata.candidate_spent);
+
+        instance.commit();
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // The spend state persists in the column.
+    transaction_database::options features;
+    features.spends_filename = spends_path;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.open());
+
+    output_point point1{ tx1.hash(), 1 };
+    BOOST_REQUIRE(instance.get_output(point1, 124));
+    BOOST_REQUIRE(point1.metadata.confirmed_spent);
+    BOOST_REQUIRE(instance.get(tx2.hash()).output(0).metadata.candidate_spent);
+    BOOST_REQUIRE(!instance.get(tx1.hash()).output(0).metadata.candidate_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__compressed_scripts__store_and_spend__round_trip)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database::options features;
+    features.compress_scripts = true;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const short_hash hash{ { 0x01, 0x02, 0x03 } };
+    const script pay_key_hash{ script::to_pay_key_hash_pattern(hash) };
+    const script pay_script_hash{ script::to_pay_script_hash_pattern(hash) };
+    const script nonstandard{ { { opcode::push_positive_1 } } };
+
+    const transaction tx1{ locktime, version, {}, { { 1201, pay_key_hash }, { 1202, nonstandard }, { 1203, pay_script_hash } } };
+    const transaction tx2{ locktime, version, { { { tx1.hash(), 2 }, {}, 0 } }, { { 1100, pay_key_hash } } };
+
+    instance.store({ tx1, tx2 });
+    BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx1.hash()).link() }, 123, 456));
+
+    // setup end
+
+    BOOST_REQUIRE(instance.confirm(link_list{ instance.get(tx2.hash()).link() }, 124, 457));
+
+    const auto result1 = instance.get(tx1.hash());
+    const auto stored1 = result1.transaction();
+    BOOST_REQUIRE(stored1.hash() == tx1.hash());
+    BOOST_REQUIRE(stored1.outputs()[0].script() == pay_key_hash);
+    BOOST_REQUIRE(stored1.outputs()[1].script() == nonstandard);
+    BOOST_REQUIRE(stored1.outputs()[2].script() == pay_script_hash);
+    BOOST_REQUIRE_EQUAL(stored1.outputs()[2].metadata.confirmed_spent_height, 124u);
+    BOOST_REQUIRE(result1.output(2).script() == pay_script_hash);
+
+    const auto result2 = instance.get(tx2.hash());
+    BOOST_REQUIRE(result2.transaction().hash() == tx2.hash());
+    BOOST_REQUIRE(result2.transaction().inputs()[0].previous_output() == output_point(tx1.hash(), 2));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__segregated_witnesses__store__witness_read_on_request)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    test::create(witnesses_path);
+    transaction_database::options features;
+    features.witnesses_filename = witnesses_path;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1201, {} }, { 1202, {} } } };
+
+    chain::input::list inputs
+    {
+        { { tx1.hash(), 0 }, {}, 0 },
+        { { tx1.hash(), 1 }, {}, 0 }
+    };
+
+    const witness witness1{ data_stack{ { 0x01, 0x02 }, { 0x03 } } };
+    const witness witness2{ data_stack{ { 0x04, 0x05, 0x06 } } };
+    inputs[0].set_witness(witness1);
+    inputs[1].set_witness(witness2);
+    const transaction tx2{ version, locktime, inputs, { { 1100, {} } } };
+    BOOST_REQUIRE(tx2.is_segregated());
+
+    instance.store({ tx1, tx2 });
+
+    // setup end
+
+    const auto result = instance.get(tx2.hash());
+    const auto with_witness = result.transaction(true);
+    BOOST_REQUIRE(with_witness.hash() == tx2.hash());
+    BOOST_REQUIRE(with_witness.inputs()[0].witness() == witness1);
+    BOOST_REQUIRE(with_witness.inputs()[1].witness() == witness2);
+
+    const auto without_witness = result.transaction(false);
+    BOOST_REQUIRE(without_witness.hash() == tx2.hash());
+    BOOST_REQUIRE(!without_witness.is_segregated());
+
+    auto inpoint = result.begin();
+    BOOST_REQUIRE(*inpoint == output_point(tx1.hash(), 0));
+    BOOST_REQUIRE(*(++inpoint) == output_point(tx1.hash(), 1));
+    BOOST_REQUIRE(++inpoint == result.end());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__view__stored__read_in_place)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const short_hash hash{ { 0x01, 0x02, 0x03 } };
+    const script pay_key_hash{ script::to_pay_key_hash_pattern(hash) };
+    const script nonstandard{ { { opcode::push_positive_1 } } };
+    const transaction tx1{ locktime, version, { { { null_hash, 7 }, {}, 0 } }, { { 1201, pay_key_hash }, { 1202, nonstandard } } };
+    instance.store({ tx1 });
+
+    // setup end
+
+    const auto result = instance.get(tx1.hash());
+    const auto view = result.view();
+    BOOST_REQUIRE_EQUAL(view.outputs(), 2u);
+    BOOST_REQUIRE_EQUAL(view.data().size(), tx1.serialized_size(false));
+    BOOST_REQUIRE_EQUAL(view.output(1).value(), 1202u);
+    BOOST_REQUIRE(view.output(1).script() == nonstandard);
+    BOOST_REQUIRE(view.output(0).script_hash() == sha256_hash(pay_key_hash.to_data(false)));
+    BOOST_REQUIRE(!view.output(2));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__view__compressed__read_in_place)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database::options features;
+    features.compress_scripts = true;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const short_hash hash{ { 0x01, 0x02, 0x03 } };
+    const script pay_key_hash{ script::to_pay_key_hash_pattern(hash) };
+    const script nonstandard{ { { opcode::push_positive_1 } } };
+    const transaction tx1{ locktime, version, {}, { { 1201, pay_key_hash }, { 1202, nonstandard } } };
+    instance.store({ tx1 });
+
+    // setup end
+
+    const auto result = instance.get(tx1.hash());
+    const auto view = result.view();
+    BOOST_REQUIRE_EQUAL(view.outputs(), 2u);
+    BOOST_REQUIRE(view.output(0).compressed());
+    BOOST_REQUIRE_EQUAL(view.output(0).value(), 1201u);
+    BOOST_REQUIRE(view.output(0).script() == pay_key_hash);
+    BOOST_REQUIRE(view.output(0).script_hash() == sha256_hash(pay_key_hash.to_data(false)));
+    BOOST_REQUIRE(view.output(1).script() == nonstandard);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__to_data__compressed_segregated__wire_serialization)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    test::create(witnesses_path);
+    transaction_database::options features;
+    features.compress_scripts = true;
+    features.witnesses_filename = witnesses_path;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const short_hash hash{ { 0x01, 0x02, 0x03 } };
+    const script pay_key_hash{ script::to_pay_key_hash_pattern(hash) };
+    const transaction tx1{ locktime, version, {}, { { 1201, pay_key_hash }, { 1202, {} } } };
+
+    chain::input::list inputs
+    {
+        { { tx1.hash(), 0 }, {}, 0 },
+        { { tx1.hash(), 1 }, {}, 0 }
+    };
+
+    inputs[0].set_witness(witness{ data_stack{ { 0x01, 0x02 }, { 0x03 } } });
+    const transaction tx2{ version, locktime, inputs, { { 1100, pay_key_hash } } };
+    instance.store({ tx1, tx2 });
+
+    // setup end
+
+    const auto result1 = instance.get(tx1.hash());
+    data_chunk data1(result1.serialized_size());
+    BOOST_REQUIRE(result1.to_data(data1.data()));
+    BOOST_REQUIRE(data1 == tx1.to_data(true, true));
+
+    const auto result2 = instance.get(tx2.hash());
+    data_chunk data2(result2.serialized_size());
+    BOOST_REQUIRE(result2.to_data(data2.data()));
+    BOOST_REQUIRE(data2 == tx2.to_data(true, true));
+
+    data_chunk stripped(result2.serialized_size(false));
+    BOOST_REQUIRE(result2.to_data(stripped.data(), false));
+    BOOST_REQUIRE(stripped == tx2.to_data(true, false));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__prune__spent_output__script_discarded)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database::options features;
+    features.prune_scripts = true;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const short_hash hash{ { 0x01, 0x02, 0x03 } };
+    const script pay_key_hash{ script::to_pay_key_hash_pattern(hash) };
+    const script nonstandard{ { { opcode::push_positive_1 } } };
+
+    const transaction tx1{ locktime, version, {}, { { 1201, pay_key_hash }, { 1202, pay_key_hash }, { 1203, nonstandard } } };
+    const transaction tx2{ locktime, version, { { { tx1.hash(), 1 }, {}, 0 } }, { { 1100, pay_key_hash } } };
+
+    instance.store({ tx1, tx2 });
+    const link_list links{ instance.get(tx1.hash()).link(), instance.get(tx2.hash()).link() };
+    BOOST_REQUIRE(instance.confirm(links, 123, 456));
+
+    // setup end
+
+    BOOST_REQUIRE(instance.prune(links));
+
+    const auto result = instance.get(tx1.hash());
+    const auto pruned = result.output(1);
+    BOOST_REQUIRE(pruned.script().empty());
+    BOOST_REQUIRE_EQUAL(pruned.value(), 1202u);
+    BOOST_REQUIRE_EQUAL(pruned.metadata.confirmed_spent_height, 123u);
+    BOOST_REQUIRE(result.output(0).script() == pay_key_hash);
+    BOOST_REQUIRE(result.output(2).script() == nonstandard);
+
+    const auto stored = result.transaction();
+    BOOST_REQUIRE(stored.outputs()[0].script() == pay_key_hash);
+    BOOST_REQUIRE(stored.outputs()[1].script().empty());
+    BOOST_REQUIRE(stored.outputs()[2].script() == nonstandard);
+
+    // A pruned output is skipped.
+    BOOST_REQUIRE(instance.prune(links));
+    BOOST_REQUIRE(instance.get(tx1.hash()).output(2).script() == nonstandard);
+}
+
 BOOST_AUTO_TEST_CASE(transaction_database__unconfirm__block_with_unconfirmed_txs__success)
 {
    uint32_t version = 2345u;
@@ -1241,4 +1812,152 @@ BOOST_AUTO_TEST_CASE(transaction_database__get_output__prevout_spent__spent)
     BOOST_REQUIRE(point.metadata.confirmed_spent);
 }
 
+BOOST_AUTO_TEST_CASE(transaction_database__get_outputs__block__populated)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1200, {} }, { 1201, {} } } };
+    instance.store(tx1, 100);
+
+    const transaction tx2{ locktime, version, { { { tx1.hash(), 0 }, {}, 0 }, { { tx1.hash(), 1 }, {}, 0 }, { { tx1.hash(), 2 }, {}, 0 } }, {} };
+    const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block1 = settings.genesis_block;
+    block1.set_transactions({ tx2 });
+
+    threadpool pool(2);
+    instance.get_outputs(block1, 101, pool);
+    pool.shutdown();
+    pool.join();
+
+    const auto& inputs = block1.transactions().front().inputs();
+    const auto& prevout0 = inputs[0].previous_output().metadata;
+    const auto& prevout1 = inputs[1].previous_output().metadata;
+    const auto& prevout2 = inputs[2].previous_output().metadata;
+    BOOST_REQUIRE(prevout0.cache.is_valid());
+    BOOST_REQUIRE_EQUAL(prevout0.cache.value(), 1200u);
+    BOOST_REQUIRE_EQUAL(prevout0.height, 100u);
+    BOOST_REQUIRE(prevout1.cache.is_valid());
+    BOOST_REQUIRE_EQUAL(prevout1.cache.value(), 1201u);
+    BOOST_REQUIRE(!prevout2.cache.is_valid());
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database__get_output__missed_then_stored__found)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database::options features;
+    features.misses = 16;
+    transaction_database instance(file_path, 1, 1000, 50, 0, features);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1200, {} } } };
+    const output_point point{ tx1.hash(), 0 };
+    BOOST_REQUIRE(!instance.get_output(point, max_size_t));
+    BOOST_REQUIRE(!instance.get_output(point, max_size_t));
+
+    // Storing the parent invalidates the recorded miss.
+    BOOST_REQUIRE(instance.store(tx1, 100));
+    BOOST_REQUIRE(instance.get_output(point, max_size_t));
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 1200u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database_with_cache__prefetch__spent_prevout__not_cached)
+{
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 42);
+    BOOST_REQUIRE(instance.create());
+
+    const transaction tx1{ locktime, version, {}, { { 1200, {} }, { 1201, {} } } };
+    const transaction tx2{ locktime, version, { { { tx1.hash(), 1 }, {}, 0 } }, { { 1100, {} } } };
+    instance.store({ tx1, tx2 });
+    const auto link1 = instance.get(tx1.hash()).link();
+    const auto link2 = instance.get(tx2.hash()).link();
+    BOOST_REQUIRE(instance.confirm(link_list{ link1 }, 123, 456));
+    BOOST_REQUIRE(instance.confirm(link_list{ link2 }, 124, 457));
+
+    const transaction tx3{ locktime, version, { { { tx1.hash(), 0 }, {}, 0 }, { { tx1.hash(), 1 }, {}, 0 } }, {} };
+    const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block1 = settings.genesis_block;
+    block1.set_transactions({ tx3 });
+    instance.prefetch(block1);
+
+    output_point point0{ tx1.hash(), 0 };
+    output_point point1{ tx1.hash(), 1 };
+    BOOST_REQUIRE(instance.get_output(point0, 125));
+    BOOST_REQUIRE(instance.get_output(point1, 125));
+    BOOST_REQUIRE(point0.metadata.confirmed);
+    BOOST_REQUIRE(!point0.metadata.confirmed_spent);
+    BOOST_REQUIRE_EQUAL(point0.metadata.height, 123u);
+    BOOST_REQUIRE_EQUAL(point0.metadata.cache.value(), 1200u);
+    BOOST_REQUIRE(point1.metadata.confirmed_spent);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_database_with_cache__prefetch__concurrent_confirm__spent_not_cached)
+{
+    static const uint32_t count = 64;
+    uint32_t version = 2345u;
+    uint32_t locktime = 0xffffffff;
+
+    test::create(file_path);
+    transaction_database instance(file_path, 1, 1000, 50, 1000);
+    BOOST_REQUIRE(instance.create());
+
+    transaction::list funding;
+    chain::input::list inputs;
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        funding.push_back({ locktime, version, {}, { { 1000u + index, {} } } });
+        inputs.push_back({ { funding.back().hash(), 0 }, {}, 0 });
+    }
+
+    instance.store(funding);
+    link_list links;
+
+    for (const auto& tx: funding)
+        links.push_back(instance.get(tx.hash()).link());
+
+    BOOST_REQUIRE(instance.confirm(links, 123, 456));
+
+    transaction coinbase{ locktime, version, {}, { { 999, {} } } };
+    transaction spender{ locktime, version, inputs, { { 100, {} } } };
+    instance.store({ coinbase, spender });
+    coinbase.metadata.link = instance.get(coinbase.hash()).link();
+    spender.metadata.link = instance.get(spender.hash()).link();
+
+    const auto settings = system::settings(system::config::settings::mainnet);
+    chain::block block1 = settings.genesis_block;
+    block1.set_transactions({ coinbase, spender });
+
+    // setup end
+
+    std::atomic<bool> confirmed(false);
+    std::thread prefetcher([&]()
+    {
+        while (!confirmed)
+            instance.prefetch(block1);
+    });
+
+    BOOST_REQUIRE(instance.confirm(block1, 124, 457));
+    confirmed = true;
+    prefetcher.join();
+
+    for (const auto& tx: funding)
+    {
+        output_point point{ tx.hash(), 0 };
+        BOOST_REQUIRE(instance.get_output(point, 124));
+        BOOST_REQUIRE(point.metadata.confirmed_spent);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
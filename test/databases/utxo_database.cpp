@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace boost::system;
+using namespace boost::filesystem;
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+#define DIRECTORY "utxo_database"
+#define TRANSACTION1 "0100000001537c9d05b5f7d67b09e5108e3bd5e466909cc9403ddd98bc42973f366fe729410600000000ffffffff0163000000000000001976a914fe06e7b4c88a719e92373de489c08244aee4520b88ac00000000"
+
+static BC_CONSTEXPR auto file_path = DIRECTORY "/utxo_table";
+static BC_CONSTEXPR auto tx_path = DIRECTORY "/tx_table";
+static BC_CONSTEXPR auto copy_path = DIRECTORY "/utxo_copy";
+static BC_CONSTEXPR auto snapshot_path = DIRECTORY "/utxo_snapshot";
+
+struct utxo_database_directory_setup_fixture
+{
+    utxo_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+
+    ~utxo_database_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+static transaction coinbase(uint64_t value)
+{
+    return { 1, 0, { { { null_hash, point::null_index }, {}, 0 } },
+        { { value, {} } } };
+}
+
+BOOST_FIXTURE_TEST_SUITE(utxo_database_tests, utxo_database_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(utxo_database__populate__stored__expected_metadata)
+{
+    transaction tx;
+    data_chunk wire_tx;
+    BOOST_REQUIRE(decode_base16(wire_tx, TRANSACTION1));
+    BOOST_REQUIRE(tx.from_data(wire_tx));
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    const output_point point{ tx.hash(), 0 };
+    BOOST_REQUIRE(instance.store(point, tx.outputs()[0], 42, 24, true));
+
+    const output_point found{ tx.hash(), 0 };
+    BOOST_REQUIRE(instance.populate(found, 42));
+    BOOST_REQUIRE(found.metadata.confirmed);
+    BOOST_REQUIRE(!found.metadata.confirmed_spent);
+    BOOST_REQUIRE(found.metadata.coinbase);
+    BOOST_REQUIRE_EQUAL(found.metadata.height, 42u);
+    BOOST_REQUIRE_EQUAL(found.metadata.median_time_past, 24u);
+    BOOST_REQUIRE(found.metadata.cache == tx.outputs()[0]);
+
+    // An output above the fork point is left to the transaction table.
+    BOOST_REQUIRE(!instance.populate({ tx.hash(), 0 }, 41));
+    BOOST_REQUIRE(!instance.populate({ tx.hash(), 1 }, 42));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__remove__stored__not_found)
+{
+    static const auto tx = coinbase(50);
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+
+    BOOST_REQUIRE(instance.store({ tx.hash(), 0 }, tx.outputs()[0], 1, 0, true));
+    BOOST_REQUIRE(instance.remove({ tx.hash(), 0 }));
+    BOOST_REQUIRE(!instance.populate({ tx.hash(), 0 }));
+    BOOST_REQUIRE(!instance.remove({ tx.hash(), 0 }));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__confirm__spending_block__prevout_removed_outputs_added)
+{
+    static const auto tx1 = coinbase(50);
+    static const transaction tx2{ 1, 0, { { { tx1.hash(), 0 }, {}, 0 } },
+        { { 40, {} }, { 10, {} } } };
+    const block block{ {}, { coinbase(51), tx2 } };
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store({ tx1.hash(), 0 }, tx1.outputs()[0], 1, 0, true));
+
+    BOOST_REQUIRE(instance.confirm(block, 2, 42));
+    BOOST_REQUIRE(!instance.populate({ tx1.hash(), 0 }));
+    BOOST_REQUIRE(instance.populate({ block.transactions()[0].hash(), 0 }));
+
+    const output_point point{ tx2.hash(), 1 };
+    BOOST_REQUIRE(instance.populate(point));
+    BOOST_REQUIRE(!point.metadata.coinbase);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 2u);
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__unconfirm__confirmed_block__prevout_restored_outputs_removed)
+{
+    static const auto tx1 = coinbase(50);
+    static const transaction tx2{ 1, 0, { { { tx1.hash(), 0 }, {}, 0 } },
+        { { 40, {} } } };
+    const block block{ {}, { coinbase(51), tx2 } };
+
+    test::create(tx_path);
+    transaction_database transactions(tx_path, 1, 1000, 50, 0);
+    BOOST_REQUIRE(transactions.create());
+    BOOST_REQUIRE(transactions.store(tx1, 1));
+    BOOST_REQUIRE(transactions.confirm(transactions.get(tx1.hash()).link(), 1,
+        24, 0));
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store({ tx1.hash(), 0 }, tx1.outputs()[0], 1, 24, true));
+    BOOST_REQUIRE(instance.confirm(block, 2, 42));
+
+    BOOST_REQUIRE(instance.unconfirm(block, transactions));
+    BOOST_REQUIRE(!instance.populate({ tx2.hash(), 0 }));
+    BOOST_REQUIRE(!instance.populate({ block.transactions()[0].hash(), 0 }));
+
+    const output_point point{ tx1.hash(), 0 };
+    BOOST_REQUIRE(instance.populate(point));
+    BOOST_REQUIRE(point.metadata.coinbase);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 1u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 24u);
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 50u);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__import_snapshot__exported__round_trips)
+{
+    static const auto tx1 = coinbase(50);
+    static const auto tx2 = coinbase(51);
+    static const hash_digest block_hash{ { 42 } };
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store({ tx1.hash(), 0 }, tx1.outputs()[0], 1, 10, true));
+    BOOST_REQUIRE(instance.store({ tx2.hash(), 0 }, tx2.outputs()[0], 2, 20, false));
+
+    hash_digest digest;
+    BOOST_REQUIRE(instance.export_snapshot(snapshot_path, 2, block_hash,
+        digest));
+
+    test::create(copy_path);
+    utxo_database copy(copy_path, 1, 1000, 50);
+    BOOST_REQUIRE(copy.create());
+
+    size_t height;
+    hash_digest hash;
+    hash_digest imported;
+    BOOST_REQUIRE(copy.import_snapshot(snapshot_path, height, hash,
+        imported));
+    BOOST_REQUIRE_EQUAL(height, 2u);
+    BOOST_REQUIRE(hash == block_hash);
+    BOOST_REQUIRE(imported == digest);
+
+    const output_point point{ tx2.hash(), 0 };
+    BOOST_REQUIRE(copy.populate(point));
+    BOOST_REQUIRE(!point.metadata.coinbase);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 2u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 20u);
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 51u);
+    BOOST_REQUIRE(copy.populate({ tx1.hash(), 0 }));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__import_snapshot__corrupted__false_unchanged)
+{
+    static const auto tx1 = coinbase(50);
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.store({ tx1.hash(), 0 }, tx1.outputs()[0], 1, 10, true));
+
+    hash_digest digest;
+    BOOST_REQUIRE(instance.export_snapshot(snapshot_path, 1, null_hash,
+        digest));
+
+    // Change the output value, after the header, chunk size and entry point
+    // [hash:32][index:4] and metadata [height:4][mtp:4][coinbase:1].
+    {
+        std::fstream file(snapshot_path, std::ios::binary | std::ios::in |
+            std::ios::out);
+        file.seekp(40 + 4 + 36 + 9);
+        file.put(49);
+    }
+
+    test::create(copy_path);
+    utxo_database copy(copy_path, 1, 1000, 50);
+    BOOST_REQUIRE(copy.create());
+
+    size_t height;
+    hash_digest hash;
+    BOOST_REQUIRE(!copy.import_snapshot(snapshot_path, height, hash, digest));
+    BOOST_REQUIRE(!copy.populate({ tx1.hash(), 0 }));
+}
+
+BOOST_AUTO_TEST_CASE(utxo_database__import_snapshot__not_empty__false_unchanged)
+{
+    static const auto tx1 = coinbase(50);
+    static const auto tx2 = coinbase(51);
+
+    test::create(file_path);
+    utxo_database instance(file_path, 1, 1000, 50);
+    BOOST_REQUIRE(instance.create());
+    BOOST_REQUIRE(instance.empty());
+    BOOST_REQUIRE(instance.store({ tx1.hash(), 0 }, tx1.outputs()[0], 1, 10, true));
+    BOOST_REQUIRE(!instance.empty());
+
+    hash_digest digest;
+    BOOST_REQUIRE(instance.export_snapshot(snapshot_path, 1, null_hash,
+        digest));
+
+    test::create(copy_path);
+    utxo_database copy(copy_path, 1, 1000, 50);
+    BOOST_REQUIRE(copy.create());
+    BOOST_REQUIRE(copy.store({ tx2.hash(), 0 }, tx2.outputs()[0], 2, 20, false));
+
+    size_t height;
+    hash_digest hash;
+    BOOST_REQUIRE(!copy.import_snapshot(snapshot_path, height, hash, digest));
+    BOOST_REQUIRE(!copy.populate({ tx1.hash(), 0 }));
+    BOOST_REQUIRE(copy.populate({ tx2.hash(), 0 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+#include "utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+// Test directory
+#define DIRECTORY "existence_filter"
+
+struct existence_filter_directory_setup_fixture
+{
+    existence_filter_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+static hash_digest digest(uint8_t value)
+{
+    hash_digest out;
+    for (size_t index = 0; index < out.size(); ++index)
+        out[index] = static_cast<uint8_t>(value * (index + 1) + index * 31);
+
+    return out;
+}
+
+BOOST_FIXTURE_TEST_SUITE(existence_filter_tests, existence_filter_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(existence_filter__construct__zero__disabled_contains_all)
+{
+    existence_filter instance(0);
+    BOOST_REQUIRE(instance.disabled());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__construct__unaligned__rounded_down)
+{
+    existence_filter instance(100);
+    BOOST_REQUIRE(!instance.disabled());
+    BOOST_REQUIRE_EQUAL(instance.size(), 64u);
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__contains__empty__false)
+{
+    existence_filter instance(1024);
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__contains__inserted__true)
+{
+    existence_filter instance(1024);
+
+    for (uint8_t value = 0; value < 50; ++value)
+        instance.insert(digest(value));
+
+    for (uint8_t value = 0; value < 50; ++value)
+        BOOST_REQUIRE(instance.contains(digest(value)));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__clear__inserted__false)
+{
+    existence_filter instance(1024);
+    instance.insert(digest(42));
+    instance.clear();
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__load__saved__round_trips)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    existence_filter saved(1024);
+    saved.insert(digest(42));
+    BOOST_REQUIRE(saved.save(file, 24));
+
+    existence_filter loaded(1024);
+    BOOST_REQUIRE(loaded.load(file, 24));
+    BOOST_REQUIRE(loaded.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__load__other_tag_or_size__false_cleared)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    existence_filter saved(1024);
+    saved.insert(digest(42));
+    BOOST_REQUIRE(saved.save(file, 24));
+
+    existence_filter loaded(1024);
+    loaded.insert(digest(42));
+    BOOST_REQUIRE(!loaded.load(file, 25));
+    BOOST_REQUIRE(!loaded.contains(digest(42)));
+
+    existence_filter other(2048);
+    BOOST_REQUIRE(!other.load(file, 24));
+}
+
+BOOST_AUTO_TEST_CASE(existence_filter__load__missing__false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    existence_filter instance(1024);
+    BOOST_REQUIRE(!instance.load(file, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
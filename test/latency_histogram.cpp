@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(latency_histogram_tests)
+
+BOOST_AUTO_TEST_CASE(latency_histogram__read__default__empty)
+{
+    latency_histogram instance;
+    const auto values = instance.read();
+    BOOST_REQUIRE_EQUAL(values.count, 0u);
+    BOOST_REQUIRE(values.total == asio::duration::zero());
+    BOOST_REQUIRE(values.maximum == asio::duration::zero());
+    BOOST_REQUIRE_EQUAL(values.buckets.size(), latency_histogram::buckets);
+    BOOST_REQUIRE(values.quantile(0.5) == asio::microseconds::zero());
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__record__latencies__power_of_two_buckets)
+{
+    latency_histogram instance;
+    instance.record(std::chrono::nanoseconds(500));
+    instance.record(asio::microseconds(1));
+    instance.record(asio::microseconds(3));
+    instance.record(asio::microseconds(1000));
+
+    const auto values = instance.read();
+    BOOST_REQUIRE_EQUAL(values.count, 4u);
+    BOOST_REQUIRE_EQUAL(values.buckets[0], 1u);
+    BOOST_REQUIRE_EQUAL(values.buckets[1], 1u);
+    BOOST_REQUIRE_EQUAL(values.buckets[2], 1u);
+    BOOST_REQUIRE_EQUAL(values.buckets[10], 1u);
+    BOOST_REQUIRE(values.maximum == asio::microseconds(1000));
+    BOOST_REQUIRE(values.total == std::chrono::nanoseconds(1004500));
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__quantile__recorded__bucket_upper_bound)
+{
+    latency_histogram instance;
+
+    for (size_t count = 0; count < 9; ++count)
+        instance.record(asio::microseconds(3));
+
+    instance.record(asio::microseconds(100));
+
+    const auto values = instance.read();
+    BOOST_REQUIRE(values.quantile(0.5) == asio::microseconds(4));
+    BOOST_REQUIRE(values.quantile(1.0) == asio::microseconds(128));
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__timer__scope__recorded)
+{
+    latency_histogram instance;
+
+    {
+        const latency_histogram::timer timer(instance);
+    }
+
+    BOOST_REQUIRE_EQUAL(instance.read().count, 1u);
+    instance.reset();
+    BOOST_REQUIRE_EQUAL(instance.read().count, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+#include "../utility/storage.hpp"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(access_guard_tests)
+
+BOOST_AUTO_TEST_CASE(access_guard__constructor__always__buffer_data)
+{
+    test::storage file(data_chunk{ 42, 24 });
+    BOOST_REQUIRE(file.open());
+    const access_guard instance(file);
+    BOOST_REQUIRE_EQUAL(instance.buffer()[0], 42u);
+}
+
+BOOST_AUTO_TEST_CASE(access_guard__increment__nonzero__expected_offset)
+{
+    test::storage file(data_chunk{ 42, 24 });
+    BOOST_REQUIRE(file.open());
+    access_guard instance(file);
+    const auto buffer = instance.buffer();
+    instance.increment(1);
+    BOOST_REQUIRE_EQUAL(instance.buffer(), buffer + 1);
+    BOOST_REQUIRE_EQUAL(instance.buffer()[0], 24u);
+}
+
+BOOST_AUTO_TEST_CASE(access_guard__move__always__transfers_lock)
+{
+    test::storage file(data_chunk{ 42 });
+    BOOST_REQUIRE(file.open());
+    access_guard source(file);
+    const auto buffer = source.buffer();
+    const access_guard instance(std::move(source));
+    BOOST_REQUIRE(source.buffer() == nullptr);
+    BOOST_REQUIRE_EQUAL(instance.buffer(), buffer);
+}
+
+BOOST_AUTO_TEST_CASE(access_guard__destructor__always__unlocks)
+{
+    test::storage file(data_chunk{ 42 });
+    BOOST_REQUIRE(file.open());
+    {
+        const access_guard instance(file);
+    }
+
+    // Reserve takes the upgrade lock and then a unique lock to resize.
+    BOOST_REQUIRE(file.reserve(2));
+    BOOST_REQUIRE_EQUAL(file.logical(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
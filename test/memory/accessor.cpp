@@ -54,4 +54,13 @@ BOOST_AUTO_TEST_CASE(accessor_assign__nonzero__expected_buffer)
     BOOST_REQUIRE_EQUAL(instance.buffer(), expected);
 }
 
+BOOST_AUTO_TEST_CASE(accessor_constructor__shared__expected_buffer)
+{
+    uint8_t value;
+    uint8_t* const expected = &value;
+    shared_mutex mutex;
+    accessor instance(mutex, expected);
+    BOOST_REQUIRE_EQUAL(instance.buffer(), expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <bitcoin/database.hpp>
 #include "../utility/utility.hpp"
 
@@ -157,6 +158,77 @@ BOOST_AUTO_TEST_CASE(file_storage__reserve__no_minimum_expansion__expected_file_
     BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
 }
 
+BOOST_AUTO_TEST_CASE(file_storage__reserve__huge_pages__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42, max_size_t);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__reserve__leading_huge_pages__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+
+    // A leading range of a two page map splits it.
+    boost::filesystem::resize_file(file, 8192);
+    file_storage instance(file, 0, 42, 4096);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(10000));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 14200u);
+}
+
+// Windows does not reserve beyond the file size.
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(file_storage__reserve__within_reservation__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42, 0, 1000);
+    BOOST_REQUIRE(instance.open());
+    const auto buffer = instance.access()->buffer();
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
+    BOOST_REQUIRE_EQUAL(instance.access()->buffer(), buffer);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(file_storage__reserve__populate__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42, 0, 0, 4096);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE(instance.reserve(120));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__reserve__extent__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42, 0, 0, 0, 4096);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
+    BOOST_REQUIRE(instance.close());
+    BOOST_REQUIRE_EQUAL(boost::filesystem::file_size(file), 100u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__reserve__beyond_reservation__expected_file_size)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42, 0, 100);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 142u);
+}
+
 // Causes boost assert.
 ////BOOST_AUTO_TEST_CASE(file_storage__access__closed__throws_runtime_error)
 ////{
@@ -176,6 +248,151 @@ BOOST_AUTO_TEST_CASE(file_storage__access__open__expected)
     BOOST_REQUIRE(instance.access());
 }
 
+BOOST_AUTO_TEST_CASE(file_storage__advise__closed__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.advise(access_advice::sequential));
+    BOOST_REQUIRE(instance.open());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__advise__open__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.advise(access_advice::normal));
+    BOOST_REQUIRE(instance.advise(access_advice::sequential));
+    BOOST_REQUIRE(instance.advise(access_advice::willneed));
+    BOOST_REQUIRE(instance.advise(access_advice::random));
+    BOOST_REQUIRE(instance.reserve(100));
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__set_read_only__unwritable_file__open_and_read)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    boost::filesystem::permissions(file, boost::filesystem::owner_read |
+        boost::filesystem::group_read | boost::filesystem::others_read);
+
+    file_storage instance(file);
+    instance.set_read_only();
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.access()->buffer()[0], 'z');
+    BOOST_REQUIRE(instance.refresh());
+    BOOST_REQUIRE(instance.close());
+
+    boost::filesystem::permissions(file, boost::filesystem::owner_read |
+        boost::filesystem::owner_write);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__place__closed_local__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.place(memory_placement::local, 0));
+    BOOST_REQUIRE(instance.open());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__place__open_local__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.place(memory_placement::local, 0));
+    BOOST_REQUIRE(instance.reserve(100));
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__prefault__closed__false)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(!instance.prefault(max_size_t, false));
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__prefault__open__true)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE(instance.prefault(max_size_t, false));
+    BOOST_REQUIRE(instance.prefault(42, false));
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__reserve__pinned_past_reservation__expected)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 1, 50, 0, 1u << 20);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+
+    // Pinning the leading page splits the reserved map.
+    BOOST_REQUIRE(instance.prefault(max_size_t, true));
+    const auto reserved = instance.counters().reserved;
+    BOOST_REQUIRE(instance.reserve(reserved + 1));
+    BOOST_REQUIRE_GT(instance.counters().reserved, reserved);
+    BOOST_REQUIRE(instance.prefault(max_size_t, false));
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__prefetch__advise__unchanged)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const auto memory = instance.reserve(100);
+    memory->buffer()[42] = 24;
+    instance.prefetch(memory->buffer() + 40, 10, false);
+    instance.prefetch(memory->buffer() + 40, 10, true);
+    instance.prefetch(memory->buffer(), 0, true);
+    BOOST_REQUIRE_EQUAL(memory->buffer()[42], 24u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__punch__pages__zeroed)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const auto memory = instance.reserve(3 * 4096);
+    const auto buffer = memory->buffer();
+    std::fill_n(buffer, 3 * 4096, 0x42);
+    instance.punch(buffer + 100, 2 * 4096);
+    BOOST_REQUIRE_EQUAL(buffer[99], 0x42u);
+    BOOST_REQUIRE_EQUAL(buffer[100], 0x00u);
+    BOOST_REQUIRE_EQUAL(buffer[4096], 0x00u);
+    BOOST_REQUIRE_EQUAL(buffer[2 * 4096 + 99], 0x00u);
+    BOOST_REQUIRE_EQUAL(buffer[2 * 4096 + 100], 0x42u);
+    BOOST_REQUIRE(instance.flush());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__counters__reserve__expected)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file, 0, 42);
+    BOOST_REQUIRE(instance.open());
+    BOOST_REQUIRE(instance.reserve(100));
+    BOOST_REQUIRE(instance.reserve(120));
+    BOOST_REQUIRE(instance.flush());
+    const auto counters = instance.counters();
+    BOOST_REQUIRE_EQUAL(counters.upgrades, 2u);
+    BOOST_REQUIRE_EQUAL(counters.resizes, 1u);
+    BOOST_REQUIRE_EQUAL(counters.remaps, 1u);
+    BOOST_REQUIRE_EQUAL(counters.flushes, 1u);
+    BOOST_REQUIRE_EQUAL(counters.capacity, 142u);
+    BOOST_REQUIRE_EQUAL(counters.logical, 120u);
+}
+
 BOOST_AUTO_TEST_CASE(file_storage__flush__closed__success)
 {
     static const std::string file = DIRECTORY "/" + TEST_NAME;
@@ -193,6 +410,62 @@ BOOST_AUTO_TEST_CASE(file_storage__flush__open__success)
     BOOST_REQUIRE(instance.flush());
 }
 
+BOOST_AUTO_TEST_CASE(file_storage__flush__dirty__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const auto memory = instance.reserve(100);
+    BOOST_REQUIRE(memory);
+    instance.dirty(memory->buffer() + 10, 42);
+    instance.dirty(memory->buffer(), 1);
+    BOOST_REQUIRE(instance.flush());
+    BOOST_REQUIRE(instance.flush());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__writeback__closed__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.writeback());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__writeback__dirty__success)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const auto memory = instance.reserve(100);
+    BOOST_REQUIRE(memory);
+    instance.dirty(memory->buffer(), 100);
+    BOOST_REQUIRE(instance.writeback());
+    BOOST_REQUIRE(instance.flush());
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__counters__dirty_pages__unwritten_until_writeback)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const auto memory = instance.reserve(3 * 4096);
+    BOOST_REQUIRE(memory);
+    instance.dirty(memory->buffer() + 10, 42);
+    instance.dirty(memory->buffer() + 100, 1);
+    BOOST_REQUIRE_EQUAL(instance.counters().unwritten, 4096u);
+    instance.dirty(memory->buffer() + 2 * 4096, 1);
+    BOOST_REQUIRE_EQUAL(instance.counters().unwritten, 2 * 4096u);
+    BOOST_REQUIRE(instance.writeback(true));
+    BOOST_REQUIRE_EQUAL(instance.counters().unwritten, 0u);
+    instance.dirty(memory->buffer(), 1);
+    BOOST_REQUIRE_EQUAL(instance.counters().unwritten, 4096u);
+    BOOST_REQUIRE(instance.flush());
+    BOOST_REQUIRE_EQUAL(instance.counters().unwritten, 0u);
+}
+
 BOOST_AUTO_TEST_CASE(file_storage__write__read__expected)
 {
     const uint64_t expected = 0x0102030405060708;
@@ -211,4 +484,65 @@ BOOST_AUTO_TEST_CASE(file_storage__write__read__expected)
     BOOST_REQUIRE_EQUAL(deserial.read_big_endian<uint64_t>(), expected);
 }
 
+BOOST_AUTO_TEST_CASE(file_storage__residency__closed__zeroed)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    const file_storage instance(file);
+    const auto residency = instance.residency(1);
+    BOOST_REQUIRE_EQUAL(residency.dirty, 0u);
+    BOOST_REQUIRE_EQUAL(residency.head_resident, 0u);
+    BOOST_REQUIRE_EQUAL(residency.body_resident, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__residency__written__resident)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    const size_t page = 4096;
+    auto memory = instance.reserve(3u * page);
+    BOOST_REQUIRE(memory);
+    std::fill_n(memory->buffer(), 3u * page, 0x42);
+    instance.dirty(memory->buffer(), 1);
+    memory.reset();
+
+    // Written pages are resident, the head and body sum to the data.
+    const auto residency = instance.residency(1);
+    BOOST_REQUIRE_EQUAL(residency.logical, 3u * page);
+    BOOST_REQUIRE_GE(residency.mapped, residency.logical);
+    BOOST_REQUIRE_EQUAL(residency.head, 1u);
+    BOOST_REQUIRE_EQUAL(residency.dirty, page);
+    BOOST_REQUIRE_EQUAL(residency.head_resident, 1u);
+    BOOST_REQUIRE_EQUAL(residency.body_resident, 3u * page - 1u);
+}
+
+BOOST_AUTO_TEST_CASE(file_storage__copy__flushed__same_content)
+{
+    const uint64_t expected = 0x0102030405060708;
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string copy = file + "_copy";
+    BOOST_REQUIRE(test::create(file));
+    file_storage instance(file);
+    BOOST_REQUIRE(instance.open());
+    auto memory = instance.reserve(sizeof(uint64_t));
+    BOOST_REQUIRE(memory);
+    auto serial = make_unsafe_serializer(memory->buffer());
+    serial.write_big_endian<uint64_t>(expected);
+    memory.reset();
+    BOOST_REQUIRE(instance.flush());
+    BOOST_REQUIRE(file_storage::copy(file, copy));
+
+    // The copy is not replaced.
+    BOOST_REQUIRE(!file_storage::copy(file, copy));
+
+    file_storage copied(copy);
+    BOOST_REQUIRE(copied.open());
+    BOOST_REQUIRE_EQUAL(copied.capacity(), instance.capacity());
+    const auto copied_memory = copied.access();
+    auto deserial = make_unsafe_deserializer(copied_memory->buffer());
+    BOOST_REQUIRE_EQUAL(deserial.read_big_endian<uint64_t>(), expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
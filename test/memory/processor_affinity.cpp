@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(processor_affinity_tests)
+
+BOOST_AUTO_TEST_CASE(processor_affinity__numa_processors__no_nodes__empty)
+{
+    BOOST_REQUIRE(numa_processors(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(processor_affinity__construct__empty__not_pinned)
+{
+    const processor_affinity instance({});
+    BOOST_REQUIRE(!instance.pinned());
+}
+
+BOOST_AUTO_TEST_CASE(processor_affinity__construct__online_nodes__pinned_if_known)
+{
+    const auto cpus = numa_processors(numa_nodes());
+    const processor_affinity instance(cpus);
+    BOOST_REQUIRE_EQUAL(instance.pinned(), !cpus.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
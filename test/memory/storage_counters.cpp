@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(storage_counters_tests)
+
+BOOST_AUTO_TEST_CASE(storage_counters__constructor__always__zero)
+{
+    const storage_counters instance;
+    BOOST_REQUIRE_EQUAL(instance.resizes, 0u);
+    BOOST_REQUIRE_EQUAL(instance.remaps, 0u);
+    BOOST_REQUIRE(instance.resize_duration == asio::duration::zero());
+    BOOST_REQUIRE(instance.resize_maximum == asio::duration::zero());
+    BOOST_REQUIRE_EQUAL(instance.flushes, 0u);
+    BOOST_REQUIRE(instance.flush_duration == asio::duration::zero());
+    BOOST_REQUIRE_EQUAL(instance.upgrades, 0u);
+    BOOST_REQUIRE(instance.upgrade_wait == asio::duration::zero());
+    BOOST_REQUIRE_EQUAL(instance.reserved, 0u);
+    BOOST_REQUIRE_EQUAL(instance.capacity, 0u);
+    BOOST_REQUIRE_EQUAL(instance.logical, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(storage_counters__add_assign__always__sums_and_maximum)
+{
+    storage_counters instance;
+    instance.resizes = 1;
+    instance.resize_duration = asio::milliseconds(2);
+    instance.resize_maximum = asio::milliseconds(2);
+    instance.logical = 42;
+
+    storage_counters other;
+    other.resizes = 2;
+    other.resize_duration = asio::milliseconds(3);
+    other.resize_maximum = asio::milliseconds(1);
+    other.logical = 8;
+
+    instance += other;
+    BOOST_REQUIRE_EQUAL(instance.resizes, 3u);
+    BOOST_REQUIRE(instance.resize_duration == asio::milliseconds(5));
+    BOOST_REQUIRE(instance.resize_maximum == asio::milliseconds(2));
+    BOOST_REQUIRE_EQUAL(instance.logical, 50u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
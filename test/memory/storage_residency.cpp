@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(storage_residency_tests)
+
+BOOST_AUTO_TEST_CASE(storage_residency__constructor__always__zero)
+{
+    const storage_residency instance;
+    BOOST_REQUIRE_EQUAL(instance.mapped, 0u);
+    BOOST_REQUIRE_EQUAL(instance.logical, 0u);
+    BOOST_REQUIRE_EQUAL(instance.head, 0u);
+    BOOST_REQUIRE_EQUAL(instance.head_resident, 0u);
+    BOOST_REQUIRE_EQUAL(instance.body_resident, 0u);
+    BOOST_REQUIRE_EQUAL(instance.dirty, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(storage_residency__add_assign__always__sums)
+{
+    storage_residency instance;
+    instance.mapped = 100;
+    instance.logical = 42;
+    instance.head = 2;
+    instance.head_resident = 1;
+    instance.body_resident = 40;
+    instance.dirty = 4;
+
+    storage_residency other;
+    other.mapped = 10;
+    other.logical = 8;
+    other.head = 3;
+    other.head_resident = 3;
+    other.body_resident = 0;
+    other.dirty = 1;
+
+    instance += other;
+    BOOST_REQUIRE_EQUAL(instance.mapped, 110u);
+    BOOST_REQUIRE_EQUAL(instance.logical, 50u);
+    BOOST_REQUIRE_EQUAL(instance.head, 5u);
+    BOOST_REQUIRE_EQUAL(instance.head_resident, 4u);
+    BOOST_REQUIRE_EQUAL(instance.body_resident, 40u);
+    BOOST_REQUIRE_EQUAL(instance.dirty, 5u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(striped_mutex_tests)
+
+BOOST_AUTO_TEST_CASE(striped_mutex__stripes__default__default_stripes)
+{
+    const striped_mutex instance;
+    BOOST_REQUIRE_EQUAL(instance.stripes(), striped_mutex::default_stripes);
+}
+
+BOOST_AUTO_TEST_CASE(striped_mutex__index__same_stripe__same_mutex)
+{
+    const striped_mutex instance(4);
+    BOOST_REQUIRE_EQUAL(&instance[1], &instance[5]);
+    BOOST_REQUIRE_EQUAL(&instance[0], &instance[4]);
+}
+
+BOOST_AUTO_TEST_CASE(striped_mutex__index__distinct_stripes__distinct_mutexes)
+{
+    const striped_mutex instance(4);
+    BOOST_REQUIRE_NE(&instance[0], &instance[1]);
+    BOOST_REQUIRE_NE(&instance[2], &instance[3]);
+}
+
+BOOST_AUTO_TEST_CASE(striped_mutex__index__lock__other_stripe_not_blocked)
+{
+    const striped_mutex instance(2);
+    unique_lock lock(instance[0]);
+    BOOST_REQUIRE(instance[1].try_lock());
+    instance[1].unlock();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
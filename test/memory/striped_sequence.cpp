@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(striped_sequence_tests)
+
+BOOST_AUTO_TEST_CASE(striped_sequence__stripes__default__default_stripes)
+{
+    const striped_sequence instance;
+    BOOST_REQUIRE_EQUAL(instance.stripes(), striped_sequence::default_stripes);
+}
+
+BOOST_AUTO_TEST_CASE(striped_sequence__end_read__no_write__true)
+{
+    const striped_sequence instance(4);
+    const auto sequence = instance.begin_read(1);
+    BOOST_REQUIRE(instance.end_read(1, sequence));
+}
+
+BOOST_AUTO_TEST_CASE(striped_sequence__end_read__overlapping_write__false)
+{
+    const striped_sequence instance(4);
+    const auto sequence = instance.begin_read(1);
+    instance.begin_write(5);
+    instance.end_write(5);
+    BOOST_REQUIRE(!instance.end_read(1, sequence));
+    BOOST_REQUIRE(instance.end_read(1, instance.begin_read(1)));
+}
+
+BOOST_AUTO_TEST_CASE(striped_sequence__end_read__other_stripe_write__true)
+{
+    const striped_sequence instance(4);
+    const auto sequence = instance.begin_read(1);
+    instance.begin_write(2);
+    BOOST_REQUIRE(instance.end_read(1, sequence));
+    instance.end_write(2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+// Test directory
+#define DIRECTORY "write_log"
+
+struct write_log_directory_setup_fixture
+{
+    write_log_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+        log::initialize();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(write_log_tests, write_log_directory_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(write_log__replay__missing_log__success)
+{
+    BOOST_REQUIRE(write_log::replay(DIRECTORY "/missing"));
+}
+
+BOOST_AUTO_TEST_CASE(write_log__replay__committed_and_uncommitted__committed_applied)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string journal = DIRECTORY "/log_" + TEST_NAME;
+    static const data_chunk committed{ 0x01, 0x02, 0x03, 0x04 };
+    BOOST_REQUIRE(test::create(file));
+
+    {
+        write_log instance(journal);
+        BOOST_REQUIRE_EQUAL(instance.enroll(file), 0u);
+        BOOST_REQUIRE(instance.open());
+        instance.record(0, 10, committed.data(), committed.size());
+        BOOST_REQUIRE(instance.commit());
+        BOOST_REQUIRE_GT(instance.size(), 0u);
+        BOOST_REQUIRE(instance.close());
+    }
+
+    // Append a write record without a commit marker, as if torn by a crash.
+    {
+        std::ofstream stream(journal, std::ios::binary | std::ios::app);
+        const data_chunk uncommitted
+        {
+            0x01, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x01, 0x2a
+        };
+        stream.write(reinterpret_cast<const char*>(uncommitted.data()),
+            uncommitted.size());
+    }
+
+    BOOST_REQUIRE(write_log::replay(journal));
+
+    file_storage storage(file);
+    BOOST_REQUIRE(storage.open());
+    BOOST_REQUIRE_GE(storage.capacity(), 14u);
+    const auto buffer = storage.access()->buffer();
+    BOOST_REQUIRE(std::equal(committed.begin(), committed.end(), buffer + 10));
+
+    if (storage.capacity() > 20u)
+        BOOST_REQUIRE_EQUAL(buffer[20], 0x00);
+
+    BOOST_REQUIRE(storage.close());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__reset__committed__log_truncated_to_enrollments)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string journal = DIRECTORY "/log_" + TEST_NAME;
+    static const data_chunk bytes{ 0x2a };
+    BOOST_REQUIRE(test::create(file));
+
+    write_log instance(journal);
+    instance.enroll(file);
+    BOOST_REQUIRE(instance.open());
+    const auto enrolled = instance.size();
+    instance.record(0, 0, bytes.data(), bytes.size());
+    BOOST_REQUIRE(instance.commit());
+    BOOST_REQUIRE_GT(instance.size(), enrolled);
+    BOOST_REQUIRE(instance.reset());
+    BOOST_REQUIRE_EQUAL(instance.size(), enrolled);
+    BOOST_REQUIRE(instance.close());
+}
+
+BOOST_AUTO_TEST_CASE(write_log__replay__append_after_flush__synced_and_applied)
+{
+    typedef record_manager<uint32_t> manager_type;
+    typedef list_element<manager_type, uint32_t, empty_key> element_type;
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const std::string journal = DIRECTORY "/log_" + TEST_NAME;
+    static const auto value_size = 2u * write_log::max_write;
+    BOOST_REQUIRE(test::create(file));
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_bytes(data_chunk(value_size, 0x2a));
+    };
+
+    {
+        write_log log(journal);
+        file_storage storage(file);
+        storage.attach(log);
+        BOOST_REQUIRE(log.open());
+        BOOST_REQUIRE(storage.open());
+
+        shared_mutex mutex;
+        manager_type manager(storage, 0, element_type::size(value_size));
+        BOOST_REQUIRE(manager.create());
+
+        element_type first(manager, mutex);
+        BOOST_REQUIRE_EQUAL(first.create(writer), 0u);
+        first.set_next(element_type::not_found);
+        manager.commit();
+        BOOST_REQUIRE(storage.flush());
+        BOOST_REQUIRE(log.commit());
+
+        // The append is too large to log, so is synced by the flush, before
+        // the commit of the logged link and count that reference it.
+        element_type second(manager, mutex);
+        BOOST_REQUIRE_EQUAL(second.create(writer), 1u);
+        second.set_next(element_type::not_found);
+        first.set_next(1);
+        manager.commit();
+        BOOST_REQUIRE_GT(storage.counters().unwritten, 0u);
+        BOOST_REQUIRE(storage.flush());
+        BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 0u);
+        BOOST_REQUIRE(log.commit());
+    }
+
+    // Lose the logged count and link of the file, as if by a crash.
+    {
+        std::fstream stream(file, std::ios::binary | std::ios::in |
+            std::ios::out);
+        const data_chunk lost(2u * sizeof(uint32_t), 0x00);
+        stream.write(reinterpret_cast<const char*>(lost.data()),
+            lost.size());
+    }
+
+    BOOST_REQUIRE(write_log::replay(journal));
+
+    file_storage storage(file);
+    BOOST_REQUIRE(storage.open());
+
+    shared_mutex mutex;
+    manager_type manager(storage, 0, element_type::size(value_size));
+    BOOST_REQUIRE(manager.start());
+    BOOST_REQUIRE_EQUAL(manager.count(), 2u);
+
+    const element_type first(manager, 0, mutex);
+    BOOST_REQUIRE_EQUAL(first.next(), 1u);
+
+    // The guard must remain in scope until the end of the block.
+    {
+        const auto memory = manager.access(1);
+        const auto value = memory.buffer() + sizeof(uint32_t);
+        BOOST_REQUIRE(std::all_of(value, value + value_size, [](uint8_t byte)
+        {
+            return byte == 0x2a;
+        }));
+    }
+
+    BOOST_REQUIRE(storage.close());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
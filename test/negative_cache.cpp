@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+static hash_digest digest(uint8_t value)
+{
+    hash_digest out;
+    for (size_t index = 0; index < out.size(); ++index)
+        out[index] = static_cast<uint8_t>(value * (index + 1) + index * 31);
+
+    return out;
+}
+
+BOOST_AUTO_TEST_SUITE(negative_cache_tests)
+
+BOOST_AUTO_TEST_CASE(negative_cache__construct__zero__disabled_contains_none)
+{
+    negative_cache instance(0);
+    BOOST_REQUIRE(instance.disabled());
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 0u);
+    instance.insert(digest(42), instance.sequence());
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(negative_cache__insert__missed__contains_and_hits)
+{
+    negative_cache instance(64);
+    BOOST_REQUIRE(!instance.disabled());
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+
+    instance.insert(digest(42), instance.sequence());
+    BOOST_REQUIRE(instance.contains(digest(42)));
+    BOOST_REQUIRE(instance.contains(digest(42)));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(negative_cache__erase__recorded__not_contained)
+{
+    negative_cache instance(64);
+    instance.insert(digest(42), instance.sequence());
+    instance.erase(digest(42));
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(negative_cache__insert__erased_since_sequence__not_recorded)
+{
+    negative_cache instance(64);
+    const auto sequence = instance.sequence();
+
+    // The digest is stored between the lookup and recording of its miss.
+    instance.erase(digest(42));
+    instance.insert(digest(42), sequence);
+    BOOST_REQUIRE(!instance.contains(digest(42)));
+}
+
+BOOST_AUTO_TEST_CASE(negative_cache__insert__same_slot__replaced)
+{
+    negative_cache instance(1);
+    instance.insert(digest(1), instance.sequence());
+    instance.insert(digest(2), instance.sequence());
+    BOOST_REQUIRE(!instance.contains(digest(1)));
+    BOOST_REQUIRE(instance.contains(digest(2)));
+
+    instance.clear();
+    BOOST_REQUIRE(!instance.contains(digest(2)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -196,6 +196,293 @@ BOOST_AUTO_TEST_CASE(hash_table__slab__unlink_first_stored__expected)
     const_element2.read(reader2);
 }
 
+BOOST_AUTO_TEST_CASE(hash_table__slab__fingerprints__round_trips)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table<slab_manager<link_type>, index_type, link_type, key_type> slab_map;
+
+    // Create the file and initialize hash table.
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    slab_map table(file, 1u, bucket_tags::fingerprint);
+    BOOST_REQUIRE(table.create());
+
+    const key_type key1{ { 0xde, 0xad, 0x01, 0x02 } };
+    const key_type key2{ { 0xba, 0xad, 0x03, 0x04 } };
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_byte(42);
+    };
+
+    // A single bucket, so a fingerprint miss would otherwise be a chain walk.
+    BOOST_REQUIRE(!table.find(key1));
+
+    auto element = table.allocator();
+    const auto link1 = element.create(key1, writer, 1);
+    table.link(element);
+
+    const auto const_element1 = table.find(key1);
+    BOOST_REQUIRE(const_element1);
+    BOOST_REQUIRE_EQUAL(const_element1.link(), link1);
+    BOOST_REQUIRE(!table.find(key2));
+
+    // Restart with the same configuration.
+    table.commit();
+    slab_map restarted(file, 1u, bucket_tags::fingerprint);
+    BOOST_REQUIRE(restarted.start());
+    BOOST_REQUIRE(restarted.find(key1));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table__rehash__slab__same_links)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table<slab_manager<link_type>, index_type, link_type, key_type> slab_map;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    slab_map table(file, 3u);
+    BOOST_REQUIRE(table.create());
+
+    const key_type key1{ { 0xde, 0xad, 0xbe, 0xef } };
+    const key_type key2{ { 0xba, 0xad, 0xbe, 0xef } };
+    const key_type key3{ { 0x01, 0x02, 0x03, 0x04 } };
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_byte(42);
+    };
+
+    auto element = table.allocator();
+    const auto link1 = element.create(key1, writer, 1);
+    table.link(element);
+    const auto link2 = element.create(key2, writer, 1);
+    table.link(element);
+    /* const auto link3 =*/ element.create(key3, writer, 1);
+    table.link(element);
+
+    // A duplicate key, which must remain the first found.
+    const auto link4 = element.create(key1, writer, 1);
+    table.link(element);
+    table.commit();
+
+    test::storage target_file;
+    BOOST_REQUIRE(target_file.open());
+    slab_map target(target_file, 16u, bucket_tags::fingerprint);
+    BOOST_REQUIRE(table.rehash(target));
+    BOOST_REQUIRE(target.start());
+
+    BOOST_REQUIRE_EQUAL(target.find(key1).link(), link4);
+    BOOST_REQUIRE_EQUAL(target.find(key2).link(), link2);
+    BOOST_REQUIRE(target.find(key3));
+    BOOST_REQUIRE(target.get(link1).match(key1));
+
+    const key_type key5{ { 0x00, 0x00, 0x00, 0x00 } };
+    BOOST_REQUIRE(!target.find(key5));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table__copy__slab__contiguous_in_copy_order)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table<slab_manager<link_type>, index_type, link_type, key_type> slab_map;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    slab_map table(file, 3u);
+    BOOST_REQUIRE(table.create());
+
+    const key_type key1{ { 0xde, 0xad, 0xbe, 0xef } };
+    const key_type key2{ { 0xba, 0xad, 0xbe, 0xef } };
+    const key_type key3{ { 0x01, 0x02, 0x03, 0x04 } };
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_byte(42);
+    };
+
+    auto element = table.allocator();
+    const auto link1 = element.create(key1, writer, 1);
+    table.link(element);
+    const auto link2 = element.create(key2, writer, 1);
+    table.link(element);
+    const auto link3 = element.create(key3, writer, 1);
+    table.link(element);
+    table.commit();
+
+    const auto links = table.links();
+    BOOST_REQUIRE_EQUAL(links.size(), 3u);
+    BOOST_REQUIRE_EQUAL(links[0], link1);
+    BOOST_REQUIRE_EQUAL(links[2], link3);
+    const auto size = link2 - link1;
+    BOOST_REQUIRE_EQUAL(table.payload_size(), link3 + size);
+
+    test::storage target_file;
+    BOOST_REQUIRE(target_file.open());
+    slab_map target(target_file, 16u);
+    BOOST_REQUIRE(target.create());
+
+    // Copy key3 and key1 only, in that order.
+    const auto copy3 = table.copy(link3, size, target);
+    const auto copy1 = table.copy(link1, size, target);
+    target.commit();
+
+    BOOST_REQUIRE_EQUAL(copy1, copy3 + size);
+    BOOST_REQUIRE_EQUAL(target.find(key3).link(), copy3);
+    BOOST_REQUIRE_EQUAL(target.find(key1).link(), copy1);
+    BOOST_REQUIRE(!target.find(key2));
+
+    const auto reader = [](byte_deserializer& deserial)
+    {
+        BOOST_REQUIRE_EQUAL(deserial.read_byte(), 42u);
+    };
+
+    target.find(key1).read(reader);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table__rehash__record__same_links)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint32_t link_type;
+    typedef hash_table<record_manager<link_type>, index_type, link_type, key_type> record_map;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    record_map table(file, 1u, 4u);
+    BOOST_REQUIRE(table.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(42);
+    };
+
+    std::vector<key_type> keys;
+    std::vector<link_type> links;
+
+    for (uint8_t index = 0; index < 10; ++index)
+    {
+        keys.push_back(key_type{ { index, index, index, index } });
+        auto element = table.allocator();
+        links.push_back(element.create(keys.back(), writer));
+        table.link(element);
+    }
+
+    table.commit();
+
+    test::storage target_file;
+    BOOST_REQUIRE(target_file.open());
+    record_map target(target_file, 7u, 4u);
+    BOOST_REQUIRE(table.rehash(target));
+    BOOST_REQUIRE(target.start());
+
+    for (size_t index = 0; index < keys.size(); ++index)
+        BOOST_REQUIRE_EQUAL(target.find(keys[index]).link(), links[index]);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table__statistics__all_and_sampled__expected)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint32_t link_type;
+    typedef hash_table<record_manager<link_type>, index_type, link_type, key_type> record_map;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    record_map table(file, 4u, 4u);
+    BOOST_REQUIRE(table.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(42);
+    };
+
+    // Masked table, so the leading byte selects the bucket.
+    for (const uint8_t first: { 0, 0, 0, 2, 4 })
+    {
+        auto element = table.allocator();
+        element.create(key_type{ { first, 0x00, 0x00, 0x00 } }, writer);
+        table.link(element);
+    }
+
+    const auto all = table.statistics();
+    BOOST_REQUIRE_EQUAL(all.buckets, 4u);
+    BOOST_REQUIRE_EQUAL(all.sampled, 4u);
+    BOOST_REQUIRE_EQUAL(all.elements, 5u);
+    BOOST_REQUIRE_EQUAL(all.empty, 2u);
+    BOOST_REQUIRE_EQUAL(all.maximum, 4u);
+    BOOST_REQUIRE_EQUAL(all.histogram[0], 2u);
+    BOOST_REQUIRE_EQUAL(all.histogram[1], 1u);
+    BOOST_REQUIRE_EQUAL(all.histogram[4], 1u);
+
+    // Buckets 0 and 2 are sampled.
+    const auto sampled = table.statistics(2);
+    BOOST_REQUIRE_EQUAL(sampled.sampled, 2u);
+    BOOST_REQUIRE_EQUAL(sampled.elements, 5u);
+    BOOST_REQUIRE_EQUAL(sampled.estimated_elements(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table__find__many_keys__ordered_results)
+{
+    // Define hash table type.
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table<slab_manager<link_type>, index_type, link_type, key_type> slab_map;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    slab_map table(file, 2u, bucket_tags::fingerprint);
+    BOOST_REQUIRE(table.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_byte(42);
+    };
+
+    std::vector<key_type> keys;
+    std::vector<link_type> links;
+
+    for (uint8_t index = 0; index < 8; ++index)
+    {
+        keys.push_back(key_type{ { index, 0x00, index, 0x00 } });
+        auto element = table.allocator();
+        links.push_back(element.create(keys.back(), writer, 1));
+        table.link(element);
+    }
+
+    // Absent keys are interleaved with present keys, in reverse order.
+    std::vector<key_type> queries;
+    for (auto key = keys.rbegin(); key != keys.rend(); ++key)
+    {
+        queries.push_back(*key);
+        queries.push_back(key_type{ { (*key)[0], 0xff, 0x1f, 0xff } });
+    }
+
+    const auto results = table.find(queries, true);
+    BOOST_REQUIRE_EQUAL(results.size(), queries.size());
+
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+        const auto& present = results[2 * index];
+        BOOST_REQUIRE(present);
+        BOOST_REQUIRE_EQUAL(present.link(), links[keys.size() - index - 1]);
+        BOOST_REQUIRE(!results[2 * index + 1]);
+    }
+
+    BOOST_REQUIRE(table.find(std::vector<key_type>{}).empty());
+}
+
 BOOST_AUTO_TEST_CASE(hash_table__get__record_range_of_links__success)
 {
     // Define hash table type.
@@ -251,7 +538,7 @@ BOOST_AUTO_TEST_CASE(hash_table__get__slab_range_of_links__success)
 
     // Allocate, create and store a new elements.
     auto element = table.allocator();
-    const auto link1 = element.create(key1, writer1);
+    const auto link1 = element.create(key1, writer1, 4);
     table.link(element);
 
     BOOST_REQUIRE(table.get(link1));
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <bitcoin/database.hpp>
 #include "../utility/storage.hpp"
+#include "../utility/utility.hpp"
 
 using namespace bc;
 using namespace bc::database;
@@ -216,4 +217,158 @@ BOOST_AUTO_TEST_CASE(hash_table_header__read_write__64_bit_value__success)
     BOOST_REQUIRE_EQUAL(header.read(0), 24u);
 }
 
+BOOST_AUTO_TEST_CASE(hash_table_header__create__power_of_two__sets_masked_bucket_count)
+{
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table_header<index_type, link_type> header_type;
+
+    test::storage file;
+    const auto buckets = 16u;
+    header_type header(file, buckets);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(header.create());
+    BOOST_REQUIRE(header.start());
+
+    auto deserial = make_unsafe_deserializer(file.access()->buffer());
+    BOOST_REQUIRE_EQUAL(deserial.template read_little_endian<index_type>(), buckets | header_type::masked);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__start__unmasked_power_of_two__success)
+{
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table_header<index_type, link_type> header_type;
+
+    test::storage file;
+    const auto buckets = 16u;
+    header_type header(file, buckets);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(header.create());
+
+    // Simulate a table created before the masked format.
+    auto serial = make_unsafe_serializer(file.access()->buffer());
+    serial.template write_little_endian<index_type>(buckets);
+    BOOST_REQUIRE(header.start());
+
+    const test::tiny_hash key{ { 0x01, 0x02, 0x03, 0x04 } };
+    BOOST_REQUIRE_EQUAL(header.bucket(key), header_type::remainder(key, buckets));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__mask__power_of_two__leading_bytes)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    const byte_array<8> key{ { 0x34, 0x12, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+    BOOST_REQUIRE_EQUAL(header_type::mask(key, 0x1000u), 0x0234u);
+    BOOST_REQUIRE_EQUAL(header_type::mask(key, 1u), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__mask__short_key__leading_bytes)
+{
+    typedef hash_table_header<uint64_t, uint64_t> header_type;
+    const byte_array<2> key{ { 0x34, 0x12 } };
+    BOOST_REQUIRE_EQUAL(header_type::mask(key, 0x100000000u), 0x1234u);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__bucket__power_of_two__mask)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    test::storage file;
+    const test::tiny_hash key{ { 0x35, 0x12, 0x00, 0x00 } };
+    const header_type header(file, 16u);
+    BOOST_REQUIRE_EQUAL(header.bucket(key), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__bucket__not_power_of_two__remainder)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    test::storage file;
+    const test::tiny_hash key{ { 0x35, 0x12, 0x00, 0x00 } };
+    const header_type header(file, 10u);
+    BOOST_REQUIRE_EQUAL(header.bucket(key), header_type::remainder(key, 10u));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__size__fingerprints__expected)
+{
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table_header<index_type, link_type> header_type;
+
+    test::storage file;
+    const auto buckets = 42u;
+    const auto expected = sizeof(index_type) + (sizeof(link_type) + sizeof(uint32_t)) * buckets;
+    header_type header(file, buckets, true);
+    BOOST_REQUIRE_EQUAL(header.size(), expected);
+    BOOST_REQUIRE_EQUAL(header_type::size(buckets, true), expected);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__create__fingerprints__sets_flagged_bucket_count)
+{
+    typedef uint32_t index_type;
+    typedef uint64_t link_type;
+    typedef hash_table_header<index_type, link_type> header_type;
+
+    test::storage file;
+    const auto buckets = 10u;
+    header_type header(file, buckets, true);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(header.create());
+    BOOST_REQUIRE(header.start());
+    BOOST_REQUIRE_EQUAL(header.read(9), header_type::empty);
+
+    auto deserial = make_unsafe_deserializer(file.access()->buffer());
+    BOOST_REQUIRE_EQUAL(deserial.template read_little_endian<index_type>(), buckets | header_type::fingerprinted);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__start__fingerprints_mismatch__failure)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+
+    test::storage file;
+    header_type tagged(file, 10u, true);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(tagged.create());
+
+    header_type untagged(file, 10u);
+    BOOST_REQUIRE(!untagged.start());
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__contains__tagged__expected)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    const test::tiny_hash key1{ { 0x00, 0x00, 0x01, 0x02 } };
+    const test::tiny_hash key2{ { 0x00, 0x00, 0x03, 0x04 } };
+
+    test::storage file;
+    header_type header(file, 10u, true);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(header.create());
+    BOOST_REQUIRE(!header.contains(0, key1));
+    BOOST_REQUIRE(!header.contains(0, key2));
+
+    header.tag(0, key1);
+    BOOST_REQUIRE(header.contains(0, key1));
+    BOOST_REQUIRE(!header.contains(0, key2));
+    BOOST_REQUIRE(!header.contains(1, key1));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__contains__untagged__true)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    const test::tiny_hash key{ { 0x00, 0x00, 0x01, 0x02 } };
+
+    test::storage file;
+    header_type header(file, 10u);
+    BOOST_REQUIRE(file.open());
+    BOOST_REQUIRE(header.create());
+    BOOST_REQUIRE(header.contains(0, key));
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_header__fingerprint__always__two_bits)
+{
+    typedef hash_table_header<uint32_t, uint64_t> header_type;
+    const test::tiny_hash key{ { 0xff, 0xff, 0x21, 0x03 } };
+    BOOST_REQUIRE_EQUAL(header_type::fingerprint(key), 0x0000000au);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
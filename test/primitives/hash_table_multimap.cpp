@@ -159,4 +159,79 @@ BOOST_AUTO_TEST_CASE(hash_table_multimap__construct__always__expected)
     BOOST_REQUIRE(!multimap.get(link));
 }
 
+BOOST_AUTO_TEST_CASE(hash_table_multimap__link__bulk__grouped_by_key)
+{
+    typedef test::tiny_hash key_type;
+    typedef uint32_t index_type;
+    typedef uint32_t link_type;
+    typedef record_manager<link_type> record_manager;
+    typedef hash_table<record_manager, index_type, link_type, key_type> record_map;
+    typedef hash_table_multimap<index_type, link_type, key_type> record_multimap;
+
+    const auto value_size = 1u;
+    const key_type key1{ { 0xde, 0xad, 0xbe, 0xef } };
+    const key_type key2{ { 0xba, 0xad, 0xf0, 0x0d } };
+
+    test::storage hash_table_file;
+    BOOST_REQUIRE(hash_table_file.open());
+    record_map table(hash_table_file, 100u, sizeof(link_type));
+    BOOST_REQUIRE(table.create());
+
+    test::storage index_file;
+    BOOST_REQUIRE(index_file.open());
+    record_manager index(index_file, 0, record_multimap::size(value_size));
+    BOOST_REQUIRE(index.create());
+
+    record_multimap multimap(table, index);
+
+    // An existing element precedes the bulk elements of key1.
+    const auto writer0 = [](byte_serializer& serial) { serial.write_byte(0); };
+    auto element = multimap.allocator();
+    const auto link0 = element.create(writer0);
+    multimap.link(key1, element);
+
+    const std::vector<key_type> keys{ key1, key2, key1 };
+    const auto first = multimap.allocate(keys.size());
+    BOOST_REQUIRE_EQUAL(first, link0 + 1u);
+
+    for (uint8_t row = 0; row < keys.size(); ++row)
+    {
+        const auto writer = [&](byte_serializer& serial)
+        {
+            serial.write_byte(row + 1u);
+        };
+
+        multimap.allocator(first + row).populate(writer);
+    }
+
+    multimap.link(keys, first);
+
+    // The newest element of a key is first and the preexisting one is last.
+    const auto found1 = multimap.find(key1);
+    BOOST_REQUIRE(found1);
+    BOOST_REQUIRE_EQUAL(found1.link(), first + 2u);
+
+    auto item = found1;
+    BOOST_REQUIRE(item.jump_next());
+    BOOST_REQUIRE_EQUAL(item.link(), first);
+    BOOST_REQUIRE(item.jump_next());
+    BOOST_REQUIRE_EQUAL(item.link(), link0);
+    BOOST_REQUIRE(item.jump_next());
+    BOOST_REQUIRE(!item);
+
+    const auto reader = [](byte_deserializer& deserial)
+    {
+        BOOST_REQUIRE_EQUAL(deserial.read_byte(), 3u);
+    };
+
+    found1.read(reader);
+
+    const auto found2 = multimap.find(key2);
+    BOOST_REQUIRE(found2);
+    BOOST_REQUIRE_EQUAL(found2.link(), first + 1u);
+    auto item2 = found2;
+    BOOST_REQUIRE(item2.jump_next());
+    BOOST_REQUIRE(!item2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -18,15 +18,94 @@
  */
 #include <boost/test/unit_test.hpp>
 #include <bitcoin/database.hpp>
+#include "../utility/utility.hpp"
 
 using namespace bc;
 using namespace bc::database;
+using namespace bc::system;
 
-BOOST_AUTO_TEST_SUITE(list_element_tests)
+// Test directory
+#define DIRECTORY "list_element"
+
+struct list_element_directory_setup_fixture
+{
+    list_element_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+        log::initialize();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(list_element_tests,
+    list_element_directory_setup_fixture)
 
 BOOST_AUTO_TEST_CASE(list_element__method__vector__expectation)
 {
     BOOST_REQUIRE(true);
 }
 
+BOOST_AUTO_TEST_CASE(list_element__create__record_after_flush__unwritten_until_flush)
+{
+    typedef record_manager<uint32_t> manager_type;
+    typedef list_element<manager_type, uint32_t, empty_key> element_type;
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+
+    file_storage storage(file);
+    BOOST_REQUIRE(storage.open());
+
+    shared_mutex mutex;
+    manager_type manager(storage, 0, element_type::size(4));
+    BOOST_REQUIRE(manager.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(42);
+    };
+
+    element_type first(manager, mutex);
+    BOOST_REQUIRE_EQUAL(first.create(writer), 0u);
+    BOOST_REQUIRE(storage.flush());
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 0u);
+
+    // The element is carved from the arena reserved by the first.
+    element_type second(manager, mutex);
+    BOOST_REQUIRE_EQUAL(second.create(writer), 1u);
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 4096u);
+    BOOST_REQUIRE(storage.flush());
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(list_element__create__slab_after_flush__unwritten_until_flush)
+{
+    typedef slab_manager<uint64_t> manager_type;
+    typedef list_element<manager_type, uint64_t, empty_key> element_type;
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    BOOST_REQUIRE(test::create(file));
+
+    file_storage storage(file);
+    BOOST_REQUIRE(storage.open());
+
+    shared_mutex mutex;
+    manager_type manager(storage, 0);
+    BOOST_REQUIRE(manager.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(42);
+    };
+
+    element_type first(manager, mutex);
+    first.create({}, writer, 4);
+    BOOST_REQUIRE(storage.flush());
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 0u);
+
+    // The element is carved from the arena reserved by the first.
+    element_type second(manager, mutex);
+    second.create({}, writer, 4);
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 4096u);
+    BOOST_REQUIRE(storage.flush());
+    BOOST_REQUIRE_EQUAL(storage.counters().unwritten, 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
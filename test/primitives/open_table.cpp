@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+#include "../utility/storage.hpp"
+#include "../utility/utility.hpp"
+
+using namespace bc;
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(open_table_tests)
+
+typedef open_table<uint32_t, test::tiny_hash> table_type;
+
+BOOST_AUTO_TEST_CASE(open_table__create__zero_slots__failure)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 0u, 4u);
+    BOOST_REQUIRE(!table.create());
+}
+
+BOOST_AUTO_TEST_CASE(open_table__find__empty__not_found)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 8u, 4u);
+    BOOST_REQUIRE(table.create());
+    BOOST_REQUIRE(!table.find(test::tiny_hash{ { 0x01, 0x02, 0x03, 0x04 } }));
+}
+
+BOOST_AUTO_TEST_CASE(open_table__store__colliding_keys__round_trips)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 8u, 4u);
+    BOOST_REQUIRE(table.create());
+
+    // Masked table (power of two), so both keys probe from slot 1.
+    const test::tiny_hash key1{ { 0x01, 0x00, 0x00, 0x00 } };
+    const test::tiny_hash key2{ { 0x09, 0x00, 0x00, 0x00 } };
+    BOOST_REQUIRE_EQUAL(table.slot(key1), 1u);
+    BOOST_REQUIRE_EQUAL(table.slot(key2), 1u);
+
+    const auto link1 = table.store(key1, [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(42);
+    });
+
+    const auto link2 = table.store(key2, [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(24);
+    });
+
+    BOOST_REQUIRE_EQUAL(link1, 1u);
+    BOOST_REQUIRE_EQUAL(link2, 2u);
+
+    const auto element2 = table.find(key2);
+    BOOST_REQUIRE(element2);
+    BOOST_REQUIRE_EQUAL(element2.link(), link2);
+    BOOST_REQUIRE(element2.match(key2));
+    element2.read([](byte_deserializer& deserial)
+    {
+        BOOST_REQUIRE_EQUAL(deserial.read_4_bytes_little_endian(), 24u);
+    });
+
+    const auto element1 = table.get(link1);
+    BOOST_REQUIRE(element1.match(key1));
+    element1.read([](byte_deserializer& deserial)
+    {
+        BOOST_REQUIRE_EQUAL(deserial.read_4_bytes_little_endian(), 42u);
+    });
+}
+
+BOOST_AUTO_TEST_CASE(open_table__store__full__not_found)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 3u, 4u);
+    BOOST_REQUIRE(table.create());
+
+    const auto writer = [](byte_serializer& serial)
+    {
+        serial.write_4_bytes_little_endian(0);
+    };
+
+    BOOST_REQUIRE(table.store(test::tiny_hash{ { 0x01 } }, writer) != table_type::not_found);
+    BOOST_REQUIRE(table.store(test::tiny_hash{ { 0x02 } }, writer) != table_type::not_found);
+    BOOST_REQUIRE(table.store(test::tiny_hash{ { 0x03 } }, writer) != table_type::not_found);
+    BOOST_REQUIRE_EQUAL(table.store(test::tiny_hash{ { 0x04 } }, writer), table_type::not_found);
+
+    // A full table still terminates the probe sequence of an absent key.
+    BOOST_REQUIRE(!table.find(test::tiny_hash{ { 0x04 } }));
+    BOOST_REQUIRE(table.find(test::tiny_hash{ { 0x02 } }));
+}
+
+BOOST_AUTO_TEST_CASE(open_table__start__slot_mismatch__failure)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 8u, 4u);
+    BOOST_REQUIRE(table.create());
+    BOOST_REQUIRE(table.start());
+
+    table_type other(file, 16u, 4u);
+    BOOST_REQUIRE(!other.start());
+}
+
+BOOST_AUTO_TEST_CASE(open_table__get__not_found__terminator)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+    table_type table(file, 8u, 4u);
+    BOOST_REQUIRE(table.create());
+    BOOST_REQUIRE(!table.get(table_type::not_found));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(record_field_tests)
+
+typedef record_field<0, uint8_t> first;
+typedef next_field<first, uint32_t> second;
+typedef next_field<second, uint16_t> third;
+
+BOOST_AUTO_TEST_CASE(record_field__offsets__sequential)
+{
+    static_assert(first::offset == 0u, "first");
+    static_assert(second::offset == 1u, "second");
+    static_assert(third::offset == 5u, "third");
+    static_assert(third::end == 7u, "end");
+    BOOST_REQUIRE_EQUAL(third::size, sizeof(uint16_t));
+}
+
+BOOST_AUTO_TEST_CASE(record_field__read__little_endian__expected)
+{
+    const uint8_t record[] { 0x2a, 0x04, 0x03, 0x02, 0x81, 0x06, 0x05 };
+    BOOST_REQUIRE_EQUAL(first::read(record), 0x2au);
+    BOOST_REQUIRE_EQUAL(second::read(record), 0x81020304u);
+    BOOST_REQUIRE_EQUAL(third::read(record), 0x0506u);
+}
+
+BOOST_AUTO_TEST_CASE(record_field__write__read__round_trip)
+{
+    uint8_t record[third::end] {};
+    second::write(record, 0xffeeddccu);
+    third::write(record, 0x0102u);
+    BOOST_REQUIRE_EQUAL(record[0], 0x00u);
+    BOOST_REQUIRE_EQUAL(record[1], 0xccu);
+    BOOST_REQUIRE_EQUAL(record[4], 0xffu);
+    BOOST_REQUIRE_EQUAL(second::read(record), 0xffeeddccu);
+    BOOST_REQUIRE_EQUAL(third::read(record), 0x0102u);
+}
+
+BOOST_AUTO_TEST_CASE(record_field__block_layout__stored_block_size)
+{
+    typedef block_result::layout layout;
+    BOOST_REQUIRE_EQUAL(layout::header_size, 80u);
+    BOOST_REQUIRE_EQUAL(layout::timestamp::offset, 68u);
+    BOOST_REQUIRE_EQUAL(layout::size, 99u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
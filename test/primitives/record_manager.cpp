@@ -18,6 +18,9 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+#include <vector>
+
 #include <bitcoin/database.hpp>
 #include "../utility/storage.hpp"
 
@@ -169,4 +172,61 @@ BOOST_AUTO_TEST_CASE(record_manager__get__read_write__expected)
     memory.reset();
 }
 
+BOOST_AUTO_TEST_CASE(record_manager__commit__unused_arena__excluded)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto record_size = 10u;
+    record_manager<uint32_t> manager(file, 0, record_size, 100u * record_size);
+    BOOST_REQUIRE(manager.create());
+    BOOST_REQUIRE_EQUAL(manager.allocate(3), 0u);
+    BOOST_REQUIRE_GE(file.capacity(), sizeof(uint32_t) + 100u * record_size);
+    manager.commit();
+
+    record_manager<uint32_t> restarted(file, 0, record_size);
+    BOOST_REQUIRE(restarted.start());
+    BOOST_REQUIRE_EQUAL(restarted.count(), 3u);
+    BOOST_REQUIRE_EQUAL(restarted.allocate(1), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(record_manager__allocate__concurrent__distinct)
+{
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto threads = 4u;
+    const auto allocations = 1000u;
+    record_manager<uint32_t> manager(file, 0, sizeof(uint32_t), 64);
+    BOOST_REQUIRE(manager.create());
+
+    std::vector<std::thread> writers;
+
+    for (uint32_t thread = 0; thread < threads; ++thread)
+    {
+        writers.emplace_back([&]()
+        {
+            for (auto count = 0u; count < allocations; ++count)
+            {
+                const auto link = manager.allocate(1);
+                auto memory = manager.access(link);
+                auto serial = make_unsafe_serializer(memory.buffer());
+                serial.write_4_bytes_little_endian(link);
+            }
+        });
+    }
+
+    for (auto& writer: writers)
+        writer.join();
+
+    BOOST_REQUIRE_EQUAL(manager.count(), threads * allocations);
+
+    for (uint32_t link = 0; link < manager.count(); ++link)
+    {
+        auto memory = manager.access(link);
+        auto deserial = make_unsafe_deserializer(memory.buffer());
+        BOOST_REQUIRE_EQUAL(deserial.read_4_bytes_little_endian(), link);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
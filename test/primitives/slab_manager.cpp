@@ -18,6 +18,9 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+#include <vector>
+
 #include <bitcoin/database.hpp>
 #include "../utility/storage.hpp"
 
@@ -148,4 +151,67 @@ BOOST_AUTO_TEST_CASE(slab_manager__get__read_write__expected)
     memory.reset();
 }
 
+BOOST_AUTO_TEST_CASE(slab_manager__commit__unused_arena__excluded)
+{
+    typedef uint32_t link_type;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto link_size = sizeof(link_type);
+    slab_manager<link_type> manager(file, 0, 1000);
+    BOOST_REQUIRE(manager.create());
+    BOOST_REQUIRE_EQUAL(manager.allocate(10), link_size);
+    BOOST_REQUIRE_GE(file.capacity(), link_size + 1000u);
+    manager.commit();
+
+    slab_manager<link_type> restarted(file, 0);
+    BOOST_REQUIRE(restarted.start());
+    BOOST_REQUIRE_EQUAL(restarted.payload_size(), link_size + 10u);
+    BOOST_REQUIRE_EQUAL(restarted.allocate(5), link_size + 10u);
+}
+
+BOOST_AUTO_TEST_CASE(slab_manager__allocate__concurrent__distinct)
+{
+    typedef uint32_t link_type;
+
+    test::storage file;
+    BOOST_REQUIRE(file.open());
+
+    const auto threads = 4u;
+    const auto allocations = 1000u;
+    const auto slab_size = sizeof(link_type);
+    slab_manager<link_type> manager(file, 0, 64);
+    BOOST_REQUIRE(manager.create());
+
+    std::vector<std::thread> writers;
+
+    for (uint32_t thread = 0; thread < threads; ++thread)
+    {
+        writers.emplace_back([&]()
+        {
+            for (auto count = 0u; count < allocations; ++count)
+            {
+                const auto link = manager.allocate(slab_size);
+                auto memory = manager.access(link);
+                auto serial = make_unsafe_serializer(memory.buffer());
+                serial.write_4_bytes_little_endian(link);
+            }
+        });
+    }
+
+    for (auto& writer: writers)
+        writer.join();
+
+    const auto end = manager.payload_size();
+    BOOST_REQUIRE_EQUAL(end, slab_size + threads * allocations * slab_size);
+
+    for (link_type link = slab_size; link < end; link += slab_size)
+    {
+        auto memory = manager.access(link);
+        auto deserial = make_unsafe_deserializer(memory.buffer());
+        BOOST_REQUIRE_EQUAL(deserial.read_4_bytes_little_endian(), link);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
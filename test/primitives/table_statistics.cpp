@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc::database;
+
+BOOST_AUTO_TEST_SUITE(table_statistics_tests)
+
+BOOST_AUTO_TEST_CASE(table_statistics__construct__default__zeroed)
+{
+    const table_statistics instance;
+    BOOST_REQUIRE_EQUAL(instance.buckets, 0u);
+    BOOST_REQUIRE_EQUAL(instance.sampled, 0u);
+    BOOST_REQUIRE_EQUAL(instance.elements, 0u);
+    BOOST_REQUIRE_EQUAL(instance.empty, 0u);
+    BOOST_REQUIRE_EQUAL(instance.maximum, 0u);
+    BOOST_REQUIRE_EQUAL(instance.histogram.size(), table_statistics::histogram_size);
+    BOOST_REQUIRE_EQUAL(instance.load_factor(), 0.0);
+    BOOST_REQUIRE_EQUAL(instance.estimated_elements(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(table_statistics__add__lengths__expected)
+{
+    table_statistics instance;
+    instance.buckets = 4;
+    instance.add(0);
+    instance.add(3);
+    instance.add(100);
+
+    BOOST_REQUIRE_EQUAL(instance.sampled, 3u);
+    BOOST_REQUIRE_EQUAL(instance.elements, 103u);
+    BOOST_REQUIRE_EQUAL(instance.empty, 1u);
+    BOOST_REQUIRE_EQUAL(instance.maximum, 100u);
+    BOOST_REQUIRE_EQUAL(instance.histogram[0], 1u);
+    BOOST_REQUIRE_EQUAL(instance.histogram[3], 1u);
+    BOOST_REQUIRE_EQUAL(instance.histogram[table_statistics::histogram_size - 1], 1u);
+}
+
+BOOST_AUTO_TEST_CASE(table_statistics__estimated_elements__sampled__extrapolated)
+{
+    table_statistics instance;
+    instance.buckets = 100;
+    instance.add(2);
+    instance.add(4);
+    BOOST_REQUIRE_EQUAL(instance.load_factor(), 3.0);
+    BOOST_REQUIRE_EQUAL(instance.estimated_elements(), 300u);
+}
+
+BOOST_AUTO_TEST_CASE(table_statistics__recommended_buckets__load__expected)
+{
+    table_statistics instance;
+    instance.buckets = 100;
+    instance.add(2);
+    instance.add(4);
+    BOOST_REQUIRE_EQUAL(instance.recommended_buckets(), 300u);
+    BOOST_REQUIRE_EQUAL(instance.recommended_buckets(0.5), 600u);
+    BOOST_REQUIRE_EQUAL(instance.recommended_buckets(0.0), 100u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
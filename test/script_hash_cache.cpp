@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+static hash_digest digest(uint8_t value)
+{
+    hash_digest out;
+    for (size_t index = 0; index < out.size(); ++index)
+        out[index] = static_cast<uint8_t>(value * (index + 1) + index * 31);
+
+    return out;
+}
+
+BOOST_AUTO_TEST_SUITE(script_hash_cache_tests)
+
+BOOST_AUTO_TEST_CASE(script_hash_cache__construct__zero__disabled_finds_none)
+{
+    script_hash_cache instance(0);
+    BOOST_REQUIRE(instance.disabled());
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 0u);
+
+    const point outpoint{ digest(1), 0 };
+    instance.insert(outpoint, digest(42));
+
+    hash_digest out;
+    BOOST_REQUIRE(!instance.find(out, outpoint));
+}
+
+BOOST_AUTO_TEST_CASE(script_hash_cache__insert__point__found_and_hits)
+{
+    script_hash_cache instance(64);
+    BOOST_REQUIRE(!instance.disabled());
+
+    const point outpoint{ digest(1), 3 };
+    hash_digest out;
+    BOOST_REQUIRE(!instance.find(out, outpoint));
+
+    instance.insert(outpoint, digest(42));
+    BOOST_REQUIRE(instance.find(out, outpoint));
+    BOOST_REQUIRE(out == digest(42));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(script_hash_cache__find__other_index__not_found)
+{
+    script_hash_cache instance(64);
+    instance.insert({ digest(1), 3 }, digest(42));
+
+    hash_digest out;
+    BOOST_REQUIRE(!instance.find(out, { digest(1), 4 }));
+    BOOST_REQUIRE(!instance.find(out, { digest(2), 3 }));
+}
+
+BOOST_AUTO_TEST_CASE(script_hash_cache__insert__same_slot__replaced)
+{
+    script_hash_cache instance(1);
+    instance.insert({ digest(1), 0 }, digest(41));
+    instance.insert({ digest(2), 0 }, digest(42));
+
+    hash_digest out;
+    BOOST_REQUIRE(!instance.find(out, { digest(1), 0 }));
+    BOOST_REQUIRE(instance.find(out, { digest(2), 0 }));
+    BOOST_REQUIRE(out == digest(42));
+
+    instance.clear();
+    BOOST_REQUIRE(!instance.find(out, { digest(2), 0 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
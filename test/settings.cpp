@@ -32,11 +32,70 @@ BOOST_AUTO_TEST_CASE(settings__construct__default_context__expected)
     database::settings configuration;
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(!configuration.flush_writes);
+    BOOST_REQUIRE_EQUAL(configuration.flush_latency, 0u);
+    BOOST_REQUIRE(!configuration.flush_log);
+    BOOST_REQUIRE_EQUAL(configuration.flush_log_size, 67108864u);
+    BOOST_REQUIRE_EQUAL(configuration.dirty_bytes_budget, 0u);
+    BOOST_REQUIRE(!configuration.read_only);
+    BOOST_REQUIRE_EQUAL(configuration.change_feed_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.prefetch_threads, 1u);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
+    BOOST_REQUIRE_EQUAL(configuration.file_reservation_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_populate_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_allocation_extent, 0u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 0u);
+    BOOST_REQUIRE(!configuration.block_table_huge_pages);
+    BOOST_REQUIRE(!configuration.transaction_table_huge_pages);
+    BOOST_REQUIRE(!configuration.address_table_huge_pages);
+    BOOST_REQUIRE(!configuration.block_resident_headers);
+    BOOST_REQUIRE(!configuration.block_time_index);
+    BOOST_REQUIRE(!configuration.block_candidate_states);
+    BOOST_REQUIRE(!configuration.transaction_table_fingerprints);
+    BOOST_REQUIRE(!configuration.address_table_paged);
+    BOOST_REQUIRE(!configuration.address_table_deferred);
+    BOOST_REQUIRE_EQUAL(configuration.address_table_lag, 6u);
+    BOOST_REQUIRE_EQUAL(configuration.address_script_hashes, 65536u);
+    BOOST_REQUIRE_EQUAL(configuration.address_read_ahead, 8u);
+    BOOST_REQUIRE(!configuration.address_table_lazy);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_filter_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_output_offsets, 0u);
+    BOOST_REQUIRE(!configuration.transaction_spend_column);
+    BOOST_REQUIRE(!configuration.transaction_script_compression);
+    BOOST_REQUIRE(!configuration.transaction_segregated_witnesses);
+    BOOST_REQUIRE(!configuration.transaction_undo);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_prune_depth, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.cache_bytes, 0u);
+    BOOST_REQUIRE(!configuration.cache_granular);
+    BOOST_REQUIRE(configuration.cache_eviction == cache_policy::fifo);
+    BOOST_REQUIRE(!configuration.cache_persist);
+    BOOST_REQUIRE_EQUAL(configuration.cache_misses, 4096u);
+    BOOST_REQUIRE_EQUAL(configuration.utxo_table_buckets, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.utxo_table_size, 1u);
+    BOOST_REQUIRE_EQUAL(configuration.filter_table_buckets, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.filter_table_size, 1u);
+    BOOST_REQUIRE_EQUAL(configuration.balance_table_buckets, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.balance_table_size, 1u);
+    BOOST_REQUIRE(configuration.block_table_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.candidate_index_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.confirmed_index_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.transaction_index_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.transaction_table_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.address_index_advice == database::access_advice::random);
+    BOOST_REQUIRE(configuration.address_table_advice == database::access_advice::random);
+    BOOST_REQUIRE(!configuration.block_table_prefault);
+    BOOST_REQUIRE(!configuration.block_index_prefault);
+    BOOST_REQUIRE(!configuration.transaction_buckets_prefault);
+    BOOST_REQUIRE(!configuration.prefault_pin);
+    BOOST_REQUIRE(configuration.block_table_placement == database::memory_placement::local);
+    BOOST_REQUIRE(configuration.transaction_table_placement == database::memory_placement::local);
+    BOOST_REQUIRE(configuration.address_table_placement == database::memory_placement::local);
+    BOOST_REQUIRE_EQUAL(configuration.block_table_nodes, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_table_nodes, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.address_table_nodes, 0u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.write_threads, 0u);
 }
 
 BOOST_AUTO_TEST_CASE(settings__construct__none_context__expected)
@@ -45,9 +104,15 @@ BOOST_AUTO_TEST_CASE(settings__construct__none_context__expected)
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(!configuration.flush_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
+    BOOST_REQUIRE_EQUAL(configuration.file_reservation_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_populate_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_allocation_extent, 0u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 0u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 0u);
+    BOOST_REQUIRE(!configuration.block_table_huge_pages);
+    BOOST_REQUIRE(!configuration.transaction_table_huge_pages);
+    BOOST_REQUIRE(!configuration.address_table_huge_pages);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
 }
 
@@ -57,6 +122,9 @@ BOOST_AUTO_TEST_CASE(settings__construct__mainnet_context__expected)
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(!configuration.flush_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
+    BOOST_REQUIRE_EQUAL(configuration.file_reservation_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_populate_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_allocation_extent, 0u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 650000u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 110000000u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 107000000u);
@@ -69,10 +137,37 @@ BOOST_AUTO_TEST_CASE(settings__construct__testnet_context__expected)
     BOOST_REQUIRE_EQUAL(configuration.directory, "blockchain");
     BOOST_REQUIRE(!configuration.flush_writes);
     BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
+    BOOST_REQUIRE_EQUAL(configuration.file_reservation_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_populate_size, 0u);
+    BOOST_REQUIRE_EQUAL(configuration.file_allocation_extent, 0u);
     BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 650000u);
     BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 110000000u);
     BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 107000000u);
     BOOST_REQUIRE_EQUAL(configuration.cache_capacity, 0u);
 }
 
+BOOST_AUTO_TEST_CASE(settings__auto_size__expected_chain__sized_to_chain)
+{
+    database::settings configuration;
+    configuration.auto_size(1000, 100000, 8000000);
+    BOOST_REQUIRE_EQUAL(configuration.block_table_buckets, 1000u);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 25000u);
+    BOOST_REQUIRE_EQUAL(configuration.address_table_buckets, 25000u);
+    BOOST_REQUIRE_EQUAL(configuration.block_table_size, 128000u);
+    BOOST_REQUIRE_EQUAL(configuration.candidate_index_size, 5000u);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_table_size, 50000000u);
+    BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 5u);
+    BOOST_REQUIRE_EQUAL(configuration.cache_bytes, 1000000u);
+}
+
+BOOST_AUTO_TEST_CASE(settings__auto_size__small_disk__scaled_down)
+{
+    database::settings configuration;
+    configuration.auto_size(1000, 100000, 0, 73598000);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_table_buckets, 25000u);
+    BOOST_REQUIRE_EQUAL(configuration.transaction_table_size, 25000000u);
+    BOOST_REQUIRE_EQUAL(configuration.file_growth_rate, 50u);
+    BOOST_REQUIRE_EQUAL(configuration.cache_bytes, 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
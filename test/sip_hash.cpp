@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/database.hpp>
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(sip_hash_tests)
+
+// Reference vector of the SipHash paper (key 00..0f, message 00..0e).
+BOOST_AUTO_TEST_CASE(sip_hash__reference_key__fifteen_bytes__expected)
+{
+    data_chunk message;
+    for (uint8_t byte = 0; byte < 15; ++byte)
+        message.push_back(byte);
+
+    BOOST_REQUIRE_EQUAL(sip_hash(0x0706050403020100, 0x0f0e0d0c0b0a0908, message), 0xa129ca6149be45e5);
+}
+
+BOOST_AUTO_TEST_CASE(sip_hash_key__hash__leading_little_endian_words)
+{
+    hash_digest hash{};
+    hash[0] = 0x01;
+    hash[8] = 0x02;
+    hash[16] = 0x03;
+
+    uint64_t k0;
+    uint64_t k1;
+    sip_hash_key(k0, k1, hash);
+    BOOST_REQUIRE_EQUAL(k0, 1u);
+    BOOST_REQUIRE_EQUAL(k1, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
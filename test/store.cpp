@@ -18,6 +18,9 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <bitcoin/database.hpp>
 #include "utility/utility.hpp"
 
@@ -33,15 +36,18 @@ class store_accessor
 {
 public:
     store_accessor(const path& prefix, bool indexes=false, bool flush=false,
-        bool result=true)
-      : store(prefix, indexes, flush), result_(result)
+        bool result=true, const options& features=options())
+      : store(prefix, indexes, flush, features), result_(result), flushes_(0)
     {
     }
 
-    virtual bool flush() const { return result_; }
+    virtual bool flush() const { ++flushes_; return result_; }
+
+    size_t flushes() const { return flushes_; }
 
 private:
     bool result_;
+    mutable std::atomic<size_t> flushes_;
 };
 
 struct store_directory_setup_fixture
@@ -134,6 +140,49 @@ BOOST_AUTO_TEST_CASE(store__construct__indexes__expected_files)
     BOOST_REQUIRE(store.close());
 }
 
+BOOST_AUTO_TEST_CASE(store__construct__spends__expected_files)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    store::options features;
+    features.spends = true;
+    store_accessor store(directory, false, false, true, features);
+
+    static const std::string tx_table = directory + "/" + store::TRANSACTION_TABLE;
+    static const std::string tx_spends = directory + "/" + store::TRANSACTION_SPENDS;
+    static const std::string tx_witnesses = directory + "/" + store::TRANSACTION_WITNESSES;
+
+    BOOST_REQUIRE(!test::exists(tx_table));
+    BOOST_REQUIRE(!test::exists(tx_spends));
+
+    BOOST_REQUIRE(store.create());
+
+    BOOST_REQUIRE(test::exists(tx_table));
+    BOOST_REQUIRE(test::exists(tx_spends));
+    BOOST_REQUIRE(!test::exists(tx_witnesses));
+
+    BOOST_REQUIRE(store.close());
+}
+
+BOOST_AUTO_TEST_CASE(store__construct__witnesses__expected_files)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    store::options features;
+    features.witnesses = true;
+    store_accessor store(directory, false, false, true, features);
+
+    static const std::string tx_spends = directory + "/" + store::TRANSACTION_SPENDS;
+    static const std::string tx_witnesses = directory + "/" + store::TRANSACTION_WITNESSES;
+
+    BOOST_REQUIRE(!test::exists(tx_witnesses));
+
+    BOOST_REQUIRE(store.create());
+
+    BOOST_REQUIRE(!test::exists(tx_spends));
+    BOOST_REQUIRE(test::exists(tx_witnesses));
+
+    BOOST_REQUIRE(store.close());
+}
+
 BOOST_AUTO_TEST_CASE(store__construct__exclusive_lock__expected_files)
 {
     static const std::string directory = DIRECTORY "/" + TEST_NAME;
@@ -240,6 +289,42 @@ BOOST_AUTO_TEST_CASE(store__construct__unbalanced_end_write__success)
     BOOST_REQUIRE(!test::exists(flush_lock));
 }
 
+BOOST_AUTO_TEST_CASE(store__end_write__flush_latency_concurrent_writers__shared_flush)
+{
+    static const std::string directory = DIRECTORY "/" + TEST_NAME;
+    store::options features;
+    features.flush_latency = 200;
+    store_accessor store(directory, false, true, true, features);
+
+    static const std::string flush_lock = directory + "/" + store::FLUSH_LOCK;
+    BOOST_REQUIRE(store.create());
+    BOOST_REQUIRE(store.open());
+
+    static const size_t writers = 4;
+    for (size_t writer = 0; writer < writers; ++writer)
+        BOOST_REQUIRE(store.begin_write());
+
+    BOOST_REQUIRE(test::exists(flush_lock));
+
+    std::atomic<size_t> ended(0);
+    std::vector<std::thread> threads;
+    for (size_t writer = 0; writer < writers; ++writer)
+        threads.emplace_back([&]()
+        {
+            if (store.end_write())
+                ++ended;
+        });
+
+    for (auto& thread: threads)
+        thread.join();
+
+    // Writers ending within the latency of the first share its flush.
+    BOOST_REQUIRE_EQUAL(ended.load(), writers);
+    BOOST_REQUIRE_LT(store.flushes(), writers);
+    BOOST_REQUIRE(!test::exists(flush_lock));
+    BOOST_REQUIRE(store.close());
+}
+
 BOOST_AUTO_TEST_CASE(store__open__before_create_existing_directory__success)
 {
     static const std::string directory = DIRECTORY;
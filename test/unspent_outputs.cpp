@@ -19,13 +19,25 @@
 #include <boost/test/unit_test.hpp>
 
 #include <bitcoin/database.hpp>
+#include "utility/utility.hpp"
 
 using namespace bc;
 using namespace bc::database;
 using namespace bc::system;
 using namespace bc::system::chain;
 
-BOOST_AUTO_TEST_SUITE(unspent_outputs_tests)
+// Test directory
+#define DIRECTORY "unspent_outputs"
+
+struct unspent_outputs_directory_setup_fixture
+{
+    unspent_outputs_directory_setup_fixture()
+    {
+        test::clear_path(DIRECTORY);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(unspent_outputs_tests, unspent_outputs_directory_setup_fixture)
 
 BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_0__disabled)
 {
@@ -51,6 +63,18 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_42__empty)
     BOOST_REQUIRE(cache.empty());
 }
 
+BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_42__default_shards)
+{
+    const unspent_outputs cache(42);
+    BOOST_REQUIRE_EQUAL(cache.shards(), unspent_outputs::default_shards);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__construct__capacity_below_shards__capacity_shards)
+{
+    const unspent_outputs cache(3, 0, 16);
+    BOOST_REQUIRE_EQUAL(cache.shards(), 3u);
+}
+
 BOOST_AUTO_TEST_CASE(unspent_outputs__hit_rate__default__1)
 {
     const unspent_outputs cache(0);
@@ -176,4 +200,263 @@ BOOST_AUTO_TEST_CASE(unspent_outputs__get__two_capacity_1__size_1_expected)
     BOOST_REQUIRE_EQUAL(point2b.metadata.cache.value(), expected2b);
 }
 
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__many_sharded__size_and_hits_aggregated)
+{
+    unspent_outputs cache(64, 0, 4);
+    std::vector<transaction> txs;
+
+    for (uint32_t locktime = 0; locktime < 32; ++locktime)
+    {
+        txs.push_back({ 0, locktime, {}, { {} } });
+        cache.add(txs.back(), 0, 0, false);
+    }
+
+    BOOST_REQUIRE_EQUAL(cache.size(), 32u);
+
+    for (const auto& tx: txs)
+        BOOST_REQUIRE(cache.populate({ tx.hash(), 0 }, max_size_t));
+
+    BOOST_REQUIRE_GT(cache.hit_rate(), 0.9f);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__bytes__add_remove__footprint_tracked)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    const unspent_transaction entry{ tx, 0, 0, false };
+    unspent_outputs cache(42);
+    BOOST_REQUIRE_EQUAL(cache.bytes(), 0u);
+
+    cache.add(tx, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.bytes(), entry.footprint());
+
+    cache.remove({ tx.hash(), 0 });
+    BOOST_REQUIRE_EQUAL(cache.bytes(), entry.footprint() -
+        unspent_transaction::footprint(tx.outputs()[0]));
+
+    cache.remove({ tx.hash(), 1 });
+    BOOST_REQUIRE(cache.empty());
+    BOOST_REQUIRE_EQUAL(cache.bytes(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__byte_budget_reached__oldest_evicted)
+{
+    static const transaction tx1{ 0, 1, {}, { {} } };
+    static const transaction tx2{ 0, 2, {}, { {} } };
+    static const transaction tx3{ 0, 3, {}, { {} } };
+    const auto cost = unspent_transaction{ tx1, 0, 0, false }.footprint();
+    unspent_outputs cache(42, 2 * cost, 1);
+    cache.add(tx1, 0, 0, false);
+    cache.add(tx2, 0, 0, false);
+    cache.add(tx3, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE_EQUAL(cache.bytes(), 2 * cost);
+    BOOST_REQUIRE(!cache.populate({ tx1.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(cache.populate({ tx2.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(cache.populate({ tx3.hash(), 0 }, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__beyond_byte_budget__not_cached)
+{
+    static const transaction tx1{ 0, 1, {}, { {} } };
+    static const transaction tx2{ 0, 2, {}, { {}, {}, {}, {} } };
+    const auto cost = unspent_transaction{ tx1, 0, 0, false }.footprint();
+    unspent_outputs cache(42, cost, 1);
+    cache.add(tx1, 0, 0, false);
+    cache.add(tx2, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE(cache.populate({ tx1.hash(), 0 }, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__granular__entry_per_output)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    unspent_outputs cache(42, 0, 1, true);
+    cache.add(tx, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+
+    chain::output_point point{ tx.hash(), 1 };
+    BOOST_REQUIRE(cache.populate(point, max_size_t));
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__granular_capacity_1__oldest_output_evicted)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    unspent_outputs cache(1, 0, 1, true);
+    cache.add(tx, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE(!cache.populate({ tx.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(cache.populate({ tx.hash(), 1 }, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__remove__granular__outputs_removed)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} }, { 2, {} } } };
+    unspent_outputs cache(42, 0, 1, true);
+    cache.add(tx, 0, 0, false);
+    cache.remove({ tx.hash(), 1 });
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE(!cache.populate({ tx.hash(), 1 }, max_size_t));
+    BOOST_REQUIRE(cache.populate({ tx.hash(), 2 }, max_size_t));
+
+    cache.remove(tx);
+    BOOST_REQUIRE(cache.empty());
+    BOOST_REQUIRE_EQUAL(cache.bytes(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__stored_outputs__subset_cached)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} }, { 2, {} } } };
+    unspent_outputs cache(42);
+    cache.add(tx.hash(), { { 2, tx.outputs()[2] } }, 10, 42, true, true);
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE(!cache.contains({ tx.hash(), 0 }));
+    BOOST_REQUIRE(cache.contains({ tx.hash(), 2 }));
+
+    // Contains is not counted as a query.
+    BOOST_REQUIRE_EQUAL(cache.hit_rate(), 1.0f);
+
+    const chain::output_point point{ tx.hash(), 2 };
+    BOOST_REQUIRE(cache.populate(point, max_size_t));
+    BOOST_REQUIRE(point.metadata.confirmed);
+    BOOST_REQUIRE(point.metadata.coinbase);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 10u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 42u);
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__granular_stored_outputs__entry_per_output)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} }, { 2, {} } } };
+    unspent_outputs cache(42, 0, 1, true);
+    cache.add(tx.hash(), { { 0, tx.outputs()[0] }, { 2, tx.outputs()[2] } }, 10,
+        42, false, true);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+    BOOST_REQUIRE(cache.contains({ tx.hash(), 0 }));
+    BOOST_REQUIRE(!cache.contains({ tx.hash(), 1 }));
+    BOOST_REQUIRE(cache.contains({ tx.hash(), 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__fifo_hit_oldest__oldest_evicted)
+{
+    static const transaction tx1{ 0, 1, {}, { {} } };
+    static const transaction tx2{ 0, 2, {}, { {} } };
+    static const transaction tx3{ 0, 3, {}, { {} } };
+    unspent_outputs cache(2, 0, 1);
+    BOOST_REQUIRE(cache.policy() == cache_policy::fifo);
+    cache.add(tx1, 0, 0, false);
+    cache.add(tx2, 0, 0, false);
+    BOOST_REQUIRE(cache.populate({ tx1.hash(), 0 }, max_size_t));
+
+    cache.add(tx3, 0, 0, false);
+    BOOST_REQUIRE(!cache.populate({ tx1.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE_EQUAL(cache.evictions(), 1u);
+    BOOST_REQUIRE_EQUAL(cache.promotions(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__add__clock_hit_oldest__oldest_promoted)
+{
+    static const transaction tx1{ 0, 1, {}, { {} } };
+    static const transaction tx2{ 0, 2, {}, { {} } };
+    static const transaction tx3{ 0, 3, {}, { {} } };
+    static const transaction tx4{ 0, 4, {}, { {} } };
+    unspent_outputs cache(2, 0, 1, false, cache_policy::clock);
+    cache.add(tx1, 0, 0, false);
+    cache.add(tx2, 0, 0, false);
+    BOOST_REQUIRE(cache.populate({ tx1.hash(), 0 }, max_size_t));
+
+    // The hit entry is passed over once, the unreferenced entry is evicted.
+    cache.add(tx3, 0, 0, false);
+    BOOST_REQUIRE(cache.populate({ tx1.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(!cache.populate({ tx2.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE_EQUAL(cache.evictions(), 1u);
+    BOOST_REQUIRE_EQUAL(cache.promotions(), 1u);
+
+    // The rehit entry is again passed over for the newer unreferenced one.
+    cache.add(tx4, 0, 0, false);
+    BOOST_REQUIRE(cache.populate({ tx1.hash(), 0 }, max_size_t));
+    BOOST_REQUIRE(!cache.populate({ tx3.hash(), 0 }, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__promote__pooled__confirmed_in_place)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    unspent_outputs cache(42);
+    cache.add(tx, 0, 0, false);
+    const auto bytes = cache.bytes();
+    BOOST_REQUIRE(cache.promote(tx, 41, 43));
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE_EQUAL(cache.bytes(), bytes);
+
+    chain::output_point point{ tx.hash(), 1 };
+    BOOST_REQUIRE(cache.populate(point, 41));
+    BOOST_REQUIRE(point.metadata.confirmed);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 41u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 43u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__promote__granular_pooled__confirmed_in_place)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    unspent_outputs cache(42, 0, 1, true);
+    cache.add(tx, 0, 0, false);
+    cache.remove({ tx.hash(), 0 });
+    BOOST_REQUIRE(cache.promote(tx, 41, 43));
+
+    chain::output_point point{ tx.hash(), 1 };
+    BOOST_REQUIRE(cache.populate(point, 41));
+    BOOST_REQUIRE(point.metadata.confirmed);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 41u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__promote__not_cached__false)
+{
+    static const transaction tx{ 0, 0, {}, { {} } };
+    unspent_outputs cache(42);
+    BOOST_REQUIRE(!cache.promote(tx, 41, 43));
+    BOOST_REQUIRE(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__load__saved__round_trips)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const transaction tx1{ 0, 1, {}, { { 0, {} }, { 1, {} } } };
+    static const transaction tx2{ 0, 2, {}, { { 2, {} } } };
+    unspent_outputs saved(42, 0, 4);
+    saved.add(tx1, 41, 43, true);
+    saved.add(tx2, 0, 0, false);
+    BOOST_REQUIRE(saved.save(file, 24, 41));
+
+    unspent_outputs loaded(42, 0, 2);
+    BOOST_REQUIRE(loaded.load(file, 24, 41));
+    BOOST_REQUIRE_EQUAL(loaded.size(), 2u);
+    BOOST_REQUIRE_EQUAL(loaded.bytes(), saved.bytes());
+
+    chain::output_point point{ tx1.hash(), 1 };
+    BOOST_REQUIRE(loaded.populate(point, 41));
+    BOOST_REQUIRE(point.metadata.confirmed);
+    BOOST_REQUIRE_EQUAL(point.metadata.height, 41u);
+    BOOST_REQUIRE_EQUAL(point.metadata.median_time_past, 43u);
+    BOOST_REQUIRE_EQUAL(point.metadata.cache.value(), 1u);
+    BOOST_REQUIRE(loaded.populate({ tx2.hash(), 0 }, 41));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_outputs__load__stale__false_cleared)
+{
+    static const std::string file = DIRECTORY "/" + TEST_NAME;
+    static const transaction tx{ 0, 1, {}, { {} } };
+    unspent_outputs saved(42);
+    saved.add(tx, 41, 43, true);
+    BOOST_REQUIRE(saved.save(file, 24, 41));
+
+    unspent_outputs loaded(42);
+    loaded.add(tx, 41, 43, true);
+    BOOST_REQUIRE(!loaded.load(file, 24, 42));
+    BOOST_REQUIRE(loaded.empty());
+    BOOST_REQUIRE(!loaded.load(file, 25, 41));
+
+    unspent_outputs granular(42, 0, 1, true);
+    BOOST_REQUIRE(!granular.load(file, 24, 41));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
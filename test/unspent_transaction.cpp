@@ -128,6 +128,35 @@ BOOST_AUTO_TEST_CASE(unspent_transaction__equal__tx_hash_only__true)
     BOOST_REQUIRE(unspent_transaction(tx, 0, 0, false) == unspent_transaction(tx.hash()));
 }
 
+BOOST_AUTO_TEST_CASE(unspent_transaction__construct4__output__single_output)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    const unspent_transaction instance(tx, 1, 0, 0, false);
+    BOOST_REQUIRE_EQUAL(instance.index(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.outputs()->size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.outputs()->at(1).value(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(unspent_transaction__equal__distinct_index__false)
+{
+    static const transaction tx{ 0, 0, {}, { { 0, {} }, { 1, {} } } };
+    const unspent_transaction instance(tx, 1, 0, 0, false);
+    BOOST_REQUIRE(instance == unspent_transaction(tx.hash(), 1));
+    BOOST_REQUIRE(!(instance == unspent_transaction(tx.hash(), 0)));
+    BOOST_REQUIRE(!(instance == unspent_transaction(tx.hash())));
+}
+
+BOOST_AUTO_TEST_CASE(unspent_transaction__confirm__unconfirmed__promoted)
+{
+    static const transaction tx{ 0, 0, {}, { {} } };
+    const unspent_transaction instance(tx, 0, 0, false);
+    instance.confirm(41, 42);
+    BOOST_REQUIRE(instance.is_confirmed());
+    BOOST_REQUIRE_EQUAL(instance.height(), 41u);
+    BOOST_REQUIRE_EQUAL(instance.median_time_past(), 42u);
+    BOOST_REQUIRE(instance == unspent_transaction(tx.hash()));
+}
+
 BOOST_AUTO_TEST_CASE(unspent_transaction__move_assign__coinbase_tx_hash_height__expected)
 {
     static const transaction tx{ 0, 0, { { { null_hash, point::null_index }, {}, 0 } }, {} };
@@ -18,6 +18,7 @@
  */
 #include "storage.hpp"
 
+#include <algorithm>
 #include <utility>
 #include <bitcoin/database.hpp>
 
@@ -85,6 +86,12 @@ bool storage::close()
     return true;
 }
 
+// The buffer is not shared, so there is no other writer to follow.
+bool storage::refresh()
+{
+    return !closed();
+}
+
 bool storage::closed() const
 {
     shared_lock lock(mutex_);
@@ -109,6 +116,17 @@ memory_ptr storage::access()
     return memory;
 }
 
+uint8_t* storage::lock_shared()
+{
+    mutex_.lock_shared();
+    return buffer_.data();
+}
+
+void storage::unlock_shared()
+{
+    mutex_.unlock_shared();
+}
+
 memory_ptr storage::resize(size_t size)
 {
     return reserve(size);
@@ -131,4 +149,17 @@ memory_ptr storage::reserve(size_t size)
     return memory;
 }
 
+void storage::dirty(const uint8_t*, size_t)
+{
+}
+
+void storage::prefetch(const uint8_t*, size_t, bool)
+{
+}
+
+void storage::punch(uint8_t* position, size_t size)
+{
+    std::fill_n(position, size, 0x00);
+}
+
 } // namespace test
@@ -36,12 +36,18 @@ public:
     bool open();
     bool flush() const;
     bool close();
+    bool refresh();
     bool closed() const;
     size_t capacity() const;
     size_t logical() const;
     bc::database::memory_ptr access();
+    uint8_t* lock_shared();
+    void unlock_shared();
     bc::database::memory_ptr resize(size_t size);
     bc::database::memory_ptr reserve(size_t size);
+    void dirty(const uint8_t* position, size_t size);
+    void prefetch(const uint8_t* position, size_t size, bool advise);
+    void punch(uint8_t* position, size_t size);
 
 private:
     bool closed_;
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_DEFRAGMENT_DIR_MISSING \
+    "Failed because the directory %1% does not exist.\n"
+#define BS_DEFRAGMENT_FAIL \
+    "Failed to defragment the transaction table.\n"
+#define BS_DEFRAGMENT_INDEX \
+    "The address index was removed, rebuild it with initindex.\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace boost::filesystem;
+using boost::format;
+
+// Rewrite the transaction table of an existing (closed) mainnet database in
+// confirmation order, dropping pooled transactions.
+int main(int argc, char** argv)
+{
+    std::string prefix("mainnet");
+
+    if (argc > 1)
+        prefix = argv[1];
+
+    if (!exists(prefix))
+    {
+        std::cerr << format(BS_DEFRAGMENT_DIR_MISSING) % prefix;
+        return -1;
+    }
+
+    // This defragments a default configuration database only!
+    const auto catalog = false;
+    database::settings configuration;
+    configuration.directory = prefix;
+    const auto indexed = exists(path(prefix) / store::ADDRESS_TABLE);
+
+    if (!data_base(configuration, catalog).defragment())
+    {
+        std::cerr << BS_DEFRAGMENT_FAIL;
+        return -1;
+    }
+
+    if (indexed)
+        std::cout << BS_DEFRAGMENT_INDEX;
+
+    return 0;
+}
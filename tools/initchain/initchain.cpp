@@ -16,7 +16,17 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <bitcoin/database.hpp>
@@ -27,6 +37,16 @@
     "Failed because the directory %1% already exists.\n"
 #define BS_INITCHAIN_FAIL \
     "Failed to initialize database files.\n"
+#define BS_INITCHAIN_SIZE_INVALID \
+    "Failed to parse the expected size %1%, as --size=blocks,transactions.\n"
+#define BS_INITCHAIN_BOOTSTRAP_MISSING \
+    "Failed to open the bootstrap file %1%.\n"
+#define BS_INITCHAIN_BOOTSTRAP_INVALID \
+    "Failed to read the bootstrap block at height %1%.\n"
+#define BS_INITCHAIN_BOOTSTRAP_FAIL \
+    "Failed to push the bootstrap blocks from height %1%, '%2%'.\n"
+#define BS_INITCHAIN_BOOTSTRAP_LOADED \
+    "Loaded %1% bootstrap blocks.\n"
 
 using namespace bc;
 using namespace bc::database;
@@ -36,15 +56,192 @@ using namespace boost::filesystem;
 using namespace boost::system;
 using boost::format;
 
-// Create a new mainnet database.
+// The number of blocks parsed in parallel and pushed in one write.
+static constexpr size_t batch_size = 1000;
+
+// The bootstrap file is framed as by the linearized block files of the
+// satoshi client, with the blocks in height order from the genesis block:
+// network magic (4), block size (4), block (wire, witness).
+static bool read_frame(std::ifstream& file, data_chunk& out)
+{
+    data_chunk frame(2 * sizeof(uint32_t));
+
+    if (!file.read(reinterpret_cast<char*>(frame.data()), frame.size()))
+        return false;
+
+    out.resize(from_little_endian_unsafe<uint32_t>(frame.data() +
+        sizeof(uint32_t)));
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()),
+        out.size()));
+}
+
+// Parse the frames into blocks, each thread its own stride of the batch.
+static bool parse(const std::vector<data_chunk>& frames,
+    std::vector<block>& out)
+{
+    const auto count = frames.size();
+    const auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<char> valid(count, 0);
+    std::vector<std::thread> workers;
+    out.resize(count);
+
+    for (size_t thread = 0; thread < threads; ++thread)
+        workers.emplace_back([&, thread]()
+        {
+            for (auto index = thread; index < count; index += threads)
+                valid[index] = out[index].from_data(frames[index], true);
+        });
+
+    for (auto& worker: workers)
+        worker.join();
+
+    return std::all_of(valid.begin(), valid.end(), [](char value)
+    {
+        return value != 0;
+    });
+}
+
+// The median of the timestamps of the preceding (up to) eleven blocks.
+static uint32_t median_time_past(const std::deque<uint32_t>& timestamps)
+{
+    std::vector<uint32_t> sorted(timestamps.begin(), timestamps.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2u];
+}
+
+// Load the blocks following genesis under the checkpoint assumption, so the
+// blocks are not validated, though each must be linked to its predecessor.
+static int bootstrap(data_base& database, std::ifstream& file,
+    const block& genesis)
+{
+    std::deque<uint32_t> timestamps{ genesis.header().timestamp() };
+    auto previous = genesis.hash();
+    size_t height = 1;
+
+    while (file.peek() != std::ifstream::traits_type::eof())
+    {
+        std::vector<data_chunk> frames;
+
+        for (data_chunk frame; frames.size() < batch_size &&
+            file.peek() != std::ifstream::traits_type::eof();)
+        {
+            if (!read_frame(file, frame))
+            {
+                std::cerr << format(BS_INITCHAIN_BOOTSTRAP_INVALID) %
+                    (height + frames.size());
+                return -1;
+            }
+
+            frames.push_back(std::move(frame));
+        }
+
+        std::vector<block> parsed;
+
+        if (!parse(frames, parsed))
+        {
+            std::cerr << format(BS_INITCHAIN_BOOTSTRAP_INVALID) % height;
+            return -1;
+        }
+
+        block_const_ptr_list blocks;
+        blocks.reserve(parsed.size());
+
+        for (auto& next: parsed)
+        {
+            if (next.header().previous_block_hash() != previous)
+            {
+                std::cerr << format(BS_INITCHAIN_BOOTSTRAP_INVALID) %
+                    (height + blocks.size());
+                return -1;
+            }
+
+            next.header().metadata.median_time_past =
+                median_time_past(timestamps);
+
+            timestamps.push_back(next.header().timestamp());
+            if (timestamps.size() > 11u)
+                timestamps.pop_front();
+
+            previous = next.hash();
+            blocks.push_back(std::make_shared<const message::block>(
+                std::move(next)));
+        }
+
+        const auto ec = database.push(blocks, height);
+
+        if (ec)
+        {
+            std::cerr << format(BS_INITCHAIN_BOOTSTRAP_FAIL) % height %
+                ec.message();
+            return -1;
+        }
+
+        height += blocks.size();
+    }
+
+    std::cout << format(BS_INITCHAIN_BOOTSTRAP_LOADED) % (height - 1u);
+    return 0;
+}
+
+// Parse the expected chain size of the --size=blocks,transactions option.
+static bool parse_size(const std::string& value, uint64_t& blocks,
+    uint64_t& transactions)
+{
+    const auto separator = value.find(',');
+
+    if (separator == std::string::npos)
+        return false;
+
+    try
+    {
+        size_t end;
+        blocks = std::stoull(value.substr(0, separator), &end);
+
+        if (end != separator)
+            return false;
+
+        const auto rest = value.substr(separator + 1u);
+        transactions = std::stoull(rest, &end);
+        return end == rest.size();
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+// Create a new mainnet database, or one of the blocks of a bootstrap file,
+// optionally sized to the expected chain (and the available disk).
 int main(int argc, char** argv)
 {
+    static const std::string size_option("--size=");
     std::string prefix("mainnet");
+    std::string bootstrap_file;
+    auto clean = false;
+    uint64_t blocks = 0;
+    uint64_t transactions = 0;
 
     if (argc > 1)
         prefix = argv[1];
 
-    if (argc > 2 && std::string("--clean") == argv[2])
+    for (auto arg = 2; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (option == "--clean")
+            clean = true;
+        else if (option.compare(0, size_option.size(), size_option) != 0)
+            bootstrap_file = option;
+        else if (!parse_size(option.substr(size_option.size()), blocks,
+            transactions))
+        {
+            std::cerr << format(BS_INITCHAIN_SIZE_INVALID) % option;
+            return -1;
+        }
+    }
+
+    if (clean)
         remove_all(prefix);
 
     error_code code;
@@ -59,18 +256,52 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    // This creates a default configuration database only!
+    // This creates a default configuration database unless sized.
     const auto catalog = false;
-    const database::settings configuration;
+    database::settings configuration;
     const system::settings bitcoin_configuration(
         system::config::settings::mainnet);
 
-    if (!data_base(configuration, catalog).create(
-        bitcoin_configuration.genesis_block))
+    if (blocks != 0 || transactions != 0)
+        configuration.auto_size(blocks, transactions, 0,
+            space(prefix).available);
+
+    if (bootstrap_file.empty())
+    {
+        if (!data_base(configuration, catalog).create(
+            bitcoin_configuration.genesis_block))
+        {
+            std::cerr << BS_INITCHAIN_FAIL;
+            return -1;
+        }
+
+        return 0;
+    }
+
+    std::ifstream file(bootstrap_file, std::ios::binary);
+    data_chunk frame;
+    block genesis;
+
+    if (!file.good())
+    {
+        std::cerr << format(BS_INITCHAIN_BOOTSTRAP_MISSING) % bootstrap_file;
+        return -1;
+    }
+
+    // The first block of the file is the genesis block of the store.
+    if (!read_frame(file, frame) || !genesis.from_data(frame, true))
+    {
+        std::cerr << format(BS_INITCHAIN_BOOTSTRAP_INVALID) % 0;
+        return -1;
+    }
+
+    data_base database(configuration, catalog);
+
+    if (!database.create(genesis))
     {
         std::cerr << BS_INITCHAIN_FAIL;
         return -1;
     }
 
-    return 0;
+    return bootstrap(database, file, genesis);
 }
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_INITINDEX_DIR_MISSING \
+    "Failed because the directory %1% does not exist.\n"
+#define BS_INITINDEX_FAIL \
+    "Failed to build the address index, its files must not exist.\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace boost::filesystem;
+using boost::format;
+
+// Build the address index of an existing mainnet database.
+int main(int argc, char** argv)
+{
+    std::string prefix("mainnet");
+
+    if (argc > 1)
+        prefix = argv[1];
+
+    if (!exists(prefix))
+    {
+        std::cerr << format(BS_INITINDEX_DIR_MISSING) % prefix;
+        return -1;
+    }
+
+    // This indexes a default configuration database only!
+    const auto catalog = true;
+    database::settings configuration;
+    configuration.directory = prefix;
+
+    // Heights are partitioned across the write threads.
+    if (argc > 2)
+        configuration.write_threads = std::stoul(argv[2]);
+
+    data_base database(configuration, catalog);
+
+    if (!database.build_addresses() || !database.close())
+    {
+        std::cerr << BS_INITINDEX_FAIL;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_RESIDENCY_DIR_MISSING \
+    "Failed because the directory %1% does not exist.\n"
+#define BS_RESIDENCY_OPEN_FAIL \
+    "Failed to open the database.\n"
+#define BS_RESIDENCY_HEADER \
+    "table (MB)         mapped    logical   head      resident  dirty\n"
+#define BS_RESIDENCY_ROW \
+    "%-18s %-9.1f %-9.1f %-9.1f %-9.1f %-9.1f\n"
+#define BS_RESIDENCY_SPLIT \
+    "  buckets %.1f of %.1f MB resident, body %.1f of %.1f MB resident\n"
+#define BS_RESIDENCY_CACHE \
+    "output cache       %.1f MB\n"
+
+using namespace bc;
+using namespace bc::database;
+using namespace bc::system;
+using namespace boost::filesystem;
+using boost::format;
+
+static double megabytes(uint64_t bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+static void report(const std::string& name, const storage_residency& table)
+{
+    const auto resident = table.head_resident + table.body_resident;
+    std::cout << format(BS_RESIDENCY_ROW) % name % megabytes(table.mapped) %
+        megabytes(table.logical) % megabytes(table.head) %
+        megabytes(resident) % megabytes(table.dirty);
+
+    if (table.head != 0)
+        std::cout << format(BS_RESIDENCY_SPLIT) %
+            megabytes(table.head_resident) % megabytes(table.head) %
+            megabytes(table.body_resident) %
+            megabytes(table.logical - table.head);
+}
+
+// Report the memory footprint of each table of an existing mainnet database.
+// The store is opened read-only, so it may be open by a node, and as the page
+// cache is shared the resident pages are those of the node.
+int main(int argc, char** argv)
+{
+    std::string prefix("mainnet");
+
+    if (argc > 1)
+        prefix = argv[1];
+
+    if (!exists(prefix))
+    {
+        std::cerr << format(BS_RESIDENCY_DIR_MISSING) % prefix;
+        return -1;
+    }
+
+    // This reports a default configuration database only!
+    database::settings configuration;
+    configuration.directory = prefix;
+    configuration.read_only = true;
+    const auto catalog = exists(path(prefix) / store::ADDRESS_TABLE);
+    data_base database(configuration, catalog);
+
+    if (!database.open())
+    {
+        std::cerr << BS_RESIDENCY_OPEN_FAIL;
+        return -1;
+    }
+
+    const auto tables = database.residency();
+    std::cout << BS_RESIDENCY_HEADER;
+    report("block_table", tables.block_table);
+    report("candidate_index", tables.candidate_index);
+    report("confirmed_index", tables.confirmed_index);
+    report("transaction_index", tables.transaction_index);
+    report("transaction_table", tables.transaction_table);
+
+    if (catalog)
+    {
+        report("address_table", tables.address_table);
+        report("address_rows", tables.address_index);
+    }
+
+    if (tables.utxo_table.logical != 0)
+        report("utxo_table", tables.utxo_table);
+
+    if (tables.filter_table.logical != 0)
+        report("filter_table", tables.filter_table);
+
+    if (tables.balance_table.logical != 0)
+        report("balance_table", tables.balance_table);
+
+    report("total", tables.total());
+
+    // The output cache is of this process, so is empty unless loaded.
+    std::cout << format(BS_RESIDENCY_CACHE) % megabytes(tables.output_cache);
+    return database.close() ? 0 : -1;
+}